@@ -46,12 +46,11 @@
 #ifndef SRSLTE_BUFFER_POOL_H
 #define SRSLTE_BUFFER_POOL_H
 
+#include <atomic>
 #include <pthread.h>
-#include <vector>
-#include <stack>
 #include <map>
 #include <string>
-#include <algorithm>
+#include <time.h>
 
 /*******************************************************************************
                               INCLUDES
@@ -62,6 +61,12 @@
 
 namespace srslte {
 
+typedef struct {
+  uint32_t capacity;
+  uint32_t nof_used;
+  uint32_t high_water_mark; // most buffers in use at once since the previous report
+} buffer_pool_metrics_t;
+
 /******************************************************************************
  * Buffer pool
  *
@@ -69,6 +74,12 @@ namespace srslte {
  * deallocate functions. Provides quick object creation and deletion as well
  * as object reuse. 
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
+ *
+ * Free buffers are kept in an intrusive list. Threads allocate from and
+ * release to a small magazine of their own, which exchanges half of its
+ * buffers with the shared list at once, so the shared lock is only taken every
+ * few operations. With SRSLTE_BUFFER_POOL_LOG_ENABLED the buffers in use and
+ * their debug names are found by walking the preallocated buffers.
  *****************************************************************************/
 
 template <class buffer_t>
@@ -76,7 +87,7 @@ class buffer_pool{
 public:
   
   // non-static methods
-  buffer_pool(int capacity_ = -1)
+  buffer_pool(int capacity_ = -1) : nof_used(0), high_water_mark(0), nof_waiters(0)
   {
     uint32_t nof_buffers = POOL_SIZE;
     if (capacity_ > 0) {
@@ -84,22 +95,25 @@ public:
     }
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cv_not_empty, NULL);
-    for(uint32_t i=0;i<nof_buffers;i++) {
-      buffer_t *b = new buffer_t;
-      available.push(b);
+    items     = new item_t[nof_buffers];
+    free_list = NULL;
+    for (uint32_t i = 0; i < nof_buffers; i++) {
+      items[nof_buffers - 1 - i].next   = free_list;
+      items[nof_buffers - 1 - i].in_use = false;
+      free_list                         = &items[nof_buffers - 1 - i];
+    }
+    for (uint32_t i = 0; i < NOF_MAGAZINES; i++) {
+      pthread_mutex_init(&magazines[i].mutex, NULL);
+      magazines[i].count = 0;
     }
     capacity = nof_buffers; 
   }
 
   ~buffer_pool() { 
-    // this destructor assumes all buffers have been properly deallocated 
-    while(available.size()) {
-      delete available.top();
-      available.pop();
-    }
-
-    for (uint32_t i = 0; i < used.size(); i++) {
-      delete used[i];
+    // all buffers are released with the pool, whether deallocated or not
+    delete[] items;
+    for (uint32_t i = 0; i < NOF_MAGAZINES; i++) {
+      pthread_mutex_destroy(&magazines[i].mutex);
     }
     pthread_cond_destroy(&cv_not_empty);
     pthread_mutex_destroy(&mutex);
@@ -107,11 +121,13 @@ public:
   
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", (int) used.size());
+    printf("%d buffers in queue\n", (int) nof_used);
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     std::map<std::string, uint32_t> buffer_cnt;
-    for (uint32_t i=0;i<used.size();i++) {
-      buffer_cnt[strlen(used[i]->debug_name)?used[i]->debug_name:"Undefined"]++;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (items[i].in_use) {
+        buffer_cnt[strlen(items[i].buf.debug_name) ? items[i].buf.debug_name : "Undefined"]++;
+      }
     }
     std::map<std::string, uint32_t>::iterator it;
     for (it = buffer_cnt.begin(); it != buffer_cnt.end(); it++) {
@@ -121,79 +137,177 @@ public:
   }
 
   uint32_t nof_available_pdus() {
-    return available.size();
+    return capacity - nof_used;
   }
 
   bool is_almost_empty() {
-    return available.size() < capacity/20;
+    return nof_available_pdus() < capacity/20;
+  }
+
+  void get_metrics(buffer_pool_metrics_t* m)
+  {
+    m->capacity        = capacity;
+    m->nof_used        = nof_used;
+    m->high_water_mark = high_water_mark.exchange(nof_used);
   }
 
   buffer_t* allocate(const char *debug_name = NULL, bool blocking = false) {
-    pthread_mutex_lock(&mutex);
-    buffer_t *b = NULL;
+    magazine_t* mag = &magazines[magazine_idx()];
 
-    if (available.size() > 0) {
-      b = available.top();
-      used.push_back(b);
-      available.pop();
+    pthread_mutex_lock(&mag->mutex);
+    if (mag->count == 0) {
+      pthread_mutex_lock(&mutex);
+      while (mag->count < BATCH_SIZE && free_list) {
+        mag->items[mag->count++] = free_list;
+        free_list                = free_list->next;
+      }
+      pthread_mutex_unlock(&mutex);
+    }
+    item_t* item = mag->count ? mag->items[--mag->count] : NULL;
+    pthread_mutex_unlock(&mag->mutex);
 
-      if (is_almost_empty()) {
-        printf("Warning buffer pool capacity is %f %%\n", (float) 100 * available.size() / capacity);
+    // The remaining buffers may sit in the magazines of other threads
+    while (item == NULL) {
+      item = steal();
+      if (item || !blocking) {
+        break;
       }
-#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
-      if (debug_name) {
-        strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
-        b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+      // Releases go to the shared list while someone waits, the timeout
+      // covers those that were already on their way to a magazine
+      struct timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      ts.tv_nsec += 1000000;
+      if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
       }
-#endif
-    } else if (blocking) {
-      // blocking allocation
-      while(available.size() == 0) {
-        pthread_cond_wait(&cv_not_empty, &mutex);
+      pthread_mutex_lock(&mutex);
+      nof_waiters++;
+      if (free_list == NULL) {
+        pthread_cond_timedwait(&cv_not_empty, &mutex, &ts);
       }
-
-      // retrieve the new buffer
-      b = available.top();
-      used.push_back(b);
-      available.pop();
-
-      // do not print any warning
+      nof_waiters--;
+      pthread_mutex_unlock(&mutex);
     }
-    else {
+
+    if (item == NULL) {
       printf("Error - buffer pool is empty\n");
-      
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
       print_all_buffers();
 #endif
+      return NULL;
     }
 
-    pthread_mutex_unlock(&mutex);
-    return b;
+    item->in_use.store(true, std::memory_order_relaxed);
+    uint32_t used = ++nof_used;
+    uint32_t hwm  = high_water_mark.load(std::memory_order_relaxed);
+    while (used > hwm && !high_water_mark.compare_exchange_weak(hwm, used, std::memory_order_relaxed)) {
+    }
+
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+    if (debug_name) {
+      strncpy(item->buf.debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
+      item->buf.debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
+    return &item->buf;
   }
   
   bool deallocate(buffer_t *b)
   {
-    bool ret = false; 
-    pthread_mutex_lock(&mutex);
-    typename std::vector<buffer_t*>::iterator elem = std::find(used.begin(), used.end(), b);
-    if (elem != used.end()) {
-      used.erase(elem); 
-      available.push(b);
-      ret = true; 
+    // buf is the first member, so the item starts where the buffer does
+    item_t* item = reinterpret_cast<item_t*>(b);
+    if (item < items || item >= items + capacity || ((uint8_t*)item - (uint8_t*)items) % sizeof(item_t)) {
+      return false;
     }
-    pthread_cond_signal(&cv_not_empty);
-    pthread_mutex_unlock(&mutex);
-    return ret; 
+    // Only one of several threads freeing the same buffer may put it back
+    if (!item->in_use.exchange(false, std::memory_order_acq_rel)) {
+      return false;
+    }
+    nof_used--;
+
+    if (nof_waiters) {
+      pthread_mutex_lock(&mutex);
+      item->next = free_list;
+      free_list  = item;
+      pthread_cond_signal(&cv_not_empty);
+      pthread_mutex_unlock(&mutex);
+      return true;
+    }
+
+    magazine_t* mag = &magazines[magazine_idx()];
+    pthread_mutex_lock(&mag->mutex);
+    if (mag->count == MAGAZINE_SIZE) {
+      pthread_mutex_lock(&mutex);
+      while (mag->count > MAGAZINE_SIZE - BATCH_SIZE) {
+        item_t* it = mag->items[--mag->count];
+        it->next   = free_list;
+        free_list  = it;
+      }
+      pthread_mutex_unlock(&mutex);
+    }
+    mag->items[mag->count++] = item;
+    pthread_mutex_unlock(&mag->mutex);
+    return true;
   }
 
   
 private:  
-  static const int       POOL_SIZE = 4096;
-  std::stack<buffer_t*>  available;
-  std::vector<buffer_t*> used; 
+  static const int       POOL_SIZE     = 4096;
+  static const uint32_t  NOF_MAGAZINES = 16;
+  static const uint32_t  MAGAZINE_SIZE = 32;
+  static const uint32_t  BATCH_SIZE    = MAGAZINE_SIZE / 2;
+
+  typedef struct item_s {
+    buffer_t          buf;
+    struct item_s*    next;
+    std::atomic<bool> in_use;
+  } item_t;
+
+  typedef struct {
+    pthread_mutex_t mutex;
+    item_t*         items[MAGAZINE_SIZE];
+    uint32_t        count;
+  } magazine_t;
+
+  // Threads are spread over the magazines in the order they first use a pool
+  static uint32_t magazine_idx()
+  {
+    static std::atomic<uint32_t> nof_threads(0);
+    static thread_local uint32_t idx = nof_threads++ % NOF_MAGAZINES;
+    return idx;
+  }
+
+  // Takes a buffer from the shared list or, if empty, from any magazine
+  item_t* steal()
+  {
+    item_t* item = NULL;
+    pthread_mutex_lock(&mutex);
+    if (free_list) {
+      item      = free_list;
+      free_list = free_list->next;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    for (uint32_t i = 0; i < NOF_MAGAZINES && item == NULL; i++) {
+      pthread_mutex_lock(&magazines[i].mutex);
+      if (magazines[i].count) {
+        item = magazines[i].items[--magazines[i].count];
+      }
+      pthread_mutex_unlock(&magazines[i].mutex);
+    }
+    return item;
+  }
+
+  item_t*                items;
+  item_t*                free_list;
+  magazine_t             magazines[NOF_MAGAZINES];
   pthread_mutex_t        mutex;
   pthread_cond_t         cv_not_empty;
-  uint32_t capacity;
+  uint32_t               capacity;
+  std::atomic<uint32_t>  nof_used;
+  std::atomic<uint32_t>  high_water_mark;
+  std::atomic<uint32_t>  nof_waiters;
 };
 
 
@@ -243,6 +357,7 @@ public:
   void print_all_buffers() {
     pool->print_all_buffers();
   }
+  void get_metrics(buffer_pool_metrics_t* m) { pool->get_metrics(m); }
 private:
   srslte::log *log;
   buffer_pool<byte_buffer_t> *pool; 
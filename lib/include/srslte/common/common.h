@@ -276,6 +276,24 @@ private:
 #endif
 };
 
+// Receive side information of a sidelink transport block, shared by all its SDUs
+struct sl_rx_meta_t {
+  uint32_t src_l2_id;    // 24 bit source layer-2 ID of the SL-SCH subheader
+  float    snr;          // PSSCH SNR in dB
+  float    rsrp;         // PSSCH RSRP in dBm
+  time_t   rx_full_secs; // rx time of the subframe
+  double   rx_frac_secs;
+  uint32_t tti;
+};
+
+// A received sidelink SDU. It points into the MAC PDU buffer it was demultiplexed
+// from and is only valid during the call it is passed to.
+struct sl_sdu_t {
+  uint8_t*            msg;
+  uint32_t            N_bytes;
+  const sl_rx_meta_t* meta;
+};
+
 // Create a Managed Life-Time Byte Buffer
 class byte_buffer_pool;
 class byte_buffer_deleter
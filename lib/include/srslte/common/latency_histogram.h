@@ -0,0 +1,120 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+/******************************************************************************
+ *  File:         latency_histogram.h
+ *  Description:  Log-linear histogram of latencies in nanoseconds, with 8
+ *                buckets per power of two (HDR histogram style, at most 12.5%
+ *                relative error). One thread records, any thread may read the
+ *                cumulative counts at the same time without locking.
+ *****************************************************************************/
+
+#ifndef SRSLTE_LATENCY_HISTOGRAM_H
+#define SRSLTE_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <stdint.h>
+
+namespace srslte {
+
+class latency_histogram
+{
+public:
+  static const uint32_t SUB_BITS    = 3;
+  static const uint32_t SUB_COUNT   = 1u << SUB_BITS;
+  static const uint32_t NOF_BUCKETS = 2 * SUB_COUNT + (32 - SUB_BITS - 1) * SUB_COUNT;
+
+  latency_histogram()
+  {
+    for (uint32_t i = 0; i < NOF_BUCKETS; i++) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static uint32_t bucket_idx(uint32_t ns)
+  {
+    if (ns < 2 * SUB_COUNT) {
+      return ns;
+    }
+    uint32_t msb   = 31 - __builtin_clz(ns);
+    uint32_t shift = msb - SUB_BITS;
+    return 2 * SUB_COUNT + (msb - SUB_BITS - 1) * SUB_COUNT + (ns >> shift) - SUB_COUNT;
+  }
+
+  // Largest value that falls into bucket idx
+  static uint32_t bucket_max(uint32_t idx)
+  {
+    if (idx < 2 * SUB_COUNT) {
+      return idx;
+    }
+    uint32_t shift    = (idx - 2 * SUB_COUNT) / SUB_COUNT + 1;
+    uint64_t mantissa = (idx - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT;
+    return (uint32_t)(((mantissa + 1) << shift) - 1);
+  }
+
+  // Writer side. Only one thread records, so the increment needs no atomic
+  // read-modify-write, the atomic store just keeps readers consistent.
+  void add(uint32_t ns)
+  {
+    std::atomic<uint32_t>* c = &counts[bucket_idx(ns)];
+    c->store(c->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  // Reader side, adds the counts recorded since the start to sum
+  void accumulate(uint32_t sum[NOF_BUCKETS]) const
+  {
+    for (uint32_t i = 0; i < NOF_BUCKETS; i++) {
+      sum[i] += counts[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // Value below which the fraction p of the counted latencies lies, 0 if empty
+  static uint32_t percentile(const uint32_t c[NOF_BUCKETS], float p)
+  {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < NOF_BUCKETS; i++) {
+      total += c[i];
+    }
+    if (total == 0) {
+      return 0;
+    }
+    uint64_t target = (uint64_t)(p * total + 0.5f);
+    target          = target < 1 ? 1 : target;
+    uint64_t n      = 0;
+    for (uint32_t i = 0; i < NOF_BUCKETS; i++) {
+      n += c[i];
+      if (n >= target) {
+        return bucket_max(i);
+      }
+    }
+    return bucket_max(NOF_BUCKETS - 1);
+  }
+
+private:
+  std::atomic<uint32_t> counts[NOF_BUCKETS];
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_LATENCY_HISTOGRAM_H
@@ -46,20 +46,34 @@
 #ifndef SRSLTE_MAC_PCAP_H
 #define SRSLTE_MAC_PCAP_H
 
+#include <atomic>
 #include <stdint.h>
+#include "srslte/common/common.h"
+#include "srslte/common/mpsc_queue.h"
 #include "srslte/common/pcap.h"
+#include "srslte/common/threads.h"
 
 namespace srslte {
 
-class mac_pcap
+/* PDUs are packed into records on the calling (PHY/MAC) thread and written to
+ * the file by a background thread, so a slow disk never delays a TTI. When the
+ * writer falls behind, the drop policy decides whether new PDUs are discarded
+ * (and counted) or the caller waits for a free record.
+ */
+class mac_pcap : public thread
 {
 public:
+  typedef enum { DROP_NEWEST = 0, BLOCK } drop_policy_t;
+
   mac_pcap();
   ~mac_pcap();
   void enable(bool en);
   void open(const char *filename, uint32_t ue_id = 0);
   void close();
 
+  void     set_drop_policy(drop_policy_t policy);
+  uint32_t get_nof_dropped(); // Since the previous call
+
   void set_ue_id(uint16_t ue_id);
 
   void write_ul_crnti(uint8_t *pdu, uint32_t pdu_len_bytes, uint16_t crnti, uint32_t reTX, uint32_t tti);
@@ -78,9 +92,32 @@ public:
   void write_ul_rrc_pdu(const uint8_t* input, const int32_t input_len);
 
 private:
-  bool     enable_write;
-  FILE*    pcap_file;
-  uint32_t ue_id;
+  // Longer PDUs are truncated, incl_len tells Wireshark about it
+  static const uint32_t MAX_RECORD_LEN   = sizeof(pcaprec_hdr_t) + MAC_LTE_MAX_CONTEXT_LEN + SRSLTE_MAX_BUFFER_SIZE_BYTES;
+  static const uint32_t NOF_RECORDS      = 256;
+  static const uint32_t MAX_WRITE_BATCH  = 64;
+  static const uint32_t WRITER_PERIOD_US = 1000;
+
+  typedef struct {
+    uint32_t len;
+    uint8_t  data[MAX_RECORD_LEN];
+  } record_t;
+
+  void run_thread();
+  void write_batch();
+  void enqueue(MAC_Context_Info_t* context, const uint8_t* pdu, uint32_t pdu_len_bytes);
+
+  std::atomic<bool>     enable_write;
+  std::atomic<uint32_t> nof_producers; // Callers currently inside pack_and_write()
+  FILE*                 pcap_file;
+  uint32_t              ue_id;
+  drop_policy_t         drop_policy;
+  std::atomic<bool>     running;
+  std::atomic<uint32_t> nof_dropped;
+
+  typedef mpsc_queue<record_t, NOF_RECORDS> record_queue_t;
+  record_queue_t*                           records;
+
   void pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reTX, bool crc_ok, uint32_t tti,
                               uint16_t crnti_, uint8_t direction, uint8_t rnti_type);
   void pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reTX, bool crc_ok, uint32_t tti,
@@ -0,0 +1,118 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+/******************************************************************************
+ *  File:         mpsc_queue.h
+ *  Description:  Bounded lock-free queue for any number of producer threads
+ *                and exactly one consumer thread. Like spsc_queue, elements
+ *                are filled and read in place. Every slot carries a sequence
+ *                number that tells producers and the consumer who owns it.
+ *****************************************************************************/
+
+#ifndef SRSLTE_MPSC_QUEUE_H
+#define SRSLTE_MPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace srslte {
+
+template <typename myobj, uint32_t capacity>
+class mpsc_queue
+{
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+  mpsc_queue() : head(0), tail(0)
+  {
+    for (uint32_t i = 0; i < capacity; i++) {
+      slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Producer: reserves the next slot and returns it, or NULL if the queue is
+  // full. The reserved slot must be filled and handed over with push(ticket).
+  // Producers may finish out of order, the consumer waits for the oldest one.
+  myobj* back(uint32_t* ticket)
+  {
+    uint32_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+      slot_t* s   = &slots[pos & (capacity - 1)];
+      int32_t dif = (int32_t)(s->seq.load(std::memory_order_acquire) - pos);
+      if (dif == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          *ticket = pos;
+          return &s->obj;
+        }
+      } else if (dif < 0) {
+        return NULL;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void push(uint32_t ticket) { slots[ticket & (capacity - 1)].seq.store(ticket + 1, std::memory_order_release); }
+
+  // Consumer: returns the i-th oldest element or NULL if it has not been pushed
+  // yet. Elements stay valid until they are released with pop().
+  myobj* front(uint32_t i = 0)
+  {
+    uint32_t pos = head.load(std::memory_order_relaxed) + i;
+    slot_t*  s   = &slots[pos & (capacity - 1)];
+    if (s->seq.load(std::memory_order_acquire) != pos + 1) {
+      return NULL;
+    }
+    return &s->obj;
+  }
+
+  void pop(uint32_t n = 1)
+  {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++, h++) {
+      slots[h & (capacity - 1)].seq.store(h + capacity, std::memory_order_release);
+    }
+    head.store(h, std::memory_order_relaxed);
+  }
+
+  // Counts reserved slots too, so only a snapshot when producers are active
+  uint32_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+  bool     empty() const { return size() == 0; }
+
+private:
+  typedef struct {
+    std::atomic<uint32_t> seq;
+    myobj                 obj;
+  } slot_t;
+
+  // head is written by the consumer only, tail is shared by all producers
+  alignas(64) std::atomic<uint32_t> head;
+  alignas(64) std::atomic<uint32_t> tail;
+  alignas(64) slot_t slots[capacity];
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_MPSC_QUEUE_H
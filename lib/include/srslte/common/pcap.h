@@ -103,6 +103,9 @@ typedef struct pcaprec_hdr_s {
 #define MAC_LTE_CRC_STATUS_TAG      0x07
 #define MAC_LTE_NB_MODE_TAG         0x0F
 
+/* Upper bound of the packed mac-context, sidelink fields included */
+#define MAC_LTE_MAX_CONTEXT_LEN     64
+
 
 
 /* Context information for every MAC PDU that will be logged */
@@ -244,21 +247,13 @@ inline void LTE_PCAP_Close(FILE *fd)
  * API functions for writing MAC-LTE PCAP files                           *
  **************************************************************************/
 
-/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
-inline int LTE_PCAP_MAC_WritePDU(FILE *fd, MAC_Context_Info_t *context,
-                                 const unsigned char *PDU, unsigned int length)
+/* Pack the mac-context including the payload tag, returns its length. The
+ * buffer must hold at least MAC_LTE_MAX_CONTEXT_LEN bytes */
+inline int LTE_PCAP_MAC_PackContext(const MAC_Context_Info_t *context, unsigned char *context_header)
 {
-    pcaprec_hdr_t packet_header;
-    char context_header[256];
     int offset = 0;
     uint16_t tmp16;
 
-    /* Can't write if file wasn't successfully opened */
-    if (fd == NULL) {
-        printf("Error: Can't write to empty file handle\n");
-        return 0;
-    }
-
     /*****************************************************************/
     /* Context information (same as written by UDP heuristic clients */
     context_header[offset++] = context->radioType;
@@ -315,6 +310,24 @@ inline int LTE_PCAP_MAC_WritePDU(FILE *fd, MAC_Context_Info_t *context,
     /* Data tag immediately preceding PDU */
     context_header[offset++] = MAC_LTE_PAYLOAD_TAG;
 
+    return offset;
+}
+
+/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
+inline int LTE_PCAP_MAC_WritePDU(FILE *fd, MAC_Context_Info_t *context,
+                                 const unsigned char *PDU, unsigned int length)
+{
+    pcaprec_hdr_t packet_header;
+    unsigned char context_header[MAC_LTE_MAX_CONTEXT_LEN];
+    int offset;
+
+    /* Can't write if file wasn't successfully opened */
+    if (fd == NULL) {
+        printf("Error: Can't write to empty file handle\n");
+        return 0;
+    }
+
+    offset = LTE_PCAP_MAC_PackContext(context, context_header);
 
     /****************************************************************/
     /* PCAP Header                                                  */
@@ -461,9 +461,6 @@ public:
   uint8_t V;
   uint8_t SRC[3];
   uint8_t DST[3];
-
-  // this is not supplied by MAC header
-  float snr;
 };
 
 
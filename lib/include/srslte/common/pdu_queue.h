@@ -69,7 +69,8 @@ public:
   class process_callback
   {
     public:
-      virtual void process_pdu(uint8_t* buff, uint32_t len, channel_t channel) = 0;
+      // sl_meta is only set for the SLSCH channel
+      virtual void process_pdu(uint8_t* buff, uint32_t len, channel_t channel, const sl_rx_meta_t* sl_meta) = 0;
   };
 
   pdu_queue(uint32_t pool_size = DEFAULT_POOL_SIZE) : pool(pool_size), callback(NULL), log_h(NULL) {}
@@ -78,6 +79,7 @@ public:
   uint8_t* request(uint32_t len);
   void     deallocate(uint8_t* pdu);
   void     push(uint8_t* ptr, uint32_t len, channel_t channel = DCH);
+  void     push_sl(uint8_t* ptr, uint32_t len, const sl_rx_meta_t& sl_meta);
 
   bool   process_pdus();
 
@@ -89,6 +91,7 @@ private:
     uint8_t  ptr[MAX_PDU_LEN];
     uint32_t len;
     channel_t channel;
+    sl_rx_meta_t sl_meta;
     #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
       char   debug_name[128];
     #endif
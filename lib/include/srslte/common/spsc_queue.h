@@ -0,0 +1,88 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+/******************************************************************************
+ *  File:         spsc_queue.h
+ *  Description:  Bounded lock-free queue for exactly one producer and one
+ *                consumer thread. Elements are filled and read in place, so
+ *                large slots never have to be copied in or out.
+ *****************************************************************************/
+
+#ifndef SRSLTE_SPSC_QUEUE_H
+#define SRSLTE_SPSC_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+namespace srslte {
+
+template <typename myobj, uint32_t capacity>
+class spsc_queue
+{
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+  spsc_queue() : head(0), tail(0) {}
+
+  // Producer: returns the slot to fill next or NULL if the queue is full.
+  // The slot becomes visible to the consumer with push().
+  myobj* back()
+  {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == capacity) {
+      return NULL;
+    }
+    return &slots[t & (capacity - 1)];
+  }
+
+  void push() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Consumer: returns the i-th oldest element or NULL if there are not as many
+  // in the queue. Elements stay valid until they are released with pop().
+  myobj* front(uint32_t i = 0)
+  {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) - h <= i) {
+      return NULL;
+    }
+    return &slots[(h + i) & (capacity - 1)];
+  }
+
+  void pop(uint32_t n = 1) { head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+  // Only a snapshot when called concurrently to the other side
+  uint32_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+  bool     empty() const { return size() == 0; }
+
+private:
+  // head is written by the consumer only, tail by the producer only. Keep them
+  // on separate cache lines so the two sides do not bounce a line between them.
+  alignas(64) std::atomic<uint32_t> head;
+  alignas(64) std::atomic<uint32_t> tail;
+  alignas(64) myobj slots[capacity];
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_SPSC_QUEUE_H
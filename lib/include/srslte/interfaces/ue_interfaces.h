@@ -344,7 +344,7 @@ public:
 
   /* MAC calls RLC to push an RLC PDU. This function is called from an independent MAC thread.
    * PDU gets placed into the buffer and higher layer thread gets notified. */
-  virtual void write_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) = 0;
+  virtual void write_pdu_sl(uint32_t lcid, const srslte::sl_sdu_t& sdu) = 0;
   virtual void write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) = 0;
   virtual void write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes) = 0;
   virtual void write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes) = 0;
@@ -741,6 +741,8 @@ typedef struct {
   int   pdsch_max_its;
   bool  attach_enable_64qam;
   int   nof_phy_threads;
+  int   pssch_decoder_threads; // 0 decodes the code blocks of a TB on the PHY thread
+  bool  sensing_debug;         // track why Sensing SPS excluded candidates for the selection printout
 
   int worker_cpu_mask;
   int sync_cpu_affinity;
@@ -788,6 +790,12 @@ typedef struct {
   int32_t      sidelink_id;
   bool         sidelink_master;
 
+  std::string capture_filename; // empty disables IQ captures
+  std::string capture_triggers;
+  bool        capture_sigmf;
+  int32_t     capture_nof_subframes;
+  int32_t     capture_nof_subframes_high_rssi;
+
   srslte::channel::args_t dl_channel_args;
   srslte::channel::args_t ul_channel_args;
 } phy_args_t;
@@ -107,6 +107,11 @@ typedef struct {
   cf_t *pilot_recv_signal; 
   cf_t *pilot_known_signal; 
   cf_t *tmp_noise; 
+
+  // PSCCH DMRS does not depend on the cell, it is generated once on init
+  cf_t *pscch_known_signal;
+  // phase ramps to derotate the 4 possible PSCCH DMRS cyclic shifts {0,3,6,9}
+  cf_t pscch_cs_ramp[4][SRSLTE_NRE];
   
 #ifdef FREQ_SEL_SNR  
   float snr_vector[12000];
@@ -142,6 +147,13 @@ SRSLTE_API int srslte_chest_sl_estimate_pscch(srslte_chest_sl_t *q,
                                               srslte_sl_mode_t sl_mode,
                                               uint32_t prb_offset);
 
+SRSLTE_API int srslte_chest_sl_pscch_dmrs_corr(srslte_chest_sl_t *q,
+                                               cf_t *input,
+                                               srslte_sl_mode_t sl_mode,
+                                               const uint32_t *prb_offset,
+                                               uint32_t nof_candidates,
+                                               float *corr);
+
 SRSLTE_API int srslte_chest_sl_estimate_pssch(srslte_chest_sl_t *q,
                                               cf_t *input,
                                               cf_t *ce,
@@ -52,6 +52,7 @@
  *********************************************************************************************/
 
 #include <complex.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "srslte/config.h"
@@ -59,6 +60,10 @@
 #ifndef SRSLTE_CH_AWGN_H
 #define SRSLTE_CH_AWGN_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 SRSLTE_API void srslte_ch_awgn_c(const cf_t* input, 
                                  cf_t* output, 
                                  float variance, 
@@ -72,5 +77,34 @@ SRSLTE_API void srslte_ch_awgn_f(const float* x,
 SRSLTE_API float srslte_ch_awgn_get_variance(float ebno_db, 
                                              float rate);
 
+/*
+ * Counter based AWGN source (Philox4x32-10 and Box-Muller). The noise only
+ * depends on the seed, the stream index and the position of a sample within
+ * the stream, so several workers can draw fresh noise for their subframes in
+ * parallel without sharing any state.
+ */
+typedef struct SRSLTE_API {
+  uint32_t key[2];
+  float    std_dev; // rms amplitude of the complex noise, 0 if disabled
+} srslte_channel_awgn_t;
+
+SRSLTE_API void srslte_channel_awgn_init(srslte_channel_awgn_t* q, uint32_t seed);
+
+// SNR relative to signals with unit power per sample, INFINITY disables the noise
+SRSLTE_API void srslte_channel_awgn_set_snr(srslte_channel_awgn_t* q, float snr_db);
+
+SRSLTE_API bool srslte_channel_awgn_enabled(const srslte_channel_awgn_t* q);
+
+// Adds the samples [offset, offset + len) of noise stream 'stream' to input
+SRSLTE_API void srslte_channel_awgn_run_c(const srslte_channel_awgn_t* q,
+                                          const cf_t*                  input,
+                                          cf_t*                        output,
+                                          uint32_t                     len,
+                                          uint64_t                     stream,
+                                          uint64_t                     offset);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // SRSLTE_CH_AWGN_H
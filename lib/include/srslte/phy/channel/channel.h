@@ -46,6 +46,7 @@
 #ifndef SRSLTE_CHANNEL_H
 #define SRSLTE_CHANNEL_H
 
+#include "ch_awgn.h"
 #include "delay.h"
 #include "fading.h"
 #include "rlf.h"
@@ -66,6 +67,7 @@ public:
     // Fading options
     bool        fading_enable = false;
     std::string fading_model  = "none";
+    uint32_t    fading_seed   = 0; // tap phases, channels with different seeds fade independently
 
     // Delay options
     bool     delay_enable   = false;
@@ -77,19 +79,31 @@ public:
     bool     rlf_enable   = false;
     uint32_t rlf_t_on_ms  = 10000;
     uint32_t rlf_t_off_ms = 2000;
+
+    // Path loss options
+    bool  path_loss_enable = false;
+    float path_loss_db     = 0.0f;
+
+    // AWGN options
+    bool     awgn_enable = false;
+    float    awgn_snr_db = 30.0f; // noise power relative to a unit power signal at the output
+    uint32_t awgn_seed   = 0;
   } args_t;
 
   channel(const args_t& channel_args, uint32_t _nof_ports);
   ~channel();
   void set_srate(uint32_t srate);
+
+  // All stages run in place on out (the first enabled one reads from in), so
+  // in and out may be the same buffers and disabled stages cost nothing.
   void run(cf_t* in[SRSLTE_MAX_PORTS], cf_t* out[SRSLTE_MAX_PORTS], uint32_t len, const srslte_timestamp_t& t);
 
 private:
   srslte_channel_fading_t* fading[SRSLTE_MAX_PORTS] = {};
   srslte_channel_delay_t*  delay[SRSLTE_MAX_PORTS]  = {};
   srslte_channel_rlf_t*    rlf                      = nullptr; // RLF has no buffers / no multiple instance is required
-  cf_t*                    buffer_in                = nullptr;
-  cf_t*                    buffer_out               = nullptr;
+  srslte_channel_awgn_t    awgn                     = {};      // counter based, one noise stream per port
+  float                    path_loss_gain           = 1.0f;    // amplitude, applied together with RLF
   uint32_t                 nof_ports                = 0;
   uint32_t                 current_srate            = 0;
   args_t                   args                     = {};
@@ -47,6 +47,7 @@
 #define SRSLTE_RLF_H
 
 #include <srslte/config.h>
+#include <stdbool.h>
 #include <srslte/phy/common/timestamp.h>
 
 typedef struct {
@@ -60,6 +61,9 @@ extern "C" {
 
 SRSLTE_API void srslte_channel_rlf_init(srslte_channel_rlf_t* q, uint32_t t_on_ms, uint32_t t_off_ms);
 
+// True while the link is in its On state at time ts
+SRSLTE_API bool srslte_channel_rlf_is_on(const srslte_channel_rlf_t* q, const srslte_timestamp_t* ts);
+
 SRSLTE_API void srslte_channel_rlf_execute(
     srslte_channel_rlf_t* q, const cf_t* in, cf_t* out, uint32_t nsamples, const srslte_timestamp_t* ts);
 
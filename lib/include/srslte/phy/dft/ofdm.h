@@ -90,6 +90,10 @@ typedef struct SRSLTE_API{
 
   int cp_shift_nsamples;
   cf_t *cp_shift_correction;
+
+  // REs of each symbol that may be non-zero in the iFFT input (tmp)
+  uint32_t tx_re_start;
+  uint32_t tx_nof_re;
 }srslte_ofdm_t;
 
 SRSLTE_API int srslte_ofdm_init_(srslte_ofdm_t *q, 
@@ -169,6 +173,15 @@ SRSLTE_API void srslte_ofdm_tx_slot_mbsfn(srslte_ofdm_t *q,
 
 SRSLTE_API void srslte_ofdm_tx_sf(srslte_ofdm_t *q);
 
+SRSLTE_API void srslte_ofdm_tx_symbol_add(srslte_ofdm_t *q,
+                                          uint32_t symbol_idx);
+
+SRSLTE_API void srslte_ofdm_tx_sf_prb(srslte_ofdm_t *q,
+                                      uint32_t prb_start,
+                                      uint32_t nof_prb,
+                                      float cfo,
+                                      float scale);
+
 SRSLTE_API int srslte_ofdm_set_freq_shift(srslte_ofdm_t *q, 
                                          float freq_shift); 
 
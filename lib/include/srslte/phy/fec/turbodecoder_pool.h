@@ -0,0 +1,88 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+/******************************************************************************
+ *  File:         turbodecoder_pool.h
+ *
+ *  Description:  Pool of threads that turbo decode the code blocks of a
+ *                transport block in parallel. Each thread owns a turbo
+ *                decoder and the CRCs for the early stopping, the pool may be
+ *                shared by several callers. The caller decodes code blocks too
+ *                while it waits for the others.
+ *****************************************************************************/
+
+#ifndef SRSLTE_TURBODECODER_POOL_H
+#define SRSLTE_TURBODECODER_POOL_H
+
+#include "srslte/config.h"
+#include "srslte/phy/fec/crc.h"
+#include "srslte/phy/fec/turbodecoder.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+// What a task needs to decode one code block
+typedef struct SRSLTE_API {
+  srslte_tdec_t* decoder;
+  srslte_crc_t*  crc_cb;
+  srslte_crc_t*  crc_tb;
+  uint8_t*       output; // room for one decoded code block of SRSLTE_TCOD_MAX_LEN_CB bits
+} srslte_tdec_pool_ctx_t;
+
+typedef void (*srslte_tdec_pool_task_t)(void* arg, uint32_t idx, srslte_tdec_pool_ctx_t* ctx);
+
+typedef struct srslte_tdec_pool_job_s {
+  srslte_tdec_pool_task_t        task;
+  void*                          arg;
+  uint32_t                       nof_tasks;
+  uint32_t                       next_task; // next index to hand out
+  uint32_t                       nof_done;
+  struct srslte_tdec_pool_job_s* next;
+} srslte_tdec_pool_job_t;
+
+typedef struct SRSLTE_API {
+  uint32_t   nof_threads; // running threads
+  pthread_t* threads;
+  void*      workers;
+  uint32_t   nof_workers;
+
+  pthread_mutex_t         mutex;
+  pthread_cond_t          cvar_task; // a job was added
+  pthread_cond_t          cvar_done; // a job was completed
+  srslte_tdec_pool_job_t* jobs;      // jobs with tasks left to hand out, oldest first
+  bool                    running;
+} srslte_tdec_pool_t;
+
+SRSLTE_API int srslte_tdec_pool_init(srslte_tdec_pool_t* q, uint32_t nof_threads);
+
+SRSLTE_API void srslte_tdec_pool_free(srslte_tdec_pool_t* q);
+
+/* Runs task for the indices 0..nof_tasks-1 on the pool threads and on the
+ * calling thread, which uses caller_ctx, and returns when all are done. */
+SRSLTE_API void srslte_tdec_pool_run(srslte_tdec_pool_t*     q,
+                                     srslte_tdec_pool_task_t task,
+                                     void*                   arg,
+                                     uint32_t                nof_tasks,
+                                     srslte_tdec_pool_ctx_t* caller_ctx);
+
+#endif // SRSLTE_TURBODECODER_POOL_H
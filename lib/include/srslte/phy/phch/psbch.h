@@ -149,4 +149,6 @@ SRSLTE_API void srslte_psbch_mib_pack(srslte_cell_t *cell,
                                       uint32_t directSubframeNumber_r12,
                                       uint8_t *payload);
 
+SRSLTE_API bool srslte_psbch_is_symbol(uint32_t l);
+
 #endif // SRSLTE_PSBCH_H
@@ -78,6 +78,30 @@ typedef struct {
   bool sequence_generated;
 } srslte_pssch_user_t;
 
+// number of interleaver tables and scrambling sequences kept per PSSCH object
+#define SRSLTE_PSSCH_NOF_CACHED_LUT 8
+#define SRSLTE_PSSCH_NOF_CACHED_SEQ 16
+
+/* Interleaver table, depends on modulation and number of PRB only */
+typedef struct {
+  bool         valid;
+  srslte_mod_t mod;
+  uint32_t     n_prb;
+  uint64_t     last_used;
+  uint16_t    *lut;
+} srslte_pssch_lut_cache_t;
+
+/* Scrambling sequence, additionally depends on n_X_ID and n_PSSCH_ssf */
+typedef struct {
+  bool              valid;
+  srslte_mod_t      mod;
+  uint32_t          n_prb;
+  uint32_t          n_X_ID;
+  uint32_t          n_PSSCH_ssf;
+  uint64_t          last_used;
+  srslte_sequence_t seq;
+} srslte_pssch_seq_cache_t;
+
 /* PSSCH object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -122,7 +146,13 @@ typedef struct SRSLTE_API {
   uint32_t n_PSSCH_ssf;
   srslte_sequence_t tmp_seq;
 
-  uint16_t *interleaver_lut;
+  // LRU caches shared by encoder and decoder, under SPS the same
+  // allocations and n_X_ID are used over and over again
+  srslte_pssch_lut_cache_t lut_cache[SRSLTE_PSSCH_NOF_CACHED_LUT];
+  srslte_pssch_seq_cache_t seq_cache[SRSLTE_PSSCH_NOF_CACHED_SEQ];
+  uint64_t cache_tick;
+  uint32_t cache_hits;
+  uint32_t cache_misses;
 
   srslte_sch_t dl_sch;
 
@@ -227,6 +257,9 @@ SRSLTE_API int srslte_pssch_cn_compute(srslte_pssch_t *q,
 SRSLTE_API void srslte_pssch_set_max_noi(srslte_pssch_t *q,
                                          uint32_t max_iter);
 
+SRSLTE_API void srslte_pssch_set_tdec_pool(srslte_pssch_t *q,
+                                           srslte_tdec_pool_t *pool);
+
 SRSLTE_API float srslte_pssch_last_noi(srslte_pssch_t *q);
 
 SRSLTE_API int srslte_pssch_enable_coworker(srslte_pssch_t *q);
@@ -256,6 +289,13 @@ SRSLTE_API int srslte_pssch_cp_for_sps_rssi(cf_t* input,
                                             cf_t* output, 
                                             srslte_cell_t cell, 
                                             uint32_t prb_offset,
-                                            uint32_t n_prb); 
+                                            uint32_t n_prb);
+
+SRSLTE_API float srslte_pssch_sps_rssi(cf_t *sf_symbols,
+                                      srslte_cell_t cell,
+                                      uint32_t prb_offset,
+                                      uint32_t subch_size,
+                                      uint32_t nof_subch,
+                                      float *subch_rssi);
 
 #endif // SRSLTE_PSSCH_H
@@ -59,6 +59,7 @@
 #include "srslte/phy/fec/rm_turbo.h"
 #include "srslte/phy/fec/turbocoder.h"
 #include "srslte/phy/fec/turbodecoder.h"
+#include "srslte/phy/fec/turbodecoder_pool.h"
 #include "srslte/phy/fec/crc.h"
 #include "srslte/phy/phch/pdsch_cfg.h"
 #include "srslte/phy/phch/pusch_cfg.h"
@@ -90,6 +91,7 @@ typedef struct SRSLTE_API {
 
   srslte_tcod_t encoder;
   srslte_tdec_t decoder;  
+  srslte_tdec_pool_t *tdec_pool; // decodes the code blocks in parallel if set
   srslte_crc_t crc_tb;
   srslte_crc_t crc_cb;
   
@@ -103,6 +105,8 @@ SRSLTE_API void srslte_sch_free(srslte_sch_t *q);
 
 SRSLTE_API void srslte_sch_set_max_noi(srslte_sch_t* q, uint32_t max_iterations);
 
+SRSLTE_API void srslte_sch_set_tdec_pool(srslte_sch_t* q, srslte_tdec_pool_t* pool);
+
 SRSLTE_API float srslte_sch_last_noi(srslte_sch_t* q);
 
 SRSLTE_API int srslte_dlsch_encode(srslte_sch_t* q, srslte_pdsch_cfg_t* cfg, uint8_t* data, uint8_t* e_bits);
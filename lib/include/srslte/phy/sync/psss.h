@@ -129,6 +129,14 @@ typedef struct SRSLTE_API {
 
   bool chest_on_filter;
 
+  // Joint search of both N_id_2: the input spectrum is multiplied with both
+  // root spectra and transformed back by a single batched plan
+  cf_t *joint_freq;
+  cf_t *joint_output;
+  float *joint_output_abs;
+  srslte_dft_plan_t joint_plan;
+  float joint_peak_value[2]; // peak to side lobe ratio of each root in the last joint search
+
 }srslte_psss_t;
 
 typedef enum { PSSS_TX, PSSS_RX } psss_direction_t;
@@ -193,6 +201,11 @@ SRSLTE_API int srslte_psss_find_psss(srslte_psss_t *q,
                                          const cf_t *input,
                                          float *corr_peak_value);
 
+SRSLTE_API int srslte_psss_find_psss_joint(srslte_psss_t *q,
+                                           const cf_t *input,
+                                           float *corr_peak_value,
+                                           uint32_t *N_id_2);
+
 SRSLTE_API int _srslte_psss_chest(srslte_psss_t *q,
                                       const cf_t *input,
                                       cf_t ce[SRSLTE_PSSS_LEN]); 
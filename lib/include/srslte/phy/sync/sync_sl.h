@@ -97,6 +97,7 @@ typedef struct SRSLTE_API {
 
   uint32_t N_id_2;
   uint32_t N_id_1;
+  bool     N_id_2_joint; // search both N_id_2 at once, N_id_2 is set to the detected one
   uint32_t sf_idx;
   uint32_t fft_size;
   uint32_t frame_size;
@@ -218,6 +219,10 @@ SRSLTE_API void srslte_sync_sl_set_em_alpha(srslte_sync_sl_t *q,
 SRSLTE_API int srslte_sync_sl_set_N_id_2(srslte_sync_sl_t *q, 
                                           uint32_t N_id_2);
 
+/* Searches both N_id_2 in the same input instead of the one set above */
+SRSLTE_API void srslte_sync_sl_set_N_id_2_joint(srslte_sync_sl_t *q,
+                                                bool enable);
+
 /* Gets the Physical CellId from the last call to synch_run() */
 SRSLTE_API int srslte_sync_sl_get_cell_id(srslte_sync_sl_t *q);
 
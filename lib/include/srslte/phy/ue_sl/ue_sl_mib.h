@@ -88,6 +88,24 @@
 #define SRSLTE_UE_SL_MIB_FOUND                1
 #define SRSLTE_UE_SL_MIB_NOTFOUND             0
 
+// maximum number of subchannels of a resource pool (numSubchannel-r14)
+#define SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES     20
+
+// default DMRS correlation a subchannel needs to be decoded, noise only is ~0.1
+#define SRSLTE_UE_SL_PSCCH_CORR_THRESHOLD     0.2f
+
+/* Result of the blind PSCCH decoding of one subchannel */
+typedef struct SRSLTE_API {
+  uint32_t prb_offset;
+  float    corr;            // DMRS correlation metric of the pre-filter
+  float    noise_estimate;
+  bool     detected;        // passed the pre-filter and was decoded
+  bool     covered;         // inside an allocation decoded on a lower subchannel, not decoded
+  bool     crc_ok;
+  uint16_t crc;             // N_X_ID
+  uint8_t  data[SRSLTE_SCI1_MAX_BITS + 16];
+} srslte_ue_sl_pscch_candidate_t;
+
 typedef struct SRSLTE_API {
   srslte_sync_t sfind;
  
@@ -112,6 +130,8 @@ typedef struct SRSLTE_API {
   uint32_t sfn_offset; 
   
   uint32_t frame_cnt; 
+
+  float pscch_corr_threshold;
 } srslte_ue_sl_mib_t;
 
 SRSLTE_API int srslte_ue_sl_mib_init(srslte_ue_sl_mib_t *q, 
@@ -163,6 +183,15 @@ SRSLTE_API int srslte_ue_sl_mib_sync_decode(srslte_ue_sl_mib_sync_t * q,
 
 
 
+SRSLTE_API void srslte_ue_sl_mib_set_pscch_corr_threshold(srslte_ue_sl_mib_t * q,
+                                                         float threshold);
+
+SRSLTE_API int srslte_ue_sl_pscch_decode_multi(srslte_ue_sl_mib_t * q,
+                                               srslte_repo_t *repo,
+                                               const uint32_t *prb_offset,
+                                               uint32_t nof_candidates,
+                                               srslte_ue_sl_pscch_candidate_t *candidates);
+
 SRSLTE_API int srslte_ue_sl_pscch_decode(srslte_ue_sl_mib_t * q,
                                           srslte_repo_t *repo,
                                           uint8_t *decoded,
@@ -278,6 +278,10 @@ SRSLTE_API void srslte_ue_sl_sync_set_cfo_i_enable(srslte_ue_sl_sync_t *q,
 SRSLTE_API void srslte_ue_sl_sync_set_N_id_2(srslte_ue_sl_sync_t *q,
                                           uint32_t N_id_2);
 
+// Lets the find state search both N_id_2 in the same samples
+SRSLTE_API void srslte_ue_sl_sync_set_N_id_2_joint(srslte_ue_sl_sync_t *q,
+                                                bool enable);
+
 SRSLTE_API void srslte_ue_sl_sync_decode_ssss_on_track(srslte_ue_sl_sync_t *q, 
                                                         bool enabled);
 
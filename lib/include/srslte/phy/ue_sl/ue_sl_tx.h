@@ -137,6 +137,7 @@ typedef struct SRSLTE_API {
 
   cf_t *refsignal; 
   cf_t *srs_signal; 
+  // all REs are zero between subframes, each transmission clears what it used
   cf_t *sf_symbols;
 
   cf_t *out_buffer;
@@ -145,6 +146,11 @@ typedef struct SRSLTE_API {
   cf_t *pscch_dmrs;
   cf_t *pssch_dmrs;
 
+  // time-domain PSSS, SSSS and PSBCH DMRS of the sync subframe, only the
+  // PSBCH symbols are modulated for each transmission
+  cf_t *sync_sf;
+  bool sync_sf_ready;
+
   float last_amplitude;
 
   uint16_t current_rnti;  
@@ -178,6 +184,15 @@ SRSLTE_API void srslte_ue_sl_tx_set_normalization(srslte_ue_sl_tx_t *q,
 SRSLTE_API void srslte_ue_sl_tx_apply_norm(srslte_ue_sl_tx_t *q,
                                             uint32_t nof_prb);
 
+SRSLTE_API int srslte_ue_sl_tx_sync_sf(srslte_ue_sl_tx_t *q,
+                                       uint32_t dfn,
+                                       uint32_t dsfn);
+
+SRSLTE_API int srslte_ue_sl_tx_modulate(srslte_ue_sl_tx_t *q,
+                                        uint32_t prb_start,
+                                        uint32_t nof_prb,
+                                        float cfo);
+
 #if 0
 // (rl, merge_19_06) 
 SRSLTE_API float srslte_ue_sl_tx_get_last_amplitude(srslte_ue_sl_tx_t *q);
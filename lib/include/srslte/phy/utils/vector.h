@@ -162,6 +162,9 @@ SRSLTE_API void srslte_vec_conj_cc(const cf_t *x, cf_t *y, const uint32_t len);
 /* average vector power */
 SRSLTE_API float srslte_vec_avg_power_cf(const cf_t *x, const uint32_t len);
 
+/* adds the power of nof_seg consecutive segments of seg_len samples each to acc[] */
+SRSLTE_API void srslte_vec_acc_power_seg_cf(const cf_t *x, const uint32_t seg_len, const uint32_t nof_seg, float *acc);
+
 /* Correlation between complex vectors x and y */
 SRSLTE_API float srslte_vec_corr_ccc(const cf_t *x, cf_t *y, const uint32_t len);
 
@@ -190,6 +193,9 @@ SRSLTE_API void srslte_vec_gen_sine(cf_t amplitude, float freq, cf_t* z, int len
 
 SRSLTE_API void srslte_vec_apply_cfo(const cf_t *x, float cfo, cf_t *z, int len);
 
+/* Frequency offset and a complex scaling in one pass: z[n] = h * x[n] * exp(j*2*pi*cfo*n) */
+SRSLTE_API void srslte_vec_apply_cfo_scale(const cf_t *x, float cfo, cf_t h, cf_t *z, int len);
+
 SRSLTE_API float srslte_vec_estimate_frequency(const cf_t* x, int len);
 
 #ifdef __cplusplus
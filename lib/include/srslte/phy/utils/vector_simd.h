@@ -129,6 +129,8 @@ SRSLTE_API void srslte_vec_div_fff_simd(const float *x, const float *y, float *z
 /* SIMD Dot product */
 SRSLTE_API cf_t srslte_vec_dot_prod_conj_ccc_simd(const cf_t *x, const cf_t *y, const int len);
 
+SRSLTE_API void srslte_vec_acc_power_seg_cf_simd(const cf_t *x, const int seg_len, const int nof_seg, float *acc);
+
 SRSLTE_API cf_t srslte_vec_dot_prod_ccc_simd(const cf_t *x, const cf_t *y, const int len);
 
 #ifdef ENABLE_C16
@@ -163,6 +165,8 @@ SRSLTE_API void srslte_vec_gen_sine_simd(cf_t amplitude, float freq, cf_t* z, in
 
 SRSLTE_API void srslte_vec_apply_cfo_simd(const cf_t *x, float cfo, cf_t *z, int len);
 
+SRSLTE_API void srslte_vec_apply_cfo_scale_simd(const cf_t *x, float cfo, cf_t h, cf_t *z, int len);
+
 SRSLTE_API float srslte_vec_estimate_frequency_simd(const cf_t* x, int len);
 
 /* SIMD Find Max functions */
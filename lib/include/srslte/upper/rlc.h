@@ -53,6 +53,8 @@
 #include "srslte/upper/rlc_metrics.h"
 #include "srslte/upper/rlc_common.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/spsc_queue.h"
+#include <atomic>
 
 namespace srslte {
 
@@ -102,7 +104,7 @@ public:
   void     write_pdu_mch(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
 
   int      read_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
-  void     write_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
+  void     write_pdu_sl(uint32_t lcid, const srslte::sl_sdu_t& sdu);
 
   // RRC interface
   void reestablish();
@@ -141,27 +143,65 @@ private:
   bool valid_lcid(uint32_t lcid);
   bool valid_lcid_mrb(uint32_t lcid);
 
-  // class to send/recv pdus from mac
+  // Application bypass of LCID 1. The application runs a TCP server on the
+  // given port and exchanges messages framed by a 16 bit big-endian length:
+  //   app -> UE: length, payload. Each message is sent as its own MAC SDU.
+  //   UE -> app: length, 24 bit source L2 ID, float SNR, payload. The length
+  //              counts the 7 byte header and the payload.
+  // An epoll thread owns the socket. It hands received messages to the MAC
+  // through one SPSC queue and drains a second one filled by send_packet().
   class tcp_process : public thread {
   public: 
     tcp_process();
-    void notify();
+    ~tcp_process();
     void stop();
     int get_packet(uint8_t *p_, uint32_t len_);
 
-    void send_packet(uint8_t *p_, uint32_t len_);
+    void send_packet(const srslte::sl_sdu_t& sdu);
     void init(int port);
   private:
-    static const int MAC_PDU_THREAD_PRIO  = DEFAULT_PRIORITY-5;
+    static const int      MAC_PDU_THREAD_PRIO = DEFAULT_PRIORITY-5;
+    static const uint32_t MAX_MSG_BYTES       = 8192; // larger than any SL-SCH TB
+    static const uint32_t HDR_LEN             = 2;
+    static const uint32_t RX_HDR_LEN          = 7;
+    static const uint32_t QUEUE_LEN           = 64;
+    static const uint32_t MAX_TX_BATCH        = 32;
+    static const int      RECONNECT_MS        = 100;
+
+    struct app_msg_t {
+      uint32_t len;
+      uint8_t  data[HDR_LEN + RX_HDR_LEN + MAX_MSG_BYTES];
+    };
+
     void run_thread();
-    bool running; 
-    bool have_data; 
-    pthread_mutex_t mutex;
-    pthread_cond_t  cvar;
-    // srsue::mac *mac_unit;
-    srslte_netsink_t net_source;
-    uint8_t recv_buffer[100];
-    int32_t recv_len;
+    bool try_connect();
+    void disconnect();
+    void update_events();
+    void handle_rx();
+    void parse_rx();
+    void handle_tx();
+
+    std::atomic<bool> started;
+    std::atomic<bool> running;
+    int               port       = 0;
+    int               sock_fd    = -1;
+    int               epoll_fd   = -1;
+    int               event_fd   = -1; // wakes up the thread for stop() and send_packet()
+    bool              connecting = false;
+    bool              connected  = false;
+    uint32_t          events     = 0;     // epoll events currently registered for sock_fd
+    bool              rx_pending = false; // complete messages wait for room in to_mac
+
+    // app -> MAC, produced by the thread, consumed by get_packet()
+    spsc_queue<app_msg_t, QUEUE_LEN> to_mac;
+    uint8_t  rx_stream[HDR_LEN + 65535];
+    uint32_t rx_stream_len = 0;
+    uint32_t max_sdu_space = 0; // largest SDU space the MAC asked to fill
+
+    // MAC -> app, produced by send_packet(), consumed by the thread
+    spsc_queue<app_msg_t, QUEUE_LEN> to_app;
+    std::atomic<bool> tx_wakeup;
+    uint32_t          tx_offset = 0; // bytes of the oldest message already written
   };
 
   tcp_process tcp_process_thread;
@@ -43,14 +43,29 @@
  *
  */
 
+#include <errno.h>
+#include <new>
 #include <stdint.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "srslte/srslte.h"
 #include "srslte/common/pcap.h"
 #include "srslte/common/mac_pcap.h"
 
 namespace srslte {
 
-mac_pcap::mac_pcap() : enable_write(false), ue_id(0), pcap_file(nullptr) {}
+mac_pcap::mac_pcap() :
+  thread("MAC_PCAP"),
+  enable_write(false),
+  nof_producers(0),
+  pcap_file(nullptr),
+  ue_id(0),
+  drop_policy(DROP_NEWEST),
+  running(false),
+  nof_dropped(0),
+  records(nullptr)
+{
+}
 
 mac_pcap::~mac_pcap()
 {
@@ -64,27 +79,147 @@ void mac_pcap::enable(bool en)
 void mac_pcap::open(const char* filename, uint32_t ue_id)
 {
   pcap_file = LTE_PCAP_Open(MAC_LTE_DLT, filename);
+  if (pcap_file == nullptr) {
+    return;
+  }
+  // The writer thread uses the descriptor directly from now on
+  fflush(pcap_file);
   this->ue_id = ue_id;
+  // Plain new does not honour the cache line alignment of the queue in C++11
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, 64, sizeof(record_queue_t))) {
+    perror("posix_memalign");
+    LTE_PCAP_Close(pcap_file);
+    pcap_file = nullptr;
+    return;
+  }
+  records      = new (ptr) record_queue_t();
+  running      = true;
+  start();
   enable_write = true;
 }
 void mac_pcap::close()
 {
+  // PHY workers may still be writing, the queue must outlive them
   enable_write = false;
+  while (nof_producers > 0) {
+    usleep(100);
+  }
+  if (running) {
+    running = false;
+    wait_thread_finish();
+  }
   if (pcap_file != nullptr) {
     fprintf(stdout, "Saving MAC PCAP file\n");
     LTE_PCAP_Close(pcap_file);
     pcap_file = nullptr;
   }
+  if (records != nullptr) {
+    records->~record_queue_t();
+    free(records);
+    records = nullptr;
+  }
 }
 
 void mac_pcap::set_ue_id(uint16_t ue_id) {
   this->ue_id = ue_id;
 }
 
+void mac_pcap::set_drop_policy(drop_policy_t policy)
+{
+  drop_policy = policy;
+}
+
+uint32_t mac_pcap::get_nof_dropped()
+{
+  return nof_dropped.exchange(0);
+}
+
+void mac_pcap::enqueue(MAC_Context_Info_t* context, const uint8_t* pdu, uint32_t pdu_len_bytes)
+{
+  uint32_t  ticket = 0;
+  record_t* r      = records->back(&ticket);
+  while (r == nullptr) {
+    if (drop_policy == DROP_NEWEST || !running) {
+      nof_dropped++;
+      return;
+    }
+    usleep(100);
+    r = records->back(&ticket);
+  }
+
+  uint32_t offset   = sizeof(pcaprec_hdr_t);
+  offset += LTE_PCAP_MAC_PackContext(context, &r->data[offset]);
+  uint32_t incl_len = SRSLTE_MIN(pdu_len_bytes, MAX_RECORD_LEN - offset);
+  memcpy(&r->data[offset], pdu, incl_len);
+
+  pcaprec_hdr_t  packet_header;
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  packet_header.ts_sec   = t.tv_sec;
+  packet_header.ts_usec  = t.tv_usec;
+  packet_header.incl_len = offset - sizeof(pcaprec_hdr_t) + incl_len;
+  packet_header.orig_len = offset - sizeof(pcaprec_hdr_t) + pdu_len_bytes;
+  memcpy(r->data, &packet_header, sizeof(pcaprec_hdr_t));
+  r->len = offset + incl_len;
+
+  records->push(ticket);
+}
+
+// Writes up to MAX_WRITE_BATCH consecutive records with a single system call
+void mac_pcap::write_batch()
+{
+  struct iovec iov[MAX_WRITE_BATCH];
+  uint32_t     n = 0;
+  for (record_t* r; n < MAX_WRITE_BATCH && (r = records->front(n)) != nullptr; n++) {
+    iov[n].iov_base = r->data;
+    iov[n].iov_len  = r->len;
+  }
+
+  int fd = fileno(pcap_file);
+  for (uint32_t i = 0; i < n;) {
+    ssize_t ret = writev(fd, &iov[i], n - i);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("Writing MAC PCAP");
+      break;
+    }
+    // Skip what went out, a short write leaves the first iov half done
+    while (i < n && (size_t)ret >= iov[i].iov_len) {
+      ret -= iov[i].iov_len;
+      i++;
+    }
+    if (i < n) {
+      iov[i].iov_base = (uint8_t*)iov[i].iov_base + ret;
+      iov[i].iov_len -= ret;
+    }
+  }
+  records->pop(n);
+}
+
+void mac_pcap::run_thread()
+{
+  while (running) {
+    if (records->front() != nullptr) {
+      write_batch();
+    } else {
+      usleep(WRITER_PERIOD_US);
+    }
+  }
+  // Flush what the producers pushed before close()
+  while (records->front() != nullptr) {
+    write_batch();
+  }
+}
+
 void mac_pcap::pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reTX, bool crc_ok, uint32_t tti, 
                               uint16_t crnti, uint8_t direction, uint8_t rnti_type)
 {
-  if (enable_write) {
+  // Announce the producer before checking enable_write, close() checks in the opposite order
+  nof_producers++;
+  if (enable_write && records != nullptr) {
     MAC_Context_Info_t  context =
     {
         FDD_RADIO, direction, rnti_type,
@@ -96,9 +231,10 @@ void mac_pcap::pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reT
         (uint16_t)(tti%10)        /* Subframe number */
     };
     if (pdu) {
-      LTE_PCAP_MAC_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      enqueue(&context, pdu, pdu_len_bytes);
     }
   }
+  nof_producers--;
 }
 
 
@@ -107,7 +243,8 @@ void mac_pcap::pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reT
                               float snr, float rsrp, float rssi, float noise_power, time_t rx_full_secs,
                               float rx_frac_secs, float rx_gain, uint16_t sl_sci_frl)
 {
-  if (enable_write) {
+  nof_producers++;
+  if (enable_write && records != nullptr) {
     MAC_Context_Info_t  context =
     {
         FDD_RADIO, direction, rnti_type,
@@ -128,9 +265,10 @@ void mac_pcap::pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes, uint32_t reT
     context.sl_sci_frl = sl_sci_frl;
     
     if (pdu) {
-      LTE_PCAP_MAC_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      enqueue(&context, pdu, pdu_len_bytes);
     }
   }
+  nof_producers--;
 }
 
 
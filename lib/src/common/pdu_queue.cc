@@ -104,6 +104,19 @@ void pdu_queue::push(uint8_t* ptr, uint32_t len, channel_t channel)
   }
 }
 
+void pdu_queue::push_sl(uint8_t* ptr, uint32_t len, const sl_rx_meta_t& sl_meta)
+{
+  if (ptr) {
+    pdu_t *pdu   = (pdu_t*) ptr;
+    pdu->len     = len;
+    pdu->channel = SLSCH;
+    pdu->sl_meta = sl_meta;
+    pdu_q.push(pdu);
+  } else {
+    log_h->warning("Error pushing pdu: ptr is empty\n");
+  }
+}
+
 bool pdu_queue::process_pdus()
 {
   bool have_data = false;
@@ -111,7 +124,7 @@ bool pdu_queue::process_pdus()
   pdu_t *pdu;
   while(pdu_q.try_pop(&pdu)) {
     if (callback) {
-      callback->process_pdu(pdu->ptr, pdu->len, pdu->channel);
+      callback->process_pdu(pdu->ptr, pdu->len, pdu->channel, pdu->channel == SLSCH ? &pdu->sl_meta : NULL);
     }
     cnt++;
     have_data = true;
@@ -74,6 +74,7 @@
 
 #define MAX_REFS_SYM    (max_prb*SRSLTE_NRE)
 #define MAX_REFS_SF     (max_prb*SRSLTE_NRE*4) // 2 reference symbols per subframe
+#define PSCCH_MAX_REFS  (2*SRSLTE_NRE*4) // 2 PRB, 4 reference symbols per subframe in mode 4
 
 
 /** 3GPP LTE Downlink channel estimator and equalizer. 
@@ -126,6 +127,19 @@ int srslte_chest_sl_init(srslte_chest_sl_t *q, uint32_t max_prb)
       perror("malloc");
       goto clean_exit;
     }
+
+    q->pscch_known_signal = srslte_vec_malloc(sizeof(cf_t) * PSCCH_MAX_REFS);
+    if (!q->pscch_known_signal) {
+      perror("malloc");
+      goto clean_exit;
+    }
+    srslte_refsignal_sl_dmrs_pscch_gen(&q->dmrs_signal, 2, 0, 0, q->pscch_known_signal);
+
+    for (int cs=0;cs<4;cs++) {
+      for (int i=0;i<SRSLTE_NRE;i++) {
+        q->pscch_cs_ramp[cs][i] = cexpf(-I*2*M_PI*(3*cs)*i/SRSLTE_NRE);
+      }
+    }
     
     if (srslte_interp_linear_vector_init(&q->srslte_interp_linvec, MAX_REFS_SYM)) {
       fprintf(stderr, "Error initializing vector interpolator\n");
@@ -181,6 +195,9 @@ void srslte_chest_sl_free(srslte_chest_sl_t *q)
   if (q->pilot_known_signal) {
     free(q->pilot_known_signal);
   }
+  if (q->pscch_known_signal) {
+    free(q->pscch_known_signal);
+  }
   bzero(q, sizeof(srslte_chest_sl_t));
 }
 
@@ -620,13 +637,70 @@ int srslte_chest_sl_estimate_pscch(srslte_chest_sl_t *q, cf_t *input, cf_t *ce,
 
   uint32_t prb_n = 2;
 
-  // generate pscch dmrs
-  srslte_refsignal_sl_dmrs_pscch_gen(&q->dmrs_signal, prb_n, 0, 0, q->pilot_known_signal);
+  // pscch dmrs was generated on init
+  memcpy(q->pilot_known_signal, q->pscch_known_signal, sizeof(cf_t)*PSCCH_MAX_REFS);
 
   return srslte_chest_sl_estimate_psxch(q, input, ce, sl_mode, prb_offset, prb_n);
 }
 
 
+/* Cheap PSCCH presence detector, used to skip empty subchannels before running
+ * the channel estimation, demodulation and viterbi decoding for each of them.
+ *
+ * For every candidate PRB pair the received DMRS is correlated with the known
+ * PSCCH DMRS per PRB and DMRS symbol. The cyclic shift is selected randomly by
+ * the transmitter, therefore the best of the 4 possible shifts is taken. The
+ * metric is normalized to the received DMRS energy:
+ *  ~0.1 for noise only, ~1 for a PSCCH with high SNR on a flat channel.
+ */
+int srslte_chest_sl_pscch_dmrs_corr(srslte_chest_sl_t *q, cf_t *input, srslte_sl_mode_t sl_mode,
+                                    const uint32_t *prb_offset, uint32_t nof_candidates, float *corr)
+{
+  if (q == NULL || input == NULL || prb_offset == NULL || corr == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  const uint32_t prb_n = 2;
+  uint32_t nsymbols = SRSLTE_CP_ISNORM(q->cell.cp)?SRSLTE_CP_NORM_NSYMB:SRSLTE_CP_EXT_NSYMB;
+
+  for (uint32_t c=0;c<nof_candidates;c++) {
+    float m[4] = {0, 0, 0, 0};
+    float energy = 0;
+
+    int dmrs_c = 0;
+    for (int ns=0;ns<2;ns++) {
+      uint32_t rs = srslte_refsignal_sl_dmrs_pscch_N_rs(sl_mode, ns);
+      for (int l=0;l<rs;l++) {
+        int dmrs_pos = srslte_refsignal_sl_dmrs_pscch_symbol(l, sl_mode, ns, q->cell.cp);
+        cf_t *y = &input[SRSLTE_RE_IDX(q->cell.nof_prb, dmrs_pos+ns*nsymbols, prb_offset[c]*SRSLTE_NRE)];
+
+        // raw LS estimates of this DMRS symbol
+        srslte_vec_prod_conj_ccc(y, &q->pscch_known_signal[dmrs_c*prb_n*SRSLTE_NRE], q->tmp_noise, prb_n*SRSLTE_NRE);
+        energy += prb_n*SRSLTE_NRE*srslte_vec_avg_power_cf(y, prb_n*SRSLTE_NRE);
+
+        for (int p=0;p<prb_n;p++) {
+          for (int cs=0;cs<4;cs++) {
+            cf_t acc = srslte_vec_dot_prod_ccc(&q->tmp_noise[p*SRSLTE_NRE], q->pscch_cs_ramp[cs], SRSLTE_NRE);
+            m[cs] += __real__ acc * __real__ acc + __imag__ acc * __imag__ acc;
+          }
+        }
+        dmrs_c++;
+      }
+    }
+
+    float best = m[0];
+    for (int cs=1;cs<4;cs++) {
+      if (m[cs] > best) {
+        best = m[cs];
+      }
+    }
+    corr[c] = energy > 0 ? best/(SRSLTE_NRE*energy) : 0;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+
 int srslte_chest_sl_estimate_pssch(srslte_chest_sl_t *q, cf_t *input, cf_t *ce, srslte_sl_mode_t sl_mode, uint32_t prb_offset, uint32_t prb_n) {
 
   // generate pssch dmrs
@@ -46,10 +46,12 @@
 #include <complex.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <string.h>
 #include <math.h>
 
 #include "gauss.h"
 #include "srslte/phy/channel/ch_awgn.h"
+#include "srslte/phy/utils/vector.h"
 
 float srslte_ch_awgn_get_variance(float ebno_db, float rate) {
   float esno_db = ebno_db + 10 * log10f(rate);
@@ -74,3 +76,131 @@ void srslte_ch_awgn_f(const float* x, float* y, float variance, uint32_t len) {
     y[i] = x[i] + variance * rand_gauss();
   }
 }
+
+/*
+ * Counter based generator. Each counter runs through its rounds independently
+ * of the others and without calls into libm, so the compiler vectorizes the
+ * loop over the counters for whatever SIMD width the build targets.
+ */
+#define AWGN_BATCH 64 // complex samples per round, even
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+// -2 * ln(u) for u in (0, 1), max. relative error around 1e-7
+static inline float awgn_m2log(float u)
+{
+  union {
+    float    f;
+    uint32_t i;
+  } b = {u};
+
+  int32_t e = (int32_t)(b.i >> 23) - 127;
+  b.i       = (b.i & 0x7fffffu) | 0x3f800000u;
+  float m   = b.f; // u = m * 2^e, m in [1, 2)
+  bool  big = m > (float)M_SQRT2;
+  m         = big ? 0.5f * m : m;
+  e         = big ? e + 1 : e;
+
+  float s  = (m - 1.0f) / (m + 1.0f);
+  float s2 = s * s;
+  float l  = 2.0f * s * (1.0f + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (1.0f / 7 + s2 * (1.0f / 9)))));
+  return -2.0f * ((float)e * (float)M_LN2 + l);
+}
+
+// Box-Muller: radius from u in (0, 1), angle 2*pi*v from v in [-0.5, 0.5)
+static inline void awgn_box_muller(uint32_t u_bits, uint32_t v_bits, float* re, float* im)
+{
+  float u = ((float)(u_bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+  float v = (float)(v_bits >> 8) * (1.0f / 16777216.0f) - 0.5f;
+  float r = sqrtf(awgn_m2log(u)) * (float)M_SQRT1_2; // unit power per complex sample
+
+  // sine and cosine of the half angle, which stays within [-pi/2, pi/2)
+  float x  = (float)M_PI * v;
+  float x2 = x * x;
+  float sn = x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42 * (1 - x2 / 72 * (1 - x2 / 110)))));
+  float cs = 1 - x2 / 2 * (1 - x2 / 12 * (1 - x2 / 30 * (1 - x2 / 56 * (1 - x2 / 90 * (1 - x2 / 132)))));
+
+  *re = r * (cs * cs - sn * sn);
+  *im = r * 2.0f * sn * cs;
+}
+
+// Each Philox4x32-10 counter (block, stream) yields two unit power complex samples
+static void
+awgn_gen(const uint32_t key[2], uint64_t stream, uint64_t block, uint32_t nof_blocks, float* restrict out)
+{
+  for (uint32_t j = 0; j < nof_blocks; j++) {
+    uint32_t c0 = (uint32_t)(block + j);
+    uint32_t c1 = (uint32_t)((block + j) >> 32);
+    uint32_t c2 = (uint32_t)stream;
+    uint32_t c3 = (uint32_t)(stream >> 32);
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+
+    for (int r = 0; r < 10; r++) {
+      uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+      uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+      c0          = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+      c1          = (uint32_t)p1;
+      c2          = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+      c3          = (uint32_t)p0;
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+
+    awgn_box_muller(c0, c1, &out[4 * j], &out[4 * j + 1]);
+    awgn_box_muller(c2, c3, &out[4 * j + 2], &out[4 * j + 3]);
+  }
+}
+
+void srslte_channel_awgn_init(srslte_channel_awgn_t* q, uint32_t seed)
+{
+  q->key[0]  = seed;
+  q->key[1]  = seed ^ 0x5bd1e995u;
+  q->std_dev = 0.0f;
+}
+
+void srslte_channel_awgn_set_snr(srslte_channel_awgn_t* q, float snr_db)
+{
+  q->std_dev = isinf(snr_db) ? 0.0f : powf(10.0f, -snr_db / 20.0f);
+}
+
+bool srslte_channel_awgn_enabled(const srslte_channel_awgn_t* q)
+{
+  return q->std_dev > 0.0f;
+}
+
+void srslte_channel_awgn_run_c(const srslte_channel_awgn_t* q,
+                               const cf_t*                  input,
+                               cf_t*                        output,
+                               uint32_t                     len,
+                               uint64_t                     stream,
+                               uint64_t                     offset)
+{
+  cf_t noise[AWGN_BATCH];
+
+  if (!srslte_channel_awgn_enabled(q)) {
+    if (input != output) {
+      memcpy(output, input, sizeof(cf_t) * len);
+    }
+    return;
+  }
+
+  // each counter yields two consecutive samples, so an odd offset starts in the middle of a pair
+  uint64_t block = offset / 2;
+  uint32_t skip  = (uint32_t)(offset % 2);
+  uint32_t i     = 0;
+
+  while (i < len) {
+    uint32_t n = SRSLTE_MIN(len - i, AWGN_BATCH - skip);
+    awgn_gen(q->key, stream, block, (n + skip + 1) / 2, (float*)noise);
+    srslte_vec_sc_prod_cfc(&noise[skip], q->std_dev, &noise[skip], n);
+    srslte_vec_sum_ccc(&input[i], &noise[skip], &output[i], n);
+
+    block += AWGN_BATCH / 2;
+    i += n;
+    skip = 0;
+  }
+}
@@ -43,6 +43,7 @@
  *
  */
 
+#include <cmath>
 #include <cstdlib>
 #include <srslte/phy/channel/channel.h>
 #include <srslte/srslte.h>
@@ -51,27 +52,20 @@ using namespace srslte;
 
 channel::channel(const channel::args_t& channel_args, uint32_t _nof_ports)
 {
-  int      ret         = SRSLTE_SUCCESS;
-  uint32_t srate_max   = (uint32_t)srslte_symbol_sz(SRSLTE_MAX_PRB) * 15000;
-  uint32_t buffer_size = (uint32_t)SRSLTE_SF_LEN_PRB(SRSLTE_MAX_PRB) * 5; // be safe, 5 Subframes
+  int      ret       = SRSLTE_SUCCESS;
+  uint32_t srate_max = (uint32_t)srslte_symbol_sz(SRSLTE_MAX_PRB) * 15000;
 
   // Copy args
   args = channel_args;
 
-  // Allocate internal buffers
-  buffer_in  = (cf_t*)srslte_vec_malloc(sizeof(cf_t) * buffer_size);
-  buffer_out = (cf_t*)srslte_vec_malloc(sizeof(cf_t) * buffer_size);
-  if (!buffer_out || !buffer_in) {
-    ret = SRSLTE_ERROR;
-  }
-
   nof_ports = _nof_ports;
   for (uint32_t i = 0; i < nof_ports; i++) {
     // Create fading channel
     if (channel_args.fading_enable && !channel_args.fading_model.empty() && channel_args.fading_model != "none" &&
         ret == SRSLTE_SUCCESS) {
       fading[i] = (srslte_channel_fading_t*)calloc(sizeof(srslte_channel_fading_t), 1);
-      ret       = srslte_channel_fading_init(fading[i], srate_max, channel_args.fading_model.c_str(), 0x1234 * i);
+      ret       = srslte_channel_fading_init(
+          fading[i], srate_max, channel_args.fading_model.c_str(), channel_args.fading_seed + 0x1234 * i);
     } else {
       fading[i] = nullptr;
     }
@@ -91,6 +85,15 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_ports)
     srslte_channel_rlf_init(rlf, channel_args.rlf_t_on_ms, channel_args.rlf_t_off_ms);
   }
 
+  if (channel_args.path_loss_enable) {
+    path_loss_gain = powf(10.0f, -channel_args.path_loss_db / 20.0f);
+  }
+
+  srslte_channel_awgn_init(&awgn, channel_args.awgn_seed);
+  if (channel_args.awgn_enable) {
+    srslte_channel_awgn_set_snr(&awgn, channel_args.awgn_snr_db);
+  }
+
   if (ret != SRSLTE_SUCCESS) {
     fprintf(stderr, "Error: Creating channel\n\n");
   }
@@ -98,14 +101,6 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_ports)
 
 channel::~channel()
 {
-  if (buffer_in) {
-    free(buffer_in);
-  }
-
-  if (buffer_out) {
-    free(buffer_out);
-  }
-
   if (rlf) {
     srslte_channel_rlf_free(rlf);
     free(rlf);
@@ -127,40 +122,56 @@ channel::~channel()
 void channel::run(cf_t* in[SRSLTE_MAX_PORTS], cf_t* out[SRSLTE_MAX_PORTS], uint32_t len, const srslte_timestamp_t& t)
 {
   // check input pointers
-  if (in != nullptr && out != nullptr) {
+  if (in == nullptr || out == nullptr) {
+    return;
+  }
+
+  // RLF and path loss are one scalar gain, which is skipped when it is one
+  float gain = path_loss_gain;
+  if (current_srate && rlf && !srslte_channel_rlf_is_on(rlf, &t)) {
+    gain = 0.0f;
+  }
+
+  // sample index of t, so the noise does not depend on how the stream is split into calls
+  uint64_t sample_idx = (uint64_t)t.full_secs * current_srate + (uint64_t)round(t.frac_secs * current_srate);
+
+  for (uint32_t i = 0; i < nof_ports; i++) {
+    // Check buffers are not null
+    if (in[i] == nullptr || out[i] == nullptr) {
+      continue;
+    }
+
+    // Every stage reads from src and writes to out[i], after the first one src is out[i] too
+    const cf_t* src = in[i];
+
     if (current_srate) {
-      for (uint32_t i = 0; i < nof_ports; i++) {
-        // Check buffers are not null
-        if (in[i] != nullptr && out[i] != nullptr) {
-          // Copy input buffer
-          memcpy(buffer_in, in[i], sizeof(cf_t) * len);
-
-          if (fading[i]) {
-            srslte_channel_fading_execute(fading[i], buffer_in, buffer_out, len, t.full_secs + t.frac_secs);
-            memcpy(buffer_in, buffer_out, sizeof(cf_t) * len);
-          }
-
-          if (delay[i]) {
-            srslte_channel_delay_execute(delay[i], buffer_in, buffer_out, len, &t);
-            memcpy(buffer_in, buffer_out, sizeof(cf_t) * len);
-          }
-
-          if (rlf) {
-            srslte_channel_rlf_execute(rlf, buffer_in, buffer_out, len, &t);
-            memcpy(buffer_in, buffer_out, sizeof(cf_t) * len);
-          }
-
-          // Copy output buffer
-          memcpy(out[i], buffer_in, sizeof(cf_t) * len);
-        }
+      if (fading[i]) {
+        srslte_channel_fading_execute(fading[i], src, out[i], len, t.full_secs + t.frac_secs);
+        src = out[i];
       }
-    } else {
-      for (uint32_t i = 0; i < nof_ports; i++) {
-        // Check buffers are not null
-        if (in[i] != nullptr && out[i] != nullptr && in[i] != out[i]) {
-          memcpy(out[i], in[i], sizeof(cf_t) * len);
-        }
+
+      if (delay[i]) {
+        srslte_channel_delay_execute(delay[i], src, out[i], len, &t);
+        src = out[i];
+      }
+
+      if (gain == 0.0f) {
+        bzero(out[i], sizeof(cf_t) * len);
+        src = out[i];
+      } else if (gain != 1.0f) {
+        srslte_vec_sc_prod_cfc(src, gain, out[i], len);
+        src = out[i];
       }
+
+      if (srslte_channel_awgn_enabled(&awgn)) {
+        srslte_channel_awgn_run_c(&awgn, src, out[i], len, i, sample_idx);
+        src = out[i];
+      }
+    }
+
+    // Nothing was enabled
+    if (src != out[i]) {
+      memcpy(out[i], src, sizeof(cf_t) * len);
     }
   }
 }
@@ -172,7 +183,7 @@ void channel::set_srate(uint32_t srate)
       if (fading[i]) {
         srslte_channel_fading_free(fading[i]);
 
-        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), 0x1234 * i);
+        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), args.fading_seed + 0x1234 * i);
       }
 
       if (delay[i]) {
@@ -72,8 +72,8 @@ int srslte_channel_delay_init(
   // Calculate buffer size
   uint32_t buff_size = (uint32_t)ceilf(delay_max_us * (float)srate_max_hz / 1e6f);
 
-  // Create ring buffer
-  int ret = srslte_ringbuffer_init(&q->rb, sizeof(cf_t) * buff_size);
+  // Create ring buffer, twice the maximum delay so that execute can also run in place
+  int ret = srslte_ringbuffer_init(&q->rb, 2 * sizeof(cf_t) * buff_size);
 
   // Create zero buffer
   q->zero_buffer = srslte_vec_malloc(sizeof(cf_t) * buff_size);
@@ -123,6 +123,16 @@ void srslte_channel_delay_execute(
     srslte_ringbuffer_read(&q->rb, q->zero_buffer, sizeof(cf_t) * (available_nsamples - delay_nsamples));
   }
 
+  if (in == out) {
+    // In place: queue the tail before it gets overwritten, then shift the head
+    srslte_ringbuffer_write(&q->rb, (void*)&in[copy_nsamples], sizeof(cf_t) * read_nsamples);
+    if (copy_nsamples) {
+      memmove(&out[read_nsamples], in, sizeof(cf_t) * copy_nsamples);
+    }
+    srslte_ringbuffer_read(&q->rb, out, sizeof(cf_t) * read_nsamples);
+    return;
+  }
+
   // Read buffered samples
   srslte_ringbuffer_read(&q->rb, out, sizeof(cf_t) * read_nsamples);
 
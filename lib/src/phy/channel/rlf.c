@@ -52,15 +52,20 @@ void srslte_channel_rlf_init(srslte_channel_rlf_t* q, uint32_t t_on_ms, uint32_t
   q->t_off_ms = t_off_ms;
 }
 
-void srslte_channel_rlf_execute(
-    srslte_channel_rlf_t* q, const cf_t* in, cf_t* out, uint32_t nsamples, const srslte_timestamp_t* ts)
+bool srslte_channel_rlf_is_on(const srslte_channel_rlf_t* q, const srslte_timestamp_t* ts)
 {
   uint32_t period_ms    = q->t_on_ms + q->t_off_ms;
   double   full_secs_ms = (ts->full_secs * 1000) % period_ms;
   double   frac_secs_ms = (ts->frac_secs * 1000);
   double   time_ms      = full_secs_ms + frac_secs_ms;
 
-  if (time_ms < q->t_on_ms) {
+  return time_ms < q->t_on_ms;
+}
+
+void srslte_channel_rlf_execute(
+    srslte_channel_rlf_t* q, const cf_t* in, cf_t* out, uint32_t nsamples, const srslte_timestamp_t* ts)
+{
+  if (srslte_channel_rlf_is_on(q, ts)) {
     srslte_vec_sc_prod_cfc(in, 1.0f, out, nsamples);
   } else {
     srslte_vec_sc_prod_cfc(in, 0.0f, out, nsamples);
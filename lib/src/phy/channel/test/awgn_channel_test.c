@@ -0,0 +1,173 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srslte/phy/utils/vector.h"
+#include <math.h>
+#include <srslte/phy/channel/ch_awgn.h>
+#include <srslte/phy/utils/debug.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static float    snr_db      = 10.0f;
+static uint32_t nof_samples = 12 * 50 * 14; // resource elements of a 10 MHz subframe
+static uint32_t nof_reps    = 1000;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [snr]\n", prog);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+  printf("\t-n Number of samples per call [Default %d]\n", nof_samples);
+  printf("\t-r Number of calls [Default %d]\n", nof_reps);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "snr")) != -1) {
+    switch (opt) {
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'n':
+        nof_samples = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        nof_reps = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int                   ret   = SRSLTE_SUCCESS;
+  srslte_channel_awgn_t awgn  = {};
+  struct timeval        t[3]  = {};
+  double                m[5]  = {}; // sum of re, im, |x|^2, |x|^4, re*im
+
+  parse_args(argc, argv);
+
+  cf_t* zeros  = srslte_vec_malloc(sizeof(cf_t) * nof_samples);
+  cf_t* output = srslte_vec_malloc(sizeof(cf_t) * nof_samples);
+  cf_t* part   = srslte_vec_malloc(sizeof(cf_t) * nof_samples);
+  if (!zeros || !output || !part) {
+    fprintf(stderr, "Error: Allocating memory\n");
+    exit(-1);
+  }
+  bzero(zeros, sizeof(cf_t) * nof_samples);
+
+  srslte_channel_awgn_init(&awgn, 0x1234);
+
+  // Infinite SNR must leave the signal untouched
+  srslte_channel_awgn_set_snr(&awgn, INFINITY);
+  memcpy(output, zeros, sizeof(cf_t) * nof_samples);
+  output[0] = 1.0f;
+  srslte_channel_awgn_run_c(&awgn, output, output, nof_samples, 0, 0);
+  if (srslte_channel_awgn_enabled(&awgn) || output[0] != 1.0f || output[nof_samples - 1] != 0.0f) {
+    printf("Noise added with infinite SNR\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  srslte_channel_awgn_set_snr(&awgn, snr_db);
+
+  // Noise depends on the sample position only, not on how the stream is cut into calls
+  uint32_t split = nof_samples / 3 | 1;
+  srslte_channel_awgn_run_c(&awgn, zeros, output, nof_samples, 7, 5);
+  srslte_channel_awgn_run_c(&awgn, zeros, part, split, 7, 5);
+  srslte_channel_awgn_run_c(&awgn, zeros, &part[split], nof_samples - split, 7, 5 + split);
+  if (memcmp(output, part, sizeof(cf_t) * nof_samples) != 0) {
+    printf("Noise depends on the call boundaries\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  // Different streams must differ
+  srslte_channel_awgn_run_c(&awgn, zeros, part, nof_samples, 8, 5);
+  if (memcmp(output, part, sizeof(cf_t) * nof_samples) == 0) {
+    printf("Streams 7 and 8 are identical\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < nof_reps; r++) {
+    srslte_channel_awgn_run_c(&awgn, zeros, output, nof_samples, r, 0);
+    for (uint32_t i = 0; i < nof_samples; i++) {
+      float re = __real__ output[i];
+      float im = __imag__ output[i];
+      float p  = re * re + im * im;
+      m[0] += re;
+      m[1] += im;
+      m[2] += p;
+      m[3] += p * p;
+      m[4] += re * im;
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  double n      = (double)nof_samples * nof_reps;
+  double power  = m[2] / n;
+  double snr    = -10 * log10(power);
+  double kurt   = m[3] / n / (power * power); // 2 for complex gaussian noise
+  double mean   = sqrt(m[0] * m[0] + m[1] * m[1]) / n / sqrt(power);
+  double corr   = m[4] / n / power;
+  double msps   = n / (t[0].tv_sec * 1e6 + t[0].tv_usec);
+
+  if (fabs(snr - snr_db) > 0.05 || fabs(kurt - 2.0) > 0.05 || mean > 0.01 || fabs(corr) > 0.01) {
+    ret = SRSLTE_ERROR;
+  }
+
+  // same scale as the transmit noise the PHY used to draw with srslte_ch_awgn_c()
+  double legacy_power = 0;
+  for (uint32_t r = 0; r < 10; r++) {
+    srslte_ch_awgn_c(zeros, output, powf(10, -(snr_db + 3.0f) / 20.0f), nof_samples);
+    for (uint32_t i = 0; i < nof_samples; i++) {
+      legacy_power += __real__ output[i] * __real__ output[i] + __imag__ output[i] * __imag__ output[i];
+    }
+  }
+  double legacy_snr = -10 * log10(legacy_power / nof_samples / 10);
+  if (fabs(legacy_snr - snr_db) > 0.1) {
+    printf("Legacy transmit noise measured snr=%.2f dB\n", legacy_snr);
+    ret = SRSLTE_ERROR;
+  }
+
+  printf("Test snr=%.1f dB; measured snr=%.2f dB; E|x|^4/E|x|^2^2=%.3f; mean=%.4f; re/im corr=%.4f; %s ... %.1f MSps "
+         "(incl. statistics)\n",
+         snr_db,
+         snr,
+         kurt,
+         mean,
+         corr,
+         ret == SRSLTE_SUCCESS ? "Passed" : "Failed",
+         msps);
+
+  free(zeros);
+  free(output);
+  free(part);
+
+  exit(ret);
+}
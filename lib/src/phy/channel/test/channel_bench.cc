@@ -0,0 +1,172 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <cmath>
+#include <srslte/phy/channel/channel.h>
+#include <srslte/phy/utils/random.h>
+#include <srslte/phy/utils/vector.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/*
+ * Measures the throughput of srslte::channel::run with all stages enabled for
+ * 1, 2 and 4 ports. Each configuration also runs a second channel out of place
+ * and checks that it produces the same samples as the in place one.
+ */
+
+static uint32_t    nof_prb      = 50;
+static uint32_t    nof_sf       = 1000;
+static std::string fading_model = "epa5";
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [pnm]\n", prog);
+  printf("\t-p Number of PRB [Default %d]\n", nof_prb);
+  printf("\t-n Number of subframes [Default %d]\n", nof_sf);
+  printf("\t-m Fading model, none disables fading [Default %s]\n", fading_model.c_str());
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "pnm")) != -1) {
+    switch (opt) {
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_sf = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'm':
+        fading_model = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static int run_ports(uint32_t nof_ports)
+{
+  uint32_t srate  = (uint32_t)srslte_sampling_freq_hz(nof_prb);
+  uint32_t sf_len = srate / 1000;
+  int      ret    = SRSLTE_SUCCESS;
+
+  srslte::channel::args_t args;
+  args.enable           = true;
+  args.fading_enable    = fading_model != "none";
+  args.fading_model     = fading_model;
+  args.delay_enable     = true;
+  args.rlf_enable       = true;
+  args.rlf_t_on_ms      = 900;
+  args.rlf_t_off_ms     = 100;
+  args.path_loss_enable = true;
+  args.path_loss_db     = 3.0f;
+  args.awgn_enable      = true;
+  args.awgn_snr_db      = 20.0f;
+
+  srslte::channel ch_inplace(args, nof_ports);
+  srslte::channel ch_outplace(args, nof_ports);
+  ch_inplace.set_srate(srate);
+  ch_outplace.set_srate(srate);
+
+  cf_t* buffer[SRSLTE_MAX_PORTS] = {};
+  cf_t* in[SRSLTE_MAX_PORTS]     = {};
+  cf_t* out[SRSLTE_MAX_PORTS]    = {};
+  for (uint32_t i = 0; i < nof_ports; i++) {
+    buffer[i] = srslte_vec_cf_malloc(sf_len);
+    in[i]     = srslte_vec_cf_malloc(sf_len);
+    out[i]    = srslte_vec_cf_malloc(sf_len);
+  }
+
+  srslte_random_t random = srslte_random_init(0);
+  double          usec   = 0;
+  float           mse    = 0;
+
+  for (uint32_t sf = 0; sf < nof_sf; sf++) {
+    srslte_timestamp_t ts;
+    srslte_timestamp_init(&ts, sf / 1000, (sf % 1000) * 1e-3);
+
+    for (uint32_t i = 0; i < nof_ports; i++) {
+      srslte_random_uniform_complex_dist_vector(random, in[i], sf_len, -1.0f, +1.0f);
+      memcpy(buffer[i], in[i], sizeof(cf_t) * sf_len);
+    }
+
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    ch_inplace.run(buffer, buffer, sf_len, ts);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+    ch_outplace.run(in, out, sf_len, ts);
+    for (uint32_t i = 0; i < nof_ports; i++) {
+      srslte_vec_sub_ccc(buffer[i], out[i], out[i], sf_len);
+      mse = SRSLTE_MAX(mse, srslte_vec_avg_power_cf(out[i], sf_len));
+    }
+  }
+
+  printf("ports=%d nof_prb=%d fading=%s: %.2f Msamples/s per port, %.2f Msamples/s total\n",
+         nof_ports,
+         nof_prb,
+         fading_model.c_str(),
+         (double)nof_sf * sf_len / usec,
+         (double)nof_sf * sf_len * nof_ports / usec);
+
+  if (mse > 1e-10f) {
+    fprintf(stderr, "In place and out of place output differ, mse=%e\n", mse);
+    ret = SRSLTE_ERROR;
+  }
+
+  srslte_random_free(random);
+  for (uint32_t i = 0; i < nof_ports; i++) {
+    free(buffer[i]);
+    free(in[i]);
+    free(out[i]);
+  }
+
+  return ret;
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSLTE_SUCCESS;
+
+  parse_args(argc, argv);
+
+  uint32_t ports[] = {1, 2, 4};
+  for (uint32_t p : ports) {
+    if (run_ports(p) != SRSLTE_SUCCESS) {
+      ret = SRSLTE_ERROR;
+    }
+  }
+
+  if (ret == SRSLTE_SUCCESS) {
+    printf("Ok!\n");
+  }
+
+  return ret;
+}
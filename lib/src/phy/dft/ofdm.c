@@ -137,6 +137,8 @@ int srslte_ofdm_init_mbsfn_(srslte_ofdm_t *q, srslte_cp_t cp, cf_t *in_buffer, c
   }
 
   q->cp_shift_nsamples = 0;
+  q->tx_re_start = 0;
+  q->tx_nof_re = 0;
   q->cp_shift_correction = srslte_vec_malloc(sizeof(cf_t) * q->nof_re);
   if (!q->cp_shift_correction) {
     perror("malloc");
@@ -201,6 +203,8 @@ int srslte_ofdm_replan_(srslte_ofdm_t *q, srslte_cp_t cp, int symbol_sz, int nof
     return -1;
   }
   bzero(q->tmp, sizeof(cf_t) * q->sf_sz);
+  q->tx_re_start = 0;
+  q->tx_nof_re   = 0;
 
   if (dir == SRSLTE_DFT_BACKWARD) {
     bzero(in_buffer, sizeof(cf_t) * SRSLTE_SF_LEN_RE(nof_prb, cp));
@@ -576,6 +580,9 @@ void srslte_ofdm_tx_slot(srslte_ofdm_t *q, int slot_in_sf) {
   float norm = 1.0f/sqrtf(q->symbol_sz);
   cf_t *tmp = q->tmp + slot_in_sf * q->symbol_sz * q->nof_symbols;
 
+  q->tx_re_start = 0;
+  q->tx_nof_re   = q->nof_re;
+
   bzero(tmp, q->slot_sz);
   uint32_t dc = (q->fft_plan.dc) ? 1:0;
 
@@ -667,3 +674,122 @@ void srslte_ofdm_tx_sf(srslte_ofdm_t *q)
   }
 }
 
+
+/* Modulates a single symbol (0 to 2*nof_symbols-1) of the input grid and adds
+ * it, with its CP and the frequency shift, to the time-domain samples already
+ * in the output buffer. Since the modulation is linear, a subframe can be
+ * assembled from a precomputed signal and the few symbols that changed.
+ */
+void srslte_ofdm_tx_symbol_add(srslte_ofdm_t *q, uint32_t symbol_idx)
+{
+  uint32_t slot   = symbol_idx / q->nof_symbols;
+  uint32_t l      = symbol_idx % q->nof_symbols;
+  cf_t    *input  = q->in_buffer + symbol_idx * q->nof_re;
+  cf_t    *output = q->out_buffer + slot * q->slot_sz;
+  cf_t    *shift  = q->shift_buffer + slot * q->slot_sz;
+
+  for (uint32_t i = 0; i < l; i++) {
+    uint32_t offset = q->symbol_sz + (SRSLTE_CP_ISNORM(q->cp) ? SRSLTE_CP_LEN_NORM(i, q->symbol_sz) : SRSLTE_CP_LEN_EXT(q->symbol_sz));
+    output += offset;
+    shift  += offset;
+  }
+  uint32_t cp_len = SRSLTE_CP_ISNORM(q->cp) ? SRSLTE_CP_LEN_NORM(l, q->symbol_sz) : SRSLTE_CP_LEN_EXT(q->symbol_sz);
+
+  // Same layout as the guru plans use, the guard carriers of tmp stay zero
+#ifdef AVOID_GURU
+  cf_t *tmp = q->tmp;
+#else
+  cf_t *tmp = q->tmp + symbol_idx * q->symbol_sz;
+#endif
+  uint32_t dc = (q->fft_plan.dc) ? 1 : 0;
+  memcpy(&tmp[dc], &input[q->nof_re / 2], q->nof_re / 2 * sizeof(cf_t));
+  memcpy(&tmp[q->symbol_sz - q->nof_re / 2], &input[0], q->nof_re / 2 * sizeof(cf_t));
+  q->tx_re_start = 0;
+  q->tx_nof_re   = q->nof_re;
+
+  cf_t *y = q->fft_plan.out;
+  srslte_dft_run_c_zerocopy(&q->fft_plan, tmp, y);
+#ifdef AVOID_GURU
+  // tx_slot() expects the centered layout with zero guards in tmp
+  bzero(tmp, q->symbol_sz * sizeof(cf_t));
+#endif
+
+  float norm = q->fft_plan.norm ? 1.0f / sqrtf(q->symbol_sz) : 1.0f;
+  for (uint32_t t = 0; t < cp_len + q->symbol_sz; t++) {
+    cf_t s = norm * y[(t + q->symbol_sz - cp_len) % q->symbol_sz];
+    output[t] += q->freq_shift ? s * shift[t] : s;
+  }
+}
+
+/* Copies REs [re_start, re_start + nof_re) of a symbol to their iFFT bins in
+ * tmp, or clears these bins if input is NULL */
+static void ofdm_tx_stage(srslte_ofdm_t *q, cf_t *tmp, const cf_t *input, uint32_t re_start, uint32_t nof_re)
+{
+  uint32_t half = q->nof_re / 2;
+  uint32_t dc   = (q->fft_plan.dc) ? 1 : 0;
+
+  while (nof_re > 0) {
+    uint32_t n   = nof_re;
+    uint32_t bin = dc + re_start - half;
+    if (re_start < half) {
+      n   = SRSLTE_MIN(nof_re, half - re_start);
+      bin = q->symbol_sz - half + re_start;
+    }
+    if (input) {
+      memcpy(&tmp[bin], &input[re_start], n * sizeof(cf_t));
+    } else {
+      bzero(&tmp[bin], n * sizeof(cf_t));
+    }
+    re_start += n;
+    nof_re -= n;
+  }
+}
+
+/* Modulates a subframe of which only PRBs [prb_start, prb_start + nof_prb) are
+ * occupied. Only these REs are staged for the iFFT. The normalization, the
+ * frequency shift, a residual frequency offset cfo (normalized to the sampling
+ * rate) and an output scaling are then applied in a single pass.
+ */
+void srslte_ofdm_tx_sf_prb(srslte_ofdm_t *q, uint32_t prb_start, uint32_t nof_prb, float cfo, float scale)
+{
+#ifdef AVOID_GURU
+  srslte_ofdm_tx_sf(q);
+  srslte_vec_apply_cfo_scale(q->out_buffer, cfo, scale, q->out_buffer, q->sf_sz);
+#else
+  uint32_t nof_symbols = 2 * q->nof_symbols;
+  uint32_t re_start    = prb_start * SRSLTE_NRE;
+  uint32_t nof_re      = re_start < q->nof_re ? SRSLTE_MIN(nof_prb * SRSLTE_NRE, q->nof_re - re_start) : 0;
+
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    cf_t *tmp = q->tmp + i * q->symbol_sz;
+    if (q->tx_nof_re) {
+      ofdm_tx_stage(q, tmp, NULL, q->tx_re_start, q->tx_nof_re);
+    }
+    ofdm_tx_stage(q, tmp, q->in_buffer + i * q->nof_re, re_start, nof_re);
+  }
+  q->tx_re_start = re_start;
+  q->tx_nof_re   = nof_re;
+
+  srslte_dft_run_guru_c(&q->fft_plan_sf[0]);
+  srslte_dft_run_guru_c(&q->fft_plan_sf[1]);
+
+  // The frequency shift restarts its phase in every symbol, see srslte_ofdm_set_freq_shift()
+  float shift = q->freq_shift ? q->freq_shift_f / q->symbol_sz : 0.0f;
+  float norm  = q->fft_plan.norm ? scale / sqrtf(q->symbol_sz) : scale;
+
+  cf_t    *output = q->out_buffer;
+  uint32_t n      = 0;
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    uint32_t l      = i % q->nof_symbols;
+    uint32_t cp_len = SRSLTE_CP_ISNORM(q->cp) ? SRSLTE_CP_LEN_NORM(l, q->symbol_sz) : SRSLTE_CP_LEN_EXT(q->symbol_sz);
+
+    memcpy(output, &output[q->symbol_sz], cp_len * sizeof(cf_t));
+
+    cf_t h = norm * cexpf(_Complex_I * 2.0f * (float) M_PI * (cfo * n - shift * cp_len));
+    srslte_vec_apply_cfo_scale(output, cfo + shift, h, output, q->symbol_sz + cp_len);
+
+    output += q->symbol_sz + cp_len;
+    n += q->symbol_sz + cp_len;
+  }
+#endif
+}
@@ -0,0 +1,220 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srslte/phy/fec/turbodecoder_pool.h"
+#include "srslte/phy/common/phy_common.h"
+#include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
+#include <stdlib.h>
+#include <strings.h>
+
+typedef struct {
+  srslte_tdec_pool_t*    pool;
+  srslte_tdec_t          decoder;
+  srslte_crc_t           crc_cb;
+  srslte_crc_t           crc_tb;
+  srslte_tdec_pool_ctx_t ctx;
+} tdec_pool_worker_t;
+
+// Takes the next task of the oldest job, called with the mutex held
+static srslte_tdec_pool_job_t* next_task(srslte_tdec_pool_t* q, uint32_t* idx)
+{
+  srslte_tdec_pool_job_t* job = q->jobs;
+  if (job) {
+    *idx = job->next_task++;
+    if (job->next_task == job->nof_tasks) {
+      q->jobs = job->next;
+    }
+  }
+  return job;
+}
+
+// Runs task idx of job and counts it as done, called and returns with the mutex held
+static void run_task(srslte_tdec_pool_t* q, srslte_tdec_pool_job_t* job, uint32_t idx, srslte_tdec_pool_ctx_t* ctx)
+{
+  pthread_mutex_unlock(&q->mutex);
+  job->task(job->arg, idx, ctx);
+  pthread_mutex_lock(&q->mutex);
+
+  job->nof_done++;
+  if (job->nof_done == job->nof_tasks) {
+    pthread_cond_broadcast(&q->cvar_done);
+  }
+}
+
+static void* tdec_pool_thread(void* arg)
+{
+  tdec_pool_worker_t* w = (tdec_pool_worker_t*)arg;
+  srslte_tdec_pool_t* q = w->pool;
+
+  pthread_mutex_lock(&q->mutex);
+  while (q->running) {
+    uint32_t                idx = 0;
+    srslte_tdec_pool_job_t* job = next_task(q, &idx);
+    if (job) {
+      run_task(q, job, idx, &w->ctx);
+    } else {
+      pthread_cond_wait(&q->cvar_task, &q->mutex);
+    }
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return NULL;
+}
+
+static int tdec_pool_worker_init(tdec_pool_worker_t* w, srslte_tdec_pool_t* q)
+{
+  w->pool = q;
+  if (srslte_tdec_init(&w->decoder, SRSLTE_TCOD_MAX_LEN_CB)) {
+    ERROR("Error initiating Turbo Decoder\n");
+    return SRSLTE_ERROR;
+  }
+  if (srslte_crc_init(&w->crc_cb, SRSLTE_LTE_CRC24B, 24) || srslte_crc_init(&w->crc_tb, SRSLTE_LTE_CRC24A, 24)) {
+    ERROR("Error initiating CRC\n");
+    return SRSLTE_ERROR;
+  }
+  w->ctx.decoder = &w->decoder;
+  w->ctx.crc_cb  = &w->crc_cb;
+  w->ctx.crc_tb  = &w->crc_tb;
+  w->ctx.output  = srslte_vec_malloc(sizeof(uint8_t) * (SRSLTE_TCOD_MAX_LEN_CB + 8) / 8);
+  if (!w->ctx.output) {
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_tdec_pool_init(srslte_tdec_pool_t* q, uint32_t nof_threads)
+{
+  if (!q || nof_threads == 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srslte_tdec_pool_t));
+  pthread_mutex_init(&q->mutex, NULL);
+  pthread_cond_init(&q->cvar_task, NULL);
+  pthread_cond_init(&q->cvar_done, NULL);
+  q->running = true;
+
+  q->threads = calloc(nof_threads, sizeof(pthread_t));
+  q->workers = calloc(nof_threads, sizeof(tdec_pool_worker_t));
+  if (!q->threads || !q->workers) {
+    srslte_tdec_pool_free(q);
+    return SRSLTE_ERROR;
+  }
+
+  q->nof_workers = nof_threads;
+
+  tdec_pool_worker_t* workers = (tdec_pool_worker_t*)q->workers;
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    if (tdec_pool_worker_init(&workers[i], q) ||
+        pthread_create(&q->threads[i], NULL, tdec_pool_thread, &workers[i])) {
+      ERROR("Error creating turbo decoder thread %d\n", i);
+      srslte_tdec_pool_free(q);
+      return SRSLTE_ERROR;
+    }
+    q->nof_threads++;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_tdec_pool_free(srslte_tdec_pool_t* q)
+{
+  if (!q) {
+    return;
+  }
+
+  pthread_mutex_lock(&q->mutex);
+  q->running = false;
+  pthread_cond_broadcast(&q->cvar_task);
+  pthread_mutex_unlock(&q->mutex);
+
+  for (uint32_t i = 0; i < q->nof_threads; i++) {
+    pthread_join(q->threads[i], NULL);
+  }
+
+  tdec_pool_worker_t* workers = (tdec_pool_worker_t*)q->workers;
+  if (workers) {
+    // workers that were not initialised are still zero
+    for (uint32_t i = 0; i < q->nof_workers; i++) {
+      srslte_tdec_free(&workers[i].decoder);
+      if (workers[i].ctx.output) {
+        free(workers[i].ctx.output);
+      }
+    }
+    free(workers);
+  }
+  if (q->threads) {
+    free(q->threads);
+  }
+
+  pthread_mutex_destroy(&q->mutex);
+  pthread_cond_destroy(&q->cvar_task);
+  pthread_cond_destroy(&q->cvar_done);
+  bzero(q, sizeof(srslte_tdec_pool_t));
+}
+
+void srslte_tdec_pool_run(srslte_tdec_pool_t*     q,
+                          srslte_tdec_pool_task_t task,
+                          void*                   arg,
+                          uint32_t                nof_tasks,
+                          srslte_tdec_pool_ctx_t* caller_ctx)
+{
+  if (nof_tasks == 0) {
+    return;
+  }
+
+  srslte_tdec_pool_job_t job;
+  bzero(&job, sizeof(srslte_tdec_pool_job_t));
+  job.task      = task;
+  job.arg       = arg;
+  job.nof_tasks = nof_tasks;
+
+  pthread_mutex_lock(&q->mutex);
+
+  srslte_tdec_pool_job_t** tail = &q->jobs;
+  while (*tail) {
+    tail = &(*tail)->next;
+  }
+  *tail = &job;
+  pthread_cond_broadcast(&q->cvar_task);
+
+  // help with this job until all its tasks are handed out, then wait for the others
+  while (job.next_task < job.nof_tasks) {
+    uint32_t idx = job.next_task++;
+    if (job.next_task == job.nof_tasks) {
+      // unlink the job, other callers may have added theirs in the meantime
+      srslte_tdec_pool_job_t** j = &q->jobs;
+      while (*j != &job) {
+        j = &(*j)->next;
+      }
+      *j = job.next;
+    }
+    run_task(q, &job, idx, caller_ctx);
+  }
+  while (job.nof_done < job.nof_tasks) {
+    pthread_cond_wait(&q->cvar_done, &q->mutex);
+  }
+
+  pthread_mutex_unlock(&q->mutex);
+}
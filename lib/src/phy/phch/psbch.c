@@ -87,6 +87,13 @@ bool srslte_pbch_exists(int nframe, int nslot) {
 #endif
 cf_t *offset_original;
 
+/**
+ * Returns true if SC-FDMA symbol l of the sync subframe carries PSBCH
+ */
+bool srslte_psbch_is_symbol(uint32_t l) {
+  return l == 0 || l == 3 || l == 5 || l == 7 || l == 8 || l == 10;
+}
+
 int srslte_psbch_cp(cf_t *input, cf_t *output, srslte_cell_t cell, bool put) {
   int i;
   cf_t *ptr;
@@ -103,7 +110,7 @@ int srslte_psbch_cp(cf_t *input, cf_t *output, srslte_cell_t cell, bool put) {
 
   for(i=0; i<2*SRSLTE_CP_NSYMB(cell.cp); i++) {
     // symbols containing psbch
-    if(i==0 || i==3 || i==5 || i==7 || i==8 || i==10) {
+    if(srslte_psbch_is_symbol(i)) {
       // printf("sym: %d from %x to %x\n", i, input, output);
       prb_cp(&input, &output, 6);
       if (put) {
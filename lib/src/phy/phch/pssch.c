@@ -328,13 +328,58 @@ int srslte_pssch_cp_for_sps_rssi(cf_t* input, cf_t* output, srslte_cell_t cell,
   return output - ptr;
 }
 
+/**
+ * @brief Measure the S-RSSI of the whole pool and of each subchannel in a single
+ *        pass over the subframe, without copying the symbols first.
+ * 
+ * @param sf_symbols    buffer to subframe
+ * @param cell 
+ * @param prb_offset    first PRB of the first subchannel
+ * @param subch_size    number of PRBs per subchannel
+ * @param nof_subch     number of subchannels
+ * @param subch_rssi    average power per RE of each subchannel, may be NULL
+ * @return float        average power per RE across all subchannels
+ */
+float srslte_pssch_sps_rssi(cf_t *sf_symbols, srslte_cell_t cell, uint32_t prb_offset,
+                            uint32_t subch_size, uint32_t nof_subch, float *subch_rssi)
+{
+  float acc[SRSLTE_MAX_PRB] = {0};
+  float total = 0.0f;
+  uint32_t n_sym = 0;
+
+  if (nof_subch == 0 || subch_size == 0 || nof_subch > SRSLTE_MAX_PRB) {
+    return 0.0f;
+  }
+
+  sf_symbols += prb_offset * SRSLTE_NRE;
+
+  for (uint32_t i = 0; i < 2 * SRSLTE_CP_NSYMB(cell.cp); i++) {
+    // symbols not containing pssch, same as srslte_pssch_cp_for_sps_rssi()
+    if (i != 0 && i != 13) {
+      srslte_vec_acc_power_seg_cf(sf_symbols, subch_size * SRSLTE_NRE, nof_subch, acc);
+      n_sym++;
+    }
+    sf_symbols += cell.nof_prb * SRSLTE_NRE;
+  }
+
+  for (uint32_t s = 0; s < nof_subch; s++) {
+    total += acc[s];
+    if (subch_rssi) {
+      subch_rssi[s] = acc[s] / (n_sym * subch_size * SRSLTE_NRE);
+    }
+  }
+
+  return total / (n_sym * nof_subch * subch_size * SRSLTE_NRE);
+}
+
 /**
  * @brief Generate interleaver sequence for sidelink PSSCH
  * 
- * @param q 
+ * @param lut 
  * @param mod 
+ * @param max_bits 
  */
-static void interleaver_table_gen(srslte_pssch_t *q, srslte_mod_t mod, uint32_t max_bits) {
+static void interleaver_table_gen(uint16_t *lut, srslte_mod_t mod, uint32_t max_bits) {
   uint32_t Qm = srslte_mod_bits_x_symbol(mod);
   uint32_t H_prime_total = max_bits / Qm;
   uint32_t N_pucch_symbs = 2*(SRSLTE_CP_NORM_NSYMB - 2); // 36.212 5.4.3
@@ -346,16 +391,101 @@ static void interleaver_table_gen(srslte_pssch_t *q, srslte_mod_t mod, uint32_t
     for(uint32_t i=0; i<cols; i++) {
       for(uint32_t k=0; k<Qm; k++) {
           // this is the indexing from SRSlte and which think is correct
-          q->interleaver_lut[j*Qm + i*rows*Qm + k] = idx;
+          lut[j*Qm + i*rows*Qm + k] = idx;
 
           // this is the indexing from feron matlab implementation, which may be wrong
-          //q->interleaver_lut[idx] = j*Qm + i*rows*Qm + k;
+          //lut[idx] = j*Qm + i*rows*Qm + k;
           idx++;                  
       }
     }
   }
 }
 
+/**
+ * @brief Get the interleaver table for an allocation, the table is generated
+ *        into the least recently used cache entry if it is not cached yet.
+ * 
+ * @param q 
+ * @param mod 
+ * @param n_prb 
+ * @return uint16_t*    interleaver table covering all 10 sc-fdma symbols
+ */
+static uint16_t *pssch_get_interleaver_lut(srslte_pssch_t *q, srslte_mod_t mod, uint32_t n_prb) {
+  srslte_pssch_lut_cache_t *victim = &q->lut_cache[0];
+
+  q->cache_tick++;
+
+  for (uint32_t i = 0; i < SRSLTE_PSSCH_NOF_CACHED_LUT; i++) {
+    srslte_pssch_lut_cache_t *c = &q->lut_cache[i];
+    if (c->valid && c->mod == mod && c->n_prb == n_prb) {
+      c->last_used = q->cache_tick;
+      q->cache_hits++;
+      return c->lut;
+    }
+    // unused entries have last_used=0
+    if (c->last_used < victim->last_used) {
+      victim = c;
+    }
+  }
+
+  q->cache_misses++;
+
+  interleaver_table_gen(victim->lut, mod, 10*SRSLTE_NRE*n_prb*srslte_mod_bits_x_symbol(mod));
+
+  victim->valid     = true;
+  victim->mod       = mod;
+  victim->n_prb     = n_prb;
+  victim->last_used = q->cache_tick;
+
+  return victim->lut;
+}
+
+/**
+ * @brief Get the scrambling sequence for the 9 transmitted sc-fdma symbols of an
+ *        allocation, using the current n_X_ID and n_PSSCH_ssf of the object.
+ * 
+ * @param q 
+ * @param mod 
+ * @param n_prb 
+ * @return srslte_sequence_t*   NULL if the sequence could not be generated
+ */
+static srslte_sequence_t *pssch_get_sequence(srslte_pssch_t *q, srslte_mod_t mod, uint32_t n_prb) {
+  srslte_pssch_seq_cache_t *victim = &q->seq_cache[0];
+
+  q->cache_tick++;
+
+  for (uint32_t i = 0; i < SRSLTE_PSSCH_NOF_CACHED_SEQ; i++) {
+    srslte_pssch_seq_cache_t *c = &q->seq_cache[i];
+    if (c->valid && c->mod == mod && c->n_prb == n_prb &&
+        c->n_X_ID == q->n_X_ID && c->n_PSSCH_ssf == q->n_PSSCH_ssf) {
+      c->last_used = q->cache_tick;
+      q->cache_hits++;
+      return &c->seq;
+    }
+    if (c->last_used < victim->last_used) {
+      victim = c;
+    }
+  }
+
+  q->cache_misses++;
+
+  victim->valid = false;
+  if (srslte_sequence_pssch(&victim->seq, 9*SRSLTE_NRE*n_prb*srslte_mod_bits_x_symbol(mod), q->n_X_ID, q->n_PSSCH_ssf)) {
+    ERROR("Error generating PSSCH scrambling sequence");
+    victim->last_used = 0;
+    return NULL;
+  }
+
+  victim->valid       = true;
+  victim->mod         = mod;
+  victim->n_prb       = n_prb;
+  victim->n_X_ID      = q->n_X_ID;
+  victim->n_PSSCH_ssf = q->n_PSSCH_ssf;
+  victim->last_used   = q->cache_tick;
+
+  return &victim->seq;
+}
+
 /** Initializes the PDSCH transmitter and receiver */
 static int pssch_init(srslte_pssch_t *q, uint32_t max_prb, bool is_ue, uint32_t nof_antennas)
 {
@@ -461,11 +591,13 @@ static int pssch_init(srslte_pssch_t *q, uint32_t max_prb, bool is_ue, uint32_t
     // actually we could use the interleaver functionality from sch.c but because
     // we do not include any control information we only took the relevant part 
     // to genenerate a more lightweight version
-    q->interleaver_lut = srslte_vec_malloc(sizeof(uint16_t) * q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_16QAM));
-    if (!q->interleaver_lut) {
-      goto clean;
+    for (int i = 0; i < SRSLTE_PSSCH_NOF_CACHED_LUT; i++) {
+      q->lut_cache[i].lut = srslte_vec_malloc(sizeof(uint16_t) * q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_16QAM));
+      if (!q->lut_cache[i].lut) {
+        goto clean;
+      }
     }
-    //interleaver_table_gen(q);
+    // scrambling sequences are allocated on first use
 
 
     ret = SRSLTE_SUCCESS;
@@ -574,8 +706,14 @@ void srslte_pssch_free(srslte_pssch_t *q) {
   srslte_dft_precoding_free(&q->dft_precoding);
   srslte_dft_precoding_free(&q->dft_deprecoding);
 
-  if (q->interleaver_lut) {
-    free(q->interleaver_lut);
+  for (int i = 0; i < SRSLTE_PSSCH_NOF_CACHED_LUT; i++) {
+    if (q->lut_cache[i].lut) {
+      free(q->lut_cache[i].lut);
+    }
+  }
+
+  for (int i = 0; i < SRSLTE_PSSCH_NOF_CACHED_SEQ; i++) {
+    srslte_sequence_free(&q->seq_cache[i].seq);
   }
 
   bzero(q, sizeof(srslte_pssch_t));
@@ -1045,34 +1183,33 @@ int srslte_pssch_decode_simple(srslte_pssch_t *q,
     */
   srslte_demod_soft_demodulate_s(sci->mcs.mod, q->d[0], q->h[0], nof_symbols);
 
-  /* Select scrambling sequence */
-  // srslte_sequence_t *seq = get_user_sequence(q, rnti, codeword_idx, cfg->sf_idx, nbits->nof_bits);
-  srslte_sequence_pssch(&q->tmp_seq, nof_symbols*srslte_mod_bits_x_symbol(sci->mcs.mod), q->n_X_ID, q->n_PSSCH_ssf);
-
-  /* Bit scrambling */
-  srslte_scrambling_s_offset(&q->tmp_seq, q->h[0], 0, nof_symbols*srslte_mod_bits_x_symbol(sci->mcs.mod));
+  /* Select scrambling sequence and interleaver table */
+  srslte_sequence_t *seq = pssch_get_sequence(q, sci->mcs.mod, n_prb);
+  uint16_t *lut = pssch_get_interleaver_lut(q, sci->mcs.mod, n_prb);
+  if (!seq) {
+    return SRSLTE_ERROR;
+  }
 
   int16_t *h = q->h[0];
   int16_t *e = q->e[0];
 
-  // explicitely clear last symbol, as it is used as guard
-  bzero(&h[nof_symbols*srslte_mod_bits_x_symbol(sci->mcs.mod)], sizeof(int16_t) * 1*SRSLTE_NRE*n_prb*srslte_mod_bits_x_symbol(sci->mcs.mod));
-
 
   /**
    * phy decoding is now finished, now follows transport block processing
    */
 
   // for interleaving we need to take all 10 symbols into consideration
-  int n_bits = 10*SRSLTE_NRE*n_prb*srslte_mod_bits_x_symbol(sci->mcs.mod);
+  uint32_t n_bits = 10*SRSLTE_NRE*n_prb*srslte_mod_bits_x_symbol(sci->mcs.mod);
+  uint32_t n_scrambled = nof_symbols*srslte_mod_bits_x_symbol(sci->mcs.mod);
 
-  // Generate interleaver table
-  // @todo: generate a interleaver table which is independent of modulation-order
-  interleaver_table_gen(q, sci->mcs.mod, n_bits);
-  
-  // de-interleaving
-  for(int i=0; i<n_bits; i++) {
-    e[q->interleaver_lut[i]] = h[i];
+  // de-interleaving and descrambling in a single pass
+  for(i=0; i<n_scrambled; i++) {
+    e[lut[i]] = h[i] * seq->c_short[i];
+  }
+
+  // explicitely clear last symbol, as it is used as guard
+  for(; i<n_bits; i++) {
+    e[lut[i]] = 0;
   }
 
   // rate-dematching and turbo-decoding
@@ -1415,20 +1552,23 @@ int srslte_pssch_encode_simple(srslte_pssch_t *q,
     return SRSLTE_ERROR;
   }
 
-  // Generate interleaver table
-  interleaver_table_gen(q, sci->mcs.mod, E);
+  // Get interleaver table
+  uint16_t *lut = pssch_get_interleaver_lut(q, sci->mcs.mod, n_prb);
 
   // y = x(lut)
-  srslte_bit_interleave_w_offset(q->e[0], q->h[0], q->interleaver_lut, E, 0);
+  srslte_bit_interleave_w_offset(q->e[0], q->h[0], lut, E, 0);
 
   // PHY processing: from here on we only need to process 9 sc-fdma symbols
   nof_re = 9 * n_prb * SRSLTE_NRE;
   E = nof_re * srslte_mod_bits_x_symbol(sci->mcs.mod);
 
   // srcambling
-  srslte_sequence_pssch(&q->tmp_seq, E, q->n_X_ID, q->n_PSSCH_ssf);
+  srslte_sequence_t *seq = pssch_get_sequence(q, sci->mcs.mod, n_prb);
+  if (!seq) {
+    return SRSLTE_ERROR;
+  }
 
-  srslte_scrambling_bytes(&q->tmp_seq, q->h[0], E);
+  srslte_scrambling_bytes(seq, q->h[0], E);
 
   // modulation
   srslte_mod_modulate_bytes(&q->mod[sci->mcs.mod],
@@ -1459,6 +1599,10 @@ void srslte_pssch_set_max_noi(srslte_pssch_t *q, uint32_t max_iter) {
   srslte_sch_set_max_noi(&q->dl_sch, max_iter);
 }
 
+void srslte_pssch_set_tdec_pool(srslte_pssch_t *q, srslte_tdec_pool_t *pool) {
+  srslte_sch_set_tdec_pool(&q->dl_sch, pool);
+}
+
 float srslte_pssch_last_noi(srslte_pssch_t *q) {
   float niters = 0;
   int   active_cw = 0;
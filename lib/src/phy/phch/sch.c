@@ -196,6 +196,11 @@ void srslte_sch_set_max_noi(srslte_sch_t *q, uint32_t max_iterations) {
   q->max_iterations = max_iterations;
 }
 
+void srslte_sch_set_tdec_pool(srslte_sch_t* q, srslte_tdec_pool_t* pool)
+{
+  q->tdec_pool = pool;
+}
+
 float srslte_sch_last_noi(srslte_sch_t* q)
 {
   return q->avg_iterations;
@@ -320,101 +325,152 @@ static int encode_tb(srslte_sch_t *q,
   return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, data, e_bits, 0);
 }
 
-bool decode_tb_cb(srslte_sch_t *q, 
-                     srslte_softbuffer_rx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
-                     uint32_t Qm, uint32_t rv, uint32_t nof_e_bits, 
-                     void *e_bits, uint8_t *data)
+/* Rate dematches and decodes code block cb_idx into output, stopping early once its
+ * CRC is OK. A code block decoded in an earlier transmission is copied from the
+ * soft buffer. Returns the number of iterations or a negative value on error.
+ */
+static int decode_cb(srslte_sch_t*           q,
+                     srslte_tdec_pool_ctx_t* ctx,
+                     srslte_softbuffer_rx_t* softbuffer,
+                     srslte_cbsegm_t*        cb_segm,
+                     uint32_t                Qm,
+                     uint32_t                rv,
+                     uint32_t                nof_e_bits,
+                     void*                   e_bits,
+                     uint8_t*                output,
+                     uint32_t                cb_idx)
 {
+  int8_t*  e_bits_b = e_bits;
+  int16_t* e_bits_s = e_bits;
 
-  int8_t *e_bits_b  = e_bits;
-  int16_t *e_bits_s = e_bits;
+  uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+  uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
 
-  if (cb_segm->C > SRSLTE_MAX_CODEBLOCKS) {
-    ERROR("Error SRSLTE_MAX_CODEBLOCKS=%d\n", SRSLTE_MAX_CODEBLOCKS);
-    return false;
+  /* Do not process blocks with CRC Ok */
+  if (softbuffer->cb_crc[cb_idx]) {
+    // Copy decoded data from previous transmissions
+    memcpy(output, softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
+    return 0;
   }
 
-  q->avg_iterations = 0;
+  uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
+  uint32_t Gp         = nof_e_bits / Qm;
+  uint32_t gamma      = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
+  uint32_t n_e        = Qm * (Gp / cb_segm->C);
 
-  for (int cb_idx=0;cb_idx<cb_segm->C;cb_idx++)
-  {
-    /* Do not process blocks with CRC Ok */
-    if (softbuffer->cb_crc[cb_idx] == false) {
+  uint32_t rp   = cb_idx * n_e;
+  uint32_t n_e2 = n_e;
 
-      uint32_t cb_len     = cb_idx<cb_segm->C1?cb_segm->K1:cb_segm->K2;
-      uint32_t cb_len_idx = cb_idx<cb_segm->C1?cb_segm->K1_idx:cb_segm->K2_idx;
+  if (cb_idx > cb_segm->C - gamma) {
+    n_e2 = n_e + Qm;
+    rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
+  }
 
-      uint32_t rlen       = cb_segm->C==1?cb_len:(cb_len-24);
-      uint32_t Gp         = nof_e_bits / Qm;
-      uint32_t gamma      = cb_segm->C>0?Gp%cb_segm->C:Gp;
-      uint32_t n_e        = Qm * (Gp/cb_segm->C);
+  if (q->llr_is_8bit) {
+    if (srslte_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
+      ERROR("Error in rate matching\n");
+      return SRSLTE_ERROR;
+    }
+  } else {
+    if (srslte_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
+      ERROR("Error in rate matching\n");
+      return SRSLTE_ERROR;
+    }
+  }
 
-      uint32_t rp   = cb_idx*n_e;
-      uint32_t n_e2 = n_e;
+  srslte_tdec_new_cb(ctx->decoder, cb_len);
 
-      if (cb_idx > cb_segm->C - gamma) {
-        n_e2 = n_e+Qm;
-        rp   = (cb_segm->C - gamma)*n_e + (cb_idx-(cb_segm->C - gamma))*n_e2;
-      }
+  uint32_t      len_crc = cb_segm->C > 1 ? cb_len : cb_segm->tbs + 24;
+  srslte_crc_t* crc_ptr = cb_segm->C > 1 ? ctx->crc_cb : ctx->crc_tb;
 
-      if (q->llr_is_8bit) {
-        if (srslte_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*) softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching\n");
-          return SRSLTE_ERROR;
-        }
-      } else {
-        if (srslte_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching\n");
-          return SRSLTE_ERROR;
-        }
-      }
+  // Run iterations and use CRC for early stopping
+  bool     early_stop = false;
+  uint32_t cb_noi     = 0;
+  do {
+    if (q->llr_is_8bit) {
+      srslte_tdec_iteration_8bit(ctx->decoder, (int8_t*)softbuffer->buffer_f[cb_idx], output);
+    } else {
+      srslte_tdec_iteration(ctx->decoder, softbuffer->buffer_f[cb_idx], output);
+    }
+    cb_noi++;
 
-      srslte_tdec_new_cb(&q->decoder, cb_len);
+    // CRC is OK
+    if (!srslte_crc_checksum_byte(crc_ptr, output, len_crc)) {
+      softbuffer->cb_crc[cb_idx] = true;
+      early_stop                 = true;
+    }
+  } while (cb_noi < q->max_iterations && !early_stop);
 
-      // Run iterations and use CRC for early stopping
-      bool early_stop = false;
-      uint32_t cb_noi = 0;
-      do {
-        if (q->llr_is_8bit) {
-          srslte_tdec_iteration_8bit(&q->decoder, (int8_t*) softbuffer->buffer_f[cb_idx], &data[cb_idx*rlen/8]);
-        } else {
-          srslte_tdec_iteration(&q->decoder, softbuffer->buffer_f[cb_idx], &data[cb_idx*rlen/8]);
-        }
-        q->avg_iterations++;
-        cb_noi++;
+  INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d\n",
+       cb_idx, rp, n_e2, cb_len, early_stop?"OK":"KO", rlen, cb_noi, q->max_iterations);
 
-        uint32_t len_crc;
-        srslte_crc_t* crc_ptr;
+  return cb_noi;
+}
 
-        if (cb_segm->C > 1) {
-          len_crc = cb_len;
-          crc_ptr = &q->crc_cb;
-        } else {
-          len_crc = cb_segm->tbs+24;
-          crc_ptr = &q->crc_tb;
-        }
+typedef struct {
+  srslte_sch_t*           q;
+  srslte_softbuffer_rx_t* softbuffer;
+  srslte_cbsegm_t*        cb_segm;
+  uint32_t                Qm;
+  uint32_t                rv;
+  uint32_t                nof_e_bits;
+  void*                   e_bits;
+  uint8_t*                data;
+  int                     noi[SRSLTE_MAX_CODEBLOCKS];
+} decode_cb_task_t;
+
+// Decodes one code block of a TB on a decoder pool thread. The decoder also writes
+// the CB CRC, which would overlap the next CB in data, so it decodes aside.
+static void decode_cb_task(void* arg, uint32_t cb_idx, srslte_tdec_pool_ctx_t* ctx)
+{
+  decode_cb_task_t* t = (decode_cb_task_t*)arg;
 
-        // CRC is OK
-        if (!srslte_crc_checksum_byte(crc_ptr, &data[cb_idx*rlen/8], len_crc)) {
+  uint32_t cb_len = cb_idx < t->cb_segm->C1 ? t->cb_segm->K1 : t->cb_segm->K2;
+  uint32_t rlen   = cb_len - 24;
 
-          softbuffer->cb_crc[cb_idx] = true;
-          early_stop = true;
+  t->noi[cb_idx] =
+      decode_cb(t->q, ctx, t->softbuffer, t->cb_segm, t->Qm, t->rv, t->nof_e_bits, t->e_bits, ctx->output, cb_idx);
+  memcpy(&t->data[cb_idx * rlen / 8], ctx->output, rlen / 8);
+}
 
-          // CRC is error and exceeded maximum iterations for this CB.
-          // Early stop the whole transport block.
-        }
+bool decode_tb_cb(srslte_sch_t *q, 
+                     srslte_softbuffer_rx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
+                     uint32_t Qm, uint32_t rv, uint32_t nof_e_bits, 
+                     void *e_bits, uint8_t *data)
+{
+  if (cb_segm->C > SRSLTE_MAX_CODEBLOCKS) {
+    ERROR("Error SRSLTE_MAX_CODEBLOCKS=%d\n", SRSLTE_MAX_CODEBLOCKS);
+    return false;
+  }
 
-      } while (cb_noi < q->max_iterations && !early_stop);
+  srslte_tdec_pool_ctx_t ctx = {&q->decoder, &q->crc_cb, &q->crc_tb, q->cb_in};
 
-      INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d\n",
-           cb_idx, rp, n_e2, cb_len, early_stop?"OK":"KO", rlen, cb_noi, q->max_iterations);
+  uint32_t total_noi = 0;
+  bool     error     = false;
 
-    } else {
-      // Copy decoded data from previous transmissions
-      uint32_t cb_len     = cb_idx<cb_segm->C1?cb_segm->K1:cb_segm->K2;
-      uint32_t rlen       = cb_segm->C==1?cb_len:(cb_len-24);
-      memcpy(&data[cb_idx*rlen/8], softbuffer->data[cb_idx], rlen/8 * sizeof(uint8_t));
+  if (q->tdec_pool && cb_segm->C > 1) {
+    // the code blocks are independent until the TB CRC
+    decode_cb_task_t t = {q, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, data, {0}};
+    srslte_tdec_pool_run(q->tdec_pool, decode_cb_task, &t, cb_segm->C, &ctx);
+    for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
+      error |= t.noi[cb_idx] < 0;
+      total_noi += t.noi[cb_idx] > 0 ? t.noi[cb_idx] : 0;
     }
+  } else {
+    for (int cb_idx = 0; cb_idx < cb_segm->C && !error; cb_idx++) {
+      uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+      uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+
+      int noi = decode_cb(q, &ctx, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, &data[cb_idx * rlen / 8], cb_idx);
+      error |= noi < 0;
+      total_noi += noi > 0 ? noi : 0;
+    }
+  }
+
+  q->avg_iterations = (float)total_noi / cb_segm->C;
+
+  if (error) {
+    return false;
   }
 
   softbuffer->tb_crc = true;
@@ -433,7 +489,6 @@ bool decode_tb_cb(srslte_sch_t *q,
     }
   }
 
-  q->avg_iterations /= (float)cb_segm->C;
   return softbuffer->tb_crc;
 }
 
@@ -0,0 +1,174 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+#include "srslte/phy/ue_sl/ue_sl_tx.h"
+
+/*
+ * Compares the sync subframe from srslte_ue_sl_tx_sync_sf() against a subframe
+ * that is mapped and modulated completely for every DFN, and reports the time
+ * per subframe of both.
+ */
+
+srslte_cell_t cell = {
+  50,            // nof_prb
+  1,            // nof_ports
+  301,          // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1,          // PHICH resources
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t nof_dfn = 1024;
+
+void usage(char *prog) {
+  printf("Usage: %s [cnd]\n", prog);
+  printf("\t-c cell id [Default %d]\n", cell.id);
+  printf("\t-n cell.nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-d number of DFNs [Default %d]\n", nof_dfn);
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "cnd")) != -1) {
+    switch(opt) {
+    case 'c':
+      cell.id = atoi(argv[optind]);
+      break;
+    case 'n':
+      cell.nof_prb = atoi(argv[optind]);
+      break;
+    case 'd':
+      nof_dfn = atoi(argv[optind]);
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+// the full generation as it was done for every sync period
+static void sync_sf_reference(srslte_ue_sl_tx_t *q, uint32_t dfn, uint32_t dsfn)
+{
+  bzero(q->sf_symbols, sizeof(cf_t) * SRSLTE_SF_LEN_RE(q->cell.nof_prb, q->cell.cp));
+  srslte_psss_put_sf(q->psss_signal, q->sf_symbols, q->cell.nof_prb, SRSLTE_CP_NORM);
+  srslte_ssss_put_sf(q->ssss_signal, q->sf_symbols, q->cell.nof_prb, SRSLTE_CP_NORM);
+  srslte_refsignal_sl_dmrs_psbch_put(&q->signals, SRSLTE_SL_MODE_4, q->psbch_dmrs, q->sf_symbols);
+
+  srslte_psbch_mib_pack(&q->cell, dfn, dsfn, q->bch_payload);
+
+  cf_t *sf_symbols[SRSLTE_MAX_PORTS] = {q->sf_symbols};
+  srslte_psbch_encode(&q->psbch, q->bch_payload, sf_symbols);
+
+  srslte_ofdm_tx_sf(&q->fft);
+}
+
+int main(int argc, char **argv) {
+  srslte_ue_sl_tx_t ue_sl_tx;
+  struct timeval t[3];
+  uint64_t time_ref = 0, time_cache = 0;
+  float max_err = 0;
+  int ret = SRSLTE_ERROR;
+
+  parse_args(argc, argv);
+
+  uint32_t sf_len = SRSLTE_SF_LEN_PRB(cell.nof_prb);
+  cf_t *out_buffer = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  cf_t *reference  = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  if (!out_buffer || !reference) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  if (srslte_ue_sl_tx_init(&ue_sl_tx, out_buffer, cell.nof_prb)) {
+    fprintf(stderr, "Error initiating ue_sl_tx object\n");
+    exit(-1);
+  }
+  if (srslte_ue_sl_tx_set_cell(&ue_sl_tx, cell)) {
+    fprintf(stderr, "Error setting cell for ue_sl_tx object\n");
+    exit(-1);
+  }
+
+  for (uint32_t dfn = 0; dfn < nof_dfn; dfn++) {
+    uint32_t dsfn = dfn % 10;
+
+    gettimeofday(&t[1], NULL);
+    sync_sf_reference(&ue_sl_tx, dfn, dsfn);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    time_ref += t[0].tv_sec * 1000000 + t[0].tv_usec;
+    memcpy(reference, out_buffer, sizeof(cf_t) * sf_len);
+
+    // the reference leaves its REs in the grid, ue_sl_tx expects an empty one
+    bzero(ue_sl_tx.sf_symbols, sizeof(cf_t) * SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp));
+
+    gettimeofday(&t[1], NULL);
+    if (srslte_ue_sl_tx_sync_sf(&ue_sl_tx, dfn, dsfn)) {
+      fprintf(stderr, "Error generating sync subframe\n");
+      goto clean_exit;
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    time_cache += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+    for (uint32_t i = 0; i < sf_len; i++) {
+      float err = cabsf(out_buffer[i] - reference[i]);
+      if (err > max_err) {
+        max_err = err;
+      }
+    }
+
+    for (uint32_t i = 0; i < SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp); i++) {
+      if (ue_sl_tx.sf_symbols[i] != 0.0f) {
+        fprintf(stderr, "RE %d of the grid was not cleared\n", i);
+        goto clean_exit;
+      }
+    }
+  }
+
+  printf("nof_prb=%d, %d DFNs: full %.1f us/sf, cached %.1f us/sf, max error %.2e\n",
+         cell.nof_prb,
+         nof_dfn,
+         (float) time_ref / nof_dfn,
+         (float) time_cache / nof_dfn,
+         max_err);
+
+  ret = (max_err < 1e-3) ? SRSLTE_SUCCESS : SRSLTE_ERROR;
+  printf("%s\n", ret == SRSLTE_SUCCESS ? "OK" : "Error");
+
+clean_exit:
+  srslte_ue_sl_tx_free(&ue_sl_tx);
+  free(out_buffer);
+  free(reference);
+  exit(ret);
+}
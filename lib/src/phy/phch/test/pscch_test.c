@@ -209,6 +209,40 @@ int main(int argc, char **argv) {
 
   }
 
+
+  // DMRS correlation pre-filter of the blind decoding, only the occupied PRB pair must pass
+  srslte_chest_sl_t chest;
+  if (srslte_chest_sl_init(&chest, cell.nof_prb) || srslte_chest_sl_set_cell(&chest, cell)) {
+    fprintf(stderr, "Error creating channel estimator\n");
+    exit(-1);
+  }
+
+  uint32_t nof_candidates = cell.nof_prb/2;
+  uint32_t candidate_prb[nof_candidates];
+  float corr[nof_candidates];
+  for (i=0;i<nof_candidates;i++) {
+    candidate_prb[i] = 2*i;
+  }
+
+  for (int occupied=0; occupied<nof_candidates; occupied++) {
+    bzero(subframe_symbols[0], sizeof(cf_t) * nof_re);
+    srslte_refsignal_sl_dmrs_psxch_put(&chest.dmrs_signal, SRSLTE_SL_MODE_4, candidate_prb[occupied], 2,
+                                       chest.pscch_known_signal, subframe_symbols[0]);
+    // 10 dB SNR on the occupied PRB pair, noise only elsewhere
+    srslte_ch_awgn_c(subframe_symbols[0], subframe_symbols[0], sqrtf(0.05), nof_re);
+
+    srslte_chest_sl_pscch_dmrs_corr(&chest, subframe_symbols[0], SRSLTE_SL_MODE_4, candidate_prb, nof_candidates, corr);
+
+    for (i=0;i<nof_candidates;i++) {
+      if ((i == occupied) != (corr[i] > 0.5)) {
+        printf("Error DMRS correlation %f for prb %d, occupied prb %d\n", corr[i], candidate_prb[i], candidate_prb[occupied]);
+        exit(-1);
+      }
+    }
+    printf("OK DMRS correlation %f for occupied prb %d\n", corr[occupied], candidate_prb[occupied]);
+  }
+
+  srslte_chest_sl_free(&chest);
   
   // srslte_psbch_free(&psbch);
   srslte_pscch_free(&pscch);
@@ -0,0 +1,198 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+
+/*
+ * Measures the PSSCH decoding time per transport block. With -x a new n_X_ID is
+ * used for every transport block, so that no scrambling sequence can be reused.
+ */
+
+srslte_cell_t cell = {
+  50,            // nof_prb
+  1,            // nof_ports
+  1,            // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1,          // PHICH resources      
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t nof_prb = 10;
+uint32_t mcs_idx = 10;
+uint32_t nof_tb = 1000;
+bool new_n_X_ID = false;
+
+void usage(char *prog) {
+  printf("Usage: %s [lmnx]\n", prog);
+  printf("\t-l number of PSSCH PRB [Default %d]\n", nof_prb);
+  printf("\t-m MCS index [Default %d]\n", mcs_idx);
+  printf("\t-n number of transport blocks [Default %d]\n", nof_tb);
+  printf("\t-x use a new n_X_ID for every transport block [Default %s]\n", new_n_X_ID ? "yes" : "no");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "lmnx")) != -1) {
+    switch(opt) {
+    case 'l':
+      nof_prb = atoi(argv[optind]);
+      break;
+    case 'm':
+      mcs_idx = atoi(argv[optind]);
+      break;
+    case 'n':
+      nof_tb = atoi(argv[optind]);
+      break;
+    case 'x':
+      new_n_X_ID = true;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  srslte_pssch_t pssch_tx;
+  srslte_pssch_t pssch_rx;
+  srslte_softbuffer_tx_t softbuffer_tx;
+  srslte_softbuffer_rx_t softbuffer_rx;
+  srslte_softbuffer_tx_t *softbuffers_tx[SRSLTE_MAX_CODEWORDS] = {&softbuffer_tx};
+  srslte_softbuffer_rx_t *softbuffers_rx[SRSLTE_MAX_CODEWORDS] = {&softbuffer_rx};
+  cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
+  cf_t *subframe_symbols[SRSLTE_MAX_PORTS];
+  uint8_t *data_tx[SRSLTE_MAX_CODEWORDS];
+  uint8_t *data_rx[SRSLTE_MAX_CODEWORDS];
+  srslte_ra_sl_sci_t sci;
+  int ret = 0;
+
+  parse_args(argc,argv);
+
+  if (nof_prb == 0 || nof_prb > cell.nof_prb) {
+    usage(argv[0]);
+    exit(-1);
+  }
+
+  uint32_t nof_re = 2*SRSLTE_SLOT_LEN_RE(cell.nof_prb, SRSLTE_CP_NORM);
+
+  subframe_symbols[0] = srslte_vec_malloc(sizeof(cf_t) * nof_re);
+  ce[0][0] = srslte_vec_malloc(sizeof(cf_t) * nof_re);
+  if (!subframe_symbols[0] || !ce[0][0]) {
+    perror("malloc");
+    exit(-1);
+  }
+  for (int i=0;i<nof_re;i++) {
+    ce[0][0][i] = 1;
+  }
+
+  bzero(&sci, sizeof(srslte_ra_sl_sci_t));
+  sci.mcs.idx = mcs_idx;
+  sci.frl_L_subCH = 1;
+  if (srslte_sl_fill_ra_mcs(&sci.mcs, nof_prb) < 0) {
+    exit(-1);
+  }
+
+  // add additional memory for tb crc
+  data_tx[0] = srslte_vec_malloc(sci.mcs.tbs/8 + 3);
+  data_rx[0] = srslte_vec_malloc(sci.mcs.tbs/8 + 3);
+
+  // transmitter and receiver use their own objects, as they do in the UE
+  if (srslte_pssch_init_ue(&pssch_tx, cell.nof_prb, cell.nof_ports) ||
+      srslte_pssch_set_cell(&pssch_tx, cell) ||
+      srslte_pssch_init_ue(&pssch_rx, cell.nof_prb, cell.nof_ports) ||
+      srslte_pssch_set_cell(&pssch_rx, cell)) {
+    fprintf(stderr, "Error creating PSSCH object\n");
+    exit(-1);
+  }
+
+  if (srslte_softbuffer_tx_init(&softbuffer_tx, cell.nof_prb) ||
+      srslte_softbuffer_rx_init(&softbuffer_rx, cell.nof_prb)) {
+    fprintf(stderr, "Error initiating soft buffer\n");
+    exit(-1);
+  }
+
+  srand(0);
+
+  for (int i=0; i<sci.mcs.tbs/8; i++) {
+    data_tx[0][i] = rand();
+  }
+
+  struct timeval t[3];
+  double usec_decode = 0;
+  uint32_t errors = 0;
+
+  for (uint32_t n=0; n<nof_tb; n++) {
+
+    // under SPS the same allocation is received every reservation period
+    pssch_tx.n_PSSCH_ssf = pssch_rx.n_PSSCH_ssf = 0;
+    pssch_tx.n_X_ID = pssch_rx.n_X_ID = new_n_X_ID ? n : 0x1234;
+
+    srslte_softbuffer_tx_reset_tbs(&softbuffer_tx, (uint32_t) sci.mcs.tbs);
+    if (srslte_pssch_encode_simple(&pssch_tx, &sci, softbuffers_tx, subframe_symbols, 0, nof_prb, data_tx)) {
+      fprintf(stderr, "Error encoding PSSCH\n");
+      exit(-1);
+    }
+
+    srslte_softbuffer_rx_reset_tbs(&softbuffer_rx, (uint32_t) sci.mcs.tbs);
+
+    gettimeofday(&t[1], NULL);
+    int decode_ret = srslte_pssch_decode_simple(&pssch_rx, &sci, NULL, softbuffers_rx, subframe_symbols, ce,
+                                                0, 0, nof_prb, data_rx);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec_decode += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+    if (decode_ret != SRSLTE_SUCCESS || memcmp(data_tx[0], data_rx[0], sci.mcs.tbs/8)) {
+      errors++;
+    }
+  }
+
+  printf("nof_prb=%d mcs=%d tbs=%d new_n_X_ID=%s\n", nof_prb, sci.mcs.idx, sci.mcs.tbs, new_n_X_ID ? "yes" : "no");
+  printf("decode: %.1f us/TB\n", usec_decode / nof_tb);
+  printf("decoder cache: %d hits %d misses\n", pssch_rx.cache_hits, pssch_rx.cache_misses);
+  printf("errors: %d/%d\n", errors, nof_tb);
+
+  if (errors) {
+    ret = -1;
+  }
+
+  srslte_pssch_free(&pssch_tx);
+  srslte_pssch_free(&pssch_rx);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  free(data_tx[0]);
+  free(data_rx[0]);
+  free(subframe_symbols[0]);
+  free(ce[0][0]);
+
+  exit(ret);
+}
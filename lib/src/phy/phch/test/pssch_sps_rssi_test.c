@@ -0,0 +1,133 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+
+/*
+ * Compares the single pass S-RSSI measurement against copying the PSSCH
+ * symbols of the pool and of each subchannel and averaging their power.
+ */
+
+srslte_cell_t cell = {
+  50,            // nof_prb
+  1,            // nof_ports
+  1,            // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1,          // PHICH resources      
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t subch_size = 10;
+uint32_t start_prb = 0;
+
+void usage(char *prog) {
+  printf("Usage: %s [nso]\n", prog);
+  printf("\t-n cell.nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-s subchannel size in PRB [Default %d]\n", subch_size);
+  printf("\t-o first PRB of the pool [Default %d]\n", start_prb);
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "nso")) != -1) {
+    switch(opt) {
+    case 'n':
+      cell.nof_prb = atoi(argv[optind]);
+      break;
+    case 's':
+      subch_size = atoi(argv[optind]);
+      break;
+    case 'o':
+      start_prb = atoi(argv[optind]);
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+static bool close_enough(float a, float b) {
+  return fabsf(a - b) <= 1e-4 * fabsf(b);
+}
+
+int main(int argc, char **argv) {
+  int ret = 0;
+
+  parse_args(argc,argv);
+
+  uint32_t nof_subch = (cell.nof_prb - start_prb) / subch_size;
+  uint32_t nof_re = 2*SRSLTE_SLOT_LEN_RE(cell.nof_prb, SRSLTE_CP_NORM);
+
+  if (nof_subch == 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+
+  cf_t *sf_symbols = srslte_vec_malloc(sizeof(cf_t) * nof_re);
+  cf_t *tmp = srslte_vec_malloc(sizeof(cf_t) * nof_re);
+  float *subch_rssi = srslte_vec_malloc(sizeof(float) * nof_subch);
+
+  srand(0);
+
+  // give every subchannel and symbol a different power level
+  for (int i=0; i<nof_re; i++) {
+    float scale = 1 + (i / SRSLTE_NRE) % 7 + (i / (cell.nof_prb * SRSLTE_NRE));
+    sf_symbols[i] = scale * ((float) rand() / RAND_MAX - 0.5f + I * ((float) rand() / RAND_MAX - 0.5f));
+  }
+
+  float rssi = srslte_pssch_sps_rssi(sf_symbols, cell, start_prb, subch_size, nof_subch, subch_rssi);
+
+  int n = srslte_pssch_get_for_sps_rssi(sf_symbols, tmp, cell, start_prb, nof_subch * subch_size);
+  float gold = srslte_vec_avg_power_cf(tmp, n);
+
+  printf("pool: %f (expected %f)\n", rssi, gold);
+  if (!close_enough(rssi, gold)) {
+    ret = -1;
+  }
+
+  for (uint32_t s=0; s<nof_subch; s++) {
+    n = srslte_pssch_get_for_sps_rssi(sf_symbols, tmp, cell, start_prb + s * subch_size, subch_size);
+    gold = srslte_vec_avg_power_cf(tmp, n);
+
+    printf("subchannel %2d: %f (expected %f)\n", s, subch_rssi[s], gold);
+    if (!close_enough(subch_rssi[s], gold)) {
+      ret = -1;
+    }
+  }
+
+  free(sf_symbols);
+  free(tmp);
+  free(subch_rssi);
+
+  printf("%s\n", ret ? "Error" : "Ok");
+  exit(ret);
+}
@@ -0,0 +1,191 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+#include "srslte/phy/ue_sl/ue_sl_tx.h"
+
+/*
+ * Measures the cost of modulating a PSCCH/PSSCH subframe as a function of the
+ * number of allocated subchannels. The full-grid path (clear, iFFT, CFO and
+ * normalization as separate passes) is compared against
+ * srslte_ue_sl_tx_modulate(), which must produce the same samples.
+ */
+
+srslte_cell_t cell = {
+  50,            // nof_prb
+  1,            // nof_ports
+  1,            // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1,          // PHICH resources
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t subchannel_size = 10;
+uint32_t nof_sf = 200;
+float cfo_hz = 300;
+
+void usage(char *prog) {
+  printf("Usage: %s [nstf]\n", prog);
+  printf("\t-n cell.nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-s subchannel size in PRB [Default %d]\n", subchannel_size);
+  printf("\t-t number of subframes per allocation [Default %d]\n", nof_sf);
+  printf("\t-f CFO in Hz [Default %.0f]\n", cfo_hz);
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "nstf")) != -1) {
+    switch(opt) {
+    case 'n':
+      cell.nof_prb = atoi(argv[optind]);
+      break;
+    case 's':
+      subchannel_size = atoi(argv[optind]);
+      break;
+    case 't':
+      nof_sf = atoi(argv[optind]);
+      break;
+    case 'f':
+      cfo_hz = atof(argv[optind]);
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+// writes the allocated REs as the channel encoders would
+static void put_allocation(cf_t *grid, cf_t *data, uint32_t prb_start, uint32_t nof_prb)
+{
+  uint32_t nof_re = cell.nof_prb * SRSLTE_NRE;
+  for (uint32_t l = 0; l < 2 * SRSLTE_CP_NSYMB(cell.cp) - 1; l++) {
+    memcpy(&grid[l * nof_re + prb_start * SRSLTE_NRE],
+           &data[l * nof_re + prb_start * SRSLTE_NRE],
+           sizeof(cf_t) * nof_prb * SRSLTE_NRE);
+  }
+}
+
+int main(int argc, char **argv) {
+  srslte_ue_sl_tx_t ue_sl_tx;
+  struct timeval t[3];
+  int ret = SRSLTE_SUCCESS;
+
+  parse_args(argc, argv);
+
+  uint32_t sf_len    = SRSLTE_SF_LEN_PRB(cell.nof_prb);
+  uint32_t nof_re_sf = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp);
+  float    cfo       = cfo_hz / (15000.0f * srslte_symbol_sz(cell.nof_prb));
+
+  cf_t *out_buffer = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  cf_t *reference  = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  cf_t *data       = srslte_vec_malloc(sizeof(cf_t) * nof_re_sf);
+  if (!out_buffer || !reference || !data) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  for (uint32_t i = 0; i < nof_re_sf; i++) {
+    data[i] = ((rand() % 2) ? M_SQRT1_2 : -M_SQRT1_2) + _Complex_I * ((rand() % 2) ? M_SQRT1_2 : -M_SQRT1_2);
+  }
+
+  if (srslte_ue_sl_tx_init(&ue_sl_tx, out_buffer, cell.nof_prb)) {
+    fprintf(stderr, "Error initiating ue_sl_tx object\n");
+    exit(-1);
+  }
+  if (srslte_ue_sl_tx_set_cell(&ue_sl_tx, cell)) {
+    fprintf(stderr, "Error setting cell for ue_sl_tx object\n");
+    exit(-1);
+  }
+  srslte_ue_sl_tx_set_cfo_enable(&ue_sl_tx, true);
+
+  printf("nof_prb=%d, subchannel=%d PRB, cfo=%.0f Hz\n", cell.nof_prb, subchannel_size, cfo_hz);
+  printf("subch   prb   full_us   sparse_us   speedup   max_err\n");
+
+  for (uint32_t L = 1; L * subchannel_size <= cell.nof_prb; L++) {
+    uint32_t nof_prb   = L * subchannel_size;
+    uint64_t time_full = 0, time_sparse = 0;
+    float    max_err   = 0;
+
+    for (uint32_t sf = 0; sf < nof_sf; sf++) {
+      uint32_t prb_start = (sf * subchannel_size) % (cell.nof_prb - nof_prb + 1);
+
+      gettimeofday(&t[1], NULL);
+      bzero(ue_sl_tx.sf_symbols, sizeof(cf_t) * nof_re_sf);
+      put_allocation(ue_sl_tx.sf_symbols, data, prb_start, nof_prb);
+      srslte_ofdm_tx_sf(&ue_sl_tx.fft);
+      srslte_cfo_correct(&ue_sl_tx.cfo, out_buffer, out_buffer, cfo);
+      srslte_ue_sl_tx_apply_norm(&ue_sl_tx, nof_prb);
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      time_full += t[0].tv_sec * 1000000 + t[0].tv_usec;
+      memcpy(reference, out_buffer, sizeof(cf_t) * sf_len);
+
+      // the full-grid path leaves its REs in the grid
+      bzero(ue_sl_tx.sf_symbols, sizeof(cf_t) * nof_re_sf);
+
+      gettimeofday(&t[1], NULL);
+      put_allocation(ue_sl_tx.sf_symbols, data, prb_start, nof_prb);
+      srslte_ue_sl_tx_modulate(&ue_sl_tx, prb_start, nof_prb, cfo);
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      time_sparse += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+      for (uint32_t i = 0; i < sf_len; i++) {
+        float err = cabsf(out_buffer[i] - reference[i]);
+        if (err > max_err) {
+          max_err = err;
+        }
+      }
+    }
+
+    printf("%5d %5d %9.1f %11.1f %8.2fx %9.2e\n",
+           L,
+           nof_prb,
+           (float) time_full / nof_sf,
+           (float) time_sparse / nof_sf,
+           time_sparse ? (float) time_full / time_sparse : 0.0f,
+           max_err);
+
+    if (max_err > 1e-3) {
+      ret = SRSLTE_ERROR;
+    }
+  }
+
+  printf("%s\n", ret == SRSLTE_SUCCESS ? "OK" : "Error");
+
+  srslte_ue_sl_tx_free(&ue_sl_tx);
+  free(out_buffer);
+  free(reference);
+  free(data);
+  exit(ret);
+}
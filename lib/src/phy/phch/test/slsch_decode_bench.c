@@ -0,0 +1,217 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/phy/channel/ch_awgn.h"
+#include "srslte/srslte.h"
+
+/*
+ * Measures the SL-SCH decoding time per transport block over the number of
+ * PSSCH PRBs, i.e. the TBS, and the number of decoder pool threads, which
+ * decode code blocks next to the calling thread. With 0 threads the code blocks
+ * are decoded one after another on the calling thread.
+ */
+
+uint32_t max_prb     = 50;
+uint32_t mcs_idx     = 20;
+uint32_t max_threads = 4;
+uint32_t nof_tb      = 100;
+float    snr_db      = 4.0;
+
+void usage(char *prog) {
+  printf("Usage: %s [pmtns]\n", prog);
+  printf("\t-p largest number of PSSCH PRB, swept in steps of 10 [Default %d]\n", max_prb);
+  printf("\t-m MCS index [Default %d]\n", mcs_idx);
+  printf("\t-t largest number of decoder threads, swept from 0 [Default %d]\n", max_threads);
+  printf("\t-n number of transport blocks per measurement [Default %d]\n", nof_tb);
+  printf("\t-s SNR of the soft bits in dB [Default %.1f]\n", snr_db);
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "pmtns")) != -1) {
+    switch(opt) {
+    case 'p':
+      max_prb = atoi(argv[optind]);
+      break;
+    case 'm':
+      mcs_idx = atoi(argv[optind]);
+      break;
+    case 't':
+      max_threads = atoi(argv[optind]);
+      break;
+    case 'n':
+      nof_tb = atoi(argv[optind]);
+      break;
+    case 's':
+      snr_db = atof(argv[optind]);
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  srslte_sch_t sch_tx;
+  srslte_sch_t sch_rx;
+  srslte_softbuffer_tx_t softbuffer_tx;
+  srslte_softbuffer_rx_t softbuffer_rx;
+  int ret = 0;
+
+  parse_args(argc, argv);
+
+  if (max_prb == 0 || max_prb > SRSLTE_MAX_PRB) {
+    usage(argv[0]);
+    exit(-1);
+  }
+
+  srslte_ra_sl_sci_t sci;
+  bzero(&sci, sizeof(srslte_ra_sl_sci_t));
+  sci.mcs.idx = mcs_idx;
+  if (srslte_sl_fill_ra_mcs(&sci.mcs, max_prb) < 0) {
+    exit(-1);
+  }
+  uint32_t max_tbs = sci.mcs.tbs;
+
+  // the PSSCH has 10 data symbols per subframe, with 16QAM at most
+  uint32_t max_E   = 10 * max_prb * SRSLTE_NRE * 4;
+  uint8_t *e_bits  = srslte_vec_malloc(max_E / 8 + 1);
+  uint8_t *bits    = srslte_vec_malloc(max_E);
+  float   *llr_f   = srslte_vec_malloc(sizeof(float) * max_E);
+  int16_t *llr     = srslte_vec_malloc(sizeof(int16_t) * max_E);
+  // the decoder writes the CRC of the last code block behind the TB CRC
+  uint8_t *data_tx = srslte_vec_malloc(max_tbs / 8 + 3);
+  uint8_t *data_rx = srslte_vec_malloc(max_tbs / 8 + 6);
+  if (!e_bits || !bits || !llr_f || !llr || !data_tx || !data_rx) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  if (srslte_sch_init(&sch_tx) || srslte_sch_init(&sch_rx) ||
+      srslte_softbuffer_tx_init(&softbuffer_tx, max_prb) ||
+      srslte_softbuffer_rx_init(&softbuffer_rx, max_prb)) {
+    fprintf(stderr, "Error initiating SL-SCH\n");
+    exit(-1);
+  }
+  srslte_sch_set_max_noi(&sch_rx, 8);
+
+  srand(0);
+  for (int i = 0; i < max_tbs / 8; i++) {
+    data_tx[i] = rand();
+  }
+
+  printf("%8s %6s %3s %8s %10s %8s %8s %7s\n", "nof_prb", "tbs", "C", "threads", "us/TB", "speedup", "iters", "errors");
+
+  for (uint32_t nof_prb = max_prb % 10 ? max_prb % 10 : 10; nof_prb <= max_prb; nof_prb += 10) {
+    if (srslte_sl_fill_ra_mcs(&sci.mcs, nof_prb) < 0) {
+      exit(-1);
+    }
+
+    srslte_cbsegm_t cb_segm;
+    srslte_cbsegm(&cb_segm, sci.mcs.tbs);
+
+    uint32_t E = 10 * nof_prb * SRSLTE_NRE * srslte_mod_bits_x_symbol(sci.mcs.mod);
+
+    srslte_softbuffer_tx_reset_tbs(&softbuffer_tx, (uint32_t) sci.mcs.tbs);
+    if (srslte_slsch_encode(&sch_tx, &sci, &softbuffer_tx, data_tx, e_bits, E)) {
+      fprintf(stderr, "Error encoding SL-SCH\n");
+      exit(-1);
+    }
+
+    // BPSK soft bits with noise, positive for a one
+    srslte_bit_unpack_vector(e_bits, bits, E);
+    for (uint32_t i = 0; i < E; i++) {
+      llr_f[i] = bits[i] ? 1.0f : -1.0f;
+    }
+    srslte_ch_awgn_f(llr_f, llr_f, powf(10.0f, -snr_db / 10.0f), E);
+    srslte_vec_convert_fi(llr_f, 1000.0f, llr, E);
+
+    double serial_us = 0;
+    for (uint32_t nof_threads = 0; nof_threads <= max_threads; nof_threads++) {
+      // the calling thread decodes code blocks as well
+      srslte_tdec_pool_t pool;
+      if (nof_threads > 0 && srslte_tdec_pool_init(&pool, nof_threads)) {
+        fprintf(stderr, "Error creating decoder pool\n");
+        exit(-1);
+      }
+      srslte_sch_set_tdec_pool(&sch_rx, nof_threads ? &pool : NULL);
+
+      struct timeval t[3];
+      double usec_decode = 0;
+      float iterations = 0;
+      uint32_t errors = 0;
+
+      for (uint32_t n = 0; n < nof_tb; n++) {
+        srslte_softbuffer_rx_reset_tbs(&softbuffer_rx, (uint32_t) sci.mcs.tbs);
+
+        gettimeofday(&t[1], NULL);
+        int decode_ret = srslte_slsch_decode(&sch_rx, &sci, &softbuffer_rx, llr, E, data_rx, 0);
+        gettimeofday(&t[2], NULL);
+        get_time_interval(t);
+        usec_decode += t[0].tv_sec * 1e6 + t[0].tv_usec;
+        iterations += srslte_sch_last_noi(&sch_rx);
+
+        if (decode_ret != SRSLTE_SUCCESS || memcmp(data_tx, data_rx, sci.mcs.tbs / 8)) {
+          errors++;
+        }
+      }
+      usec_decode /= nof_tb;
+      if (nof_threads == 0) {
+        serial_us = usec_decode;
+      }
+
+      printf("%8d %6d %3d %8d %10.1f %8.2f %8.2f %7d\n", nof_prb, sci.mcs.tbs, cb_segm.C, nof_threads, usec_decode,
+             serial_us / usec_decode, iterations / nof_tb, errors);
+
+      if (errors) {
+        ret = -1;
+      }
+      if (nof_threads > 0) {
+        srslte_tdec_pool_free(&pool);
+      }
+    }
+  }
+
+  srslte_sch_free(&sch_tx);
+  srslte_sch_free(&sch_rx);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  free(e_bits);
+  free(bits);
+  free(llr_f);
+  free(llr);
+  free(data_tx);
+  free(data_rx);
+
+  exit(ret);
+}
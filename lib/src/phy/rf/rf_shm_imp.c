@@ -0,0 +1,905 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+
+/*
+ * Shared memory RF backend for running several nodes against each other on one
+ * host. All nodes of a bus map the same segment. Every node owns one ring with
+ * its transmitted baseband at the base rate, indexed by the sample timestamp
+ * modulo the ring length, and only that node writes it. A receiving node mixes
+ * the rings of the nodes it subscribes to straight into the caller's buffer.
+ *
+ * There are no locks and no copies between the nodes on the data path, only
+ * the cursors of each node which are accessed atomically: a reader waits until
+ * the writers have published the samples it is about to read, a writer waits
+ * until the slowest reader can no longer be overrun. Each node fills its own
+ * stream with zeros up to the end of the block it is receiving, so all nodes
+ * advance in lockstep without anybody transmitting continuously.
+ *
+ * Device arguments:
+ *   bus=<name>       name of the bus, all nodes of a bus share /dev/shm/srslte_shm_<name> (required)
+ *   node=<0..15>     ring of this node, the first free one if not given
+ *   rx_nodes=<a:b:c> nodes to receive from, all others if not given
+ *   tx=0             do not transmit
+ *   base_srate=<Hz>  rate of the rings, must be the same for all nodes of a bus
+ *   id=<name>        name in log messages
+ */
+
+#include "rf_shm_imp.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <srslte/phy/common/phy_common.h>
+#include <srslte/phy/common/timestamp.h>
+#include <srslte/phy/utils/vector.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHM_MAGIC 0x53484d31 // "SHM1"
+#define SHM_RING_MS 20
+#define SHM_TIMEOUT_MS 1000
+#define SHM_SPIN_POLLS 64
+#define SHM_SLEEP_US 20
+#define SHM_MAX_BUFFER_SAMPLES (5 * SRSLTE_SF_LEN_MAX) // Five subframes at max LTE rate using default FFT-length
+
+#define SHM_LOAD(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#define SHM_STORE(X, V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+
+// Cursors of one node, one cache line each so that nodes do not share lines
+typedef struct {
+  uint64_t write_ts; // samples before this timestamp are in the ring of the node
+  uint64_t read_ts;  // next timestamp the node is going to receive
+  uint64_t start_ts; // the node joined the bus at this timestamp, its ring is empty before
+  uint32_t tx_active;
+  uint32_t rx_active;
+  uint8_t  padding[32];
+} rf_shm_node_t;
+
+typedef struct {
+  uint32_t      magic;    // written last by the node creating the bus
+  uint32_t      lock;     // only taken while nodes join or leave
+  uint32_t      unlinked; // the last node left and removed the segment
+  uint32_t      ring_len; // samples per ring
+  double        base_srate;
+  uint8_t       padding[40];
+  rf_shm_node_t node[SHM_MAX_NODES];
+} rf_shm_bus_t;
+
+typedef struct {
+  // Common attributes
+  srslte_rf_info_t info;
+  char             id[PARAM_LEN_SHORT];
+  char             shm_name[PARAM_LEN];
+
+  // RF State
+  double   srate; // radio rate configured by upper layers
+  double   base_srate;
+  uint32_t decim_factor; // decimation factor between base_srate used on transport on radio's rate
+  double   rx_gain;
+  double   tx_freq;
+  double   rx_freq;
+
+  // Bus
+  rf_shm_bus_t* bus;
+  size_t        bus_len;
+  cf_t*         rings;
+  uint32_t      ring_len;
+  uint32_t      node;
+  bool          joined;
+  bool          tx_enabled;
+  bool          subscribed[SHM_MAX_NODES];
+
+  // Rx and Tx timestamps, the published cursors of this node follow them
+  uint64_t next_rx_ts;
+  uint64_t next_tx_ts;
+
+  // Rate conversion buffers
+  cf_t* buffer_decimation;
+  cf_t* buffer_tx;
+} rf_shm_handler_t;
+
+const char shm_devname[4] = "shm";
+
+/*
+ * Static methods
+ */
+
+static void rf_shm_error(rf_shm_handler_t* handler, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "[shm] %s: ", handler->id);
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
+
+static void bus_lock(rf_shm_bus_t* bus)
+{
+  uint32_t unlocked = 0;
+  while (!__atomic_compare_exchange_n(&bus->lock, &unlocked, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+    unlocked = 0;
+    sched_yield();
+  }
+}
+
+static void bus_unlock(rf_shm_bus_t* bus)
+{
+  SHM_STORE(bus->lock, 0);
+}
+
+typedef struct {
+  uint32_t        polls;
+  struct timespec start;
+} shm_wait_t;
+
+// Spins for a short while, then sleeps between the polls. Returns false once
+// the wait took longer than SHM_TIMEOUT_MS.
+static bool shm_wait(shm_wait_t* w)
+{
+  if (w->polls++ < SHM_SPIN_POLLS) {
+    sched_yield();
+    return true;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (w->polls == SHM_SPIN_POLLS + 1) {
+    w->start = now;
+  }
+  usleep(SHM_SLEEP_US);
+
+  return (now.tv_sec - w->start.tv_sec) * 1000 + (now.tv_nsec - w->start.tv_nsec) / 1000000 < SHM_TIMEOUT_MS;
+}
+
+static inline cf_t* node_ring(rf_shm_handler_t* handler, uint32_t node)
+{
+  return handler->rings + (size_t)node * handler->ring_len;
+}
+
+// Writes nsamples (zeros if samples is NULL) at timestamp ts into the own ring
+// and publishes them. Waits for readers which would be overrun, a reader which
+// does not move for SHM_TIMEOUT_MS is considered dead and is ignored from then on.
+static void shm_write(rf_shm_handler_t* handler, const cf_t* samples, uint64_t ts, uint32_t nsamples)
+{
+  rf_shm_bus_t* bus = handler->bus;
+  uint64_t      end = ts + nsamples;
+
+  for (uint32_t i = 0; i < SHM_MAX_NODES; i++) {
+    if (i == handler->node) {
+      continue;
+    }
+    shm_wait_t w = {};
+    while (SHM_LOAD(bus->node[i].rx_active) && (int64_t)(end - SHM_LOAD(bus->node[i].read_ts)) > handler->ring_len) {
+      if (!shm_wait(&w)) {
+        rf_shm_error(handler, "node %d stopped receiving, ignoring it\n", i);
+        SHM_STORE(bus->node[i].rx_active, 0);
+      }
+    }
+  }
+
+  cf_t*    ring  = node_ring(handler, handler->node);
+  uint32_t idx   = (uint32_t)(ts % handler->ring_len);
+  uint32_t first = SRSLTE_MIN(nsamples, handler->ring_len - idx);
+  if (samples) {
+    memcpy(&ring[idx], samples, sizeof(cf_t) * first);
+    memcpy(ring, &samples[first], sizeof(cf_t) * (nsamples - first));
+  } else {
+    bzero(&ring[idx], sizeof(cf_t) * first);
+    bzero(ring, sizeof(cf_t) * (nsamples - first));
+  }
+
+  handler->next_tx_ts = end;
+  SHM_STORE(bus->node[handler->node].write_ts, end);
+}
+
+// Adds (or copies if it is the first contribution) the samples node sent in [ts, ts + nsamples) to output
+static void shm_mix(rf_shm_handler_t* handler, uint32_t node, cf_t* output, uint64_t ts, uint32_t nsamples, bool first)
+{
+  rf_shm_node_t* n   = &handler->bus->node[node];
+  uint64_t       end = ts + nsamples;
+
+  // Wait for the writer unless it left the bus
+  shm_wait_t w = {};
+  while (SHM_LOAD(n->tx_active) && SHM_LOAD(n->write_ts) < end) {
+    if (!shm_wait(&w)) {
+      rf_shm_error(handler, "node %d stopped transmitting, ignoring it\n", node);
+      SHM_STORE(n->tx_active, 0);
+    }
+  }
+
+  // Only [begin, stop) is in the ring, the rest is silence
+  uint64_t write_ts = SHM_LOAD(n->write_ts);
+  uint64_t begin    = SRSLTE_MAX(ts, SHM_LOAD(n->start_ts));
+  uint64_t stop     = SRSLTE_MIN(end, write_ts);
+  if (write_ts > handler->ring_len && begin < write_ts - handler->ring_len) {
+    rf_shm_error(handler, "samples of node %d were overwritten before they were read\n", node);
+    begin = write_ts - handler->ring_len;
+  }
+
+  if (first) {
+    bzero(output, sizeof(cf_t) * nsamples);
+  }
+
+  cf_t* ring = node_ring(handler, node);
+  while (begin < stop) {
+    uint32_t idx = (uint32_t)(begin % handler->ring_len);
+    uint32_t len = (uint32_t)SRSLTE_MIN(stop - begin, handler->ring_len - idx);
+    cf_t*    dst = &output[begin - ts];
+    if (first) {
+      memcpy(dst, &ring[idx], sizeof(cf_t) * len);
+    } else {
+      srslte_vec_sum_ccc(dst, &ring[idx], dst, len);
+    }
+    begin += len;
+  }
+}
+
+// Copies the value of key to value (PARAM_LEN bytes) and removes key and value from args
+static bool parse_arg(char* args, const char* key, char* value)
+{
+  char* ptr = strstr(args, key);
+  if (!ptr) {
+    return false;
+  }
+
+  size_t len = strcspn(ptr + strlen(key), ",");
+  if (len >= PARAM_LEN) {
+    len = PARAM_LEN - 1;
+  }
+  memcpy(value, ptr + strlen(key), len);
+  value[len] = '\0';
+
+  // remove the argument together with one of its separating commas
+  char* end = ptr + strlen(key) + strcspn(ptr + strlen(key), ",");
+  if (*end == ',') {
+    end++;
+  } else if (ptr > args && ptr[-1] == ',') {
+    ptr--;
+  }
+  memmove(ptr, end, strlen(end) + 1);
+
+  return true;
+}
+
+static int parse_nodes(rf_shm_handler_t* handler, char* str)
+{
+  bzero(handler->subscribed, sizeof(handler->subscribed));
+
+  char* saveptr = NULL;
+  for (char* tok = strtok_r(str, ":", &saveptr); tok; tok = strtok_r(NULL, ":", &saveptr)) {
+    long node = strtol(tok, NULL, 10);
+    if (node < 0 || node >= SHM_MAX_NODES) {
+      rf_shm_error(handler, "invalid node %s in rx_nodes\n", tok);
+      return SRSLTE_ERROR;
+    }
+    handler->subscribed[node] = true;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+// Maps the segment of the bus, creating it if this is the first node
+static int shm_map(rf_shm_handler_t* handler)
+{
+  uint32_t ring_len = (uint32_t)(handler->base_srate * SHM_RING_MS / 1000);
+  size_t   bus_len  = sizeof(rf_shm_bus_t) + (size_t)SHM_MAX_NODES * ring_len * sizeof(cf_t);
+
+  for (;;) {
+    bool creator = true;
+    int  fd      = shm_open(handler->shm_name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0 && errno == EEXIST) {
+      creator = false;
+      fd      = shm_open(handler->shm_name, O_RDWR, 0666);
+      if (fd < 0 && errno == ENOENT) {
+        // removed by the last node leaving in between
+        continue;
+      }
+    }
+    if (fd < 0) {
+      rf_shm_error(handler, "opening %s: %s\n", handler->shm_name, strerror(errno));
+      return SRSLTE_ERROR;
+    }
+
+    if (creator) {
+      if (ftruncate(fd, bus_len)) {
+        rf_shm_error(handler, "resizing %s: %s\n", handler->shm_name, strerror(errno));
+        close(fd);
+        shm_unlink(handler->shm_name);
+        return SRSLTE_ERROR;
+      }
+    } else {
+      // the creator might not have resized the segment yet
+      struct stat st = {};
+      shm_wait_t  w  = {};
+      while (!fstat(fd, &st) && st.st_size == 0 && shm_wait(&w)) {
+      }
+      if ((size_t)st.st_size != bus_len) {
+        rf_shm_error(handler, "%s has %ld B instead of %ld B, all nodes must use the same base_srate\n",
+                     handler->shm_name, (long)st.st_size, (long)bus_len);
+        close(fd);
+        return SRSLTE_ERROR;
+      }
+    }
+
+    void* ptr = mmap(NULL, bus_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+      rf_shm_error(handler, "mapping %s: %s\n", handler->shm_name, strerror(errno));
+      return SRSLTE_ERROR;
+    }
+
+    rf_shm_bus_t* bus = (rf_shm_bus_t*)ptr;
+    if (creator) {
+      bus->ring_len   = ring_len;
+      bus->base_srate = handler->base_srate;
+      SHM_STORE(bus->magic, SHM_MAGIC);
+    } else {
+      shm_wait_t w = {};
+      while (SHM_LOAD(bus->magic) != SHM_MAGIC && shm_wait(&w)) {
+      }
+      if (SHM_LOAD(bus->magic) != SHM_MAGIC || bus->ring_len != ring_len || bus->base_srate != handler->base_srate) {
+        rf_shm_error(handler, "%s is not a bus with a base rate of %.2f MHz\n", handler->shm_name,
+                     handler->base_srate / 1e6);
+        munmap(ptr, bus_len);
+        return SRSLTE_ERROR;
+      }
+    }
+
+    bus_lock(bus);
+    if (bus->unlinked) {
+      // mapped a segment the last node removed while leaving, open the new one
+      bus_unlock(bus);
+      munmap(ptr, bus_len);
+      continue;
+    }
+
+    handler->bus      = bus;
+    handler->bus_len  = bus_len;
+    handler->rings    = (cf_t*)((uint8_t*)ptr + sizeof(rf_shm_bus_t));
+    handler->ring_len = ring_len;
+
+    // the bus stays locked until the node joined
+    return SRSLTE_SUCCESS;
+  }
+}
+
+// Takes a free ring and starts at the current time of the bus. Called with the bus locked.
+static int shm_join(rf_shm_handler_t* handler, int node)
+{
+  rf_shm_bus_t* bus = handler->bus;
+
+  if (node < 0) {
+    for (node = 0; node < SHM_MAX_NODES; node++) {
+      if (!bus->node[node].tx_active && !bus->node[node].rx_active) {
+        break;
+      }
+    }
+  }
+  if (node >= SHM_MAX_NODES) {
+    rf_shm_error(handler, "all %d nodes of the bus are in use\n", SHM_MAX_NODES);
+    return SRSLTE_ERROR;
+  }
+  if (bus->node[node].tx_active || bus->node[node].rx_active) {
+    rf_shm_error(handler, "node %d is already in use\n", node);
+    return SRSLTE_ERROR;
+  }
+
+  // Receivers are never ahead of the streams they read, transmit only nodes might be
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < SHM_MAX_NODES; i++) {
+    if (SHM_LOAD(bus->node[i].rx_active)) {
+      now = SRSLTE_MAX(now, SHM_LOAD(bus->node[i].read_ts));
+    } else if (SHM_LOAD(bus->node[i].tx_active)) {
+      now = SRSLTE_MAX(now, SHM_LOAD(bus->node[i].write_ts));
+    }
+  }
+
+  rf_shm_node_t* n = &bus->node[node];
+  n->start_ts      = now;
+  n->read_ts       = now;
+  n->write_ts      = now;
+  SHM_STORE(n->rx_active, 1);
+  SHM_STORE(n->tx_active, handler->tx_enabled ? 1 : 0);
+
+  handler->node             = (uint32_t)node;
+  handler->joined           = true;
+  handler->next_rx_ts       = now;
+  handler->next_tx_ts       = now;
+  handler->subscribed[node] = false;
+
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Public methods
+ */
+
+void rf_shm_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_shm_register_error_handler(void* h, srslte_rf_error_handler_t new_handler)
+{
+  // do nothing
+}
+
+char* rf_shm_devname(void* h)
+{
+  return (char*)shm_devname;
+}
+
+bool rf_shm_rx_wait_lo_locked(void* h)
+{
+  return true;
+}
+
+int rf_shm_start_rx_stream(void* h, bool now)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_shm_stop_rx_stream(void* h)
+{
+  return SRSLTE_SUCCESS;
+}
+
+void rf_shm_flush_buffer(void* h)
+{
+  // do nothing
+}
+
+bool rf_shm_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_shm_get_rssi(void* h)
+{
+  return 0.0;
+}
+
+int rf_shm_open(char* args, void** h)
+{
+  return rf_shm_open_multi(args, h, 1);
+}
+
+int rf_shm_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  int ret = SRSLTE_ERROR;
+  if (h) {
+    *h = NULL;
+
+    if (nof_channels != 1) {
+      printf("rf_shm only supports single port at the moment.\n");
+      return SRSLTE_ERROR;
+    }
+
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)malloc(sizeof(rf_shm_handler_t));
+    if (!handler) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    bzero(handler, sizeof(rf_shm_handler_t));
+    *h                        = handler;
+    handler->base_srate       = 23.04e6; // Sample rate for 100 PRB cell
+    handler->rx_gain          = 0.0;
+    handler->info.max_rx_gain = +INFINITY;
+    handler->info.min_rx_gain = -INFINITY;
+    handler->info.max_tx_gain = +INFINITY;
+    handler->info.min_tx_gain = -INFINITY;
+    handler->tx_enabled       = true;
+    strcpy(handler->id, "shm");
+    for (uint32_t i = 0; i < SHM_MAX_NODES; i++) {
+      handler->subscribed[i] = true;
+    }
+
+    char bus_name[PARAM_LEN] = {0};
+    int  node                = -1;
+
+    // parse args
+    if (args) {
+      char config_str[PARAM_LEN] = {0};
+
+      if (parse_arg(args, "base_srate=", config_str)) {
+        printf("Using base rate=%s\n", config_str);
+        handler->base_srate = strtod(config_str, NULL);
+      }
+
+      if (parse_arg(args, "bus=", bus_name)) {
+        printf("Using bus=%s\n", bus_name);
+      }
+
+      if (parse_arg(args, "node=", config_str)) {
+        printf("Using node=%s\n", config_str);
+        node = (int)strtol(config_str, NULL, 10);
+      }
+
+      if (parse_arg(args, "rx_nodes=", config_str)) {
+        printf("Using rx_nodes=%s\n", config_str);
+        if (parse_nodes(handler, config_str)) {
+          goto clean_exit;
+        }
+      }
+
+      if (parse_arg(args, "tx=", config_str)) {
+        handler->tx_enabled = strtol(config_str, NULL, 10) != 0;
+      }
+
+      if (parse_arg(args, "id=", config_str)) {
+        printf("Using ID=%s\n", config_str);
+        strncpy(handler->id, config_str, PARAM_LEN_SHORT);
+        handler->id[PARAM_LEN_SHORT - 1] = 0;
+      }
+    }
+
+    if (strlen(bus_name) == 0) {
+      // not meant for us, e.g. when probing devices in auto mode
+      goto clean_exit;
+    }
+    snprintf(handler->shm_name, PARAM_LEN, "/srslte_shm_%s", bus_name);
+
+    rf_shm_set_rx_srate(handler, 1.92e6);
+
+    handler->buffer_decimation = srslte_vec_malloc(sizeof(cf_t) * SHM_MAX_BUFFER_SAMPLES);
+    handler->buffer_tx         = srslte_vec_malloc(sizeof(cf_t) * SHM_MAX_BUFFER_SAMPLES);
+    if (!handler->buffer_decimation || !handler->buffer_tx) {
+      fprintf(stderr, "Error: allocating rate conversion buffers\n");
+      goto clean_exit;
+    }
+
+    if (shm_map(handler)) {
+      goto clean_exit;
+    }
+    ret = shm_join(handler, node);
+    bus_unlock(handler->bus);
+    if (ret) {
+      goto clean_exit;
+    }
+
+    printf("[shm] %s joined %s as node %d at sample %lu\n", handler->id, handler->shm_name, handler->node,
+           (unsigned long)handler->next_rx_ts);
+
+  clean_exit:
+    if (ret) {
+      rf_shm_close(handler);
+      *h = NULL;
+    }
+  }
+  return ret;
+}
+
+int rf_shm_close(void* h)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+  if (handler->bus) {
+    rf_shm_bus_t* bus = handler->bus;
+
+    bus_lock(bus);
+    if (handler->joined) {
+      SHM_STORE(bus->node[handler->node].tx_active, 0);
+      SHM_STORE(bus->node[handler->node].rx_active, 0);
+    }
+
+    bool last = true;
+    for (uint32_t i = 0; i < SHM_MAX_NODES; i++) {
+      last &= !bus->node[i].tx_active && !bus->node[i].rx_active;
+    }
+    if (last) {
+      shm_unlink(handler->shm_name);
+      bus->unlinked = 1;
+    }
+    bus_unlock(bus);
+
+    munmap(bus, handler->bus_len);
+  }
+
+  if (handler->buffer_decimation) {
+    free(handler->buffer_decimation);
+  }
+
+  if (handler->buffer_tx) {
+    free(handler->buffer_tx);
+  }
+
+  free(handler);
+
+  return SRSLTE_SUCCESS;
+}
+
+void rf_shm_set_master_clock_rate(void* h, double rate)
+{
+  // Do nothing
+}
+
+bool rf_shm_is_master_clock_dynamic(void* h)
+{
+  return false;
+}
+
+double rf_shm_set_rx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    // Decimation must be full integer
+    if (((uint64_t)handler->base_srate % (uint64_t)srate) == 0) {
+      handler->srate        = srate;
+      handler->decim_factor = handler->base_srate / handler->srate;
+    } else {
+      fprintf(stderr, "Error: couldn't update sample rate. %.2f is not divisible by %.2f\n", srate / 1e6,
+              handler->base_srate / 1e6);
+    }
+    printf("Current sample rate is %.2f MHz with a base rate of %.2f MHz (x%d decimation)\n", handler->srate / 1e6,
+           handler->base_srate / 1e6, handler->decim_factor);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_srate(void* h, double srate)
+{
+  return rf_shm_set_rx_srate(h, srate);
+}
+
+double rf_shm_set_rx_gain(void* h, double gain)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    handler->rx_gain          = gain;
+    ret                       = gain;
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_gain(void* h, double gain)
+{
+  return 0.0;
+}
+
+double rf_shm_get_rx_gain(void* h)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    ret                       = handler->rx_gain;
+  }
+  return ret;
+}
+
+double rf_shm_get_tx_gain(void* h)
+{
+  return 0.0;
+}
+
+srslte_rf_info_t* rf_shm_get_info(void* h)
+{
+  srslte_rf_info_t* info = NULL;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    info                      = &handler->info;
+  }
+  return info;
+}
+
+double rf_shm_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  double ret = NAN;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    handler->rx_freq          = freq;
+    ret                       = freq;
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  double ret = NAN;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    handler->tx_freq          = freq;
+    ret                       = freq;
+  }
+  return ret;
+}
+
+void rf_shm_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    srslte_timestamp_t ts     = {};
+    srslte_timestamp_init_uint64(&ts, handler->next_rx_ts, handler->base_srate);
+    if (secs) {
+      *secs = ts.full_secs;
+    }
+    if (frac_secs) {
+      *frac_secs = ts.frac_secs;
+    }
+  }
+}
+
+int rf_shm_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_shm_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_shm_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h) {
+    rf_shm_handler_t* handler           = (rf_shm_handler_t*)h;
+    uint32_t          nsamples_baserate = nsamples * handler->decim_factor;
+    uint64_t          ts                = handler->next_rx_ts;
+
+    // set timestamp for this reception
+    if (secs != NULL && frac_secs != NULL) {
+      rf_shm_get_time(h, secs, frac_secs);
+    }
+
+    if (nsamples_baserate > handler->ring_len / 2 ||
+        (handler->decim_factor != 1 && nsamples_baserate > SHM_MAX_BUFFER_SAMPLES)) {
+      rf_shm_error(handler, "trying to receive %d samples at once\n", nsamples_baserate);
+      goto clean_exit;
+    }
+
+    // fill the gap in the own stream, so the other nodes can receive this block too
+    while (handler->tx_enabled && handler->next_tx_ts < ts + nsamples_baserate) {
+      uint32_t n = (uint32_t)SRSLTE_MIN(ts + nsamples_baserate - handler->next_tx_ts, handler->ring_len / 2);
+      shm_write(handler, NULL, handler->next_tx_ts, n);
+    }
+
+    // mix all subscribed streams straight into the output unless it needs decimation
+    cf_t* ptr   = (handler->decim_factor != 1) ? handler->buffer_decimation : data[0];
+    bool  first = true;
+    for (uint32_t i = 0; i < SHM_MAX_NODES; i++) {
+      // a node which left the bus might still have sent samples of this block
+      rf_shm_node_t* n = &handler->bus->node[i];
+      if (handler->subscribed[i] && (SHM_LOAD(n->tx_active) || SHM_LOAD(n->write_ts) > ts)) {
+        shm_mix(handler, i, ptr, ts, nsamples_baserate, first);
+        first = false;
+      }
+    }
+    if (first) {
+      bzero(ptr, sizeof(cf_t) * nsamples_baserate);
+    }
+
+    // release the samples to the writers
+    handler->next_rx_ts = ts + nsamples_baserate;
+    SHM_STORE(handler->bus->node[handler->node].read_ts, handler->next_rx_ts);
+
+    // decimate if needed
+    if (handler->decim_factor != 1) {
+      cf_t* dst = data[0];
+
+      int n;
+      for (int i = n = 0; i < nsamples; i++) {
+        // Averaging decimation
+        cf_t avg = 0.0f;
+        for (int j = 0; j < handler->decim_factor; j++, n++) {
+          avg += ptr[n];
+        }
+        dst[i] = avg / (float)handler->decim_factor;
+      }
+    }
+
+    ret = nsamples;
+  }
+
+clean_exit:
+  return ret;
+}
+
+int rf_shm_send_timed(void*  h,
+                      void*  data,
+                      int    nsamples,
+                      time_t secs,
+                      double frac_secs,
+                      bool   has_time_spec,
+                      bool   blocking,
+                      bool   is_start_of_burst,
+                      bool   is_end_of_burst)
+{
+  void* _data[4] = {data, NULL, NULL, NULL};
+
+  return rf_shm_send_timed_multi(h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst,
+                                 is_end_of_burst);
+}
+
+int rf_shm_send_timed_multi(void*  h,
+                            void*  data[4],
+                            int    nsamples,
+                            time_t secs,
+                            double frac_secs,
+                            bool   has_time_spec,
+                            bool   blocking,
+                            bool   is_start_of_burst,
+                            bool   is_end_of_burst)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data && nsamples > 0) {
+    rf_shm_handler_t* handler           = (rf_shm_handler_t*)h;
+    uint32_t          nsamples_baseband = nsamples * handler->decim_factor;
+
+    // return if transmitter is switched off
+    if (!handler->tx_enabled) {
+      return SRSLTE_SUCCESS;
+    }
+
+    if (nsamples_baseband > handler->ring_len / 2 ||
+        (handler->decim_factor != 1 && nsamples_baseband > SHM_MAX_BUFFER_SAMPLES)) {
+      rf_shm_error(handler, "trying to transmit %d samples at once\n", nsamples_baseband);
+      goto clean_exit;
+    }
+
+    // check if this is a tx in the future
+    if (has_time_spec) {
+      srslte_timestamp_t ts = {};
+      srslte_timestamp_init(&ts, secs, frac_secs);
+      uint64_t tx_ts = srslte_timestamp_uint64(&ts, handler->base_srate);
+
+      if (tx_ts < handler->next_tx_ts) {
+        rf_shm_error(handler, "tx time is %.3f ms in the past\n",
+                     1000.0 * (handler->next_tx_ts - tx_ts) / handler->base_srate);
+        goto clean_exit;
+      }
+
+      // send zero samples up to the tx time, in chunks the readers can follow
+      while (handler->next_tx_ts < tx_ts) {
+        uint32_t n = (uint32_t)SRSLTE_MIN(tx_ts - handler->next_tx_ts, handler->ring_len / 2);
+        shm_write(handler, NULL, handler->next_tx_ts, n);
+      }
+    }
+
+    cf_t* buf = data[0];
+    if (handler->decim_factor != 1) {
+      // perform zero order hold
+      buf = handler->buffer_tx;
+
+      int   n   = 0;
+      cf_t* src = data[0];
+      for (int i = 0; i < nsamples; i++) {
+        for (int j = 0; j < handler->decim_factor; j++, n++) {
+          buf[n] = src[i];
+        }
+      }
+    }
+
+    shm_write(handler, buf, handler->next_tx_ts, nsamples_baseband);
+
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  return ret;
+}
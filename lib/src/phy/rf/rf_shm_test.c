@@ -0,0 +1,236 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+
+#include "rf_shm_imp.h"
+#include "srslte/srslte.h"
+#include <pthread.h>
+#include <srslte/phy/common/phy_common.h>
+#include <stdlib.h>
+
+#define NOF_RX_ANT 1
+#define NUM_SF (2000)
+#define SF_LEN (1920)
+#define RF_BUFFER_SIZE (SF_LEN * NUM_SF)
+#define TX_OFFSET_MS (4)
+
+static cf_t ue_rx_buffer[RF_BUFFER_SIZE];
+static cf_t enb_tx_buffer[2][RF_BUFFER_SIZE];
+
+typedef struct {
+  srslte_rf_t radio;
+  cf_t*       tx_buffer;
+  cf_t        rx_buffer[SF_LEN];
+  bool        timed_tx;
+} tx_node_t;
+
+static void open_radio(srslte_rf_t* radio, const char* args)
+{
+  char rf_args[PARAM_LEN];
+  strncpy(rf_args, args, PARAM_LEN);
+  rf_args[PARAM_LEN - 1] = 0;
+
+  printf("opening device with args=%s\n", rf_args);
+  if (srslte_rf_open_devname(radio, "shm", rf_args, NOF_RX_ANT)) {
+    fprintf(stderr, "Error opening rf\n");
+    exit(-1);
+  }
+}
+
+void* ue_rx_thread_function(void* args)
+{
+  srslte_rf_t* radio = (srslte_rf_t*)args;
+
+  // receive 5 subframes at once (i.e. mimic initial rx that receives one slot)
+  uint32_t num_slots          = NUM_SF / 5;
+  uint32_t num_samps_per_slot = SF_LEN * 5;
+  uint32_t num_rxed_samps     = 0;
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    void* data_ptr[SRSLTE_MAX_PORTS] = {NULL};
+    data_ptr[0]                      = &ue_rx_buffer[i * num_samps_per_slot];
+    num_rxed_samps += srslte_rf_recv_with_time_multi(radio, data_ptr, num_samps_per_slot, true, NULL, NULL);
+  }
+
+  printf("received %d samples.\n", num_rxed_samps);
+
+  printf("closing ue device\n");
+  srslte_rf_close(radio);
+
+  return NULL;
+}
+
+// Sends the buffer subframe by subframe and receives in between, like the PHY does
+void* enb_tx_thread_function(void* args)
+{
+  tx_node_t* node = (tx_node_t*)args;
+
+  // initial transmission without ts
+  void* data_ptr[SRSLTE_MAX_PORTS] = {NULL};
+  data_ptr[0]                      = &node->tx_buffer[0];
+  int ret                          = srslte_rf_send_multi(&node->radio, (void**)data_ptr, SF_LEN, true, true, false);
+
+  uint32_t num_txed_samples = SF_LEN;
+
+  // from here on, all transmissions are timed relative to the last rx time
+  srslte_timestamp_t rx_time, tx_time;
+
+  for (uint32_t i = 0; i < NUM_SF - ((node->timed_tx) ? TX_OFFSET_MS : 1); ++i) {
+    // first recv samples
+    data_ptr[0] = node->rx_buffer;
+    srslte_rf_recv_with_time_multi(&node->radio, data_ptr, SF_LEN, true, &rx_time.full_secs, &rx_time.frac_secs);
+
+    // prepare data buffer
+    data_ptr[0] = &node->tx_buffer[num_txed_samples];
+
+    if (node->timed_tx) {
+      // timed tx relative to receive time (this will cause a gap in the rx'ed samples at the UE resulting in 3 zero
+      // subframes)
+      srslte_timestamp_copy(&tx_time, &rx_time);
+      srslte_timestamp_add(&tx_time, 0, TX_OFFSET_MS * 1e-3);
+      ret = srslte_rf_send_timed_multi(&node->radio, (void**)data_ptr, SF_LEN, tx_time.full_secs, tx_time.frac_secs,
+                                       true, true, false);
+    } else {
+      // normal tx
+      ret = srslte_rf_send_multi(&node->radio, (void**)data_ptr, SF_LEN, true, true, false);
+    }
+    if (ret != SRSLTE_SUCCESS) {
+      fprintf(stderr, "Error sending data\n");
+      exit(-1);
+    }
+
+    num_txed_samples += SF_LEN;
+  }
+
+  printf("transmitted %d samples in %d subframes\n", num_txed_samples, NUM_SF);
+
+  printf("closing tx device\n");
+  srslte_rf_close(&node->radio);
+
+  return NULL;
+}
+
+// srate below the base_srate of the bus makes the nodes decimate, 0 keeps the base_srate
+int run_test(const char* rx_args, const char* tx_args[], uint32_t nof_tx, bool timed_tx, double srate)
+{
+  int              ret = SRSLTE_ERROR;
+  srslte_rf_t      ue_radio;
+  static tx_node_t enb[2];
+  pthread_t        rx_thread, tx_thread[2];
+
+  // generate random tx data
+  for (uint32_t n = 0; n < nof_tx; n++) {
+    for (int i = 0; i < RF_BUFFER_SIZE; i++) {
+      enb_tx_buffer[n][i] = ((float)rand() / (float)RAND_MAX) + _Complex_I * ((float)rand() / (float)RAND_MAX);
+    }
+  }
+
+  // open all nodes before anybody starts streaming, so they all start at the same time
+  open_radio(&ue_radio, rx_args);
+  for (uint32_t n = 0; n < nof_tx; n++) {
+    open_radio(&enb[n].radio, tx_args[n]);
+    enb[n].tx_buffer = enb_tx_buffer[n];
+    enb[n].timed_tx  = timed_tx;
+  }
+
+  if (srate > 0) {
+    srslte_rf_set_rx_srate(&ue_radio, srate);
+    for (uint32_t n = 0; n < nof_tx; n++) {
+      srslte_rf_set_tx_srate(&enb[n].radio, srate);
+    }
+  }
+
+  if (pthread_create(&rx_thread, NULL, ue_rx_thread_function, &ue_radio)) {
+    perror("pthread_create");
+    exit(-1);
+  }
+  for (uint32_t n = 0; n < nof_tx; n++) {
+    if (pthread_create(&tx_thread[n], NULL, enb_tx_thread_function, &enb[n])) {
+      perror("pthread_create");
+      exit(-1);
+    }
+  }
+
+  for (uint32_t n = 0; n < nof_tx; n++) {
+    pthread_join(tx_thread[n], NULL);
+  }
+  pthread_join(rx_thread, NULL);
+
+  // subframe-wise compare the sum of the tx'ed and the rx'ed data (stop 3 subframes earlier for timed tx)
+  for (uint32_t i = 0; i < NUM_SF - (timed_tx ? 3 : 0); ++i) {
+    uint32_t sf_offet = 0;
+    if (timed_tx && i >= 1) {
+      // for timed transmission, the enb inserts 3 zero subframes after the first untimed tx
+      sf_offet = (TX_OFFSET_MS - 1) * SF_LEN;
+    }
+
+    cf_t expected[SF_LEN];
+    memcpy(expected, &enb_tx_buffer[0][i * SF_LEN], sizeof(cf_t) * SF_LEN);
+    for (uint32_t n = 1; n < nof_tx; n++) {
+      srslte_vec_sum_ccc(expected, &enb_tx_buffer[n][i * SF_LEN], expected, SF_LEN);
+    }
+
+    if (memcmp(&ue_rx_buffer[sf_offet + i * SF_LEN], expected, sizeof(cf_t) * SF_LEN) != 0) {
+      fprintf(stderr, "data mismatch in subframe %d\n", i);
+      goto exit;
+    }
+  }
+
+  ret = SRSLTE_SUCCESS;
+
+exit:
+  return ret;
+}
+
+int main()
+{
+  // single tx, single rx with continuous transmissions (no timed tx)
+  const char* single_tx[] = {"bus=test1,id=enb,base_srate=1.92e6"};
+  if (run_test("bus=test1,tx=0,id=ue,base_srate=1.92e6", single_tx, 1, false, 0) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Single tx, single rx test failed!\n");
+    return -1;
+  }
+
+  // single tx with timed tx and a gap in the stream
+  const char* timed_tx[] = {"bus=test2,id=enb,base_srate=1.92e6"};
+  if (run_test("bus=test2,tx=0,id=ue,base_srate=1.92e6", timed_tx, 1, true, 0) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Single tx, single rx test with timed tx failed!\n");
+    return -1;
+  }
+
+  // two transmitters on fixed nodes, the receiver subscribes to both and gets the sum
+  const char* two_tx[] = {"bus=test3,node=1,id=enb1,base_srate=1.92e6", "bus=test3,node=2,id=enb2,base_srate=1.92e6"};
+  if (run_test("bus=test3,node=0,rx_nodes=1:2,tx=0,id=ue,base_srate=1.92e6", two_tx, 2, false, 0) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Two tx, single rx test failed!\n");
+    return -1;
+  }
+
+  // half the base rate, the samples held by the tx must come out of the rx averaging unchanged
+  const char* decim_tx[] = {"bus=test4,id=enb,base_srate=3.84e6"};
+  if (run_test("bus=test4,tx=0,id=ue,base_srate=3.84e6", decim_tx, 1, false, 1.92e6) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Single tx, single rx test with decimation failed!\n");
+    return -1;
+  }
+
+  return 0;
+}
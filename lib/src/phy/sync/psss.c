@@ -239,6 +239,22 @@ int srslte_psss_init_fft_offset_decim(srslte_psss_t *q,
 
     }
 
+    q->joint_freq = srslte_vec_malloc(2 * buffer_size * sizeof(cf_t));
+    q->joint_output = srslte_vec_malloc(2 * buffer_size * sizeof(cf_t));
+    q->joint_output_abs = srslte_vec_malloc(2 * buffer_size * sizeof(float));
+    if (!q->joint_freq || !q->joint_output || !q->joint_output_abs) {
+      fprintf(stderr, "Error allocating memory\n");
+      goto clean_and_exit;
+    }
+
+    // both correlations are transformed back at once, one after the other
+    uint32_t conv_len = q->conv_fft.output_len;
+    if (srslte_dft_plan_guru_c(&q->joint_plan, conv_len, SRSLTE_DFT_BACKWARD,
+                               q->joint_freq, q->joint_output, 1, 1, 2, conv_len, conv_len)) {
+      fprintf(stderr, "Error creating DFT plan \n");
+      goto clean_and_exit;
+    }
+
     #endif
 
     srslte_psss_reset(q);
@@ -327,6 +343,13 @@ int srslte_psss_resize(srslte_psss_t *q, uint32_t frame_size, uint32_t fft_size,
       srslte_vec_conj_cc(q->psss_signal_freq_full[N_id_2], q->psss_signal_freq_full[N_id_2], buffer_size);
     }
 
+    uint32_t conv_len = q->conv_fft.output_len;
+    if (srslte_dft_replan_guru_c(&q->joint_plan, conv_len,
+                                 q->joint_freq, q->joint_output, 1, 1, 2, conv_len, conv_len)) {
+      fprintf(stderr, "Error creating DFT plan \n");
+      return SRSLTE_ERROR;
+    }
+
 #endif
 
     srslte_psss_reset(q);
@@ -351,7 +374,16 @@ void srslte_psss_free(srslte_psss_t *q) {
     }
   #ifdef CONVOLUTION_FFT
     srslte_conv_fft_cc_free(&q->conv_fft);
-
+    srslte_dft_plan_free(&q->joint_plan);
+    if (q->joint_freq) {
+      free(q->joint_freq);
+    }
+    if (q->joint_output) {
+      free(q->joint_output);
+    }
+    if (q->joint_output_abs) {
+      free(q->joint_output_abs);
+    }
   #endif
     if (q->tmp_input) {
       free(q->tmp_input);
@@ -586,6 +618,51 @@ static int srslte_psss_compute_peak_sidelobe(srslte_psss_t *q, uint32_t corr_pea
   return q->conv_output_avg[corr_peak_pos]/side_lobe_value;
 }
 
+/* Checks that the highest correlation peak has a partner one PSSS symbol
+ * away, as both PSSS of a subframe produce a peak of similar height. Returns
+ * the position of the first of the two peaks and their peak to side lobe
+ * ratio in corr_peak_value, or 0 with a zero ratio if there is no such pair.
+ */
+static int psss_find_peak_pair(srslte_psss_t *q, float *conv_output_abs, uint32_t corr_peak_pos,
+                               uint32_t conv_output_len, float *corr_peak_value, float *peak_abs)
+{
+  int next_peak = srslte_psss_compute_peak_sidelobe_pos(conv_output_abs, corr_peak_pos, conv_output_len);
+
+  float dummy_value;
+  if (!corr_peak_value) {
+    corr_peak_value = &dummy_value;
+  }
+  *corr_peak_value = 0;
+
+  if(abs(abs((int) corr_peak_pos - next_peak) - (int) (q->fft_size + SRSLTE_CP_LEN((q->fft_size),SRSLTE_CP_NORM_LEN))) > 5){
+    DEBUG("PSSS peaks are too far apart: [%d] = %f [%d] = %f\n",
+          corr_peak_pos, conv_output_abs[corr_peak_pos],
+          next_peak, conv_output_abs[next_peak]);
+    return 0;
+  }
+
+  // check if both peaks are in same magnitude range
+  float ratio = conv_output_abs[corr_peak_pos] / conv_output_abs[next_peak];
+  if (ratio > 2.0 || ratio < 0.5) {
+    DEBUG("PSSS peaks values are not similar: [%d] = %f [%d] = %f\n",
+          corr_peak_pos, conv_output_abs[corr_peak_pos],
+          next_peak, conv_output_abs[next_peak]);
+    return 0;
+  }
+
+  int psr = srslte_psss_compute_peak_sidelobe_pos2(conv_output_abs, corr_peak_pos, next_peak, conv_output_len);
+
+  DEBUG("psr: [%d] = %f corr_peak_pos: [%d] = %f next_peaks [%d] = %f\n",
+        psr, conv_output_abs[psr],
+        corr_peak_pos, conv_output_abs[corr_peak_pos],
+        next_peak, conv_output_abs[next_peak]);
+
+  *corr_peak_value = conv_output_abs[corr_peak_pos] / conv_output_abs[psr];
+  *peak_abs = conv_output_abs[corr_peak_pos];
+
+  return (int) corr_peak_pos < next_peak ? (int) corr_peak_pos : next_peak;
+}
+
 /** Performs time-domain PSS correlation.
  * Returns the index of the PSS correlation peak in a subframe.
  * The frame starts at corr_peak_pos-subframe_size/2.
@@ -646,43 +723,12 @@ int srslte_psss_find_psss(srslte_psss_t *q, const cf_t *input, float *corr_peak_
 
     if (q->frame_size >= q->fft_size) {
       // i assume we are in find operation, so we are looking for two peaks
-      int next_peak = srslte_psss_compute_peak_sidelobe_pos(q->conv_output_abs, corr_peak_pos, conv_output_len);
-
-      // printf("Peak pos is %d with value %f\n", corr_peak_pos, q->conv_output_abs[corr_peak_pos]);
-      // printf("\t next Peak pos is %d with value %f\n", next_peak, q->conv_output_abs[next_peak]);
-
-      if(abs(abs(corr_peak_pos - next_peak) - (q->fft_size + SRSLTE_CP_LEN((q->fft_size),SRSLTE_CP_NORM_LEN))) > 5){
-        printf("PSSS peaks are too far apart: [%d] = %f [%d] = %f\n",
-                corr_peak_pos, q->conv_output_abs[corr_peak_pos],
-                next_peak, q->conv_output_abs[next_peak]);
-        *corr_peak_value = 0;
-        return 0;
-      }
-
-      // check if both peaks are in same magnitude range
-      float ratio = q->conv_output_abs[corr_peak_pos] / q->conv_output_abs[next_peak];
-      if (ratio > 2.0 || ratio < 0.5) {
-        printf("PSSS peaks values are not similar: [%d] = %f [%d] = %f\n",
-                corr_peak_pos, q->conv_output_abs[corr_peak_pos],
-                next_peak, q->conv_output_abs[next_peak]);
-        *corr_peak_value = 0;
-        return 0;
+      float peak_abs = 0;
+      int first_peak = psss_find_peak_pair(q, q->conv_output_abs, corr_peak_pos, conv_output_len, corr_peak_value, &peak_abs);
+      if (first_peak > 0) {
+        q->peak_value = peak_abs;
       }
-
-
-      int psr = srslte_psss_compute_peak_sidelobe_pos2(q->conv_output_abs, corr_peak_pos, next_peak, conv_output_len);
-
-      printf("psr: [%d] = %f corr_peak_pos: [%d] = %f next_peaks [%d] = %f\n",
-              psr, q->conv_output_abs[psr],
-              corr_peak_pos, q->conv_output_abs[corr_peak_pos],
-              next_peak, q->conv_output_abs[next_peak]);
-
-      *corr_peak_value = q->conv_output_abs[corr_peak_pos] / q->conv_output_abs[psr];
-
-      q->peak_value = q->conv_output_abs[corr_peak_pos];
-
-      return corr_peak_pos < next_peak ? corr_peak_pos : next_peak;
-
+      return first_peak;
 
     } else {
       // we are in tracking state, so we check for absolute peak
@@ -740,6 +786,82 @@ int srslte_psss_find_psss(srslte_psss_t *q, const cf_t *input, float *corr_peak_
   return ret;
 }
 
+/** Searches both PSSS roots in the same input with a single input FFT. The
+ * input spectrum is multiplied with both root spectra and both correlations
+ * are transformed back by one batched IFFT, then each goes through the same
+ * peak pairing as srslte_psss_find_psss(). The root with the higher peak to
+ * side lobe ratio wins, it is returned in N_id_2 and set in the object.
+ *
+ * Only available in find operation, i.e. frame_size >= fft_size.
+ * Returns the position of the first PSSS of the winning root, 0 if neither
+ * root shows a valid peak pair or a negative number on error.
+ */
+int srslte_psss_find_psss_joint(srslte_psss_t *q, const cf_t *input, float *corr_peak_value, uint32_t *N_id_2)
+{
+#ifdef CONVOLUTION_FFT
+  if (q == NULL || input == NULL || q->frame_size < q->fft_size) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t conv_len = q->conv_fft.output_len;
+
+  // the transform runs over frame_size + fft_size samples, the tail of tmp_input stays zero
+  memcpy(q->tmp_input, input, (q->frame_size * q->decimate) * sizeof(cf_t));
+  const cf_t *in_ptr = q->tmp_input;
+
+  if(q->decimate > 1) {
+    srslte_filt_decim_cc_execute(&(q->filter), q->tmp_input, q->filter.downsampled_input, q->filter.filter_output , (q->frame_size * q->decimate));
+    in_ptr = q->filter.filter_output;
+  }
+
+  // One input FFT serves both roots
+  srslte_dft_run_c(&q->conv_fft.input_plan, in_ptr, q->conv_fft.input_fft);
+  for (uint32_t i = 0; i < 2; i++) {
+    srslte_vec_prod_ccc(q->conv_fft.input_fft, q->psss_signal_freq_full[i], &q->joint_freq[i * conv_len], conv_len);
+  }
+  srslte_dft_run_guru_c(&q->joint_plan);
+
+  // Same length as returned by srslte_conv_fft_cc_run_opt()
+  uint32_t conv_output_len = conv_len - 1;
+
+  int best_pos = 0;
+  float best_psr = 0;
+  float best_abs = 0;
+  uint32_t best_N_id_2 = q->N_id_2;
+
+  for (uint32_t i = 0; i < 2; i++) {
+    float *abs_ptr = &q->joint_output_abs[i * conv_len];
+    srslte_vec_abs_square_cf(&q->joint_output[i * conv_len], abs_ptr, conv_output_len-1);
+
+    uint32_t corr_peak_pos = srslte_vec_max_fi(abs_ptr, conv_output_len-1);
+    float peak_abs = 0;
+    int pos = psss_find_peak_pair(q, abs_ptr, corr_peak_pos, conv_output_len, &q->joint_peak_value[i], &peak_abs);
+
+    if (pos > 0 && q->joint_peak_value[i] > best_psr) {
+      best_pos = pos;
+      best_psr = q->joint_peak_value[i];
+      best_abs = peak_abs;
+      best_N_id_2 = i;
+    }
+  }
+
+  if (best_pos > 0) {
+    q->N_id_2 = best_N_id_2;
+    q->peak_value = best_abs;
+  }
+  if (N_id_2) {
+    *N_id_2 = best_N_id_2;
+  }
+  if (corr_peak_value) {
+    *corr_peak_value = best_psr;
+  }
+
+  return best_pos;
+#else
+  return SRSLTE_ERROR;
+#endif
+}
+
 #if 0
 /* Computes frequency-domain channel estimation of the PSS symbol
  * input signal is in the time-domain.
@@ -878,7 +1000,7 @@ float srslte_psss_cfo_compute_with_ssss(srslte_psss_t* q, const cf_t *subframe){
 
   float cfo = carg(xc)*q->fft_size/short_symbol_size/2/M_PI;
 
-  printf("srslte_psss_cfo_compute_with_ssss returned %f\n", cfo);
+  DEBUG("srslte_psss_cfo_compute_with_ssss returned %f\n", cfo);
 
   return cfo;
 }
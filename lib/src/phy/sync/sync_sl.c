@@ -296,6 +296,13 @@ int srslte_sync_sl_set_N_id_2(srslte_sync_sl_t *q, uint32_t N_id_2) {
   }
 }
 
+void srslte_sync_sl_set_N_id_2_joint(srslte_sync_sl_t *q, bool enable) {
+  q->N_id_2_joint = enable;
+  if (enable && !srslte_SL_N_id_2_isvalid(q->N_id_2)) {
+    q->N_id_2 = 0;
+  }
+}
+
 uint32_t srslte_sync_sl_get_sf_idx(srslte_sync_sl_t *q) {
   return q->sf_idx;
 }
@@ -628,8 +635,12 @@ srslte_sync_find_ret_t srslte_sync_sl_find(srslte_sync_sl_t *q, const cf_t *inpu
     //   }
     // }
 
-    srslte_psss_set_N_id_2(&q->psss, q->N_id_2);
-    peak_pos = srslte_psss_find_psss(&q->psss, &input_ptr[find_offset], q->threshold>0?&q->peak_value:NULL);
+    if (q->N_id_2_joint) {
+      peak_pos = srslte_psss_find_psss_joint(&q->psss, &input_ptr[find_offset], &q->peak_value, &q->N_id_2);
+    } else {
+      srslte_psss_set_N_id_2(&q->psss, q->N_id_2);
+      peak_pos = srslte_psss_find_psss(&q->psss, &input_ptr[find_offset], q->threshold>0?&q->peak_value:NULL);
+    }
 
     INFO("PSSS: id=%d, find_offset=%d, peak_pos=%d, peak_value=%f\n", q->N_id_2, find_offset, peak_pos, q->peak_value);
 
@@ -0,0 +1,201 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+#include "srslte/phy/channel/ch_awgn.h"
+#include "srslte/phy/sync/psss.h"
+#include "srslte/phy/sync/ssss.h"
+
+/*
+ * Places a sidelink synchronization subframe into a 5 ms search window and
+ * checks that srslte_psss_find_psss_joint() finds the same position as the
+ * single root search and picks the right N_id_2. Also compares the time of
+ * the joint search with searching both roots one after the other.
+ */
+
+static uint32_t nof_prb  = 6;
+static uint32_t offset   = 1234;
+static float    snr_db   = 10.0f;
+static uint32_t nof_reps = 100;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [posn]\n", prog);
+  printf("\t-p nof_prb [Default %d]\n", nof_prb);
+  printf("\t-o offset of the sync subframe in the search window [Default %d]\n", offset);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+  printf("\t-n Number of searches to time [Default %d]\n", nof_reps);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "posn")) != -1) {
+    switch (opt) {
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        offset = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'n':
+        nof_reps = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSLTE_SUCCESS;
+
+  parse_args(argc, argv);
+
+  int fft_size = srslte_symbol_sz(nof_prb);
+  if (fft_size < 0) {
+    ERROR("Invalid nof_prb=%d\n", nof_prb);
+    exit(-1);
+  }
+  uint32_t sf_len    = SRSLTE_SF_LEN(fft_size);
+  uint32_t frame_len = 5 * sf_len;
+
+  if (offset + sf_len > frame_len) {
+    ERROR("Invalid offset=%d\n", offset);
+    exit(-1);
+  }
+
+  uint32_t nof_re     = SRSLTE_SF_LEN_RE(nof_prb, SRSLTE_CP_NORM);
+  cf_t*    sf_symbols = srslte_vec_malloc(sizeof(cf_t) * nof_re);
+  cf_t*    sf_buffer  = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  cf_t*    input      = srslte_vec_malloc(sizeof(cf_t) * frame_len);
+  if (!sf_symbols || !sf_buffer || !input) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  srslte_ofdm_t ifft;
+  if (srslte_ofdm_tx_init(&ifft, SRSLTE_CP_NORM, sf_symbols, sf_buffer, nof_prb)) {
+    ERROR("Error creating iFFT object\n");
+    exit(-1);
+  }
+  srslte_ofdm_set_freq_shift(&ifft, 0.5);
+  srslte_ofdm_set_normalize(&ifft, true);
+
+  srslte_psss_t psss;
+  if (srslte_psss_init_fft(&psss, frame_len, fft_size)) {
+    ERROR("Error initiating PSSS\n");
+    exit(-1);
+  }
+
+  double usec_single = 0;
+  double usec_joint  = 0;
+
+  for (uint32_t N_id_2 = 0; N_id_2 < 2; N_id_2++) {
+    cf_t  psss_signal[SRSLTE_PSSS_LEN];
+    float ssss_signal[SRSLTE_SSS_LEN];
+    uint32_t cell_id = N_id_2 * 168 + 42;
+
+    srslte_psss_generate(psss_signal, N_id_2);
+    srslte_ssss_generate(ssss_signal, cell_id);
+
+    bzero(sf_symbols, sizeof(cf_t) * nof_re);
+    srslte_psss_put_sf(psss_signal, sf_symbols, nof_prb, SRSLTE_CP_NORM);
+    srslte_ssss_put_sf(ssss_signal, sf_symbols, nof_prb, SRSLTE_CP_NORM);
+    srslte_ofdm_tx_sf(&ifft);
+
+    bzero(input, sizeof(cf_t) * frame_len);
+    memcpy(&input[offset], sf_buffer, sizeof(cf_t) * sf_len);
+    float std_dev = sqrtf(srslte_vec_avg_power_cf(sf_buffer, sf_len)) * powf(10.0f, -snr_db / 20.0f);
+    srslte_ch_awgn_c(input, input, std_dev, frame_len);
+
+    int   pos_single[2] = {};
+    float psr_single[2] = {};
+    int   pos_joint     = 0;
+    float psr_joint     = 0;
+    uint32_t found_N_id_2 = 0;
+
+    for (uint32_t n = 0; n < nof_reps; n++) {
+      struct timeval t[3];
+
+      gettimeofday(&t[1], NULL);
+      for (uint32_t i = 0; i < 2; i++) {
+        srslte_psss_set_N_id_2(&psss, i);
+        pos_single[i] = srslte_psss_find_psss(&psss, input, &psr_single[i]);
+      }
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      usec_single += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+      gettimeofday(&t[1], NULL);
+      pos_joint = srslte_psss_find_psss_joint(&psss, input, &psr_joint, &found_N_id_2);
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      usec_joint += t[0].tv_sec * 1e6 + t[0].tv_usec;
+    }
+
+    printf("N_id_2=%d: single pos=%d psr=%.1f, other root pos=%d psr=%.1f, joint N_id_2=%d pos=%d psr=%.1f\n",
+           N_id_2,
+           pos_single[N_id_2],
+           psr_single[N_id_2],
+           pos_single[1 - N_id_2],
+           psr_single[1 - N_id_2],
+           found_N_id_2,
+           pos_joint,
+           psr_joint);
+
+    if (pos_single[N_id_2] <= 0 || found_N_id_2 != N_id_2 || pos_joint != pos_single[N_id_2] ||
+        psr_joint != psr_single[N_id_2] || psss.N_id_2 != N_id_2) {
+      printf("Joint search does not match the single root search\n");
+      ret = SRSLTE_ERROR;
+    }
+  }
+
+  printf("both roots one by one: %.1f us, joint: %.1f us per search window\n",
+         usec_single / (2 * nof_reps),
+         usec_joint / (2 * nof_reps));
+
+  srslte_psss_free(&psss);
+  srslte_ofdm_tx_free(&ifft);
+  free(sf_symbols);
+  free(sf_buffer);
+  free(input);
+
+  if (ret == SRSLTE_SUCCESS) {
+    printf("Ok\n");
+  }
+  exit(ret);
+}
@@ -218,7 +218,7 @@ int srslte_ue_sl_cellsearch_set_nof_valid_frames(srslte_ue_sl_cellsearch_t * q,
 }
 
 /* Decide the most likely cell based on the mode */
-static void get_cell(srslte_ue_sl_cellsearch_t * q, uint32_t nof_detected_frames, srslte_ue_cellsearch_result_t *found_cell)
+static void get_cell(srslte_ue_sl_cellsearch_t * q, srslte_ue_cellsearch_result_t *candidates, uint32_t nof_detected_frames, srslte_ue_cellsearch_result_t *found_cell)
 {
   uint32_t i, j;
   
@@ -229,7 +229,7 @@ static void get_cell(srslte_ue_sl_cellsearch_t * q, uint32_t nof_detected_frames
   for (i = 0; i < nof_detected_frames; i++) {
     uint32_t cnt = 1;
     for (j=i+1;j<nof_detected_frames;j++) {
-      if (q->candidates[j].cell_id == q->candidates[i].cell_id && !q->mode_counted[j]) {
+      if (candidates[j].cell_id == candidates[i].cell_id && !q->mode_counted[j]) {
         q->mode_counted[j]=1;
         cnt++;
       }
@@ -243,18 +243,18 @@ static void get_cell(srslte_ue_sl_cellsearch_t * q, uint32_t nof_detected_frames
       mode_pos = i;
     }
   }
-  found_cell->cell_id = q->candidates[mode_pos].cell_id;
+  found_cell->cell_id = candidates[mode_pos].cell_id;
   /* Now in all these cell IDs, find most frequent CP */
   uint32_t nof_normal = 0;
   found_cell->peak = 0; 
   for (i=0;i<nof_detected_frames;i++) {
-    if (q->candidates[i].cell_id == found_cell->cell_id) {
-      if (SRSLTE_CP_ISNORM(q->candidates[i].cp)) {
+    if (candidates[i].cell_id == found_cell->cell_id) {
+      if (SRSLTE_CP_ISNORM(candidates[i].cp)) {
         nof_normal++;
       } 
     }
     // average absolute peak value 
-    found_cell->peak += q->candidates[i].peak; 
+    found_cell->peak += candidates[i].peak; 
   }
   found_cell->peak /= nof_detected_frames;
   
@@ -266,14 +266,15 @@ static void get_cell(srslte_ue_sl_cellsearch_t * q, uint32_t nof_detected_frames
   found_cell->mode = (float) q->mode_ntimes[mode_pos]/nof_detected_frames;  
   
   // PSR is already averaged so take the last value 
-  found_cell->psr = q->candidates[nof_detected_frames-1].psr;
+  found_cell->psr = candidates[nof_detected_frames-1].psr;
   
   // CFO is also already averaged 
-  found_cell->cfo = q->candidates[nof_detected_frames-1].cfo; 
+  found_cell->cfo = candidates[nof_detected_frames-1].cfo; 
 }
 
-/** Finds up to 3 cells, one per each N_id_2=0,1,2 and stores ID and CP in the structure pointed by found_cell.
- * Each position in found_cell corresponds to a different N_id_2. 
+/** Finds up to 2 cells, one per each N_id_2=0,1 and stores ID and CP in the structure pointed by found_cell.
+ * Each position in found_cell corresponds to a different N_id_2. Both N_id_2 are searched
+ * jointly in the same received frames, so the scan takes as long as one for a single N_id_2.
  * Saves in the pointer max_N_id_2 the N_id_2 index of the cell with the highest PSR
  * Returns the number of found cells or a negative number if error
  */
@@ -284,14 +285,71 @@ int srslte_ue_sl_cellsearch_scan(srslte_ue_sl_cellsearch_t * q,
   int ret = 0; 
   float max_peak_value = -1.0;
   uint32_t nof_detected_cells = 0;
+  uint32_t nof_detected_frames = 0;
+  uint32_t nof_detected[2] = {0, 0};
+  uint32_t nof_scanned_frames = 0;
+
+  if (q == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q->candidates, sizeof(srslte_ue_cellsearch_result_t)*q->max_frames);
+  bzero(q->mode_ntimes, sizeof(uint32_t)*q->max_frames);
+  bzero(q->mode_counted, sizeof(uint8_t)*q->max_frames);
+
+  srslte_ue_sl_sync_set_N_id_2_joint(&q->ue_sl_sync, true);
+  srslte_ue_sl_sync_cfo_reset(&q->ue_sl_sync);
 
-  for (uint32_t N_id_2=0; N_id_2<2 && ret >= 0; N_id_2++) {
-    ret = srslte_ue_sl_cellsearch_scan_N_id_2(q, N_id_2, &found_cells[N_id_2]);
+  do {
+    ret = srslte_ue_sl_sync_zerocopy_multi(&q->ue_sl_sync, q->sf_buffer, CELL_SEARCH_BUFFER_MAX_SAMPLES);
     if (ret < 0) {
-      fprintf(stderr, "Error searching cell\n");
-      return ret; 
+      fprintf(stderr, "Error calling srslte_ue_sync_work()\n");
+      srslte_ue_sl_sync_set_N_id_2_joint(&q->ue_sl_sync, false);
+      return -1;
+    } else if (ret == 1) {
+      /* A peak was found, the N_id_2 it belongs to is part of the cell id */
+      ret = srslte_sync_sl_get_cell_id(&q->ue_sl_sync.sfind);
+      if (ret >= 0) {
+        q->candidates[nof_detected_frames].cell_id = (uint32_t) ret;
+        q->candidates[nof_detected_frames].cp = srslte_sync_sl_get_cp(&q->ue_sl_sync.sfind);
+        q->candidates[nof_detected_frames].peak = q->ue_sl_sync.sfind.psss.peak_value;
+        q->candidates[nof_detected_frames].psr = srslte_sync_sl_get_peak_value(&q->ue_sl_sync.sfind);
+        q->candidates[nof_detected_frames].cfo = 15000 * srslte_sync_sl_get_cfo(&q->ue_sl_sync.sfind);
+        DEBUG("CELL SEARCH: [%3d/%3d/%d]: Found peak PSR=%.3f, Cell_id: %d CP: %s\n",
+              nof_detected_frames, nof_scanned_frames, q->nof_valid_frames,
+              q->candidates[nof_detected_frames].psr, q->candidates[nof_detected_frames].cell_id,
+              srslte_cp_string(q->candidates[nof_detected_frames].cp));
+
+        nof_detected[ret / 168]++;
+        nof_detected_frames++;
+      }
     }
-    nof_detected_cells += ret;
+
+    nof_scanned_frames++;
+
+  } while (nof_scanned_frames < q->max_frames &&
+           nof_detected[0] < q->nof_valid_frames && nof_detected[1] < q->nof_valid_frames);
+
+  srslte_ue_sl_sync_set_N_id_2_joint(&q->ue_sl_sync, false);
+
+  // Group the candidates by N_id_2 while keeping their order, get_cell() takes the last PSR and CFO
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < nof_detected_frames; i++) {
+    if (q->candidates[i].cell_id / 168 == 0) {
+      srslte_ue_cellsearch_result_t c = q->candidates[i];
+      memmove(&q->candidates[n + 1], &q->candidates[n], sizeof(srslte_ue_cellsearch_result_t) * (i - n));
+      q->candidates[n++] = c;
+    }
+  }
+
+  srslte_ue_cellsearch_result_t *candidates = q->candidates;
+  for (uint32_t N_id_2 = 0; N_id_2 < 2; N_id_2++) {
+    if (nof_detected[N_id_2] > 0) {
+      get_cell(q, candidates, nof_detected[N_id_2], &found_cells[N_id_2]);
+      nof_detected_cells++;
+    }
+    candidates += nof_detected[N_id_2];
+
     if (max_N_id_2) {
       if (found_cells[N_id_2].peak > max_peak_value) {
         max_peak_value = found_cells[N_id_2].peak;
@@ -365,7 +423,7 @@ int srslte_ue_sl_cellsearch_scan_N_id_2(srslte_ue_sl_cellsearch_t * q,
     if (nof_detected_frames > 0) {
       ret = 1;      // A cell has been found.  
       if (found_cell) {
-        get_cell(q, nof_detected_frames, found_cell);        
+        get_cell(q, q->candidates, nof_detected_frames, found_cell);        
       }
     } else {
       ret = 0;      // A cell was not found. 
@@ -139,6 +139,7 @@ int srslte_ue_sl_mib_init(srslte_ue_sl_mib_t * q,
       fprintf(stderr, "Error initializing reference signal\n");
       goto clean_exit;
     }
+    q->pscch_corr_threshold = SRSLTE_UE_SL_PSCCH_CORR_THRESHOLD;
     srslte_ue_sl_mib_reset(q);
     
     ret = SRSLTE_SUCCESS;
@@ -464,6 +465,96 @@ int srslte_ue_sl_pssch_decode(srslte_ue_sl_mib_t * q,
 
 
 
+/**
+ * @brief Sets the DMRS correlation a subchannel needs to be decoded, 0 disables the pre-filter
+ */
+void srslte_ue_sl_mib_set_pscch_corr_threshold(srslte_ue_sl_mib_t * q, float threshold)
+{
+  q->pscch_corr_threshold = threshold;
+}
+
+
+/**
+ * @brief Blind PSCCH decoding of several subchannels of the current subframe
+ * 
+ * The DMRS correlation of all candidates is computed in one pass over the
+ * PSCCH reference symbols. Only candidates above the threshold go through
+ * channel estimation, LLR extraction and viterbi decoding, which are run
+ * back-to-back with the same PSCCH decoder. FFT must already have been done.
+ * 
+ * If repo is given, candidates are decoded in order and a valid SCI-1 marks
+ * the following candidates of its allocation as covered, they only carry
+ * PSSCH and are neither decoded nor reported.
+ * 
+ * @param q 
+ * @param repo resource pool of the candidates, may be NULL
+ * @param prb_offset first PRB of each candidate
+ * @param nof_candidates 
+ * @param candidates results, one per candidate
+ * @return number of candidates with valid CRC, or an error code
+ */
+int srslte_ue_sl_pscch_decode_multi(srslte_ue_sl_mib_t * q,
+                                    srslte_repo_t *repo,
+                                    const uint32_t *prb_offset,
+                                    uint32_t nof_candidates,
+                                    srslte_ue_sl_pscch_candidate_t *candidates)
+{
+  float corr[SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES];
+  cf_t * ce[SRSLTE_MAX_PORTS];
+  srslte_ra_sl_sci_t sci;
+  uint32_t covered_end = 0;
+  int nof_decoded = 0;
+
+  if (q == NULL || prb_offset == NULL || candidates == NULL ||
+      nof_candidates > SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (srslte_chest_sl_pscch_dmrs_corr(&q->chest, q->sf_symbols, SRSLTE_SL_MODE_4, prb_offset, nof_candidates, corr)) {
+    return SRSLTE_ERROR;
+  }
+
+  ce[0] = q->ce;
+
+  for (uint32_t i=0; i<nof_candidates; i++) {
+    srslte_ue_sl_pscch_candidate_t *c = &candidates[i];
+
+    c->prb_offset     = prb_offset[i];
+    c->corr           = corr[i];
+    c->noise_estimate = 0;
+    c->covered        = prb_offset[i] < covered_end;
+    c->detected       = !c->covered && corr[i] >= q->pscch_corr_threshold;
+    c->crc_ok         = false;
+    c->crc            = 0;
+
+    if (!c->detected) {
+      continue;
+    }
+
+    srslte_chest_sl_estimate_pscch(&q->chest, q->sf_symbols, q->ce, SRSLTE_SL_MODE_4, prb_offset[i]);
+    c->noise_estimate = srslte_chest_sl_get_noise_estimate(&q->chest);
+
+    if (srslte_pscch_extract_llr(&q->pscch, q->sf_symbols, ce, c->noise_estimate, 0, prb_offset[i])) {
+      fprintf(stderr, "Error extracting LLRs\n");
+      return SRSLTE_ERROR;
+    }
+
+    if (SRSLTE_SUCCESS == srslte_pscch_dci_decode(&q->pscch, q->pscch.llr, c->data, q->pscch.max_bits, SRSLTE_SCI1_MAX_BITS, &c->crc)) {
+      c->crc_ok = true;
+      nof_decoded++;
+
+      // skip the remaining subchannels of an allocation starting here
+      if (repo != NULL && SRSLTE_SUCCESS == srslte_repo_sci_decode(repo, c->data, &sci) &&
+          prb_offset[i] == repo->rp.startRB_Subchannel_r14 + sci.frl_n_subCH*repo->rp.sizeSubchannel_r14) {
+        covered_end = prb_offset[i] + sci.frl_L_subCH*repo->rp.sizeSubchannel_r14;
+      }
+    }
+  }
+
+  return nof_decoded;
+}
+
+
 /**
  * @brief Trys to find a valid PSCCH and decodes the adjacent PSSCH
  * 
@@ -488,10 +579,8 @@ int srslte_ue_sl_pscch_decode(srslte_ue_sl_mib_t * q,
                   int *n_decoded_bytes)
 {
   int ret = SRSLTE_SUCCESS;
-  uint8_t mdata[SRSLTE_SCI1_MAX_BITS + 16];
   uint16_t crc_rem = 0xdead;
   srslte_ra_sl_sci_t sci;
-  cf_t * ce[4];
 
   /* Run FFT for the slot symbols */
   srslte_ofdm_rx_sf(&q->fft);
@@ -503,28 +592,31 @@ int srslte_ue_sl_pscch_decode(srslte_ue_sl_mib_t * q,
   // apply normalization
   rssi_freq -= q->fft.fft_plan.norm ? 0.0 : 10*log10(q->fft.fft_plan.size);
 
-  ce[0] = q->ce;
   *n_decoded_bytes = 0;
 
-  // try to decode PSCCH for each subchannel
-  for(int rbp=0; rbp<repo->rp.numSubchannel_r14; rbp++) {
+  uint32_t prb_offset[SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES];
+  srslte_ue_sl_pscch_candidate_t candidates[SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES];
+  uint32_t nof_candidates = SRSLTE_MIN(repo->rp.numSubchannel_r14, SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES);
 
-    uint32_t prb_offset = repo->rp.startRB_Subchannel_r14 + rbp*repo->rp.sizeSubchannel_r14;
+  for(int rbp=0; rbp<nof_candidates; rbp++) {
+    prb_offset[rbp] = repo->rp.startRB_Subchannel_r14 + rbp*repo->rp.sizeSubchannel_r14;
+  }
 
-    srslte_chest_sl_estimate_pscch(&q->chest, q->sf_symbols, q->ce, SRSLTE_SL_MODE_4, prb_offset);
+  if (srslte_ue_sl_pscch_decode_multi(q, repo, prb_offset, nof_candidates, candidates) < 0) {
+    fprintf(stderr, "Error decoding PSCCH\n");
+    return -1;
+  }
 
-    if (srslte_pscch_extract_llr(&q->pscch, q->sf_symbols, 
-                        ce,
-                        srslte_chest_sl_get_noise_estimate(&q->chest),
-                        0 %10, prb_offset)) {
-      fprintf(stderr, "Error extracting LLRs\n");
-      return -1;
-    }
+  // try to decode PSCCH for each subchannel
+  for(int rbp=0; rbp<nof_candidates; rbp++) {
 
-    if(SRSLTE_SUCCESS != srslte_pscch_dci_decode(&q->pscch, q->pscch.llr, mdata, q->pscch.max_bits, SRSLTE_SCI1_MAX_BITS, &crc_rem)) {
+    if (!candidates[rbp].crc_ok) {
       continue;
     }
 
+    uint8_t *mdata = candidates[rbp].data;
+    crc_rem = candidates[rbp].crc;
+
     if(SRSLTE_SUCCESS != srslte_repo_sci_decode(repo, mdata, &sci)) {
       continue;
     }
@@ -540,7 +632,7 @@ int srslte_ue_sl_pscch_decode(srslte_ue_sl_mib_t * q,
             sci.mcs.idx,
             sci.rti);
 
-    printf("DECODED PSCCH  N_X_ID: %x  n0: %f\n", crc_rem, srslte_chest_sl_get_noise_estimate(&q->chest));
+    printf("DECODED PSCCH  N_X_ID: %x  n0: %f\n", crc_rem, candidates[rbp].noise_estimate);
 
     printf("RSSI | t-domain: %f dBm | f-domain: %f dBm\n", rssi_time, rssi_freq);
 
@@ -560,6 +560,13 @@ void srslte_ue_sl_sync_set_N_id_2(srslte_ue_sl_sync_t *q, uint32_t N_id_2) {
   }
 }
 
+void srslte_ue_sl_sync_set_N_id_2_joint(srslte_ue_sl_sync_t *q, bool enable) {
+  if (!q->file_mode) {
+    srslte_ue_sl_sync_reset(q);
+    srslte_sync_sl_set_N_id_2_joint(&q->sfind, enable);
+  }
+}
+
 void srslte_ue_sl_sync_set_agc_period(srslte_ue_sl_sync_t *q, uint32_t period) {
   q->agc_period = period;
 }
@@ -604,7 +611,7 @@ static int find_peak_ok(srslte_ue_sl_sync_t *q, cf_t *input_buffer[SRSLTE_MAX_PO
     q->mean_sample_offset = 0; 
 
     /* Goto Tracking state if cell ID is known already */
-    printf("TODO: q->cell.id %d\n", q->cell.id);
+    DEBUG("TODO: q->cell.id %d\n", q->cell.id);
     if (q->cell.id < 1000) {
       q->state = SF_TRACK;
     }
@@ -165,6 +165,12 @@ int srslte_ue_sl_tx_init(srslte_ue_sl_tx_t *q,
       perror("malloc");
       goto clean_exit; 
     }
+
+    q->sync_sf = srslte_vec_malloc(MAX_SFLEN * sizeof(cf_t));
+    if (!q->sync_sf) {
+      perror("malloc");
+      goto clean_exit;
+    }
     q->out_buffer = out_buffer;
     q->signals_pregenerated = false; 
     ret = SRSLTE_SUCCESS;
@@ -210,6 +216,9 @@ void srslte_ue_sl_tx_free(srslte_ue_sl_tx_t *q) {
     if (q->srs_signal) {
       free(q->srs_signal);
     }
+    if (q->sync_sf) {
+      free(q->sync_sf);
+    }
     if (q->signals_pregenerated) {
       srslte_refsignal_dmrs_pusch_pregen_free(&q->signals, &q->pregen_drms);
       srslte_refsignal_srs_pregen_free(&q->signals, &q->pregen_srs);
@@ -276,6 +285,7 @@ int srslte_ue_sl_tx_set_cell(srslte_ue_sl_tx_t *q,
       srslte_ssss_generate(q->ssss_signal, q->cell.id);
 
       q->signals_pregenerated = false;
+      q->sync_sf_ready = false;
     }
     ret = SRSLTE_SUCCESS;
   } else {
@@ -311,6 +321,77 @@ void srslte_ue_sl_tx_apply_norm(srslte_ue_sl_tx_t *q, uint32_t nof_prb) {
   }
 }
 
+/* Generates the sync subframe for the given DFN/DSFN in the output buffer.
+ * PSSS, SSSS and the PSBCH DMRS do not change between sync periods, so they
+ * are modulated once per cell and kept in the time domain. Each call copies
+ * them and only adds the modulated PSBCH symbols on top.
+ */
+int srslte_ue_sl_tx_sync_sf(srslte_ue_sl_tx_t *q, uint32_t dfn, uint32_t dsfn)
+{
+  if (q == NULL || q->cell.nof_prb == 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t nof_symbols = 2 * SRSLTE_CP_NSYMB(q->cell.cp);
+  uint32_t nof_re      = q->cell.nof_prb * SRSLTE_NRE;
+
+  if (!q->sync_sf_ready) {
+    bzero(q->sf_symbols, sizeof(cf_t) * CURRENT_SFLEN_RE);
+    srslte_psss_put_sf(q->psss_signal, q->sf_symbols, q->cell.nof_prb, q->cell.cp);
+    srslte_ssss_put_sf(q->ssss_signal, q->sf_symbols, q->cell.nof_prb, q->cell.cp);
+    srslte_refsignal_sl_dmrs_psbch_put(&q->signals, SRSLTE_SL_MODE_4, q->psbch_dmrs, q->sf_symbols);
+
+    srslte_ofdm_tx_sf(&q->fft);
+    memcpy(q->sync_sf, q->out_buffer, sizeof(cf_t) * CURRENT_SFLEN);
+    bzero(q->sf_symbols, sizeof(cf_t) * CURRENT_SFLEN_RE);
+    q->sync_sf_ready = true;
+  }
+
+  memcpy(q->out_buffer, q->sync_sf, sizeof(cf_t) * CURRENT_SFLEN);
+
+  srslte_psbch_mib_pack(&q->cell, dfn, dsfn, q->bch_payload);
+
+  cf_t *sf_symbols[SRSLTE_MAX_PORTS] = {q->sf_symbols};
+  if (srslte_psbch_encode(&q->psbch, q->bch_payload, sf_symbols)) {
+    return SRSLTE_ERROR;
+  }
+
+  for (uint32_t l = 0; l < nof_symbols; l++) {
+    if (srslte_psbch_is_symbol(l)) {
+      srslte_ofdm_tx_symbol_add(&q->fft, l);
+      bzero(&q->sf_symbols[l * nof_re + nof_re / 2 - 36], sizeof(cf_t) * 6 * SRSLTE_NRE);
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+/* Modulates a PSCCH/PSSCH subframe that only occupies PRBs [prb_start,
+ * prb_start + nof_prb) of the grid. Normalization to nof_prb and the CFO, if
+ * enabled, are applied within the same pass as the OFDM scaling. The used REs
+ * are cleared afterwards, so the next subframe starts from an empty grid.
+ */
+int srslte_ue_sl_tx_modulate(srslte_ue_sl_tx_t *q, uint32_t prb_start, uint32_t nof_prb, float cfo)
+{
+  if (q == NULL || prb_start + nof_prb > q->cell.nof_prb) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  float scale = 1.0f;
+  if (q->normalize_en && nof_prb > 0) {
+    scale = (float) q->cell.nof_prb/15/sqrtf(nof_prb);
+  }
+
+  srslte_ofdm_tx_sf_prb(&q->fft, prb_start, nof_prb, q->cfo_en ? cfo : 0.0f, scale);
+
+  uint32_t nof_re = q->cell.nof_prb * SRSLTE_NRE;
+  for (uint32_t l = 0; l < 2 * SRSLTE_CP_NSYMB(q->cell.cp); l++) {
+    bzero(&q->sf_symbols[l * nof_re + prb_start * SRSLTE_NRE], sizeof(cf_t) * nof_prb * SRSLTE_NRE);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 #if 0
 // (rl, merge_19_06) 
 /* Precalculate the PUSCH scramble sequences for a given RNTI. This function takes a while
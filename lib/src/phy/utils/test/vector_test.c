@@ -334,6 +334,25 @@ float squared_error (cf_t a, cf_t b) {
      free(x);
      free(y);)
 
+ TEST(
+     srslte_vec_acc_power_seg_cf, MALLOC(cf_t, x); MALLOC(float, z);
+
+     // segments of one 5 PRB subchannel
+     uint32_t seg_len = (block_size < 60) ? block_size : 60;
+     uint32_t nof_seg = block_size / seg_len;
+
+     for (int i = 0; i < block_size; i++) { x[i] = RANDOM_CF(); }
+
+     TEST_CALL(bzero(z, sizeof(float) * nof_seg); srslte_vec_acc_power_seg_cf(x, seg_len, nof_seg, z))
+
+         for (int i = 0; i < nof_seg; i++) {
+           float gold = srslte_vec_avg_power_cf(&x[i * seg_len], seg_len) * seg_len;
+           mse += fabsf(gold - z[i]) / gold;
+         } mse /= nof_seg;
+
+     free(x);
+     free(z);)
+
  TEST(
      srslte_vec_prod_ccc, MALLOC(cf_t, x); MALLOC(cf_t, y); MALLOC(cf_t, z);
 
@@ -692,6 +711,24 @@ float squared_error (cf_t a, cf_t b) {
       free(x);
       free(z);)
 
+ TEST(srslte_vec_apply_cfo_scale, MALLOC(cf_t, x); MALLOC(cf_t, z);
+
+      const float cfo = 0.1f;
+      const cf_t  h   = RANDOM_CF();
+      cf_t        gold;
+      for (int i = 0; i < block_size; i++) { x[i] = RANDOM_CF(); }
+
+      // unaligned on purpose, the transmitter applies it to single symbols
+      TEST_CALL(srslte_vec_apply_cfo_scale(&x[1], cfo, h, &z[1], block_size - 1))
+
+          for (int i = 1; i < block_size; i++) {
+            gold = h * x[i] * cexpf(_Complex_I * 2.0f * (float)M_PI * (i - 1) * cfo);
+            mse += cabsf(gold - z[i]) / cabsf(gold);
+          } mse /= block_size;
+
+      free(x);
+      free(z);)
+
  TEST(
      srslte_vec_gen_sine, MALLOC(cf_t, z);
 
@@ -824,6 +861,10 @@ float squared_error (cf_t a, cf_t b) {
          test_srslte_vec_dot_prod_conj_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
      func_count++;
 
+     passed[func_count][size_count] = test_srslte_vec_acc_power_seg_cf(
+         func_names[func_count], &timmings[func_count][size_count], block_size);
+     func_count++;
+
      passed[func_count][size_count] =
          test_srslte_vec_convert_fi(func_names[func_count], &timmings[func_count][size_count], block_size);
      func_count++;
@@ -882,6 +923,10 @@ float squared_error (cf_t a, cf_t b) {
     passed[func_count][size_count] = test_srslte_vec_apply_cfo(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_apply_cfo_scale(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_gen_sine(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
@@ -400,6 +400,10 @@ float srslte_vec_avg_power_cf(const cf_t *x, const uint32_t len) {
   return crealf(srslte_vec_dot_prod_conj_ccc(x,x,len)) / len;
 }
 
+void srslte_vec_acc_power_seg_cf(const cf_t *x, const uint32_t seg_len, const uint32_t nof_seg, float *acc) {
+  srslte_vec_acc_power_seg_cf_simd(x, seg_len, nof_seg, acc);
+}
+
 // Correlation assumes zero-mean x and y
 float srslte_vec_corr_ccc(const cf_t *x, cf_t *y, const uint32_t len) {
 //  return crealf(srslte_vec_dot_prod_conj_ccc(x,y,len)) / len;
@@ -512,6 +516,10 @@ void srslte_vec_apply_cfo(const cf_t *x, float cfo, cf_t *z, int len) {
   srslte_vec_apply_cfo_simd(x, cfo, z, len);
 }
 
+void srslte_vec_apply_cfo_scale(const cf_t *x, float cfo, cf_t h, cf_t *z, int len) {
+  srslte_vec_apply_cfo_scale_simd(x, cfo, h, z, len);
+}
+
 float srslte_vec_estimate_frequency(const cf_t* x, int len)
 {
   return srslte_vec_estimate_frequency_simd(x, len);
@@ -552,6 +552,46 @@ float srslte_vec_acc_ff_simd(const float *x, const int len) {
   return acc_sum;
 }
 
+void srslte_vec_acc_power_seg_cf_simd(const cf_t *x, const int seg_len, const int nof_seg, float *acc) {
+  const float *f = (const float *) x;
+
+  for (int s = 0; s < nof_seg; s++, f += 2 * seg_len) {
+    int i = 0;
+    float acc_sum = 0.0f;
+
+#if SRSLTE_SIMD_F_SIZE
+    simd_f_t simd_sum = srslte_simd_f_zero();
+
+    // each complex sample is two floats, the squares of both add up to the power
+    if (SRSLTE_IS_ALIGNED(f)) {
+      for (; i < 2 * seg_len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
+        simd_f_t a = srslte_simd_f_load(&f[i]);
+
+        simd_sum = srslte_simd_f_add(simd_sum, srslte_simd_f_mul(a, a));
+      }
+    } else {
+      for (; i < 2 * seg_len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
+        simd_f_t a = srslte_simd_f_loadu(&f[i]);
+
+        simd_sum = srslte_simd_f_add(simd_sum, srslte_simd_f_mul(a, a));
+      }
+    }
+
+    __attribute__((aligned(SRSLTE_SIMD_F_SIZE*4))) float sum[SRSLTE_SIMD_F_SIZE];
+    srslte_simd_f_store(sum, simd_sum);
+    for (int k = 0; k < SRSLTE_SIMD_F_SIZE; k++) {
+      acc_sum += sum[k];
+    }
+#endif
+
+    for (; i < 2 * seg_len; i++) {
+      acc_sum += f[i] * f[i];
+    }
+
+    acc[s] += acc_sum;
+  }
+}
+
 cf_t srslte_vec_acc_cc_simd(const cf_t *x, const int len) {
   int i = 0;
   cf_t acc_sum = 0.0f;
@@ -1578,6 +1618,12 @@ void srslte_vec_gen_sine_simd(cf_t amplitude, float freq, cf_t* z, int len)
 }
 
 void srslte_vec_apply_cfo_simd(const cf_t *x, float cfo, cf_t *z, int len) {
+  srslte_vec_apply_cfo_scale_simd(x, cfo, 1.0f, z, len);
+}
+
+/* Same as srslte_vec_apply_cfo_simd() with the oscillator starting at h
+ * instead of 1, i.e. z[n] = h * x[n] * exp(j*2*pi*cfo*n) */
+void srslte_vec_apply_cfo_scale_simd(const cf_t *x, float cfo, cf_t h, cf_t *z, int len) {
   const float TWOPI = 2.0f * (float) M_PI;
   int i = 0;
 
@@ -1588,7 +1634,7 @@ void srslte_vec_apply_cfo_simd(const cf_t *x, float cfo, cf_t *z, int len) {
   if (i < len - SRSLTE_SIMD_CF_SIZE + 1) {
     for (int k = 0; k < SRSLTE_SIMD_CF_SIZE; k++) {
       _osc[k] = cexpf(_Complex_I * TWOPI * cfo * SRSLTE_SIMD_CF_SIZE);
-      _phase[k] = cexpf(_Complex_I * TWOPI * cfo * k);
+      _phase[k] = h * cexpf(_Complex_I * TWOPI * cfo * k);
     }
   }
   simd_cf_t _simd_osc = srslte_simd_cfi_load(_osc);
@@ -1606,20 +1652,18 @@ void srslte_vec_apply_cfo_simd(const cf_t *x, float cfo, cf_t *z, int len) {
 
     }
   } else {
-    for (; i < len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
-      for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
-        simd_cf_t a = srslte_simd_cfi_loadu(&x[i]);
+    for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+      simd_cf_t a = srslte_simd_cfi_loadu(&x[i]);
 
-        simd_cf_t r = srslte_simd_cf_prod(a, _simd_phase);
-        _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
+      simd_cf_t r = srslte_simd_cf_prod(a, _simd_phase);
+      _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
 
-        srslte_simd_cfi_storeu(&z[i], r);
-      }
+      srslte_simd_cfi_storeu(&z[i], r);
     }
   }
 #endif
   cf_t osc = cexpf(_Complex_I * TWOPI * cfo);
-  cf_t phase = cexpf(_Complex_I * TWOPI * cfo * i);
+  cf_t phase = h * cexpf(_Complex_I * TWOPI * cfo * i);
   for (; i < len; i++) {
     z[i] = x[i] * phase;
 
@@ -48,6 +48,15 @@
 #include "srslte/upper/rlc_um.h"
 #include "srslte/upper/rlc_am.h"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
 namespace srslte {
 
 rlc::rlc(log* log_) : rlc_log(log_)
@@ -362,20 +371,19 @@ int rlc::read_pdu_mch(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
   return ret;
 }
 
-void rlc::write_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
+void rlc::write_pdu_sl(uint32_t lcid, const srslte::sl_sdu_t& sdu)
 {
   if(lcid==1) {
     // write direct into socket and bypass rlc+ layers
-    pthread_rwlock_rdlock(&rwlock);
-    // make the hidden snr and sl id visible 
-    tcp_process_thread.send_packet(payload - 7, nof_bytes + 7);
-    pthread_rwlock_unlock(&rwlock);
+    tcp_process_thread.send_packet(sdu);
     return;
   }
 
+  // The rx metadata is only used by the LCID 1 bypass. The RLC entities and
+  // everything above them see the plain PDU, as for LTE.
   pthread_rwlock_rdlock(&rwlock);
   if (valid_lcid(lcid)) {
-    rlc_array.at(lcid)->write_pdu(payload, nof_bytes);
+    rlc_array.at(lcid)->write_pdu(sdu.msg, sdu.N_bytes);
   } else {
     rlc_log->warning("LCID %d doesn't exist. Dropping PDU.\n", lcid);
   }
@@ -675,94 +683,364 @@ bool rlc::valid_lcid_mrb(uint32_t lcid)
 
 
 /********************
- * udp socket class implementation
+ * application socket class implementation
  * *****************************/
 
-rlc::tcp_process::tcp_process(void) : thread("rlc::tcp_proc") {
-  pthread_mutex_init(&mutex, NULL);
-  pthread_cond_init(&cvar, NULL);
-  have_data = false; 
+rlc::tcp_process::tcp_process(void) : thread("rlc::tcp_proc"), started(false), running(false), tx_wakeup(false) {}
+
+rlc::tcp_process::~tcp_process()
+{
+  stop();
 }
 
-void rlc::tcp_process::init(int net_port) {
-  // mac_unit = mac_unit_;
+void rlc::tcp_process::init(int net_port)
+{
+  port     = net_port;
+  epoll_fd = epoll_create1(0);
+  event_fd = eventfd(0, EFD_NONBLOCK);
+  if (epoll_fd < 0 || event_fd < 0) {
+    perror("epoll/eventfd");
+    exit(-1);
+  }
 
-  printf("TCP: Looking for server on port %d\n", net_port);
-  if (srslte_netsink_init(&net_source, "127.0.0.1", net_port, SRSLTE_NETSINK_TCP)) {
-    fprintf(stderr, "Error source as server\n");
+  struct epoll_event ev = {};
+  ev.events             = EPOLLIN;
+  ev.data.fd            = event_fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) < 0) {
+    perror("epoll_ctl");
     exit(-1);
   }
-  srslte_netsink_set_nonblocking(&net_source);
+
+  printf("TCP: Looking for server on port %d\n", port);
+  running = true;
+  started = true;
   start(MAC_PDU_THREAD_PRIO);
 }
 
-
 void rlc::tcp_process::stop()
 {
-  pthread_mutex_lock(&mutex);
-  running = false; 
-  pthread_cond_signal(&cvar);
-  pthread_mutex_unlock(&mutex);
-  
+  // send_packet() stops queueing before the thread goes away
+  if (!started.exchange(false)) {
+    return;
+  }
+  running      = false;
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    perror("write");
+  }
   wait_thread_finish();
+
+  disconnect();
+  close(epoll_fd);
+  close(event_fd);
 }
 
-void rlc::tcp_process::notify()
+// Called from the MAC when it assembles a SL-SCH PDU. Hands out one message per
+// SDU, messages are never truncated or split.
+int rlc::tcp_process::get_packet(uint8_t *p_, uint32_t len_)
 {
-  pthread_mutex_lock(&mutex);
-  have_data = true; 
-  pthread_cond_signal(&cvar);
-  pthread_mutex_unlock(&mutex);
-}
+  if (len_ > max_sdu_space) {
+    max_sdu_space = len_;
+  }
 
-int rlc::tcp_process::get_packet(uint8_t *p_, uint32_t len_) {
-  if(recv_len > 0) {
-    if((int32_t)len_ > recv_len) {
-      printf("MAC requested %d bytes but RLC has only %d\n", len_, recv_len);
-      len_ = recv_len;
+  app_msg_t* msg;
+  while ((msg = to_mac.front()) != NULL) {
+    if (msg->len <= len_) {
+      int n = msg->len;
+      memcpy(p_, msg->data, msg->len);
+      to_mac.pop();
+      return n;
+    }
+    if (len_ < max_sdu_space) {
+      // might still fit as first SDU of the next PDU
+      return 0;
     }
-    memcpy(p_, recv_buffer, len_);
-    recv_len = 0;
-    return len_;
+    printf("TCP: Dropping %d byte message, SL-SCH PDU only has room for %d bytes\n", msg->len, len_);
+    to_mac.pop();
   }
   return 0;
 }
 
-// @todo: only copy buffer and let it the task send out
-void rlc::tcp_process::send_packet(uint8_t *p_, uint32_t len_) {
-  pthread_mutex_lock(&mutex);
-  srslte_netsink_write(&net_source, p_, len_);
-  pthread_mutex_unlock(&mutex);
+// Called from the MAC for every SDU received on LCID 1. Never blocks, the
+// message is written to the socket by the tcp_process thread.
+void rlc::tcp_process::send_packet(const srslte::sl_sdu_t& sdu)
+{
+  if (!started) {
+    return;
+  }
+
+  app_msg_t* msg = to_app.back();
+  if (msg == NULL || sdu.N_bytes > MAX_MSG_BYTES) {
+    printf("TCP: Cannot queue %d byte packet for the application, dropping it\n", sdu.N_bytes);
+    return;
+  }
+
+  uint32_t src_l2_id = sdu.meta ? sdu.meta->src_l2_id : 0;
+  float    snr       = sdu.meta ? sdu.meta->snr : 0;
+  uint32_t len       = RX_HDR_LEN + sdu.N_bytes;
+
+  msg->data[0] = (len >> 8) & 0xff;
+  msg->data[1] = len & 0xff;
+  msg->data[2] = (src_l2_id >> 16) & 0xff;
+  msg->data[3] = (src_l2_id >> 8) & 0xff;
+  msg->data[4] = src_l2_id & 0xff;
+  memcpy(&msg->data[5], &snr, sizeof(float));
+  memcpy(&msg->data[HDR_LEN + RX_HDR_LEN], sdu.msg, sdu.N_bytes);
+  msg->len = HDR_LEN + len;
+  to_app.push();
+
+  // only the first packet after the thread drained the queue needs to wake it up
+  if (!tx_wakeup.exchange(true)) {
+    uint64_t one = 1;
+    if (write(event_fd, &one, sizeof(one)) < 0) {
+      perror("write");
+    }
+  }
 }
 
-void rlc::tcp_process::run_thread()
+bool rlc::tcp_process::try_connect()
+{
+  sock_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (sock_fd < 0) {
+    perror("socket");
+    return false;
+  }
+  int enable = 1;
+  setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+  struct sockaddr_in addr = {};
+  addr.sin_family         = AF_INET;
+  addr.sin_addr.s_addr    = inet_addr("127.0.0.1");
+  addr.sin_port           = htons(port);
+
+  if (connect(sock_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+    connected = true;
+  } else if (errno == EINPROGRESS) {
+    connecting = true;
+  } else {
+    // server not up yet, retry later
+    close(sock_fd);
+    sock_fd = -1;
+    return false;
+  }
+
+  events = connected ? EPOLLIN : EPOLLOUT;
+  struct epoll_event ev = {};
+  ev.events             = events;
+  ev.data.fd            = sock_fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock_fd, &ev) < 0) {
+    perror("epoll_ctl");
+    disconnect();
+    return false;
+  }
+  return true;
+}
+
+void rlc::tcp_process::disconnect()
 {
-  running = true; 
-  while(running) {
-    
-    pthread_mutex_lock(&mutex);
+  if (sock_fd >= 0) {
+    // closing the socket also removes it from the epoll set
+    close(sock_fd);
+    sock_fd = -1;
+  }
+  connecting    = false;
+  connected     = false;
+  events        = 0;
+  rx_stream_len = 0;
+  rx_pending    = false;
+  tx_offset     = 0;
+}
 
-    if(recv_len <= 0) {
-      int b = srslte_netsink_read( &net_source, recv_buffer, 100);
-      if(b > 0) {
-        // printf("tcp_process: got %d bytes\n", b);
-        recv_len = b;
+void rlc::tcp_process::update_events()
+{
+  uint32_t want = 0;
+  if (connecting) {
+    want = EPOLLOUT;
+  } else if (connected) {
+    if (rx_stream_len < sizeof(rx_stream)) {
+      want |= EPOLLIN;
+    }
+    if (!to_app.empty()) {
+      want |= EPOLLOUT;
+    }
+  }
+  if (sock_fd >= 0 && want != events) {
+    struct epoll_event ev = {};
+    ev.events             = want;
+    ev.data.fd            = sock_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock_fd, &ev) < 0) {
+      perror("epoll_ctl");
+    }
+    events = want;
+  }
+}
 
+void rlc::tcp_process::handle_rx()
+{
+  while (rx_stream_len < sizeof(rx_stream)) {
+    uint32_t room = sizeof(rx_stream) - rx_stream_len;
+    ssize_t  n    = recv(sock_fd, &rx_stream[rx_stream_len], room, 0);
+    if (n > 0) {
+      rx_stream_len += n;
+      if ((uint32_t)n < room) {
+        break;
       }
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
     } else {
-      //make a dummy read to setup connection
-      srslte_netsink_read( &net_source, NULL, 0);
+      printf("Connection closed\n");
+      disconnect();
+      return;
+    }
+  }
+  parse_rx();
+}
+
+// Moves all complete messages from the stream buffer to the MAC queue
+void rlc::tcp_process::parse_rx()
+{
+  uint32_t pos = 0;
+  rx_pending   = false;
+  while (rx_stream_len - pos >= HDR_LEN) {
+    uint32_t len = ((uint32_t)rx_stream[pos] << 8) | rx_stream[pos + 1];
+    if (rx_stream_len - pos < HDR_LEN + len) {
+      break;
+    }
+    if (len > MAX_MSG_BYTES) {
+      printf("TCP: Dropping %d byte message, messages are limited to %d bytes\n", len, MAX_MSG_BYTES);
+    } else if (len > 0) {
+      app_msg_t* msg = to_mac.back();
+      if (msg == NULL) {
+        rx_pending = true;
+        break;
+      }
+      memcpy(msg->data, &rx_stream[pos + HDR_LEN], len);
+      msg->len = len;
+      to_mac.push();
+    }
+    pos += HDR_LEN + len;
+  }
+  if (pos > 0) {
+    memmove(rx_stream, &rx_stream[pos], rx_stream_len - pos);
+    rx_stream_len -= pos;
+  }
+}
+
+// Writes as many queued packets as the socket takes with one system call each
+// round, a partially written packet is continued on the next EPOLLOUT.
+void rlc::tcp_process::handle_tx()
+{
+  if (!connected) {
+    uint32_t n = to_app.size();
+    if (n > 0) {
+      printf("TCP: Not connected, dropping %d packets\n", n);
+      to_app.pop(n);
+    }
+    tx_offset = 0;
+    return;
+  }
+
+  while (true) {
+    struct iovec iov[MAX_TX_BATCH];
+    uint32_t     nof_iov = 0;
+    app_msg_t*   msg;
+    while (nof_iov < MAX_TX_BATCH && (msg = to_app.front(nof_iov)) != NULL) {
+      uint32_t offset       = nof_iov == 0 ? tx_offset : 0;
+      iov[nof_iov].iov_base = &msg->data[offset];
+      iov[nof_iov].iov_len  = msg->len - offset;
+      nof_iov++;
+    }
+    if (nof_iov == 0) {
+      return;
+    }
+
+    struct msghdr hdr = {};
+    hdr.msg_iov       = iov;
+    hdr.msg_iovlen    = nof_iov;
+    ssize_t n         = sendmsg(sock_fd, &hdr, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        printf("Connection closed\n");
+        disconnect();
+      }
+      return;
+    }
+
+    uint32_t done = 0;
+    size_t   left = n;
+    while (done < nof_iov && left >= iov[done].iov_len) {
+      left -= iov[done].iov_len;
+      done++;
+    }
+    to_app.pop(done);
+    tx_offset = (done == 0 ? tx_offset : 0) + left;
+    if (done < nof_iov) {
+      // socket buffer is full, wait for EPOLLOUT
+      return;
+    }
+  }
+}
+
+void rlc::tcp_process::run_thread()
+{
+  struct epoll_event ev[2];
+
+  while (running) {
+    if (sock_fd < 0) {
+      try_connect();
+    }
+
+    int timeout = -1;
+    if (sock_fd < 0) {
+      timeout = RECONNECT_MS;
+    } else if (rx_pending) {
+      // MAC queue is full, check again soon
+      timeout = 1;
+    }
+
+    int nof_events = epoll_wait(epoll_fd, ev, 2, timeout);
+    if (nof_events < 0 && errno != EINTR) {
+      perror("epoll_wait");
+      break;
+    }
+
+    for (int i = 0; i < nof_events; i++) {
+      if (ev[i].data.fd == event_fd) {
+        uint64_t cnt;
+        if (read(event_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+          perror("read");
+        }
+        tx_wakeup.store(false);
+        handle_tx();
+      } else if (connecting) {
+        int       err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(sock_fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+          disconnect();
+        } else {
+          connecting = false;
+          connected  = true;
+          handle_tx();
+        }
+      } else if (connected) {
+        if (ev[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+          handle_rx();
+        }
+        if (connected && (ev[i].events & EPOLLOUT)) {
+          handle_tx();
+        }
+      }
+    }
+
+    if (rx_pending) {
+      parse_rx();
     }
-    
-
-    // if(b>0) {
-    //   if(0 != recv_len){
-    //     printf("TCP: Packet overwritten %d bytes with %d bytes.\n", recv_len, b);
-    //   }
-    //   recv_len = b;
-    // }
-    pthread_mutex_unlock(&mutex);
-    usleep(900);
+    update_events();
   }
 }
 
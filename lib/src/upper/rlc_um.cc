@@ -830,6 +830,22 @@ void rlc_um::rlc_um_rx::reassemble_rx_sdus()
       pdu_lost = false;
     }
 
+    // A PDU carrying exactly one complete SDU is delivered in its rx window buffer, without copying it again
+    if (rx_sdu->N_bytes == 0 && rx_window[vr_ur].header.N_li == 0 &&
+        rlc_um_start_aligned(rx_window[vr_ur].header.fi) && rlc_um_end_aligned(rx_window[vr_ur].header.fi)) {
+      log->info_hex(rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes, "%s Rx SDU vr_ur=%d (complete PDU)", get_rb_name(), vr_ur);
+      vr_ur_in_rx_sdu = vr_ur;
+      unique_byte_buffer_t sdu = std::move(rx_window[vr_ur].buf);
+      sdu->set_timestamp();
+      if(cfg.is_mrb){
+        pdcp->write_pdu_mch(lcid, std::move(sdu));
+      } else {
+        pdcp->write_pdu(lcid, std::move(sdu));
+      }
+      pdu_lost = false;
+      goto clean_up_rx_window;
+    }
+
     // Handle last segment
     if (rx_sdu->N_bytes == 0 && rx_window[vr_ur].header.N_li == 0 && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
       log->warning("Dropping PDU %d due to lost start segment\n", vr_ur);
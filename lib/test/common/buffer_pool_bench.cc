@@ -0,0 +1,283 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srslte/common/buffer_pool.h"
+#include "srslte/common/spsc_queue.h"
+#include "srslte/phy/utils/debug.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/*
+ * Measures allocate/deallocate of the byte buffer pool from several threads.
+ * Each pair of threads runs two patterns: both allocate bursts and release
+ * them again themselves, then one thread allocates and hands the buffers over
+ * to the other, which releases them, like the stack does from PDCP to RLC.
+ * With -o some buffers stay allocated during the run, as in full RLC queues.
+ * Finally two threads free the same buffers at once, which must put every
+ * buffer back exactly once.
+ */
+
+using namespace srslte;
+
+uint32_t nof_threads = 2;
+uint32_t nof_allocs  = 1000000;
+uint32_t burst_len   = 16;
+uint32_t nof_held    = 0;
+
+#define HANDOVER_LEN 256
+#define MAX_THREADS 32
+
+typedef struct {
+  spsc_queue<byte_buffer_t*, HANDOVER_LEN> q;
+  bool                                     error;
+} pair_t;
+
+typedef struct {
+  pair_t*  pair;
+  uint32_t idx;
+} thread_args_t;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [tnbo]\n", prog);
+  printf("\t-t number of threads, rounded up to pairs [Default %d]\n", nof_threads);
+  printf("\t-n number of allocations per thread and pattern [Default %d]\n", nof_allocs);
+  printf("\t-b burst length [Default %d]\n", burst_len);
+  printf("\t-o number of buffers held during the run [Default %d]\n", nof_held);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "tnbo")) != -1) {
+    switch (opt) {
+      case 't':
+        nof_threads = atoi(argv[optind]);
+        break;
+      case 'n':
+        nof_allocs = atoi(argv[optind]);
+        break;
+      case 'b':
+        burst_len = atoi(argv[optind]);
+        break;
+      case 'o':
+        nof_held = atoi(argv[optind]);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  nof_threads = SRSLTE_MIN(2 * ((nof_threads + 1) / 2), MAX_THREADS);
+}
+
+void* local_thread(void* a)
+{
+  thread_args_t*    args = (thread_args_t*)a;
+  byte_buffer_pool* pool = byte_buffer_pool::get_instance();
+  byte_buffer_t*    burst[burst_len];
+
+  for (uint32_t i = 0; i < nof_allocs; i += burst_len) {
+    for (uint32_t j = 0; j < burst_len; j++) {
+      burst[j] = pool->allocate("bench", true);
+      if (burst[j] == NULL) {
+        args->pair->error = true;
+        return NULL;
+      }
+      burst[j]->N_bytes = j;
+    }
+    for (uint32_t j = 0; j < burst_len; j++) {
+      pool->deallocate(burst[j]);
+    }
+  }
+  return NULL;
+}
+
+void* handover_thread(void* a)
+{
+  thread_args_t*    args = (thread_args_t*)a;
+  byte_buffer_pool* pool = byte_buffer_pool::get_instance();
+
+  for (uint32_t i = 0; i < nof_allocs; i++) {
+    if (args->idx == 0) {
+      byte_buffer_t** slot;
+      while ((slot = args->pair->q.back()) == NULL) {
+        sched_yield();
+      }
+      *slot = pool->allocate("bench", true);
+      if (*slot == NULL) {
+        args->pair->error = true;
+      }
+      args->pair->q.push();
+    } else {
+      byte_buffer_t** slot;
+      while ((slot = args->pair->q.front()) == NULL) {
+        sched_yield();
+      }
+      pool->deallocate(*slot);
+      args->pair->q.pop();
+    }
+  }
+  return NULL;
+}
+
+bool run(const char* name, void* (*fn)(void*), pair_t* pairs)
+{
+  pthread_t      threads[nof_threads];
+  thread_args_t  args[nof_threads];
+  struct timeval t[3];
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    args[i].pair = &pairs[i / 2];
+    args[i].idx  = i % 2;
+    pthread_create(&threads[i], NULL, fn, &args[i]);
+  }
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  double secs = t[0].tv_sec + t[0].tv_usec * 1e-6;
+  printf("%-9s %d threads, %d held: %7.1f ns per allocate/deallocate\n",
+         name,
+         nof_threads,
+         nof_held,
+         secs * 1e9 / nof_allocs / nof_threads);
+
+  for (uint32_t i = 0; i < nof_threads / 2; i++) {
+    if (pairs[i].error) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#define DOUBLE_FREE_ROUNDS 1000
+#define DOUBLE_FREE_LEN 64
+
+typedef struct {
+  buffer_pool<byte_buffer_t>* pool;
+  byte_buffer_t**             bufs;
+  pthread_barrier_t*          barrier;
+  uint32_t                    nof_freed;
+} double_free_args_t;
+
+void* double_free_thread(void* a)
+{
+  double_free_args_t* args = (double_free_args_t*)a;
+  for (uint32_t r = 0; r < DOUBLE_FREE_ROUNDS; r++) {
+    pthread_barrier_wait(args->barrier);
+    for (uint32_t i = 0; i < DOUBLE_FREE_LEN; i++) {
+      args->nof_freed += args->pool->deallocate(args->bufs[i]);
+    }
+    pthread_barrier_wait(args->barrier);
+  }
+  return NULL;
+}
+
+bool double_free()
+{
+  buffer_pool<byte_buffer_t> pool(DOUBLE_FREE_LEN * 4);
+  byte_buffer_t*             bufs[DOUBLE_FREE_LEN];
+  pthread_barrier_t          barrier;
+  pthread_barrier_init(&barrier, NULL, 3);
+
+  double_free_args_t args[2];
+  pthread_t          threads[2];
+  for (uint32_t i = 0; i < 2; i++) {
+    args[i].pool      = &pool;
+    args[i].bufs      = bufs;
+    args[i].barrier   = &barrier;
+    args[i].nof_freed = 0;
+    pthread_create(&threads[i], NULL, double_free_thread, &args[i]);
+  }
+
+  bool ok = true;
+  for (uint32_t r = 0; r < DOUBLE_FREE_ROUNDS; r++) {
+    for (uint32_t i = 0; i < DOUBLE_FREE_LEN; i++) {
+      bufs[i] = pool.allocate("double_free");
+      ok      = ok && bufs[i] != NULL;
+    }
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier);
+    ok = ok && args[0].nof_freed + args[1].nof_freed == (r + 1) * DOUBLE_FREE_LEN;
+    ok = ok && pool.nof_available_pdus() == DOUBLE_FREE_LEN * 4;
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_barrier_destroy(&barrier);
+
+  // A buffer put back twice would be handed out twice
+  byte_buffer_t* all[DOUBLE_FREE_LEN * 4];
+  for (uint32_t i = 0; i < DOUBLE_FREE_LEN * 4; i++) {
+    all[i] = pool.allocate("double_free");
+    for (uint32_t j = 0; j < i && ok; j++) {
+      ok = all[i] != all[j];
+    }
+  }
+  for (uint32_t i = 0; i < DOUBLE_FREE_LEN * 4; i++) {
+    pool.deallocate(all[i]);
+  }
+
+  printf("double free %d rounds: %s\n", DOUBLE_FREE_ROUNDS, ok ? "every buffer freed once" : "pool corrupted");
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  static pair_t pairs[MAX_THREADS / 2];
+  for (uint32_t i = 0; i < nof_threads / 2; i++) {
+    pairs[i].error = false;
+  }
+
+  byte_buffer_pool* pool = byte_buffer_pool::get_instance();
+  byte_buffer_t*    held[nof_held];
+  for (uint32_t i = 0; i < nof_held; i++) {
+    held[i] = pool->allocate("held");
+  }
+
+  bool ok = run("local", local_thread, pairs);
+  ok      = ok && run("handover", handover_thread, pairs);
+  ok      = ok && double_free();
+
+  for (uint32_t i = 0; i < nof_held; i++) {
+    pool->deallocate(held[i]);
+  }
+  byte_buffer_pool::cleanup();
+
+  if (!ok) {
+    printf("Error allocating buffers\n");
+    exit(-1);
+  }
+  printf("Ok\n");
+  exit(0);
+}
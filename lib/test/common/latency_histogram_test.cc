@@ -0,0 +1,89 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+#include "srslte/common/latency_histogram.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TESTASSERT(cond)                                                                                               \
+  {                                                                                                                    \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]: FAIL at %s\n", __FUNCTION__, __LINE__, (#cond));                                         \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  }
+
+using namespace srslte;
+
+int test_buckets()
+{
+  // every value lands in a bucket whose range contains it, within 12.5%
+  uint32_t prev = 0;
+  for (uint64_t v = 0; v <= 0xffffffffu; v = v < 100 ? v + 1 : v + v / 97) {
+    uint32_t idx = latency_histogram::bucket_idx((uint32_t)v);
+    TESTASSERT(idx < latency_histogram::NOF_BUCKETS);
+    TESTASSERT(idx >= prev);
+    TESTASSERT(latency_histogram::bucket_max(idx) >= v);
+    TESTASSERT(idx == 0 || latency_histogram::bucket_max(idx - 1) < v);
+    TESTASSERT(latency_histogram::bucket_max(idx) <= v + v / 8);
+    prev = idx;
+  }
+  TESTASSERT(latency_histogram::bucket_idx(0xffffffffu) == latency_histogram::NOF_BUCKETS - 1);
+  return 0;
+}
+
+int test_percentiles()
+{
+  latency_histogram h;
+  uint32_t          counts[latency_histogram::NOF_BUCKETS];
+
+  bzero(counts, sizeof(counts));
+  h.accumulate(counts);
+  TESTASSERT(latency_histogram::percentile(counts, 0.5f) == 0);
+
+  for (uint32_t i = 1; i <= 1000; i++) {
+    h.add(i * 1000);
+  }
+  bzero(counts, sizeof(counts));
+  h.accumulate(counts);
+
+  uint32_t p50 = latency_histogram::percentile(counts, 0.50f);
+  uint32_t p99 = latency_histogram::percentile(counts, 0.99f);
+  uint32_t max = latency_histogram::percentile(counts, 1.0f);
+  TESTASSERT(p50 >= 500000 && p50 <= 500000 + 500000 / 8);
+  TESTASSERT(p99 >= 990000 && p99 <= 990000 + 990000 / 8);
+  TESTASSERT(max >= 1000000 && max <= 1000000 + 1000000 / 8);
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  if (test_buckets()) {
+    return -1;
+  }
+  if (test_percentiles()) {
+    return -1;
+  }
+  printf("Ok\n");
+  return 0;
+}
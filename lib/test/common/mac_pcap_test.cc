@@ -0,0 +1,203 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srslte/common/mac_pcap.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define NOF_WRITERS 4
+#define NOF_PDUS 20000
+#define PDU_LEN 100
+#define LONG_PDU_LEN (SRSLTE_MAX_BUFFER_SIZE_BYTES + 100)
+
+#define TESTASSERT(cond)                                                                                               \
+  {                                                                                                                    \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]: FAIL at %s\n", __FUNCTION__, __LINE__, (#cond));                                         \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  }
+
+using namespace srslte;
+
+static const char* filename = "/tmp/mac_pcap_test.pcap";
+
+typedef struct {
+  mac_pcap* pcap;
+  uint32_t  id;
+} writer_args_t;
+
+void* write_thread(void* a)
+{
+  writer_args_t* args = (writer_args_t*)a;
+  uint8_t        pdu[PDU_LEN];
+  memset(pdu, 0, sizeof(pdu));
+  for (uint32_t i = 0; i < NOF_PDUS; i++) {
+    pdu[0] = (uint8_t)args->id;
+    memcpy(&pdu[1], &i, sizeof(i));
+    args->pcap->write_dl_crnti(pdu, PDU_LEN, 0x10 + args->id, true, i % 10240);
+  }
+  return NULL;
+}
+
+// Runs all writers concurrently and returns the number of PDUs dropped. With
+// close_after_us the capture is closed while the writers are still running,
+// as the stack does while the PHY is still up.
+static uint32_t run_writers(mac_pcap* pcap, int close_after_us = -1)
+{
+  pthread_t     threads[NOF_WRITERS];
+  writer_args_t args[NOF_WRITERS];
+  for (uint32_t i = 0; i < NOF_WRITERS; i++) {
+    args[i].pcap = pcap;
+    args[i].id   = i;
+    pthread_create(&threads[i], NULL, write_thread, &args[i]);
+  }
+  if (close_after_us >= 0) {
+    usleep(close_after_us);
+    pcap->close();
+  }
+  for (uint32_t i = 0; i < NOF_WRITERS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  return pcap->get_nof_dropped();
+}
+
+// Reads back the capture, checks every record and returns their number
+static int read_file(uint32_t* nof_long)
+{
+  FILE* f = fopen(filename, "r");
+  TESTASSERT(f != NULL);
+
+  pcap_hdr_t file_header;
+  TESTASSERT(fread(&file_header, sizeof(file_header), 1, f) == 1);
+  TESTASSERT(file_header.magic_number == 0xa1b2c3d4);
+  TESTASSERT(file_header.network == MAC_LTE_DLT);
+
+  // Records of one writer must come out in the order it wrote them
+  int64_t              last_seq[NOF_WRITERS];
+  int                  nof_records = 0;
+  pcaprec_hdr_t        packet_header;
+  std::vector<uint8_t> data;
+  for (uint32_t i = 0; i < NOF_WRITERS; i++) {
+    last_seq[i] = -1;
+  }
+  *nof_long = 0;
+  while (fread(&packet_header, sizeof(packet_header), 1, f) == 1) {
+    TESTASSERT(packet_header.incl_len <= packet_header.orig_len);
+    data.resize(packet_header.incl_len);
+    TESTASSERT(fread(data.data(), 1, packet_header.incl_len, f) == packet_header.incl_len);
+
+    MAC_Context_Info_t context = {};
+    uint8_t            context_header[MAC_LTE_MAX_CONTEXT_LEN];
+    uint32_t           context_len = LTE_PCAP_MAC_PackContext(&context, context_header);
+    if (packet_header.orig_len == context_len + LONG_PDU_LEN) {
+      (*nof_long)++;
+    } else {
+      TESTASSERT(packet_header.incl_len == context_len + PDU_LEN);
+      uint8_t  id = data[context_len];
+      uint32_t seq;
+      memcpy(&seq, &data[context_len + 1], sizeof(seq));
+      TESTASSERT(id < NOF_WRITERS);
+      TESTASSERT((int64_t)seq > last_seq[id]);
+      last_seq[id] = seq;
+    }
+    nof_records++;
+  }
+  fclose(f);
+  return nof_records;
+}
+
+int lossless_test()
+{
+  mac_pcap pcap;
+  pcap.set_drop_policy(mac_pcap::BLOCK);
+  pcap.open(filename);
+
+  TESTASSERT(run_writers(&pcap) == 0);
+
+  // Longer PDUs than a record holds are truncated but still written
+  std::vector<uint8_t> long_pdu(LONG_PDU_LEN, 0);
+  pcap.write_dl_crnti(long_pdu.data(), LONG_PDU_LEN, 0x10, true, 0);
+  pcap.close();
+
+  uint32_t nof_long = 0;
+  TESTASSERT(read_file(&nof_long) == NOF_WRITERS * NOF_PDUS + 1);
+  TESTASSERT(nof_long == 1);
+  return 0;
+}
+
+int drop_test()
+{
+  mac_pcap pcap;
+  pcap.set_drop_policy(mac_pcap::DROP_NEWEST);
+  pcap.open(filename);
+
+  uint32_t nof_dropped = run_writers(&pcap);
+  pcap.close();
+
+  // Nothing may get lost without being counted
+  uint32_t nof_long = 0;
+  int      nof_written = read_file(&nof_long);
+  printf("Dropped %d of %d PDUs\n", nof_dropped, NOF_WRITERS * NOF_PDUS);
+  TESTASSERT(nof_written + nof_dropped == NOF_WRITERS * NOF_PDUS);
+  return 0;
+}
+
+int close_test()
+{
+  mac_pcap pcap;
+  pcap.set_drop_policy(mac_pcap::BLOCK);
+  pcap.open(filename);
+
+  run_writers(&pcap, 2000);
+
+  // Whatever made it in before the close must be complete
+  uint32_t nof_long    = 0;
+  int      nof_written = read_file(&nof_long);
+  printf("Wrote %d of %d PDUs before closing\n", nof_written, NOF_WRITERS * NOF_PDUS);
+  TESTASSERT(nof_written >= 0 && nof_written <= NOF_WRITERS * NOF_PDUS);
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  if (lossless_test()) {
+    printf("Lossless test failed\n");
+    return -1;
+  }
+  if (drop_test()) {
+    printf("Drop test failed\n");
+    return -1;
+  }
+  if (close_test()) {
+    printf("Close test failed\n");
+    return -1;
+  }
+  remove(filename);
+  printf("Ok\n");
+  return 0;
+}
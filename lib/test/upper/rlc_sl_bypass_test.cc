@@ -0,0 +1,237 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include <arpa/inet.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "srslte/common/log_filter.h"
+#include "srslte/upper/rlc.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  {                                                                                                                    \
+    if (!(cond)) {                                                                                                     \
+      std::cout << "[" << __FUNCTION__ << "][Line " << __LINE__ << "]: FAIL at " << (#cond) << std::endl;              \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  }
+
+#define NOF_MSGS 10
+#define MSG_LEN 300
+#define PDU_LEN 1000
+#define BIG_MSG_LEN 2000
+#define NOF_RX_SDUS 128
+#define RX_BATCH 32
+#define RX_HDR_LEN 7
+#define TIMEOUT_MS 2000
+
+using namespace srslte;
+
+// Exercises the LCID 1 application bypass of the RLC against a local TCP
+// server standing in for the application.
+
+class mac_dummy_timers : public srslte::mac_interface_timers
+{
+public:
+  srslte::timers::timer* timer_get(uint32_t timer_id) { return &t; }
+  uint32_t               timer_get_unique_id() { return 0; }
+  void                   timer_release_id(uint32_t timer_id) {}
+
+private:
+  srslte::timers::timer t;
+};
+
+class rlc_tester : public srsue::pdcp_interface_rlc, public srsue::rrc_interface_rlc
+{
+public:
+  // PDCP interface
+  void write_pdu(uint32_t lcid, unique_byte_buffer_t sdu) {}
+  void write_pdu_bcch_bch(unique_byte_buffer_t sdu) {}
+  void write_pdu_bcch_dlsch(unique_byte_buffer_t sdu) {}
+  void write_pdu_pcch(unique_byte_buffer_t sdu) {}
+  void write_pdu_mch(uint32_t lcid, unique_byte_buffer_t sdu) {}
+
+  // RRC interface
+  void        max_retx_attempted() {}
+  std::string get_rb_name(uint32_t lcid) { return std::string(""); }
+};
+
+static int wait_fd(int fd, short events)
+{
+  struct pollfd p = {};
+  p.fd            = fd;
+  p.events        = events;
+  return poll(&p, 1, TIMEOUT_MS) == 1 ? 0 : -1;
+}
+
+static int read_all(int fd, uint8_t* p, uint32_t len)
+{
+  while (len > 0) {
+    if (wait_fd(fd, POLLIN)) {
+      return -1;
+    }
+    int n = read(fd, p, len);
+    if (n <= 0) {
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+// polls the MAC side until a message is handed out
+static int read_pdu_sl_wait(rlc* r, uint8_t* p, uint32_t len)
+{
+  for (int i = 0; i < TIMEOUT_MS; i++) {
+    int n = r->read_pdu_sl(1, p, len);
+    if (n > 0) {
+      return n;
+    }
+    usleep(1000);
+  }
+  return 0;
+}
+
+static void put_msg(uint8_t* p, uint32_t len, uint8_t seed)
+{
+  p[0] = (len >> 8) & 0xff;
+  p[1] = len & 0xff;
+  for (uint32_t i = 0; i < len; i++) {
+    p[2 + i] = seed + i;
+  }
+}
+
+int bypass_test()
+{
+  log_filter log1("RLC_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+
+  // the application server
+  int srv = socket(AF_INET, SOCK_STREAM, 0);
+  TESTASSERT(srv >= 0);
+  struct sockaddr_in addr = {};
+  socklen_t          alen = sizeof(addr);
+  addr.sin_family         = AF_INET;
+  addr.sin_addr.s_addr    = inet_addr("127.0.0.1");
+  addr.sin_port           = 0;
+  TESTASSERT(bind(srv, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+  TESTASSERT(listen(srv, 1) == 0);
+  TESTASSERT(getsockname(srv, (struct sockaddr*)&addr, &alen) == 0);
+
+  rlc_tester       tester;
+  mac_dummy_timers timers;
+  rlc              rlc1(&log1);
+  rlc1.init(&tester, &tester, &timers, 0, ntohs(addr.sin_port));
+
+  TESTASSERT(wait_fd(srv, POLLIN) == 0);
+  int app = accept(srv, NULL, NULL);
+  TESTASSERT(app >= 0);
+
+  // app -> UE: several messages in one write and an oversize one, which is dropped
+  uint8_t  tx[NOF_MSGS * (2 + MSG_LEN) + 2 + BIG_MSG_LEN + 2 + MSG_LEN];
+  uint32_t tx_len = 0;
+  for (int i = 0; i < NOF_MSGS; i++) {
+    put_msg(&tx[tx_len], MSG_LEN, i);
+    tx_len += 2 + MSG_LEN;
+  }
+  put_msg(&tx[tx_len], BIG_MSG_LEN, 0xbb);
+  tx_len += 2 + BIG_MSG_LEN;
+  put_msg(&tx[tx_len], MSG_LEN, NOF_MSGS);
+  tx_len += 2 + MSG_LEN;
+  TESTASSERT(write(app, tx, tx_len) == (int)tx_len);
+
+  uint8_t pdu[PDU_LEN];
+  uint8_t ref[2 + MSG_LEN];
+  TESTASSERT(read_pdu_sl_wait(&rlc1, pdu, PDU_LEN) == MSG_LEN);
+  put_msg(ref, MSG_LEN, 0);
+  TESTASSERT(memcmp(pdu, &ref[2], MSG_LEN) == 0);
+
+  // a message is never truncated, it waits for a larger SDU
+  TESTASSERT(rlc1.read_pdu_sl(1, pdu, MSG_LEN - 1) == 0);
+
+  for (int i = 1; i <= NOF_MSGS; i++) {
+    TESTASSERT(read_pdu_sl_wait(&rlc1, pdu, PDU_LEN) == MSG_LEN);
+    put_msg(ref, MSG_LEN, i);
+    TESTASSERT(memcmp(pdu, &ref[2], MSG_LEN) == 0);
+  }
+
+  // UE -> app: every SDU arrives with its length and rx header. The MAC must
+  // not queue more SDUs than the handoff holds before the thread drains it.
+  sl_rx_meta_t meta = {};
+  meta.src_l2_id    = 0x123456;
+  meta.snr          = 12.5;
+  uint8_t data[MSG_LEN];
+  for (uint32_t batch = 0; batch < NOF_RX_SDUS; batch += RX_BATCH) {
+    for (uint32_t i = batch; i < batch + RX_BATCH; i++) {
+      sl_sdu_t sdu;
+      memset(data, i, sizeof(data));
+      sdu.msg     = data;
+      sdu.N_bytes = 1 + i;
+      sdu.meta    = &meta;
+      rlc1.write_pdu_sl(1, sdu);
+    }
+
+    for (uint32_t i = batch; i < batch + RX_BATCH; i++) {
+      uint8_t rx[2 + RX_HDR_LEN + MSG_LEN];
+      float   snr;
+      TESTASSERT(read_all(app, rx, 2 + RX_HDR_LEN) == 0);
+      uint32_t len = (rx[0] << 8) | rx[1];
+      TESTASSERT(len == RX_HDR_LEN + 1 + i);
+      TESTASSERT(((rx[2] << 16) | (rx[3] << 8) | rx[4]) == 0x123456);
+      memcpy(&snr, &rx[5], sizeof(float));
+      TESTASSERT(snr == meta.snr);
+      TESTASSERT(read_all(app, &rx[2 + RX_HDR_LEN], len - RX_HDR_LEN) == 0);
+      for (uint32_t j = 0; j < 1 + i; j++) {
+        TESTASSERT(rx[2 + RX_HDR_LEN + j] == i);
+      }
+    }
+  }
+
+  // after stop() SDUs are ignored and stop() may be called again
+  rlc1.stop();
+  sl_sdu_t sdu = {data, 1, NULL};
+  rlc1.write_pdu_sl(1, sdu);
+  rlc1.stop();
+
+  close(app);
+  close(srv);
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  if (bypass_test()) {
+    printf("bypass_test failed\n");
+    return -1;
+  }
+  byte_buffer_pool::get_instance()->cleanup();
+
+  return 0;
+}
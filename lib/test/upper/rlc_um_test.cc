@@ -528,6 +528,75 @@ int reassmble_test2()
   return 0;
 }
 
+// PDUs that carry exactly one complete SDU are handed to PDCP in their rx
+// window buffer, the others are reassembled. Both must deliver the SDUs intact
+// and in order, and no buffer may be lost or freed twice.
+int complete_pdu_test()
+{
+  srslte::log_filter log1("RLC_UM_1");
+  srslte::log_filter log2("RLC_UM_2");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log2.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  log2.set_hex_limit(-1);
+  rlc_um_tester    tester;
+  mac_dummy_timers timers;
+
+  rlc_um rlc1(&log1, 3, &tester, &tester, &timers);
+  rlc_um rlc2(&log2, 3, &tester, &tester, &timers);
+
+  rlc_config_t cnfg = rlc_config_t::default_rlc_um_config(10);
+  TESTASSERT(rlc1.configure(cnfg) == true);
+  TESTASSERT(rlc2.configure(cnfg) == true);
+
+  // Complete, segmented over three PDUs, complete, complete
+  const uint32_t nof_sdus          = 4;
+  const uint32_t sdu_len[nof_sdus] = {100, 300, 100, 100};
+  byte_buffer_pool*     pool              = byte_buffer_pool::get_instance();
+  buffer_pool_metrics_t metrics;
+  pool->get_metrics(&metrics);
+  uint32_t nof_used = metrics.nof_used;
+  for (uint32_t i = 0; i < nof_sdus; i++) {
+    unique_byte_buffer_t sdu = srslte::allocate_unique_buffer(*pool, true);
+    for (uint32_t k = 0; k < sdu_len[i]; k++) {
+      sdu->msg[k] = i * 7 + k;
+    }
+    sdu->N_bytes = sdu_len[i];
+    rlc1.write_sdu(std::move(sdu));
+  }
+
+  // 2 bytes of header and 100 of payload per PDU
+  const int     max_pdus = 8;
+  byte_buffer_t pdu_bufs[max_pdus];
+  int           nof_pdus = 0;
+  while (rlc1.get_buffer_state() > 0 && nof_pdus < max_pdus) {
+    pdu_bufs[nof_pdus].N_bytes = rlc1.read_pdu(pdu_bufs[nof_pdus].msg, 102);
+    nof_pdus++;
+  }
+  TESTASSERT(nof_pdus == 6);
+
+  for (int i = 0; i < nof_pdus; i++) {
+    rlc2.write_pdu(pdu_bufs[i].msg, pdu_bufs[i].N_bytes);
+  }
+
+  TESTASSERT(tester.n_sdus == (int)nof_sdus);
+  for (uint32_t i = 0; i < nof_sdus; i++) {
+    TESTASSERT(tester.sdus[i]->N_bytes == sdu_len[i]);
+    for (uint32_t k = 0; k < sdu_len[i]; k++) {
+      TESTASSERT(tester.sdus[i]->msg[k] == (uint8_t)(i * 7 + k));
+    }
+    tester.sdus[i].reset();
+  }
+
+  // The rx window must not keep or double free any of the delivered buffers
+  rlc1.stop();
+  rlc2.stop();
+  pool->get_metrics(&metrics);
+  TESTASSERT(metrics.nof_used == nof_used);
+
+  return 0;
+}
+
 int main(int argc, char** argv)
 {
   if (basic_test()) {
@@ -554,5 +623,10 @@ int main(int argc, char** argv)
     return -1;
   }
   byte_buffer_pool::get_instance()->cleanup();
+
+  if (complete_pdu_test()) {
+    return -1;
+  }
+  byte_buffer_pool::get_instance()->cleanup();
 }
 
@@ -49,6 +49,9 @@
 #include "phy_common.h"
 #include "srslte/srslte.h"
 
+// numSubchannel-r14 allows at most 20 subchannels, each may carry a PSCCH
+#define SL_MAX_SCI_PER_SF 20
+
 namespace srsue {
 
 class cc_worker
@@ -92,6 +95,20 @@ public:
 
   void update_measurements();
   bool dump_subframe();
+
+  // processing time of each stage during the last work_sl_rx() in us
+  const float* get_sl_rx_stage_times() { return sl_rx_stage_us; }
+
+  // subchannels of the PSSCH sent by the last work_sl_tx(), L_subch is 0 if none was sent
+  void get_sl_tx_subchannels(uint32_t* n_subch, uint32_t* L_subch)
+  {
+    *n_subch = sl_tx_n_subch;
+    *L_subch = sl_tx_L_subch;
+  }
+
+  // Draw the random choices of this worker from its own generator instead of rand(),
+  // so that several UEs in one process are reproducible
+  void set_random_seed(uint32_t seed);
   void set_receive_time(srslte_timestamp_t tx_time);
   void set_receiver_gain(float rx_gain_from_sf_worker);
 
@@ -137,7 +154,8 @@ private:
   void                     parse_pucch_config(phy_interface_rrc_lte::phy_cfg_t* phy_cfg);
 
   /* Methods for sidleink */
-  bool decode_pscch_dl(srsue::mac_interface_phy_lte::mac_grant_dl_t* grant);
+  uint32_t decode_pscch_dl();
+  void sl_sci_to_mac_grant(srslte_ra_sl_sci_t* sci, srsue::mac_interface_phy_lte::mac_grant_dl_t* grant);
   int decode_pssch(srslte_ra_sl_sci_t *grant,
                     uint8_t *payload[SRSLTE_MAX_CODEWORDS],
                     srslte_softbuffer_rx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
@@ -150,6 +168,27 @@ private:
   } pending_sl_grant_t;
   pending_sl_grant_t pending_sl_grant[SRSLTE_MAX_CARRIERS]; // Only for the current TTI
 
+  // every subchannel may carry the PSCCH of a different UE
+  typedef struct {
+    srslte_ra_sl_sci_t                    sci;
+    uint16_t                              n_X_ID;
+    mac_interface_phy_lte::mac_grant_dl_t grant;
+  } pending_sl_sci_t;
+  pending_sl_sci_t pending_sl_sci[SL_MAX_SCI_PER_SF]; // Only for the current TTI
+  uint32_t         nof_pending_sl_sci;
+
+  float           sl_rx_stage_us[SL_RX_NOF_STAGES];
+  struct timespec sl_rx_stage_ts;
+  void            sl_rx_stage_reset();
+  void            sl_rx_stage_lap(sl_stage_t stage);
+
+  uint32_t sl_tx_n_subch;
+  uint32_t sl_tx_L_subch;
+
+  uint32_t     next_random();
+  bool         rand_seeded;
+  unsigned int rand_state;
+
   /* Common objects */
   phy_common*  phy;
   srslte::log* log_h;
@@ -183,10 +222,7 @@ private:
 
   /* SL */
   srslte_timestamp_t rx_time;
-  static uint32_t sps_rsrp_read_cnt;
-  static uint32_t sps_rssi_read_cnt;
-  bool last_decoding_successful;
-  bool last_decoding_successful_high_rsrp;
+  iq_capture::meta_t capture_meta;
   float agc_max_value;
   // this is the rx_gain
   float curr_rx_gain;
@@ -0,0 +1,122 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+/******************************************************************************
+ *  File:         iq_capture.h
+ *
+ *  Description:  Captures received subframes together with their sidelink
+ *                metadata. Workers copy a subframe into a preallocated ring,
+ *                a background thread appends it to one file per session, as
+ *                raw complex float samples or as a SigMF recording.
+ *****************************************************************************/
+
+#ifndef SRSUE_IQ_CAPTURE_H
+#define SRSUE_IQ_CAPTURE_H
+
+#include "srslte/common/mpsc_queue.h"
+#include "srslte/common/threads.h"
+#include "srslte/srslte.h"
+#include <atomic>
+#include <stdio.h>
+#include <string>
+
+namespace srsue {
+
+class iq_capture : public thread
+{
+public:
+  // Conditions under which a received subframe is captured, as a bit mask
+  typedef enum {
+    TRIGGER_DECODED   = 0x1, // PSSCH decoded with valid CRC
+    TRIGGER_CRC_FAIL  = 0x2, // PSSCH decoded with CRC error
+    TRIGGER_HIGH_RSSI = 0x4, // S-RSSI well above its average
+  } trigger_t;
+
+  typedef struct {
+    uint32_t tti;
+    time_t   rx_full_secs;
+    double   rx_frac_secs;
+    float    snr;
+    float    rsrp;
+    float    rssi;
+    float    rx_gain;
+    uint32_t frl_n_subch;
+    uint32_t frl_l_subch;
+    uint32_t triggers; // trigger_t conditions met by this subframe
+  } meta_t;
+
+  iq_capture();
+  ~iq_capture();
+
+  // Parses a comma separated list such as "decoded,crc_fail,high_rssi"
+  static uint32_t parse_triggers(const std::string& list);
+
+  // Starts a session. The files are named after filename and the start time
+  // and are only created once the first subframe is captured.
+  bool init(const std::string& filename, uint32_t triggers, bool sigmf, double center_freq_hz);
+  void stop();
+
+  uint32_t get_triggers() { return triggers; }
+
+  // Worker side, copies the subframe once. Returns false and counts the
+  // subframe as dropped if the writer has no free slot left.
+  bool     push(const meta_t* meta, const cf_t* samples, uint32_t nof_samples);
+  uint32_t get_nof_dropped() { return nof_dropped; }
+
+private:
+  static const uint32_t NOF_SLOTS        = 16;
+  static const uint32_t WRITER_PERIOD_US = 1000;
+
+  typedef struct {
+    meta_t   meta;
+    uint32_t nof_samples;
+    cf_t     samples[SRSLTE_SF_LEN_MAX];
+  } slot_t;
+  typedef srslte::mpsc_queue<slot_t, NOF_SLOTS> slot_queue_t;
+
+  void run_thread();
+  bool open_files(const slot_t* s);
+  void write_slot(const slot_t* s);
+  void close_files();
+
+  slot_queue_t*         slots;
+  std::atomic<bool>     running;
+  std::atomic<uint32_t> nof_dropped;
+  uint32_t              triggers;
+  bool                  sigmf;
+  double                center_freq_hz;
+  std::string           filename;
+
+  // Owned by the writer thread
+  FILE*       data_file;
+  FILE*       meta_file;
+  bool        open_failed;
+  uint64_t    nof_written_samples;
+  uint32_t    nof_written;
+  std::string sigmf_captures;
+};
+
+} // namespace srsue
+
+#endif // SRSUE_IQ_CAPTURE_H
@@ -48,9 +48,11 @@
 
 #define TX_MODE_CONTINUOUS 1
 
+#include "iq_capture.h"
 #include "ue_sl_sensing_sps.h"
 #include "phy_metrics.h"
 #include "srslte/common/gen_mch_tables.h"
+#include "srslte/common/latency_histogram.h"
 #include "srslte/common/log.h"
 #include "srslte/interfaces/common_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
@@ -59,6 +61,7 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <string.h>
+#include <atomic>
 #include <vector>
 
 namespace srsue {
@@ -114,13 +117,30 @@ public:
   float         inst_sps_rsrp[1000]; // stores sps_rsrp value, for REST SPS_RSRP purpose.
   float         inst_sps_rssi[1000]; // stores sps_rssi value, for REST SPS_RSSI purpose. 
 
+  // next write position in inst_sps_rsrp/inst_sps_rssi, shared by all workers
+  std::atomic<uint32_t> sps_rsrp_read_cnt;
+  std::atomic<uint32_t> sps_rssi_read_cnt;
+
   uint8_t pssch_fixed_i_mcs;
   uint32_t pssch_min_tbs;
 
-  cf_t*     noise_buffer;
-  float     tx_snr;
-  int8_t    n_subframes_to_dump;
-  int8_t    n_subframes_to_dump_special;
+  srslte_channel_awgn_t tx_awgn;        // noise on the allocated PRBs of SL transmissions
+  std::atomic<uint64_t> tx_awgn_stream; // one noise stream per transmission
+  float                 tx_snr;
+  // Remaining subframes to capture on PSSCH decoding and on high S-RSSI
+  std::atomic<int32_t> n_subframes_to_dump;
+  std::atomic<int32_t> n_subframes_to_dump_special;
+  iq_capture           capture;
+
+  // Turbo decoder threads shared by all workers, NULL if code blocks are decoded serially
+  srslte_tdec_pool_t* tdec_pool;
+
+  // Processing time of the sidelink TTIs. Each sf_worker records into its own
+  // set of histograms, readers sum them up.
+  typedef struct {
+    srslte::latency_histogram stage[SL_NOF_STAGES];
+    std::atomic<uint32_t>     deadline_misses;
+  } sl_latency_t;
 
   // SCell EARFCN, PCI, configured and enabled list
   typedef struct {
@@ -207,6 +227,10 @@ public:
   void set_sync_metrics(const uint32_t& cc_idx, const sync_metrics_t& m);
   void get_sync_metrics(sync_metrics_t m[SRSLTE_MAX_CARRIERS]);
 
+  sl_latency_t* add_sl_latency();
+  // Latencies since the previous call, or since the start without affecting the former
+  void get_sl_latency_metrics(sl_latency_metrics_t* m, bool since_start = false);
+
   void reset();
 
   /* SCell Management */
@@ -287,6 +311,12 @@ private:
   uint32_t       sync_metrics_count;
   bool           sync_metrics_read;
 
+  sl_latency_t*         sl_latency;
+  std::atomic<uint32_t> nof_sl_latency;
+  pthread_mutex_t       sl_latency_mutex;
+  uint32_t              sl_latency_last[SL_NOF_STAGES][srslte::latency_histogram::NOF_BUCKETS];
+  uint32_t              sl_latency_last_misses;
+
   // MBSFN
   bool     sib13_configured;
   bool     mcch_configured;
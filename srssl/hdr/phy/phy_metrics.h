@@ -50,6 +50,41 @@
 
 namespace srsue {
 
+// Stages of a sidelink TTI whose processing time is measured. The stages up to
+// SL_STAGE_OTHER are measured inside cc_worker::work_sl_rx().
+typedef enum {
+  SL_STAGE_FFT = 0,
+  SL_STAGE_SENSING, // S-RSSI, PSSCH-RSRP and sensing bookkeeping
+  SL_STAGE_PSBCH,   // PSBCH channel estimation and decoding in sync subframes
+  SL_STAGE_CHEST,   // PSSCH channel estimation
+  SL_STAGE_PSCCH,   // PSCCH blind decoding, including its channel estimation
+  SL_STAGE_PSSCH,   // PSSCH demodulation and turbo decoding
+  SL_STAGE_MAC,     // new_grant_dl() and tb_decoded() callbacks into the MAC
+  SL_STAGE_OTHER,   // everything else in work_sl_rx()
+  SL_STAGE_TX,      // work_sl_tx(), PSCCH/PSSCH encoding
+  SL_STAGE_WAIT,    // worker_end(), waiting for the previous TTI and handing the samples to the radio
+  SL_STAGE_TTI,     // the whole TTI, from the start of the worker to the end of worker_end()
+  SL_NOF_STAGES
+} sl_stage_t;
+
+#define SL_RX_NOF_STAGES (SL_STAGE_OTHER + 1)
+
+inline const char* sl_stage_name(sl_stage_t stage)
+{
+  static const char* names[SL_NOF_STAGES] = {
+      "fft", "sensing", "psbch", "chest", "pscch", "pssch", "mac", "other", "tx", "wait", "tti"};
+  return (stage < SL_NOF_STAGES) ? names[stage] : "unknown";
+}
+
+struct sl_latency_metrics_t
+{
+  uint32_t count;           // TTIs processed
+  uint32_t deadline_misses; // TTIs whose samples were not handed to the radio within the TX_DELAY budget
+  float    p50_us[SL_NOF_STAGES];
+  float    p99_us[SL_NOF_STAGES];
+  float    max_us[SL_NOF_STAGES];
+};
+
 struct sync_metrics_t
 {
   float ta_us;
@@ -83,6 +118,8 @@ struct phy_metrics_t
   dl_metrics_t   dl[SRSLTE_MAX_CARRIERS];
   ul_metrics_t   ul[SRSLTE_MAX_CARRIERS];
   uint32_t       nof_active_cc;
+
+  sl_latency_metrics_t sl_latency;
 };
 
 } // namespace srsue
@@ -112,6 +112,7 @@ private:
 
   void update_measurements();
   void reset_uci(srslte_uci_data_t* uci_data);
+  void record_sl_latency(uint32_t tx_ns, uint32_t wait_ns, uint32_t tti_ns);
 
   std::vector<cc_worker*> cc_workers;
 
@@ -136,6 +137,8 @@ private:
   int                next_offset[SRSLTE_MAX_RADIOS];
 
   uint32_t rssi_read_cnt;
+
+  phy_common::sl_latency_t* sl_latency = nullptr;
 };
 
 } // namespace srsue
@@ -52,6 +52,7 @@
  *****************************************************************************/
 
 #include "srslte/srslte.h"
+#include <atomic>
 
 #ifndef SRSLTE_SL_SENSING_SPS_H
 #define SRSLTE_SL_SENSING_SPS_H
@@ -103,6 +104,17 @@ typedef struct {
 // The maximum number of candidate resources in a subframe
 #define MAX_CANDIDATE_RESOURCES (MAX_SUBCHANNELS)
 
+// Received reservations are projected this many TTIs into the future,
+// which covers the whole sensing window plus the selection window
+#define MAX_PROJECTION_DISTANCE (MAX_SENSING_WINDOW + MAX_SELECTION_WINDOW)
+// Number of projection buckets, needs to divide 10240 and be larger
+// than MAX_PROJECTION_DISTANCE
+#define PROJECTION_RING_SIZE 2560
+#define MAX_PROJECTIONS_IN_TTI 128
+
+// Upper bound of 3dB increments of the PSSCH-RSRP threshold
+#define MAX_THRESHOLD_STEPS 255
+
 namespace srslte {
 
 class SensingSPS;
@@ -115,6 +127,46 @@ typedef struct {
   float    rsrp;
 } SensingSCI;
 
+// A reservation of a received SCI which lands in a future TTI
+typedef struct {
+  uint16_t srcTti; // tti the SCI was received in
+  uint8_t  sci;    // index into the SCIs of srcTti
+  uint8_t  j;      // multiple of the reservation period
+} SensingProjection;
+
+// Sensing data received in one TTI. A slot is only written by the worker
+// processing that TTI, which makes the sequence number odd while it updates
+// the slot. Readers retry until they copied the slot without a concurrent
+// update (seqlock), so they never block the PHY.
+typedef struct {
+  std::atomic<uint32_t> seq;
+  uint32_t              tti;      // tti the slot currently holds
+  float                 avgSRssi; // -INFINITY if we did not monitor the subframe
+  float                 sRssi[MAX_SUBCHANNELS];
+  uint32_t              numScis;
+  SensingSCI            scis[MAX_SCIS_IN_TTI];
+} SensingSlot;
+
+// Consistent copy of the sensing data of one TTI, see SensingSPS::getSnapshot()
+typedef struct {
+  uint32_t   tti;
+  float      avgSRssi;
+  float      sRssi[MAX_SUBCHANNELS];
+  uint32_t   numScis;
+  SensingSCI scis[MAX_SCIS_IN_TTI];
+} SensingSnapshot;
+
+// Buckets are written with the same seqlock protocol as SensingSlot. All SCIs
+// projected into a bucket were received at least PStep TTIs apart, so as long
+// as fewer than PStep workers are in flight a bucket has a single writer too.
+typedef struct {
+  std::atomic<uint32_t> seq;
+  uint32_t          tti; // projected tti this bucket currently holds
+  uint32_t          numProjections;
+  bool              overflow;
+  SensingProjection projections[MAX_PROJECTIONS_IN_TTI];
+} SensingProjectionBucket;
+
 struct ReservationResource {
   uint32_t rsvpOffset;
   uint32_t subchannelStart;
@@ -149,45 +201,61 @@ typedef enum {
   CANDIDATE_CHOSEN,
 } CandidateResourceStatus;
 
-typedef struct {
-  CandidateResourceStatus     valid;
-  uint32_t subChannelStart;
-} CandidateResource;
+// Number of 64-bit words needed to hold one bit per candidate resource of a subframe
+#define CANDIDATE_WORDS ((MAX_CANDIDATE_RESOURCES + 63) / 64)
 
+// The candidate resources of a selection window. Resource (idx, channel) is the
+// resource in subframe idx of the selection window starting at subchannel channel.
+// Availability is kept as one bitmask per subframe, so that copies and
+// exclusions stay cheap. The reasons why candidates were excluded are only
+// tracked when debugging is enabled (phy.sensing_debug) and are only used by print().
 class CandidateResources {
   public:
-    CandidateResources() { }
+    CandidateResources() : windowSize(0), LSubCh(0), NSubCh(0) { }
 
     CandidateResources(uint32_t _windowSize,uint32_t _LSubCh,uint32_t _NSubCh);
  
     CandidateResources(const CandidateResources &other);
 
+    CandidateResources& operator=(const CandidateResources& other);
+
     uint32_t remove(uint32_t idx, CandidateResourceStatus reason);
 
     uint32_t remove(uint32_t idx, uint32_t channel, CandidateResourceStatus reason);
 
     uint32_t remove(uint32_t idx, uint32_t channel, uint32_t len, CandidateResourceStatus reason);
 
-    uint32_t size() { return setSize; }
+    uint32_t size() const;
+
+    bool valid(uint32_t idx, uint32_t channel) const { return (mask[idx][channel / 64] >> (channel % 64)) & 1; }
 
     void print(bool withRssi = false);
 
     void handleSrssi(SensingSPS* sps, uint32_t sensingWindowStart, uint32_t sensingWindowEnd, uint32_t t1, uint32_t t2, uint32_t MTotal);
 
-    void random(uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels);
-    void random_with_retx(uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels, uint32_t& sl_gap);
+    // rnd is a random number which selects one of the candidates
+    void random(uint32_t rnd, uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels);
+    void random_with_retx(uint32_t rnd, uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels, uint32_t& sl_gap);
+
+    // enables tracking of exclusion reasons and S-RSSI for print()
+    static void set_debug(bool enable) { debug = enable; }
 
   private:
     uint32_t windowSize;
     uint32_t LSubCh;
     uint32_t NSubCh;
-    uint32_t setSize;
 
-    uint32_t          numResources[MAX_SELECTION_WINDOW];
-    CandidateResource resources[MAX_SELECTION_WINDOW][MAX_CANDIDATE_RESOURCES];
+    // bit channel of mask[idx] is set while the candidate is valid
+    uint64_t mask[MAX_SELECTION_WINDOW][CANDIDATE_WORDS];
 
-    // for print() purposes only:
+    void clear(uint32_t idx, const uint64_t remove[CANDIDATE_WORDS], CandidateResourceStatus reason);
+
+    // S-RSSI ranking of the valid candidates, see handleSrssi()
     float avgRssi[MAX_SELECTION_WINDOW][MAX_CANDIDATE_RESOURCES];
+
+    // for print() purposes only:
+    static bool debug;
+    uint8_t     reasons[MAX_SELECTION_WINDOW][MAX_CANDIDATE_RESOURCES];
 };
 
 // @todo at the moment this only supports adjacent PSCCH transmissions
@@ -223,34 +291,35 @@ public:
   void addChannelSRSSI(uint32_t tti,uint32_t channel,float sRssi);
 
   CandidateResources resourceSelection(uint32_t tti, uint32_t t1, uint32_t t2, uint32_t LSubCh, uint32_t prioTx, uint32_t Cresel, uint32_t PrsvpTx);
-  ReservationResource* schedule(uint32_t tti, uint32_t bufferOccupancy);
 
-  void setTransmit(uint32_t tti, bool _transmit) { transmit[getIdx(tti)] = _transmit; }
-  bool getTransmit(uint32_t tti) { return transmit[getIdx(tti)]; }
-
-  uint32_t getLatestTti() { return latestTti; }
-  float getAverageSRSSI(uint32_t tti) {
-    return avgSRssi[getIdx(tti)];
-  }
+  // Reference implementation which scans the complete sensing window. sps_bench checks
+  // resourceSelection() against it. Its SCI scan removeScisFullScan() is also used by
+  // resourceSelection() when the projections of a subframe overflowed.
+  CandidateResources resourceSelectionFullScan(uint32_t tti, uint32_t t1, uint32_t t2, uint32_t LSubCh, uint32_t prioTx, uint32_t Cresel, uint32_t PrsvpTx);
+  ReservationResource* schedule(uint32_t tti, uint32_t bufferOccupancy);
 
-  float getAverageSRSRP(uint32_t tti) {
-    uint32_t idx = getIdx(tti);
+  void setTransmit(uint32_t tti, bool _transmit) { transmit[getIdx(tti)].store(_transmit, std::memory_order_relaxed); }
+  bool getTransmit(uint32_t tti) { return transmit[getIdx(tti)].load(std::memory_order_relaxed); }
 
-    for (uint32_t i = 0; i < numScis[idx];++i)
-    {
-      return scis[idx][i].rsrp; // @todo currently just return the 1st rsrp for the 1st SCI we find
-    }
-    return -INFINITY;
-  }
+  // The following getters may be called from any thread, e.g. the REST interface.
+  // They return -INFINITY if the slot of tti already holds a different TTI.
+  uint32_t getLatestTti() { return latestTti.load(std::memory_order_relaxed); }
+  float    getAverageSRSSI(uint32_t tti);
+  float    getAverageSRSRP(uint32_t tti); // @todo currently just the rsrp of the 1st SCI we find
 
-  float getSRSSI(uint32_t tti, uint32_t channel) {
-    uint32_t idx = getIdx(tti);
+  // Copies the first numSubChannels S-RSSI values and all SCIs of tti,
+  // returns false if the slot of tti already holds a different TTI
+  bool getSnapshot(uint32_t tti, uint32_t numSubChannels, SensingSnapshot* snapshot);
 
-    return sRssi[idx][channel];
-  }
+  // tti may carry add_tti_wrap(), only the index into the sensing data is used
+  float getSRSSI(uint32_t tti, uint32_t channel);
 
   void dummyRx(uint32_t tti);
 
+  // Draw the random choices from an own generator instead of rand(), so that
+  // several instances in one process are reproducible
+  void setRandomSeed(uint32_t seed);
+
 private:
   SL_CommResourcePoolV2X_r14* resourcePool;
   SL_CommTxPoolSensingConfig_r14* sensingConfig;
@@ -258,23 +327,65 @@ private:
   uint32_t sensingWindowSize;
   uint32_t currentPrsvpTx;
   
-  uint32_t latestTti; // only for REST interface
+  std::atomic<uint32_t> latestTti; // only for REST interface
 
-  uint32_t sensingWindowFilled;
+  std::atomic<uint32_t> sensingWindowFilled;
 
-  // SCIs received this TTI
-  uint32_t   numScis[MAX_SENSING_WINDOW];
-  SensingSCI scis[MAX_SENSING_WINDOW][MAX_SCIS_IN_TTI];
+  // S-RSSI measurements and SCIs, indexed by getIdx()
+  SensingSlot slots[MAX_SENSING_WINDOW];
 
-  uint32_t calc_reselection_counter(uint32_t rsvp) const;
+  bool         randSeeded;
+  unsigned int randState;
+  uint32_t     nextRandom();
 
-  // S-RSSI measurements
-  // Set to -INFINITY if it we did not monitor the subframe
-  float sRssi[MAX_SENSING_WINDOW][MAX_SUBCHANNELS];
-  float avgSRssi[MAX_SENSING_WINDOW];
+  uint32_t calc_reselection_counter(uint32_t rsvp);
+
+  void removeUnmonitored(CandidateResources& setA, uint32_t tti, int32_t z, uint32_t t1, uint32_t t2, uint32_t Cresel, uint32_t PrsvpPrime);
+  // removeScisFullScan() is the fallback of removeScisProjected() for overflowed subframes
+  CandidateResources removeScisFullScan(CandidateResources& setA, uint32_t tti, uint32_t t1, uint32_t t2, uint32_t prioTx, uint32_t Cresel, uint32_t MTotal);
+  CandidateResources removeScisProjected(CandidateResources& setA, uint32_t tti, uint32_t t1, uint32_t t2, uint32_t LSubCh, uint32_t prioTx, uint32_t Cresel, uint32_t MTotal);
 
   // Used to keep track of whether work_sl_tx() transmitted in a tti
-  bool transmit[MAX_SENSING_WINDOW];
+  std::atomic<bool> transmit[MAX_SENSING_WINDOW];
+
+  // Index of the sensing data, maintained by tick(), addSCI() and addAverageSRSSI()
+  // so that resourceSelection() does not need to scan the whole sensing window
+  std::atomic<uint64_t>   unmonitored[MAX_SENSING_WINDOW / 64]; // bit set if avgSRssi is -INFINITY
+  SensingProjectionBucket projections[PROJECTION_RING_SIZE];
+
+  void addProjection(uint32_t tti, uint32_t srcTti, uint32_t sci, uint32_t j);
+  void setMonitored(uint32_t tti, bool monitored);
+
+  uint32_t readScis(uint32_t idx, SensingSCI* scis);
+  bool     readSci(uint32_t srcTti, uint32_t sci, SensingSCI* out);
+
+  // seqlock protocol of SensingSlot and SensingProjectionBucket
+  template <typename T>
+  static void beginWrite(T* s)
+  {
+    s->seq.store(s->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  template <typename T>
+  static void endWrite(T* s)
+  {
+    s->seq.store(s->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // calls read() until it did not overlap with an update of s
+  template <typename T, typename F>
+  static void readConsistent(const T* s, F read)
+  {
+    uint32_t seq;
+    do {
+      while ((seq = s->seq.load(std::memory_order_acquire)) & 1) {
+        // writer is in the middle of an update
+      }
+      read();
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (s->seq.load(std::memory_order_relaxed) != seq);
+  }
 
   Reservation reservation;
 
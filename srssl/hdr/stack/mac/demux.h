@@ -78,8 +78,7 @@ public:
   uint8_t* request_buffer_bcch(uint32_t len);
   void     deallocate(uint8_t* payload_buffer_ptr);
 
-  // @todo (rl) fix  
-  void     push_pdu_sl(uint8_t *buff, uint32_t nof_bytes, uint32_t tstamp);
+  void     push_pdu_sl(uint8_t *buff, uint32_t nof_bytes, const srslte::sl_rx_meta_t& meta);
 
   void push_pdu(uint8_t* buff, uint32_t nof_bytes);
   void push_pdu_bcch(uint8_t* buff, uint32_t nof_bytes);
@@ -88,7 +87,7 @@ public:
 
   bool     get_uecrid_successful();
 
-  void     process_pdu(uint8_t* pdu, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel);
+  void     process_pdu(uint8_t* pdu, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel, const srslte::sl_rx_meta_t* sl_meta);
   void     mch_start_rx(uint32_t lcid);
 
 private:
@@ -97,7 +96,7 @@ private:
   uint8_t bcch_buffer[MAX_BCCH_PDU_LEN]; // BCCH PID has a dedicated buffer
   
   srslte::slsch_pdu sl_mac_msg;
-  void process_sl_sch_pdu(srslte::slsch_pdu *pdu);
+  void process_sl_sch_pdu(srslte::slsch_pdu *pdu, const srslte::sl_rx_meta_t* meta);
   
   srslte::sch_pdu mac_msg;
   srslte::mch_pdu mch_mac_msg;
@@ -60,6 +60,7 @@ struct mac_metrics_t
   int ul_buffer;
   float dl_retx_avg;
   float ul_retx_avg;
+  int pcap_dropped;
 };
 
 } // namespace srsue
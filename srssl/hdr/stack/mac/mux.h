@@ -131,6 +131,7 @@ private:
   /* PDU Buffer */
   srslte::sch_pdu pdu_msg;
   srslte::slsch_pdu sl_pdu_msg;
+  bool              sl_lcid1_unreserved = false; // last SL PDU ignored the lcid 3 reservation
 
   srslte::byte_buffer_t msg3_buff;
   bool                  msg3_has_been_transmitted = false;
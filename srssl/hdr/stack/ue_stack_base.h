@@ -59,6 +59,7 @@ namespace srsue {
 typedef struct {
   bool        enable;
   std::string filename;
+  std::string drop_policy;
   bool        nas_enable;
   std::string nas_filename;
 } pcap_args_t;
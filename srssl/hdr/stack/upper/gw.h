@@ -52,11 +52,15 @@
 #include "srslte/common/interfaces_common.h"
 #include "srslte/common/log.h"
 #include "srslte/common/log_filter.h"
+#include "srslte/common/spsc_queue.h"
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/ue_interfaces.h"
+#include "tft_classifier.h"
 #include "tft_packet_filter.h"
+#include <atomic>
 #include <mutex>
 #include <net/if.h>
+#include <semaphore.h>
 
 namespace srsue {
 
@@ -67,8 +71,15 @@ struct gw_args_t {
   } log;
   std::string tun_dev_name;
   std::string tun_dev_netmask;
+  uint32_t    tun_nof_queues;
 };
 
+/* Every TUN queue is served by its own reader thread, which reads packets in
+ * batches and hands them to the GW thread through a bounded lock-free queue.
+ * The GW thread applies the TFT and passes the packets to the stack. With more
+ * than one queue the device is opened with IFF_MULTI_QUEUE and the kernel
+ * spreads the flows over the queues.
+ */
 class gw : public gw_interface_stack, public thread
 {
 public:
@@ -94,7 +105,37 @@ public:
   // int setup_if_addr(uint32_t lcid, uint8_t pdn_type, uint32_t ip_addr, uint8_t* ipv6_if_addr, char* err_str);
 
 private:
-  static const int GW_THREAD_PRIO = 7;
+  static const int      GW_THREAD_PRIO      = 7;
+  static const uint32_t TUN_HANDOFF_LEN     = 256; // Packets per queue waiting for the GW thread
+  static const uint32_t TUN_BATCH_LEN       = 32;  // Packets read or forwarded per queue in one go
+  static const int      TUN_POLL_TIMEOUT_MS = 100;
+
+  class tun_reader : public thread
+  {
+  public:
+    tun_reader() : thread("GW_RX"), parent(NULL), fd(-1), full(false), ul_pkts(0), ul_bytes(0), ul_drops(0)
+    {
+      sem_init(&space_sem, 0, 0);
+    }
+    ~tun_reader() { sem_destroy(&space_sem); }
+
+    gw*     parent;
+    int32_t fd;
+    srslte::spsc_queue<srslte::unique_byte_buffer_t, TUN_HANDOFF_LEN> pdus;
+
+    // While the handoff queue is full the reader leaves the packets in the
+    // kernel and sleeps until the GW thread has made room
+    std::atomic<bool> full;
+    sem_t             space_sem;
+
+    // Written by the reader and the GW thread, read by the metrics thread
+    std::atomic<uint64_t> ul_pkts;
+    std::atomic<uint64_t> ul_bytes;
+    std::atomic<uint64_t> ul_drops;
+
+  private:
+    void run_thread() { parent->run_reader(this); }
+  };
 
   stack_interface_gw*       stack;
   srslte::byte_buffer_pool* pool;
@@ -104,7 +145,10 @@ private:
 
   bool                running;
   bool                run_enable;
-  int32_t             tun_fd;
+  int32_t             tun_fd; // Queue 0, used for all writes
+  uint32_t            nof_queues;
+  tun_reader          readers[GW_MAX_TUN_QUEUES];
+  sem_t               pdu_sem; // Posted by the readers after every batch
   struct ifreq        ifr;
   int32_t             sock;
   bool                if_up;
@@ -119,8 +163,15 @@ private:
   long                dl_tput_bytes;
   struct timeval      metrics_time[3];
 
+  std::atomic<uint64_t> dl_pkts;
+  std::atomic<uint64_t> dl_bytes;
+  std::atomic<uint64_t> dl_drops;
+
   void run_thread();
+  void run_reader(tun_reader* r);
+  void write_tun(srslte::unique_byte_buffer_t& pdu);
   int  init_if(char* err_str);
+  void close_if();
   int  setup_if_addr4(uint32_t ip_addr, char* err_str);
   int  setup_if_addr6(uint8_t* ipv6_if_id, char* err_str);
   bool find_ipv6_addr(struct in6_addr* in6_out);
@@ -131,10 +182,12 @@ private:
   struct   sockaddr_in mbsfn_sock_addr;     // Target address
   uint32_t mbsfn_ports[SRSLTE_N_MCH_LCIDS]; // Target ports for MBSFN data
 
-  // TFT
+  // TFT. The map is changed by NAS under the mutex and compiled into a new
+  // classifier after every change, the GW thread only uses the classifier.
   std::mutex                                      tft_mutex;
   typedef std::map<uint16_t, tft_packet_filter_t> tft_filter_map_t;
   tft_filter_map_t                                tft_filter_map;
+  tft_classifier_rcu                              tft_classifier_ptr;
 
   uint8_t check_tft_filter_match(const srslte::unique_byte_buffer_t& pdu);
 };
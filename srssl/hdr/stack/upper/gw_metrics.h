@@ -46,13 +46,31 @@
 #ifndef SRSUE_GW_METRICS_H
 #define SRSUE_GW_METRICS_H
 
+#include <stdint.h>
 
 namespace srsue {
 
+const uint32_t GW_MAX_TUN_QUEUES = 8;
+
+// Packets read from one TUN queue, counted since the interface came up
+struct gw_queue_metrics_t {
+  uint64_t ul_pkts;  // Handed to the stack
+  uint64_t ul_bytes;
+  uint64_t ul_drops; // Malformed or no active bearer
+};
+
 struct gw_metrics_t
 {
   double dl_tput_mbps;
   double ul_tput_mbps;
+
+  // Packets written to the TUN device, counted since the interface came up
+  uint64_t dl_pkts;
+  uint64_t dl_bytes;
+  uint64_t dl_drops;
+
+  uint32_t           nof_queues;
+  gw_queue_metrics_t queue[GW_MAX_TUN_QUEUES];
 };
 
 } // namespace srsue
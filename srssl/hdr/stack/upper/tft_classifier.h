@@ -0,0 +1,126 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#ifndef SRSUE_TFT_CLASSIFIER_H
+#define SRSUE_TFT_CLASSIFIER_H
+
+#include "tft_packet_filter.h"
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace srsue {
+
+/* TFT packet filters compiled for the uplink data path. The header fields the
+ * filters look at are extracted once per packet. Filters using the same set of
+ * components form a group, which is an exact-match hash table on those fields.
+ * Port ranges are not hashed but checked on the entries of the matching bucket.
+ * Groups are searched in order of their lowest precedence value, so the search
+ * ends as soon as no remaining group can beat the current match.
+ *
+ * The result is the same as walking the filters with tft_packet_filter_t::match
+ * in precedence order, for IPv4 and IPv6 packets. A classifier is never
+ * modified after it is built.
+ */
+class tft_classifier
+{
+public:
+  typedef std::map<uint16_t, tft_packet_filter_t> filter_map_t;
+
+  explicit tft_classifier(const filter_map_t& filter_map);
+
+  // Returns the first filter in precedence order matching the packet or NULL
+  const tft_packet_filter_t* match(const srslte::unique_byte_buffer_t& pdu) const;
+
+  uint32_t nof_filters() const { return filters.size(); }
+  uint32_t nof_groups() const { return groups.size(); }
+
+private:
+  // Header fields in packet byte order, except for the protocol and ToS
+  struct key_t {
+    uint32_t local_addr;
+    uint32_t remote_addr;
+    uint16_t local_port;
+    uint16_t remote_port;
+    uint8_t  protocol;
+    uint8_t  tos;
+
+    bool operator==(const key_t& other) const
+    {
+      return local_addr == other.local_addr && remote_addr == other.remote_addr && local_port == other.local_port &&
+             remote_port == other.remote_port && protocol == other.protocol && tos == other.tos;
+    }
+  };
+
+  struct key_hash {
+    size_t operator()(const key_t& k) const;
+  };
+
+  // Ranks (indices into filters) of all filters with the same key, in ascending order
+  typedef std::unordered_map<key_t, std::vector<uint32_t>, key_hash> table_t;
+
+  struct group_t {
+    uint16_t components; // Active filter components shared by all filters of the group
+    uint32_t best_rank;
+    bool     match_v6; // IPv6 packets never match a ToS component
+    table_t  v4_table;
+    table_t  v6_table; // Only the protocol is checked on IPv6 packets
+  };
+
+  static key_t make_key(const key_t& fields, uint16_t components);
+  static key_t filter_key(const tft_packet_filter_t& filter);
+
+  std::vector<tft_packet_filter_t> filters; // In precedence order
+  std::vector<group_t>             groups;  // Ordered by best_rank
+};
+
+/* Hands classifiers over to a single reader thread. The reader never blocks,
+ * the writer waits for the reader to leave the old classifier before freeing
+ * it. Writers must be serialized by the caller.
+ */
+class tft_classifier_rcu
+{
+public:
+  tft_classifier_rcu() : current(NULL), epoch(0) {}
+  ~tft_classifier_rcu() { delete current.load(); }
+
+  // The classifier stays valid until read_unlock(), NULL if none was published
+  const tft_classifier* read_lock()
+  {
+    epoch.fetch_add(1);
+    return current.load();
+  }
+  void read_unlock() { epoch.fetch_add(1); }
+
+  void publish(tft_classifier* classifier);
+
+private:
+  std::atomic<tft_classifier*> current;
+  std::atomic<uint64_t>        epoch; // Odd while the reader is inside
+};
+
+} // namespace srsue
+
+#endif // SRSUE_TFT_CLASSIFIER_H
@@ -108,7 +108,7 @@ public:
   uint8_t  ipv6_local_addr_length;
   uint8_t  protocol_id;
   uint16_t single_local_port;
-  uint16_t local_port_range[2];
+  uint16_t local_port_range[2]; // Host byte order, unlike the single ports
   uint16_t single_remote_port;
   uint16_t remote_port_range[2];
   uint32_t security_parameter_index;
@@ -49,6 +49,7 @@
 #include <stdint.h>
 
 #include "phy/phy_metrics.h"
+#include "srslte/common/buffer_pool.h"
 #include "srslte/common/metrics_hub.h"
 #include "srslte/radio/radio_metrics.h"
 #include "srslte/upper/rlc_metrics.h"
@@ -60,10 +61,11 @@
 namespace srsue {
 
 typedef struct {
-  mac_metrics_t         mac[SRSLTE_MAX_CARRIERS];
-  srslte::rlc_metrics_t rlc;
-  nas_metrics_t         nas;
-  rrc_metrics_t         rrc;
+  mac_metrics_t                 mac[SRSLTE_MAX_CARRIERS];
+  srslte::rlc_metrics_t         rlc;
+  nas_metrics_t                 nas;
+  rrc_metrics_t                 rrc;
+  srslte::buffer_pool_metrics_t pool;
 } stack_metrics_t;
 
 typedef struct {
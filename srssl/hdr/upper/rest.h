@@ -66,6 +66,40 @@ extern "C" {
 
 
 
+/*
+ * Binary frames streamed by GET /phy/SPS_stream, one per TTI in host byte order:
+ *
+ *   rest_stream_frame_hdr_t
+ *   float             sRssi[numSubChannels]   S-RSSI of each subchannel in dBm
+ *   rest_stream_sci_t scis[numScis]
+ *
+ * Query parameters:
+ *   since_tti=<tti>  only TTIs after tti are sent, clients pass the tti of the
+ *                    last frame they received. Without it the last 1000 TTIs are sent.
+ *   follow=1         keep the connection open and push new TTIs as they are processed
+ */
+#define REST_STREAM_MAGIC 0x5353 // "SS"
+
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint16_t tti;
+  uint8_t  numSubChannels;
+  uint8_t  numScis;
+  uint16_t length;    // of the whole frame in bytes
+  float    avgSRssi;  // dBm, -INFINITY if the subframe was not monitored
+  float    rssi;      // sidelink RSSI, latest value when the frame was sent
+  float    snrPsbch;  // latest value when the frame was sent
+  float    rsrpPsbch; // latest value when the frame was sent
+} rest_stream_frame_hdr_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t subChannelStart;
+  uint8_t numSubChannels;
+  uint8_t priority;
+  uint8_t rsvp;
+  float   rsrp; // PSSCH-RSRP in dBm
+} rest_stream_sci_t;
+
 class rest// : public thread
 {
 public:
@@ -138,8 +138,15 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     ("pcap.enable", bpo::value<bool>(&args->stack.pcap.enable)->default_value(false), "Enable MAC packet captures for wireshark")
     ("pcap.filename", bpo::value<string>(&args->stack.pcap.filename)->default_value("ue.pcap"), "MAC layer capture filename")
+    ("pcap.drop_policy", bpo::value<string>(&args->stack.pcap.drop_policy)->default_value("drop"), "MAC capture policy when the writer falls behind: drop or block")
     ("pcap.nas_enable",   bpo::value<bool>(&args->stack.pcap.nas_enable)->default_value(false), "Enable NAS packet captures for wireshark")
     ("pcap.nas_filename", bpo::value<string>(&args->stack.pcap.nas_filename)->default_value("ue_nas.pcap"), "NAS layer capture filename (useful when NAS encryption is enabled)")
+
+    ("capture.filename", bpo::value<string>(&args->phy.capture_filename)->default_value("iq_capture"), "IQ capture file name prefix, empty disables IQ captures")
+    ("capture.triggers", bpo::value<string>(&args->phy.capture_triggers)->default_value("decoded,crc_fail,high_rssi"), "Comma separated list of IQ capture triggers: decoded, crc_fail, high_rssi")
+    ("capture.sigmf", bpo::value<bool>(&args->phy.capture_sigmf)->default_value(true), "Write IQ captures as SigMF recording instead of raw samples")
+    ("capture.nof_subframes", bpo::value<int32_t>(&args->phy.capture_nof_subframes)->default_value(0), "Number of subframes to capture on PSSCH decoding, can be raised via REST")
+    ("capture.nof_subframes_high_rssi", bpo::value<int32_t>(&args->phy.capture_nof_subframes_high_rssi)->default_value(0), "Number of subframes to capture on high S-RSSI, can be raised via REST")
     
     ("gui.enable", bpo::value<bool>(&args->gui.enable)->default_value(false), "Enable GUI plots")
 
@@ -180,6 +187,7 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     ("gw.tun_dev_name", bpo::value<string>(&args->gw.tun_dev_name)->default_value("tun_srssl"), "Name of the tun_srssl device")
     ("gw.tun_dev_netmask", bpo::value<string>(&args->gw.tun_dev_netmask)->default_value("255.255.255.0"), "Netmask of the tun_srssl device")
+    ("gw.tun_nof_queues", bpo::value<uint32_t>(&args->gw.tun_nof_queues)->default_value(1), "Number of TUN queues, each served by its own reader thread (max 8)")
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable", bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false), "Enable/Disable internal Downlink channel emulator")
@@ -192,6 +200,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("channel.dl.rlf.enable", bpo::value<bool>(&args->phy.dl_channel_args.rlf_enable)->default_value(false), "Enable/Disable Radio-Link Failure simulator")
     ("channel.dl.rlf.t_on_ms", bpo::value<uint32_t >(&args->phy.dl_channel_args.rlf_t_on_ms)->default_value(10000), "Time for On state of the channel (ms)")
     ("channel.dl.rlf.t_off_ms", bpo::value<uint32_t >(&args->phy.dl_channel_args.rlf_t_off_ms)->default_value(2000), "Time for Off state of the channel (ms)")
+    ("channel.dl.path_loss.enable", bpo::value<bool>(&args->phy.dl_channel_args.path_loss_enable)->default_value(false), "Enable/Disable Path loss")
+    ("channel.dl.path_loss.db", bpo::value<float>(&args->phy.dl_channel_args.path_loss_db)->default_value(0.0f), "Path loss in dB")
+    ("channel.dl.awgn.enable", bpo::value<bool>(&args->phy.dl_channel_args.awgn_enable)->default_value(false), "Enable/Disable AWGN")
+    ("channel.dl.awgn.snr", bpo::value<float>(&args->phy.dl_channel_args.awgn_snr_db)->default_value(30.0f), "SNR in dB relative to a unit power signal")
 
     /* Uplink Channel emulator section */
     ("channel.ul.enable", bpo::value<bool>(&args->phy.ul_channel_args.enable)->default_value(false), "Enable/Disable internal Uplink channel emulator")
@@ -204,6 +216,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("channel.ul.rlf.enable", bpo::value<bool>(&args->phy.ul_channel_args.rlf_enable)->default_value(false), "Enable/Disable Radio-Link Failure simulator")
     ("channel.ul.rlf.t_on_ms", bpo::value<uint32_t >(&args->phy.ul_channel_args.rlf_t_on_ms)->default_value(10000), "Time for On state of the channel (ms)")
     ("channel.ul.rlf.t_off_ms", bpo::value<uint32_t >(&args->phy.ul_channel_args.rlf_t_off_ms)->default_value(2000), "Time for Off state of the channel (ms)")
+    ("channel.ul.path_loss.enable", bpo::value<bool>(&args->phy.ul_channel_args.path_loss_enable)->default_value(false), "Enable/Disable Path loss")
+    ("channel.ul.path_loss.db", bpo::value<float>(&args->phy.ul_channel_args.path_loss_db)->default_value(0.0f), "Path loss in dB")
+    ("channel.ul.awgn.enable", bpo::value<bool>(&args->phy.ul_channel_args.awgn_enable)->default_value(false), "Enable/Disable AWGN")
+    ("channel.ul.awgn.snr", bpo::value<float>(&args->phy.ul_channel_args.awgn_snr_db)->default_value(30.0f), "SNR in dB relative to a unit power signal")
 
     /* PHY section */
     ("phy.worker_cpu_mask",
@@ -258,6 +274,14 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<int>(&args->phy.nof_phy_threads)->default_value(3),
      "Number of PHY threads")
 
+    ("phy.pssch_decoder_threads",
+     bpo::value<int>(&args->phy.pssch_decoder_threads)->default_value(0),
+     "Number of threads shared by the PHY threads to decode the code blocks of a PSSCH TB in parallel, 0 to disable")
+
+    ("phy.sensing_debug",
+     bpo::value<bool>(&args->phy.sensing_debug)->default_value(false),
+     "Show exclusion reasons and S-RSSI in the Sensing SPS resource selection printout")
+
     ("phy.equalizer_mode",
      bpo::value<string>(&args->phy.equalizer_mode)->default_value("mmse"),
      "Equalizer mode")
@@ -446,6 +470,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     return SRSLTE_ERROR;
   }
 
+  // every UE and direction draws different channel noise
+  args->phy.dl_channel_args.awgn_seed = 2 * (uint32_t)args->phy.sidelink_id;
+  args->phy.ul_channel_args.awgn_seed = 2 * (uint32_t)args->phy.sidelink_id + 1;
+
   // Check conflicting OP/OPc options and which is being used
   if (vm.count("usim.op") && !vm["usim.op"].defaulted() && vm.count("usim.opc") && !vm["usim.opc"].defaulted()) {
     cout << "Conflicting options OP and OPc. Please configure either one or the other." << endl;
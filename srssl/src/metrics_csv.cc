@@ -95,7 +95,13 @@ void metrics_csv::set_metrics(ue_metrics_t &metrics, const uint32_t period_usec)
   pthread_mutex_lock(&mutex);
   if (file.is_open() && ue != NULL) {
     if(n_reports == 0) {
-      file << "time;rsrp;pl;cfo;dl_mcs;dl_snr;dl_turbo;dl_brate;dl_bler;ul_ta;ul_mcs;ul_buff;ul_brate;ul_bler;rf_o;rf_u;rf_l;is_attached\n";
+      file << "time;rsrp;pl;cfo;dl_mcs;dl_snr;dl_turbo;dl_brate;dl_bler;ul_ta;ul_mcs;ul_buff;ul_brate;ul_bler;rf_o;rf_u;rf_l;is_attached";
+      file << ";sl_ttis;sl_deadline_miss";
+      for (uint32_t s = 0; s < SL_NOF_STAGES; s++) {
+        const char* name = sl_stage_name((sl_stage_t)s);
+        file << ";" << name << "_p50_us;" << name << "_p99_us;" << name << "_max_us";
+      }
+      file << "\n";
     }
 
     file << (metrics_report_period * n_reports) << ";";
@@ -156,6 +162,15 @@ void metrics_csv::set_metrics(ue_metrics_t &metrics, const uint32_t period_usec)
     file << float_to_string(metrics.rf.rf_u, 2);
     file << float_to_string(metrics.rf.rf_l, 2);
     file << (metrics.stack.rrc.state == RRC_STATE_CONNECTED ? "1.0" : "0.0");
+
+    // Sidelink processing latency during this period
+    const sl_latency_metrics_t& lat = metrics.phy.sl_latency;
+    file << ";" << lat.count << ";" << lat.deadline_misses;
+    for (uint32_t s = 0; s < SL_NOF_STAGES; s++) {
+      file << ";" << float_to_string(lat.p50_us[s], 2, false);
+      file << ";" << float_to_string(lat.p99_us[s], 2, false);
+      file << ";" << float_to_string(lat.max_us[s], 2, false);
+    }
     file << "\n";
 
     n_reports++;
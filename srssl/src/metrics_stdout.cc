@@ -128,6 +128,15 @@ void metrics_stdout::set_metrics(ue_metrics_t &metrics, const uint32_t period_us
     cout << endl;
   }
 
+  // the pool no longer warns on every allocation when it runs low
+  if (metrics.stack.pool.high_water_mark >= metrics.stack.pool.capacity * 19 / 20) {
+    printf("Buffer pool: up to %d of %d buffers in use\n", metrics.stack.pool.high_water_mark, metrics.stack.pool.capacity);
+  }
+
+  if (metrics.stack.mac[0].pcap_dropped) {
+    printf("MAC PCAP: dropped %d PDUs\n", metrics.stack.mac[0].pcap_dropped);
+  }
+
   if (metrics.rf.rf_error) {
     printf("RF status: O=%d, U=%d, L=%d\n", metrics.rf.rf_o, metrics.rf.rf_u, metrics.rf.rf_l);
   }
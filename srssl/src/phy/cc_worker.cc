@@ -68,8 +68,6 @@ using namespace asn1::rrc;
 
 namespace srsue {
 
-uint32_t srsue::cc_worker::sps_rsrp_read_cnt = 0;
-uint32_t srsue::cc_worker::sps_rssi_read_cnt = 0;
 
 /************
  *
@@ -80,8 +78,17 @@ uint32_t srsue::cc_worker::sps_rssi_read_cnt = 0;
 cc_worker::cc_worker(uint32_t cc_idx, uint32_t max_prb, srsue::phy_common* phy, srslte::log* log_h)
 {
   ZERO_OBJECT(signal_buffer_rx);
+  ZERO_OBJECT(capture_meta);
   ZERO_OBJECT(signal_buffer_tx);
   ZERO_OBJECT(pending_dl_grant);
+  ZERO_OBJECT(pending_sl_sci);
+  nof_pending_sl_sci = 0;
+  ZERO_OBJECT(sl_rx_stage_us);
+  ZERO_OBJECT(sl_rx_stage_ts);
+  sl_tx_n_subch = 0;
+  sl_tx_L_subch = 0;
+  rand_seeded   = false;
+  rand_state    = 0;
   ZERO_OBJECT(cell);
   ZERO_OBJECT(sf_cfg_dl);
   ZERO_OBJECT(sf_cfg_ul);
@@ -349,51 +356,82 @@ void cc_worker::set_receiver_gain(float rx_gain_from_sf_worker)
   curr_rx_gain = rx_gain_from_sf_worker;
 }
 
-bool cc_worker::decode_pscch_dl(srsue::mac_interface_phy_lte::mac_grant_dl_t* grant)
+void cc_worker::set_random_seed(uint32_t seed)
 {
-  char timestr[64];
-  timestr[0]='\0';
+  rand_state  = seed;
+  rand_seeded = true;
+}
+
+uint32_t cc_worker::next_random()
+{
+  return rand_seeded ? (uint32_t)rand_r(&rand_state) : (uint32_t)rand();
+}
+
+void cc_worker::sl_rx_stage_reset()
+{
+  bzero(sl_rx_stage_us, sizeof(sl_rx_stage_us));
+  clock_gettime(CLOCK_MONOTONIC, &sl_rx_stage_ts);
+}
+
+// adds the time passed since the previous call to stage
+void cc_worker::sl_rx_stage_lap(sl_stage_t stage)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  sl_rx_stage_us[stage] += (now.tv_sec - sl_rx_stage_ts.tv_sec) * 1e6f + (now.tv_nsec - sl_rx_stage_ts.tv_nsec) / 1e3f;
+  sl_rx_stage_ts = now;
+}
 
+uint32_t cc_worker::decode_pscch_dl()
+{
   uint32_t tti = sf_cfg_dl.tti;
 
+  nof_pending_sl_sci = 0;
+
   Debug("decode_pscch_dl TTI: %d t_SL: %d\n", tti, phy->ue_repo.subframe_rp[tti]);
 
 #ifndef USE_SENSING_SPS
   // early completion in case of this subframe is not in resource pool
   if(phy->ue_repo.subframe_rp[tti] == -1) {
-    return false;
+    return 0;
   }
 #endif
 
-  uint8_t mdata[SRSLTE_SCI1_MAX_BITS + 16];
   uint16_t crc_rem = 0xdead;
   srslte_ra_sl_sci_t sci;
-  cf_t * ce[4];
   srslte_ue_sl_mib_t * q = &ue_sl;
 
+  uint32_t prb_offsets[SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES];
+  srslte_ue_sl_pscch_candidate_t candidates[SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES];
+  uint32_t nof_candidates = SRSLTE_MIN((uint32_t)phy->ue_repo.rp.numSubchannel_r14, SRSLTE_UE_SL_PSCCH_MAX_CANDIDATES);
 
-  ce[0] = q->ce;
-
+  for (uint32_t rbp = 0; rbp < nof_candidates; rbp++) {
+    prb_offsets[rbp] = phy->ue_repo.rp.startRB_Subchannel_r14 + rbp*phy->ue_repo.rp.sizeSubchannel_r14;
+  }
 
-    // try to decode PSCCH for each subchannel
-  for(int rbp=0; rbp < phy->ue_repo.rp.numSubchannel_r14; rbp++) {
+  sl_rx_stage_lap(SL_STAGE_OTHER);
 
-    uint32_t prb_offset = phy->ue_repo.rp.startRB_Subchannel_r14 + rbp*phy->ue_repo.rp.sizeSubchannel_r14;
+  // all subchannels are decoded in one batch, several UEs may share this subframe.
+  // Empty subchannels are skipped by a DMRS correlation pre-filter, subchannels
+  // inside an already decoded allocation are not decoded at all.
+  if (srslte_ue_sl_pscch_decode_multi(q, &phy->ue_repo, prb_offsets, nof_candidates, candidates) <= 0) {
+    sl_rx_stage_lap(SL_STAGE_PSCCH);
+    return 0;
+  }
 
-    srslte_chest_sl_estimate_pscch(&q->chest, q->sf_symbols, q->ce, SRSLTE_SL_MODE_4, prb_offset);
+  sl_rx_stage_lap(SL_STAGE_PSCCH);
 
-    if (srslte_pscch_extract_llr(&q->pscch, q->sf_symbols, 
-                        ce,
-                        q->chest.noise_estimate,
-                        0 %10, prb_offset)) {
-      fprintf(stderr, "Error extracting LLRs\n");
-      return -1;
-    }
+  for(uint32_t rbp=0; rbp < nof_candidates && nof_pending_sl_sci < SL_MAX_SCI_PER_SF; rbp++) {
 
-    if(SRSLTE_SUCCESS != srslte_pscch_dci_decode(&q->pscch, q->pscch.llr, mdata, q->pscch.max_bits, SRSLTE_SCI1_MAX_BITS, &crc_rem)) {
+    if (!candidates[rbp].crc_ok) {
       continue;
     }
 
+    uint8_t* mdata = candidates[rbp].data;
+    uint32_t prb_offset = candidates[rbp].prb_offset;
+    crc_rem = candidates[rbp].crc;
+
     if(SRSLTE_SUCCESS != srslte_repo_sci_decode(&phy->ue_repo, mdata, &sci)) {
       continue;
     }
@@ -415,77 +453,71 @@ bool cc_worker::decode_pscch_dl(srsue::mac_interface_phy_lte::mac_grant_dl_t* gr
       continue;
     }
 
-    q->pssch.n_X_ID = crc_rem;
+    if(sci.frl_L_subCH == 0 || sci.frl_n_subCH + sci.frl_L_subCH > phy->ue_repo.rp.numSubchannel_r14) {
+      printf("Detected allocation exceeding the resource pool.\n");
+      continue;
+    }
+
+    pending_sl_sci_t* pending = &pending_sl_sci[nof_pending_sl_sci++];
+
+    memcpy(&pending->sci, &sci, sizeof(srslte_ra_sl_sci_t));
+    pending->n_X_ID = crc_rem;
+
+    sl_sci_to_mac_grant(&sci, &pending->grant);
+
+    // the remaining subchannels of this allocation only carry PSSCH
+    rbp += sci.frl_L_subCH - 1;
+  }
 
-    // memcpy(&grant->phy_grant.sl, &sci, sizeof(srslte_ra_sl_sci_t));
-    memcpy(&pending_sl_grant[0].sl_dci, &sci, sizeof(srslte_ra_sl_sci_t));
+  sl_rx_stage_lap(SL_STAGE_PSCCH);
 
+  return nof_pending_sl_sci;
+}
 
-    // /* Fill MAC grant structure */
-    // grant->ndi[0] = 0;
-    // grant->ndi[1] = 0;
-    // grant->n_bytes[0] = sci.mcs.tbs / (uint32_t) 8;
-    // grant->n_bytes[1] = 0;
-    // grant->tti = phy->ue_repo.subframe_rp[tti];//tti;
-    // grant->rv[0] = 0; // @todo change if this is a retransmission
-    // grant->rv[1] = 0;
-    // grant->rnti = 0;
-    // grant->rnti_type = SRSLTE_RNTI_SL_PLACEHOLDER;
-    // grant->last_tti = 0;
-    // grant->tb_en[0] = true;
-    // grant->tb_en[1] = false;
-    // grant->tb_cw_swap = false;
+void cc_worker::sl_sci_to_mac_grant(srslte_ra_sl_sci_t* sci, srsue::mac_interface_phy_lte::mac_grant_dl_t* grant)
+{
+  uint32_t tti = sf_cfg_dl.tti;
 
-    // here we select which harq process should handle this tb
-    // @todo in future we may decode multiple SCIs in a single TTI,
-    //       so the harq pid selection needs enhancing.
+  ZERO_OBJECT(*grant);
+
+  // here we select which harq process should handle this tb
+  // @todo several SCIs received in the same TTI with the same time gap map to
+  //       the same harq process, they are therefore handled one after another.
 
 #ifdef USE_SENSING_SPS
-    if (sci.rti==0) {
-      // 1st tx
-      grant->pid = (tti + sci.time_gap) % 8;
-    } else {
-      // retransmission
-      grant->pid = tti % 8;
-    }
+  if (sci->rti==0) {
+    // 1st tx
+    grant->pid = (tti + sci->time_gap) % 8;
+  } else {
+    // retransmission
+    grant->pid = tti % 8;
+  }
 
-    // we use this to distinguish transmissions from each other
-    grant->sl_tti = tti;
-    grant->sl_gap = sci.time_gap;
+  // we use this to distinguish transmissions from each other
+  grant->sl_tti = tti;
+  grant->sl_gap = sci->time_gap;
 #else
-    // todo: this may still be wrong, as i assume need at least 16 different processes
-    grant->pid = (phy->ue_repo.subframe_rp[tti] + (8 - sci.rti * sci.time_gap)) % 8;
+  // todo: this may still be wrong, as i assume need at least 16 different processes
+  grant->pid = (phy->ue_repo.subframe_rp[tti] + (8 - sci->rti * sci->time_gap)) % 8;
 
-    grant->sl_tti = phy->ue_repo.subframe_rp[tti];
-    grant->sl_gap = sci.time_gap;
+  grant->sl_tti = phy->ue_repo.subframe_rp[tti];
+  grant->sl_gap = sci->time_gap;
 #endif
 
-    grant->tb[0].tbs = sci.mcs.tbs / (uint32_t) 8;
-    grant->rnti = SRSLTE_RNTI_SL_PLACEHOLDER;
-
-    // here we also need to select the correct rv value
-    // Use ndi flag to tell dl_harq if this is a retransmission
-    if (sci.rti==0) {
-      grant->tb[0].rv = 0;
-      grant->tb[0].ndi_present = true;
-      grant->tb[0].ndi = true;
-    } else {
-       grant->tb[0].rv = 2;
-      grant->tb[0].ndi_present = true;
-      grant->tb[0].ndi = false;
-    }
+  grant->tb[0].tbs = sci->mcs.tbs / (uint32_t) 8;
+  grant->rnti = SRSLTE_RNTI_SL_PLACEHOLDER;
 
-    // char hexstr[512];
-    // hexstr[0]='\0';
-    // if (log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
-    //   srslte_vec_sprint_hex(hexstr, sizeof(hexstr), dci_msg.data, dci_msg.nof_bits);
-    // }
-    // Info("PDCCH: DL DCI %s cce_index=%2d, L=%d, n_data_bits=%d, tpc_pucch=%d, hex=%s\n", srslte_dci_format_string(dci_msg.format),
-    //      last_dl_pdcch_ncce, (1<<ue_dl.last_location.L), dci_msg.nof_bits, dci_unpacked.tpc_pucch, hexstr);
-    
-    return true; 
+  // here we also need to select the correct rv value
+  // Use ndi flag to tell dl_harq if this is a retransmission
+  if (sci->rti==0) {
+    grant->tb[0].rv = 0;
+    grant->tb[0].ndi_present = true;
+    grant->tb[0].ndi = true;
+  } else {
+    grant->tb[0].rv = 2;
+    grant->tb[0].ndi_present = true;
+    grant->tb[0].ndi = false;
   }
-  return false;
 }
 
 
@@ -540,6 +572,9 @@ int cc_worker::decode_pssch(srslte_ra_sl_sci_t *grant, uint8_t *payload[SRSLTE_M
           srslte_pssch_set_max_noi(&ue_sl.pssch, phy->args->pdsch_max_its);
         }
 
+        /* Large TBs have their code blocks decoded in parallel if there is a decoder pool */
+        srslte_pssch_set_tdec_pool(&ue_sl.pssch, phy->tdec_pool);
+
         /** maybe export into seperate function */
         {
 
@@ -551,6 +586,8 @@ int cc_worker::decode_pssch(srslte_ra_sl_sci_t *grant, uint8_t *payload[SRSLTE_M
 
           ce[0] = q->ce;
 
+          sl_rx_stage_lap(SL_STAGE_OTHER);
+
           // set parameters for pssch
           //q->pssch.n_X_ID = crc_rem;
           q->pssch.n_PSSCH_ssf = 0; //@todo, make dynamically when sfn is detected
@@ -567,6 +604,8 @@ int cc_worker::decode_pssch(srslte_ra_sl_sci_t *grant, uint8_t *payload[SRSLTE_M
                                           prb_offset + 2,
                                           grant->frl_L_subCH*phy->ue_repo.rp.sizeSubchannel_r14 - 2);
 
+          sl_rx_stage_lap(SL_STAGE_CHEST);
+
           cf_t *_sf_symbols[SRSLTE_MAX_PORTS]; 
           cf_t *_ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
 
@@ -594,6 +633,8 @@ int cc_worker::decode_pssch(srslte_ra_sl_sci_t *grant, uint8_t *payload[SRSLTE_M
                                                       grant->frl_L_subCH*phy->ue_repo.rp.sizeSubchannel_r14 - 2,
                                                       payload);//uint8_t *data[SRSLTE_MAX_CODEWORDS],
 
+          sl_rx_stage_lap(SL_STAGE_PSSCH);
+
 
           if(SRSLTE_SUCCESS == decode_ret) {
             ret = SRSLTE_SUCCESS;
@@ -677,7 +718,10 @@ bool cc_worker::work_sl_rx()
   float rssi_sps = 0.0f;
   float rssi_dBm = 0.0f;
 
-  last_decoding_successful_high_rsrp = false;
+  ZERO_OBJECT(capture_meta);
+  capture_meta.tti = tti;
+
+  sl_rx_stage_reset();
 
   /* Run FFT for the slot symbols */
   srslte_ofdm_rx_sf(&ue_sl.fft);
@@ -689,87 +733,47 @@ bool cc_worker::work_sl_rx()
   float* t = (float*) ue_sl.fft.in_buffer; 
   this->agc_max_value = t[srslte_vec_max_fi(t, 2*ue_sl.fft.sf_sz)];// take only positive max to avoid abs() (should be similar)
 
+  sl_rx_stage_lap(SL_STAGE_FFT);
+
   /* Initialise the SPS algorithm for this tti */
   phy->sensing_sps->tick(tti);
 
   /* calculate S-RSSI for SPS */
   if (!phy->sensing_sps->getTransmit(tti))
   {
-    // uint8_t L_subch       = 1; // phy->ue_repo.rp.numSubchannel_r14
-    uint8_t n_subCH_start = 0;
-
-    int n_re_pssch_rssi = 2 * SRSLTE_CP_NSYMB(cell.cp) - 2; // exclude l=0 and l=13.
-
-    // struct timespec start, end;
-    // // ios_base::sync_with_stdio(false); // unsync the I/O
-    // clock_gettime(CLOCK_MONOTONIC, &start);
-
-    srslte_pssch_get_for_sps_rssi(
-        ue_sl.sf_symbols, ue_sl.pssch.SymSPSRssi[0], ue_sl.pssch.cell,
-        phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start * phy->ue_repo.rp.sizeSubchannel_r14,
-        // L_subch * phy->ue_repo.rp.sizeSubchannel_r14); // avearge over Lsubch including PSCCH and PSSCH.
-        phy->ue_repo.rp.numSubchannel_r14 * phy->ue_repo.rp.sizeSubchannel_r14);
-
-    // // Calculating total time taken by the program.
-    // clock_gettime(CLOCK_MONOTONIC, &end);
-    // double time_taken;
-    // time_taken = (end.tv_sec - start.tv_sec) * 1e9;
-    // time_taken = (time_taken + (end.tv_nsec - start.tv_nsec)) * 1e-9;
-
-    // std::cout << "Time taken by srslte_pssch_get_for_sps_rssi is : " << time_taken << setprecision(9) << " sec" << endl;
-
-    // clock_gettime(CLOCK_MONOTONIC, &start);
-    rssi_sps =
-        // srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRssi[SRSLTE_MAX_PORTS], SRSLTE_SF_LEN_PRB(cell.nof_prb));
-        srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRssi[0],
-                                // L_subch * phy->ue_repo.rp.sizeSubchannel_r14 * n_re_pssch_rssi); 
-                                // L_subch * phy->ue_repo.rp.sizeSubchannel_r14 * SRSLTE_NRE * n_re_pssch_rssi);
-                                phy->ue_repo.rp.numSubchannel_r14 * phy->ue_repo.rp.sizeSubchannel_r14 * SRSLTE_NRE * n_re_pssch_rssi) + (1 + (rand() % 1000)) / 1000.0E8;
-    //srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRssi[0], 1); // for calc time testing: pw avg for one sym. 
-    // clock_gettime(CLOCK_MONOTONIC, &end);
-    // time_taken = (end.tv_sec - start.tv_sec) * 1e9;
-    // time_taken = (time_taken + (end.tv_nsec - start.tv_nsec)) * 1e-9;
-    // // std::cout << "Time taken by rssi_sps avg_power_cf is : " << time_taken << setprecision(9) << " sec" << endl;
-
-    ue_sl.pssch.sps_rssi[sps_rssi_read_cnt] = rssi_sps;
-    phy->inst_sps_rssi[sps_rssi_read_cnt]   = 10 * log10(rssi_sps * 1000); // in dBm.
-    rssi_dBm = 10 * log10(rssi_sps) - 10*log10(ue_sl.fft.symbol_sz * ue_sl.fft.symbol_sz / ue_sl.fft.nof_re); //29.93f; // 10*log10(768*768/600)
-    
-    // phy->inst_sps_rssi = 10 * log10(rssi_sps * 1000); // in dBm.
+    // for sensing-based SPS we need to measure the S-RSSI of the whole pool and
+    // per subchannel, both are accumulated in a single pass over the subframe
+    float rssi_subch[SRSLTE_MAX_PRB];
+
+    rssi_sps = srslte_pssch_sps_rssi(ue_sl.sf_symbols,
+                                     ue_sl.pssch.cell,
+                                     phy->ue_repo.rp.startRB_Subchannel_r14,
+                                     phy->ue_repo.rp.sizeSubchannel_r14,
+                                     phy->ue_repo.rp.numSubchannel_r14,
+                                     rssi_subch) + (1 + (next_random() % 1000)) / 1000.0E8;
 
+    uint32_t rssi_idx = phy->sps_rssi_read_cnt.fetch_add(1, std::memory_order_relaxed) % 1000;
 
-    // if( phy->inst_sps_rssi[sps_rssi_read_cnt] - phy->sl_rssi > 15) {
-    //   printf("TTI: %4d detected large RSSI value of %f (avg: %f)\n", tti, phy->inst_sps_rssi[sps_rssi_read_cnt], phy->sl_rssi);
-    //   last_decoding_successful_high_rsrp = true;
-    // }
+    ue_sl.pssch.sps_rssi[rssi_idx] = rssi_sps;
+    phy->inst_sps_rssi[rssi_idx]   = 10 * log10(rssi_sps * 1000); // in dBm.
+    rssi_dBm = 10 * log10(rssi_sps) - 10*log10(ue_sl.fft.symbol_sz * ue_sl.fft.symbol_sz / ue_sl.fft.nof_re); //29.93f; // 10*log10(768*768/600)
 
     // save average RSSI
     phy->sl_rssi = SRSLTE_VEC_EMA(rssi_dBm, phy->sl_rssi, 0.1);
-
-    sps_rssi_read_cnt++;
-    if (sps_rssi_read_cnt == 1000)
-      sps_rssi_read_cnt = 0;
+    capture_meta.rssi = rssi_dBm;
 
     // @todo: check if are save to user rssi_dBm here
     phy->sensing_sps->addAverageSRSSI(tti,10 * log10(rssi_sps * 1000));
 
-    // for sensing-based SPS we need to measure the S-RSSI per subchannel
-    // Note that this reuses the SymSPSRssi buffer
-    uint32_t n_re_pscch_subchannel = phy->ue_repo.rp.sizeSubchannel_r14 * SRSLTE_NRE * n_re_pssch_rssi;
-
     for (int rbp = 0; rbp < phy->ue_repo.rp.numSubchannel_r14; ++rbp) {
-      srslte_pssch_get_for_sps_rssi(ue_sl.sf_symbols,
-                                    ue_sl.pssch.SymSPSRssi[0],
-                                    ue_sl.pssch.cell,
-                                    phy->ue_repo.rp.startRB_Subchannel_r14 + rbp * phy->ue_repo.rp.sizeSubchannel_r14,
-                                    phy->ue_repo.rp.sizeSubchannel_r14);
-
-      float rssi = srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRssi[0], n_re_pscch_subchannel) + (1 + (rand() % 1000)) / 1000.0E8;
+      float rssi = rssi_subch[rbp] + (1 + (next_random() % 1000)) / 1000.0E8;
 
       phy->sensing_sps->addChannelSRSSI(tti, rbp, 10 * log10(rssi * 1000));
     }
   }
 
+  sl_rx_stage_lap(SL_STAGE_SENSING);
+
   // in each sync symbol we also decode mib
   if(!phy->args->sidelink_master && (tti%5 == 0)) {
     // get channel estimates for psbch
@@ -813,10 +817,12 @@ bool cc_worker::work_sl_rx()
     // report large RSSI values, except for broadcast subframes
     if( rssi_dBm - phy->sl_rssi > 15) {
       // printf("TTI: %4d detected large RSSI value of %f (avg: %f)\n", tti, rssi_dBm, phy->sl_rssi);
-      last_decoding_successful_high_rsrp = true;
+      capture_meta.triggers |= iq_capture::TRIGGER_HIGH_RSSI;
     }
   }
 
+  sl_rx_stage_lap(SL_STAGE_PSBCH);
+
   int t_SL_k = srslte_repo_get_t_SL_k(&phy->ue_repo, tti);
 
   // do not decode our own sent messages
@@ -835,26 +841,38 @@ bool cc_worker::work_sl_rx()
   }
   #endif
 
-  mac_interface_phy_lte::mac_grant_dl_t dl_mac_grant = {};
-
   memset(&pending_sl_grant[0], 0x00, sizeof(pending_sl_grant[0]));
 
-  last_decoding_successful = false;
-
 #if 1
   // do not decode our own sent messages
-  if(!phy->sensing_sps->getTransmit(tti) && decode_pscch_dl(&dl_mac_grant)) {
+  uint32_t nof_sci = phy->sensing_sps->getTransmit(tti) ? 0 : decode_pscch_dl();
+
+  // The PSSCHs are decoded one after another: they share the channel estimator and
+  // PSSCH buffers of this worker, and each decoding has to go through the MAC HARQ
+  // entity before the next grant is issued, as several SCIs may map to the same process.
+  for (uint32_t i = 0; i < nof_sci; i++) {
+    pending_sl_sci_t* pending = &pending_sl_sci[i];
+
+    mac_interface_phy_lte::mac_grant_dl_t dl_mac_grant = pending->grant;
+
+    // keep the last decoded SCI for the plotting functions
+    memcpy(&pending_sl_grant[0].sl_dci, &pending->sci, sizeof(srslte_ra_sl_sci_t));
+
+    ue_sl.pssch.n_X_ID = pending->n_X_ID;
+
+    dl_ack[0] = false;
+
+    sl_rx_stage_lap(SL_STAGE_OTHER);
 
     /* Send grant to MAC and get action for this TB */
     phy->stack->new_grant_dl(cc_idx, dl_mac_grant, &dl_action);
 
+    sl_rx_stage_lap(SL_STAGE_MAC);
+
     /* Decode PSSCH if instructed to do so */
     if (dl_action.tb[0].enabled) {
 
-      // indicate, that we can dump this subframe
-      last_decoding_successful = true;
-      
-      decode_pssch(&pending_sl_grant[0].sl_dci, &dl_action.tb[0].payload,
+      decode_pssch(&pending->sci, &dl_action.tb[0].payload,
                     &dl_action.tb[0].softbuffer.rx, &dl_action.tb[0].rv, dl_mac_grant.rnti,
                     dl_mac_grant.pid, dl_ack);
       
@@ -880,7 +898,14 @@ bool cc_worker::work_sl_rx()
       dl_mac_grant.sl_rx_gain  = curr_rx_gain;
 
       // combine extracted FRL into one variable
-      dl_mac_grant.sl_sci_frl = (pending_sl_grant[0].sl_dci.frl_L_subCH << 8) | (pending_sl_grant[0].sl_dci.frl_n_subCH & 0xFF);
+      dl_mac_grant.sl_sci_frl = (pending->sci.frl_L_subCH << 8) | (pending->sci.frl_n_subCH & 0xFF);
+
+      // the last PSSCH of the subframe describes an IQ capture
+      capture_meta.triggers |= dl_ack[0] ? iq_capture::TRIGGER_DECODED : iq_capture::TRIGGER_CRC_FAIL;
+      capture_meta.snr         = snr;
+      capture_meta.rsrp        = rsrp;
+      capture_meta.frl_n_subch = pending->sci.frl_n_subCH;
+      capture_meta.frl_l_subch = pending->sci.frl_L_subCH;
 
       int ue_id = srslte_repo_get_t_SL_k(&phy->ue_repo, tti % 10240);
 
@@ -907,71 +932,53 @@ bool cc_worker::work_sl_rx()
         // }
       }
 
-      /* calculate PSSCH-RSRP for SPS */
-      {
-        uint8_t n_subCH_start = 0;
-
-        int n_rs_pssch_rsrp = srslte_refsignal_sl_dmrs_pscch_N_rs(SRSLTE_SL_MODE_4, 0) +
-                              srslte_refsignal_sl_dmrs_pscch_N_rs(SRSLTE_SL_MODE_4, 1); //hard coded as mode 4.
-
-        srslte_pssch_get_for_sps_rsrp( // ue_sl.sf_symbols, ue_sl.pssch.SymSPSRsrp[SRSLTE_MAX_PORTS], ue_sl.pssch.cell,
-            ue_sl.sf_symbols, ue_sl.pssch.SymSPSRsrp[0], ue_sl.pssch.cell,
-            phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start * phy->ue_repo.rp.sizeSubchannel_r14 + 2,
-            // L_subch * phy->ue_repo.rp.sizeSubchannel_r14 - 2); // avearge over Lsubch of PSSCH.
-            phy->ue_repo.rp.numSubchannel_r14 * phy->ue_repo.rp.sizeSubchannel_r14 - 2);
-
-        float rsrp_sps =
-            // srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRsrp[SRSLTE_MAX_PORTS], SRSLTE_SF_LEN_PRB(cell.nof_prb));
-            srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRsrp[0],
-                                    // (L_subch * phy->ue_repo.rp.sizeSubchannel_r14 - 2) * n_rs_pssch_rsrp);
-                                    (phy->ue_repo.rp.numSubchannel_r14 * phy->ue_repo.rp.sizeSubchannel_r14 - 2) * SRSLTE_NRE * n_rs_pssch_rsrp);
-
-        int tst = (phy->ue_repo.rp.numSubchannel_r14 * phy->ue_repo.rp.sizeSubchannel_r14 - 2) * SRSLTE_NRE * n_rs_pssch_rsrp;  
-                                
-        ue_sl.pssch.sps_rsrp[sps_rsrp_read_cnt] = rsrp_sps;
-        phy->inst_sps_rsrp[sps_rsrp_read_cnt] = 10 * log10(rsrp_sps * 1000); // in dBm.
-        // phy->inst_sps_rsrp = 10 * log10(rsrp_sps * 1000); // in dBm.
-
-        // Warning: we are currently only decoding a single PSSCH per subframe
-        //          and are calculating the RSRP across all the channels
-        phy->sensing_sps->addSCI(tti,
-                            pending_sl_grant[0].sl_dci.frl_n_subCH,
-                            pending_sl_grant[0].sl_dci.frl_L_subCH,
-                            pending_sl_grant[0].sl_dci.resource_reservation,
-                            pending_sl_grant[0].sl_dci.priority,
-                            10 * log10(rsrp_sps * 1000)
-        );
-
-
-#if 0
-printf("dumping subframe subframe..\n");
-  for (int i=0;i<8400;++i) {
-      cf_t c = ue_sl.sf_symbols[i];
-      printf(" %f%+fj",crealf(c),cimagf(c));
-}
-#endif
-
-        sps_rsrp_read_cnt++;
-        if (sps_rsrp_read_cnt == 1000)
-          sps_rsrp_read_cnt = 0;
-      }
-
-      // append SNR value after payload, the mac knows about it and will read it from there to attach it to each TCP terminated sl packet
-      *((float *)(dl_action.tb[0].payload + dl_mac_grant.tb[0].tbs)) = phy->snr_pssch_per_ue[ue_id];//snr;//ue_sl.chest.noise_estimate;
-
 #ifdef ENABLE_GUI
       // save ce for psxch for plotting
-      bzero(ue_sl.ce_plot, SRSLTE_NRE * cell.nof_prb * sizeof(cf_t));// (pending_sl_grant[0].sl_dci.frl_L_subCH * phy->ue_repo.rp.sizeSubchannel_r14) * sizeof(cf_t));
-      memcpy(&ue_sl.ce_plot[SRSLTE_NRE * (pending_sl_grant[0].sl_dci.frl_n_subCH * phy->ue_repo.rp.sizeSubchannel_r14)],
-              &ue_sl.ce[SRSLTE_NRE * (2*cell.nof_prb + pending_sl_grant[0].sl_dci.frl_n_subCH * phy->ue_repo.rp.sizeSubchannel_r14)],
-              SRSLTE_NRE * (pending_sl_grant[0].sl_dci.frl_L_subCH * phy->ue_repo.rp.sizeSubchannel_r14) * sizeof(cf_t));
+      bzero(ue_sl.ce_plot, SRSLTE_NRE * cell.nof_prb * sizeof(cf_t));// (pending->sci.frl_L_subCH * phy->ue_repo.rp.sizeSubchannel_r14) * sizeof(cf_t));
+      memcpy(&ue_sl.ce_plot[SRSLTE_NRE * (pending->sci.frl_n_subCH * phy->ue_repo.rp.sizeSubchannel_r14)],
+              &ue_sl.ce[SRSLTE_NRE * (2*cell.nof_prb + pending->sci.frl_n_subCH * phy->ue_repo.rp.sizeSubchannel_r14)],
+              SRSLTE_NRE * (pending->sci.frl_L_subCH * phy->ue_repo.rp.sizeSubchannel_r14) * sizeof(cf_t));
 
       memcpy(ue_sl.td_plot, ue_sl.fft.in_buffer, ue_sl.fft.sf_sz * sizeof(cf_t));
 #endif
       
     }
 
+    sl_rx_stage_lap(SL_STAGE_OTHER);
+
+    /* calculate PSSCH-RSRP of this allocation for SPS */
+    {
+      int n_rs_pssch_rsrp = srslte_refsignal_sl_dmrs_pscch_N_rs(SRSLTE_SL_MODE_4, 0) +
+                            srslte_refsignal_sl_dmrs_pscch_N_rs(SRSLTE_SL_MODE_4, 1); //hard coded as mode 4.
+
+      // the first two PRBs of the allocation carry the PSCCH
+      uint32_t n_prb_pssch = pending->sci.frl_L_subCH * phy->ue_repo.rp.sizeSubchannel_r14 - 2;
+
+      srslte_pssch_get_for_sps_rsrp(ue_sl.sf_symbols, ue_sl.pssch.SymSPSRsrp[0], ue_sl.pssch.cell,
+          phy->ue_repo.rp.startRB_Subchannel_r14 + pending->sci.frl_n_subCH * phy->ue_repo.rp.sizeSubchannel_r14 + 2,
+          n_prb_pssch);
+
+      float rsrp_sps = srslte_vec_avg_power_cf(ue_sl.pssch.SymSPSRsrp[0], n_prb_pssch * SRSLTE_NRE * n_rs_pssch_rsrp);
+
+      uint32_t rsrp_idx = phy->sps_rsrp_read_cnt.fetch_add(1, std::memory_order_relaxed) % 1000;
+
+      ue_sl.pssch.sps_rsrp[rsrp_idx] = rsrp_sps;
+      phy->inst_sps_rsrp[rsrp_idx] = 10 * log10(rsrp_sps * 1000); // in dBm.
+
+      phy->sensing_sps->addSCI(tti,
+                          pending->sci.frl_n_subCH,
+                          pending->sci.frl_L_subCH,
+                          pending->sci.resource_reservation,
+                          pending->sci.priority,
+                          10 * log10(rsrp_sps * 1000)
+      );
+    }
+
+    sl_rx_stage_lap(SL_STAGE_SENSING);
+
     phy->stack->tb_decoded(cc_idx, dl_mac_grant, dl_ack);//[0], 0, dl_mac_grant.rnti_type, dl_mac_grant.pid);
+
+    sl_rx_stage_lap(SL_STAGE_MAC);
   }
 
 #if 0
@@ -982,43 +989,44 @@ printf("dumping subframe subframe..\n");
 
 #endif
 
+  sl_rx_stage_lap(SL_STAGE_OTHER);
+
   return true;
 }
 
-bool cc_worker::dump_subframe() {
-
-  if(phy->n_subframes_to_dump>0 && last_decoding_successful) {
-    struct timeval t;
-    gettimeofday(&t, NULL);
-
-    char filename [30];
-
-    snprintf(filename, sizeof(filename), "iq_dump_%ld.%ld.bin", t.tv_sec, t.tv_usec);
-
-    srslte_filesink_t fsink;
-    srslte_filesink_init(&fsink, filename, SRSLTE_COMPLEX_FLOAT_BIN);
-    srslte_filesink_write(&fsink, (void*) get_rx_buffer(0), SRSLTE_SF_LEN_PRB(cell.nof_prb));
-    srslte_filesink_free(&fsink);
-
-    phy->n_subframes_to_dump--;
+// Takes one subframe from a capture budget that other workers share
+static bool take_capture_budget(std::atomic<int32_t>* budget)
+{
+  int32_t n = budget->load(std::memory_order_relaxed);
+  while (n > 0 && !budget->compare_exchange_weak(n, n - 1, std::memory_order_relaxed)) {
   }
+  return n > 0;
+}
 
-  if(last_decoding_successful_high_rsrp && phy->n_subframes_to_dump_special>0) {
-    struct timeval t;
-    gettimeofday(&t, NULL);
-
-    char filename [30];
+bool cc_worker::dump_subframe() {
 
-    snprintf(filename, sizeof(filename), "iq_hr_dump_%ld.%ld.bin", t.tv_sec, t.tv_usec);
+  uint32_t triggers = capture_meta.triggers & phy->capture.get_triggers();
+  if (!triggers) {
+    return true;
+  }
 
-    srslte_filesink_t fsink;
-    srslte_filesink_init(&fsink, filename, SRSLTE_COMPLEX_FLOAT_BIN);
-    srslte_filesink_write(&fsink, (void*) get_rx_buffer(0), SRSLTE_SF_LEN_PRB(cell.nof_prb));
-    srslte_filesink_free(&fsink);
+  bool capture = false;
+  if ((triggers & (iq_capture::TRIGGER_DECODED | iq_capture::TRIGGER_CRC_FAIL)) &&
+      take_capture_budget(&phy->n_subframes_to_dump)) {
+    capture = true;
+  }
+  if ((triggers & iq_capture::TRIGGER_HIGH_RSSI) && take_capture_budget(&phy->n_subframes_to_dump_special)) {
+    capture = true;
+  }
 
-    phy->n_subframes_to_dump_special--;
+  if (capture) {
+    capture_meta.triggers     = triggers;
+    capture_meta.rx_full_secs = rx_time.full_secs;
+    capture_meta.rx_frac_secs = rx_time.frac_secs;
+    capture_meta.rx_gain      = curr_rx_gain;
+    phy->capture.push(&capture_meta, get_rx_buffer(0), SRSLTE_SF_LEN_PRB(cell.nof_prb));
   }
-  
+
   return true;
 }
 
@@ -1035,28 +1043,17 @@ bool cc_worker::work_sl_tx() {
   // this is the ul tti
   int tti = sf_cfg_ul.tti;
 
+  sl_tx_n_subch = 0;
+  sl_tx_L_subch = 0;
+
   // we are the master node and need to send sync sequences
   if(phy->args->sidelink_master && ((tti % phy->ue_repo.syncPeriod) == phy->ue_repo.syncOffsetIndicator_r12)) {
 
-    // clear sf buffer
-    bzero(ue_sl_tx.sf_symbols, sizeof(cf_t)*SRSLTE_SF_LEN_RE(ue_sl_tx.cell.nof_prb, ue_sl_tx.cell.cp));
-    srslte_psss_put_sf(ue_sl_tx.psss_signal, ue_sl_tx.sf_symbols, cell.nof_prb, SRSLTE_CP_NORM);
-    srslte_ssss_put_sf(ue_sl_tx.ssss_signal, ue_sl_tx.sf_symbols, cell.nof_prb, SRSLTE_CP_NORM);
-
-    srslte_refsignal_sl_dmrs_psbch_put(&ue_sl_tx.signals, SRSLTE_SL_MODE_4, ue_sl_tx.psbch_dmrs, ue_sl_tx.sf_symbols);
-
-    srslte_psbch_mib_pack(&cell,
-                          (tti % 10240)/10, //sfn,
-                          tti % 10,//sf_idx,
-                          ue_sl_tx.bch_payload);
-
-    cf_t *sf_tmp[2];
-    sf_tmp[0] = ue_sl_tx.sf_symbols;
-    sf_tmp[1] = NULL;
-
-    srslte_psbch_encode(&ue_sl_tx.psbch, ue_sl_tx.bch_payload, sf_tmp);
-
-    srslte_ofdm_tx_sf(&ue_sl_tx.fft);
+    // PSSS, SSSS and PSBCH DMRS come precomputed, only the PSBCH is modulated
+    if (srslte_ue_sl_tx_sync_sf(&ue_sl_tx, (tti % 10240) / 10, tti % 10)) {
+      Error("Error generating sync subframe\n");
+      return false;
+    }
 
     signal_ready = true;
 
@@ -1193,8 +1190,10 @@ bool cc_worker::work_sl_tx() {
               c_bits,
               i_bits/c_bits);
       
-      // select random between valid values
-      n_subCH_start = rand() % (phy->ue_repo.rp.numSubchannel_r14 - L_subch + 1);
+#ifndef USE_SENSING_SPS
+      // select random between valid values, Sensing SPS has already chosen the subchannels
+      n_subCH_start = next_random() % (phy->ue_repo.rp.numSubchannel_r14 - L_subch + 1);
+#endif
 
       // set RIV
       srslte_repo_encode_frl(&phy->ue_repo, &sci, L_subch, n_subCH_start);
@@ -1221,8 +1220,7 @@ bool cc_worker::work_sl_tx() {
       cf_t *ta[2];
       ta[0] = ue_sl_tx.sf_symbols;
 
-      bzero(ue_sl_tx.sf_symbols, sizeof(cf_t)*SRSLTE_SF_LEN_RE(ue_sl_tx.cell.nof_prb, ue_sl_tx.cell.cp));
-
+      // the grid is empty here, ue_sl_tx clears the REs of each transmission
       if(SRSLTE_SUCCESS != srslte_pscch_encode(&ue_sl_tx.pscch, sci_buffer, phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start*phy->ue_repo.rp.sizeSubchannel_r14, ta)) {
         printf("Failed to encode PSCCH for PRB offset: %d \n", phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start*phy->ue_repo.rp.sizeSubchannel_r14);
         exit(-1);
@@ -1274,19 +1272,27 @@ bool cc_worker::work_sl_tx() {
                                           L_subch * phy->ue_repo.rp.sizeSubchannel_r14 - 2,
                                           ue_sl_tx.pssch_dmrs, ue_sl_tx.sf_symbols);  
 
-      // add awgn to transmit signal
-      srslte_vec_sub_ccc(ue_sl_tx.sf_symbols, phy->noise_buffer, ue_sl_tx.sf_symbols, SRSLTE_SF_LEN_RE(cell.nof_prb, SRSLTE_CP_NORM));
-
-      srslte_ofdm_tx_sf(&ue_sl_tx.fft);
-
-      // apply same cfo which we have to the master node, by doing this, each other node
-      // also needs to be cfo-sync to the master to be automatically sync with all nodes
-      if (ue_sl_tx.cfo_en) {
-        //srslte_cfo_correct(&ue_sl_tx.cfo, signal_buffer[0], signal_buffer[0], get_cfo() / srslte_symbol_sz(ue_sl_tx.cell.nof_prb));
-        srslte_cfo_correct(&ue_sl_tx.cfo, ue_sl_tx.out_buffer, ue_sl_tx.out_buffer, ue_ul_cfg.cfo_value / srslte_symbol_sz(ue_sl_tx.cell.nof_prb));
+      // add fresh awgn to the allocated PRBs, the last symbol is the guard period
+      if (srslte_channel_awgn_enabled(&phy->tx_awgn)) {
+        uint32_t prb_start = phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start*phy->ue_repo.rp.sizeSubchannel_r14;
+        uint32_t nof_re    = L_subch*phy->ue_repo.rp.sizeSubchannel_r14*SRSLTE_NRE;
+        uint64_t stream    = phy->tx_awgn_stream++;
+        for (uint32_t l = 0; l < 2*SRSLTE_CP_NSYMB(cell.cp) - 1; l++) {
+          cf_t* re = &ue_sl_tx.sf_symbols[l*cell.nof_prb*SRSLTE_NRE + prb_start*SRSLTE_NRE];
+          srslte_channel_awgn_run_c(&phy->tx_awgn, re, re, nof_re, stream, l*nof_re);
+        }
       }
 
-      srslte_ue_sl_tx_apply_norm(&ue_sl_tx, L_subch*phy->ue_repo.rp.sizeSubchannel_r14);
+      // apply same cfo which we have to the master node, by doing this, each other node
+      // also needs to be cfo-sync to the master to be automatically sync with all nodes.
+      // Only the allocated PRBs are modulated, cfo and normalization are applied in one pass.
+      srslte_ue_sl_tx_modulate(&ue_sl_tx,
+                               phy->ue_repo.rp.startRB_Subchannel_r14 + n_subCH_start*phy->ue_repo.rp.sizeSubchannel_r14,
+                               L_subch*phy->ue_repo.rp.sizeSubchannel_r14,
+                               ue_ul_cfg.cfo_value / srslte_symbol_sz(ue_sl_tx.cell.nof_prb));
+
+      sl_tx_n_subch = n_subCH_start;
+      sl_tx_L_subch = L_subch;
 
       signal_ready = true;
       // signal_ptr = signal_buffer[0];
@@ -0,0 +1,273 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srssl/hdr/phy/iq_capture.h"
+#include <new>
+#include <sstream>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace srsue {
+
+iq_capture::iq_capture() :
+  thread("IQ_CAPTURE"),
+  slots(NULL),
+  running(false),
+  nof_dropped(0),
+  triggers(0),
+  sigmf(false),
+  center_freq_hz(0),
+  data_file(NULL),
+  meta_file(NULL),
+  open_failed(false),
+  nof_written_samples(0),
+  nof_written(0)
+{
+}
+
+iq_capture::~iq_capture()
+{
+  stop();
+}
+
+uint32_t iq_capture::parse_triggers(const std::string& list)
+{
+  uint32_t          mask = 0;
+  std::stringstream ss(list);
+  std::string       item;
+  while (std::getline(ss, item, ',')) {
+    if (item == "decoded") {
+      mask |= TRIGGER_DECODED;
+    } else if (item == "crc_fail") {
+      mask |= TRIGGER_CRC_FAIL;
+    } else if (item == "high_rssi") {
+      mask |= TRIGGER_HIGH_RSSI;
+    } else if (!item.empty()) {
+      fprintf(stderr, "Unknown IQ capture trigger %s\n", item.c_str());
+    }
+  }
+  return mask;
+}
+
+bool iq_capture::init(const std::string& filename_, uint32_t triggers_, bool sigmf_, double center_freq_hz_)
+{
+  // The ring is about 4 MB, do not hold it when nothing is ever captured
+  if (filename_.empty() || !triggers_) {
+    return false;
+  }
+
+  // Plain new does not honour the cache line alignment of the queue in C++11
+  void* ptr = NULL;
+  if (posix_memalign(&ptr, 64, sizeof(slot_queue_t))) {
+    perror("posix_memalign");
+    return false;
+  }
+  slots = new (ptr) slot_queue_t();
+
+  std::stringstream ss;
+  ss << filename_ << "_" << time(NULL);
+  filename       = ss.str();
+  triggers       = triggers_;
+  sigmf          = sigmf_;
+  center_freq_hz = center_freq_hz_;
+  running        = true;
+
+  // PHY workers run with real-time priority, the writer does not need any
+  start();
+  return true;
+}
+
+void iq_capture::stop()
+{
+  if (running) {
+    running = false;
+    wait_thread_finish();
+    if (nof_written || nof_dropped) {
+      printf("Saved %d IQ subframes to %s, dropped %d\n", nof_written, filename.c_str(), (uint32_t)nof_dropped);
+    }
+  }
+  if (slots) {
+    slots->~slot_queue_t();
+    free(slots);
+    slots = NULL;
+  }
+}
+
+bool iq_capture::push(const meta_t* meta, const cf_t* samples, uint32_t nof_samples)
+{
+  if (!running || nof_samples > SRSLTE_SF_LEN_MAX) {
+    return false;
+  }
+
+  uint32_t ticket = 0;
+  slot_t*  s      = slots->back(&ticket);
+  if (s == NULL) {
+    nof_dropped++;
+    return false;
+  }
+  s->meta        = *meta;
+  s->nof_samples = nof_samples;
+  memcpy(s->samples, samples, sizeof(cf_t) * nof_samples);
+  slots->push(ticket);
+  return true;
+}
+
+void iq_capture::run_thread()
+{
+  while (running) {
+    slot_t* s = slots->front();
+    if (s) {
+      write_slot(s);
+      slots->pop();
+    } else {
+      if (data_file) {
+        fflush(data_file);
+      }
+      usleep(WRITER_PERIOD_US);
+    }
+  }
+
+  // Write what the workers pushed before stop()
+  for (slot_t* s; (s = slots->front()) != NULL; slots->pop()) {
+    write_slot(s);
+  }
+  close_files();
+}
+
+static std::string iso8601(time_t full_secs, double frac_secs)
+{
+  char      buf[64];
+  struct tm t;
+  gmtime_r(&full_secs, &t);
+  size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &t);
+  snprintf(&buf[n], sizeof(buf) - n, ".%06dZ", (int)(frac_secs * 1e6));
+  return std::string(buf);
+}
+
+bool iq_capture::open_files(const slot_t* s)
+{
+  std::string data_name = filename + (sigmf ? ".sigmf-data" : ".bin");
+  data_file             = fopen(data_name.c_str(), "w");
+  if (data_file == NULL) {
+    perror("Opening IQ capture");
+    return false;
+  }
+
+  if (sigmf) {
+    std::string meta_name = filename + ".sigmf-meta";
+    meta_file             = fopen(meta_name.c_str(), "w");
+    if (meta_file == NULL) {
+      perror("Opening IQ capture metadata");
+      return true;
+    }
+    // Captures are collected until the end, annotations are streamed
+    fprintf(meta_file,
+            "{\n"
+            "  \"global\": {\n"
+            "    \"core:datatype\": \"cf32_le\",\n"
+            "    \"core:sample_rate\": %d,\n"
+            "    \"core:version\": \"1.0.0\",\n"
+            "    \"core:recorder\": \"srssl\",\n"
+            "    \"core:description\": \"Received sidelink subframes, one capture segment each\",\n"
+            "    \"core:extensions\": [{\"name\": \"srssl\", \"version\": \"1.0.0\", \"optional\": true}]\n"
+            "  },\n"
+            "  \"annotations\": [",
+            s->nof_samples * 1000);
+  }
+  return true;
+}
+
+void iq_capture::write_slot(const slot_t* s)
+{
+  if (data_file == NULL) {
+    if (open_failed || !open_files(s)) {
+      open_failed = true;
+      return;
+    }
+  }
+
+  fwrite(s->samples, sizeof(cf_t), s->nof_samples, data_file);
+
+  if (meta_file) {
+    const meta_t* m = &s->meta;
+
+    std::string trigger;
+    trigger += (m->triggers & TRIGGER_DECODED) ? "decoded," : "";
+    trigger += (m->triggers & TRIGGER_CRC_FAIL) ? "crc_fail," : "";
+    trigger += (m->triggers & TRIGGER_HIGH_RSSI) ? "high_rssi," : "";
+    if (!trigger.empty()) {
+      trigger.erase(trigger.size() - 1);
+    }
+
+    fprintf(meta_file,
+            "%s\n    {\"core:sample_start\": %lu, \"core:sample_count\": %d, \"srssl:tti\": %d, "
+            "\"srssl:trigger\": \"%s\", \"srssl:snr_db\": %.2f, \"srssl:rsrp_db\": %.2f, \"srssl:rssi_dbm\": %.2f, "
+            "\"srssl:rx_gain_db\": %.1f, \"srssl:frl_n_subch\": %d, \"srssl:frl_l_subch\": %d}",
+            nof_written ? "," : "",
+            (unsigned long)nof_written_samples,
+            s->nof_samples,
+            m->tti,
+            trigger.c_str(),
+            m->snr,
+            m->rsrp,
+            m->rssi,
+            m->rx_gain,
+            m->frl_n_subch,
+            m->frl_l_subch);
+
+    // Subframes are not contiguous, each starts its own capture segment
+    char capture[256];
+    snprintf(capture,
+             sizeof(capture),
+             "%s\n    {\"core:sample_start\": %lu, \"core:datetime\": \"%s\"%s",
+             nof_written ? "," : "",
+             (unsigned long)nof_written_samples,
+             iso8601(m->rx_full_secs, m->rx_frac_secs).c_str(),
+             center_freq_hz > 0 ? ", \"core:frequency\": " : "}");
+    sigmf_captures += capture;
+    if (center_freq_hz > 0) {
+      snprintf(capture, sizeof(capture), "%.0f}", center_freq_hz);
+      sigmf_captures += capture;
+    }
+  }
+
+  nof_written_samples += s->nof_samples;
+  nof_written++;
+}
+
+void iq_capture::close_files()
+{
+  if (meta_file) {
+    fprintf(meta_file, "\n  ],\n  \"captures\": [%s\n  ]\n}\n", sigmf_captures.c_str());
+    fclose(meta_file);
+    meta_file = NULL;
+  }
+  if (data_file) {
+    fclose(data_file);
+    data_file = NULL;
+  }
+}
+
+} // namespace srsue
@@ -257,6 +257,7 @@ void phy::stop()
 
     workers_pool.stop();
     prach_buffer.stop();
+    common.capture.stop();
 
     initiated = false;
   }
@@ -267,6 +268,7 @@ void phy::get_metrics(phy_metrics_t* m)
   common.get_dl_metrics(m->dl);
   common.get_ul_metrics(m->ul);
   common.get_sync_metrics(m->sync);
+  common.get_sl_latency_metrics(&m->sl_latency);
   m->nof_active_cc = args.nof_carriers;
 }
 
@@ -97,6 +97,15 @@ phy_common::phy_common(uint32_t max_workers) : tx_sem(max_workers)
   sync_metrics_read  = true;
   sync_metrics_count = 0;
 
+  sl_latency = new sl_latency_t[max_workers];
+  for (uint32_t i = 0; i < max_workers; i++) {
+    sl_latency[i].deadline_misses = 0;
+  }
+  nof_sl_latency = 0;
+  pthread_mutex_init(&sl_latency_mutex, NULL);
+  ZERO_OBJECT(sl_latency_last);
+  sl_latency_last_misses = 0;
+
   ZERO_OBJECT(snr_pssch_per_ue);
   ZERO_OBJECT(rsrp_pssch_per_ue);
   ZERO_OBJECT(ue_repo);
@@ -104,9 +113,17 @@ phy_common::phy_common(uint32_t max_workers) : tx_sem(max_workers)
   rsrp_psbch = 0.0;
   pssch_fixed_i_mcs = 8;
   pssch_min_tbs = 800;
+  sps_rsrp_read_cnt = 0;
+  sps_rssi_read_cnt = 0;
 
-  // set initial snr value for transmit samples
-  tx_snr = 60.0;
+  // no noise on transmit samples unless requested via the REST API
+  tx_snr = INFINITY;
+  srslte_channel_awgn_init(&tx_awgn, 0);
+  tx_awgn_stream = 0;
+
+  n_subframes_to_dump         = 0;
+  n_subframes_to_dump_special = 0;
+  tdec_pool                   = NULL;
 
   rar_grant_tti = -1;
 
@@ -165,6 +182,14 @@ phy_common::~phy_common()
   for (uint32_t i = 0; i < max_workers; i++) {
     sem_destroy(&tx_sem[i]);
   }
+
+  pthread_mutex_destroy(&sl_latency_mutex);
+  delete[] sl_latency;
+
+  if (tdec_pool) {
+    srslte_tdec_pool_free(tdec_pool);
+    delete tdec_pool;
+  }
 }
 
 void phy_common::set_nof_workers(uint32_t nof_workers)
@@ -190,15 +215,28 @@ void phy_common::init(phy_args_t*                  _args,
         srslte::channel_ptr(new srslte::channel(args->ul_channel_args, args->nof_rf_channels * args->nof_rx_ant));
   }
 
-  // allocate buffer for noise samples
-  noise_buffer = (cf_t*)srslte_vec_malloc(sizeof(cf_t) * SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM));
-  if (!noise_buffer) {
-    Error("Allocating memory\n");
-    return;
+  // every UE draws different noise
+  srslte_channel_awgn_init(&tx_awgn, (uint32_t)args->sidelink_id);
+  set_transmit_snr(tx_snr);
+
+  capture.init(args->capture_filename,
+               iq_capture::parse_triggers(args->capture_triggers),
+               args->capture_sigmf,
+               args->dl_freq);
+  n_subframes_to_dump         = args->capture_nof_subframes;
+  n_subframes_to_dump_special = args->capture_nof_subframes_high_rssi;
+
+  if (args->pssch_decoder_threads > 0 && !tdec_pool) {
+    tdec_pool = new srslte_tdec_pool_t;
+    if (srslte_tdec_pool_init(tdec_pool, (uint32_t)args->pssch_decoder_threads)) {
+      Error("Error creating %d PSSCH decoder threads, decoding serially\n", args->pssch_decoder_threads);
+      delete tdec_pool;
+      tdec_pool = NULL;
+    }
   }
 
-  // populate buffer with values
-  set_transmit_snr(tx_snr);
+  // exclusion reasons and S-RSSI of the Sensing SPS printout cost time on every selection
+  srslte::CandidateResources::set_debug(args->sensing_debug);
 
   #ifdef ENABLE_REST
   // attach rest api and start it
@@ -211,11 +249,11 @@ void phy_common::set_transmit_snr(float snr) {
 
   tx_snr = snr;
 
-  // initialize with values
-  float scaling = 1.0;
-  float std_dev = powf(10, - (tx_snr + 3.0f) / 20.0f) * scaling;
-
-  srslte_ch_awgn_c(zeros, noise_buffer, std_dev, SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM));
+  // noise power is 10^(-snr/10) relative to the unit power resource elements
+  // of the transmit grid, INFINITY switches the noise off. This is the scale of
+  // the former srslte_ch_awgn_c(std_dev = 10^(-(snr+3)/20)), which scaled each
+  // of I and Q by std_dev.
+  srslte_channel_awgn_set_snr(&tx_awgn, tx_snr);
 }
 
 void phy_common::set_ue_dl_cfg(srslte_ue_dl_cfg_t* ue_dl_cfg)
@@ -832,6 +870,60 @@ void phy_common::get_sync_metrics(sync_metrics_t m[SRSLTE_MAX_CARRIERS])
   sync_metrics_read = true;
 }
 
+phy_common::sl_latency_t* phy_common::add_sl_latency()
+{
+  uint32_t idx = nof_sl_latency.fetch_add(1);
+  if (idx >= max_workers) {
+    fprintf(stderr, "Error: more latency trackers than the %d workers\n", max_workers);
+    return NULL;
+  }
+  return &sl_latency[idx];
+}
+
+void phy_common::get_sl_latency_metrics(sl_latency_metrics_t* m, bool since_start)
+{
+  const uint32_t nof_buckets = srslte::latency_histogram::NOF_BUCKETS;
+  uint32_t       n           = SRSLTE_MIN(nof_sl_latency.load(), max_workers);
+
+  pthread_mutex_lock(&sl_latency_mutex);
+
+  uint32_t misses = 0;
+  for (uint32_t w = 0; w < n; w++) {
+    misses += sl_latency[w].deadline_misses.load(std::memory_order_relaxed);
+  }
+  m->deadline_misses = misses - (since_start ? 0 : sl_latency_last_misses);
+  if (!since_start) {
+    sl_latency_last_misses = misses;
+  }
+
+  for (uint32_t s = 0; s < SL_NOF_STAGES; s++) {
+    uint32_t counts[nof_buckets];
+    bzero(counts, sizeof(counts));
+    for (uint32_t w = 0; w < n; w++) {
+      sl_latency[w].stage[s].accumulate(counts);
+    }
+
+    uint32_t delta[nof_buckets];
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < nof_buckets; i++) {
+      delta[i] = counts[i] - (since_start ? 0 : sl_latency_last[s][i]);
+      total += delta[i];
+    }
+    if (!since_start) {
+      memcpy(sl_latency_last[s], counts, sizeof(counts));
+    }
+
+    m->p50_us[s] = srslte::latency_histogram::percentile(delta, 0.50f) / 1e3f;
+    m->p99_us[s] = srslte::latency_histogram::percentile(delta, 0.99f) / 1e3f;
+    m->max_us[s] = srslte::latency_histogram::percentile(delta, 1.0f) / 1e3f;
+    if (s == SL_STAGE_TTI) {
+      m->count = total;
+    }
+  }
+
+  pthread_mutex_unlock(&sl_latency_mutex);
+}
+
 void phy_common::reset()
 {
   sr_enabled      = false;
@@ -78,6 +78,11 @@ static int plot_worker_id = -1;
 
 namespace srsue {
 
+static uint32_t elapsed_ns(const struct timespec* from, const struct timespec* to)
+{
+  return (uint32_t)((to->tv_sec - from->tv_sec) * 1000000000L + (to->tv_nsec - from->tv_nsec));
+}
+
 sf_worker::sf_worker(uint32_t            max_prb,
                      phy_common*         phy_,
                      srslte::log*        log_h_,
@@ -97,6 +102,8 @@ sf_worker::sf_worker(uint32_t            max_prb,
     cc_workers.push_back(new cc_worker(r, max_prb, phy, log_h));
   }
 
+  sl_latency = phy->add_sl_latency();
+
   pthread_mutex_init(&mutex, NULL);
   reset_();
 }
@@ -253,6 +260,9 @@ void sf_worker::work_imp()
 
   pthread_mutex_lock(&mutex);
 
+  struct timespec t_start, t_lap;
+  clock_gettime(CLOCK_MONOTONIC, &t_start);
+
   /***** Downlink Processing *******/
 
   bool rx_signal_ok = false;
@@ -312,6 +322,8 @@ void sf_worker::work_imp()
   }
 #endif
 
+  clock_gettime(CLOCK_MONOTONIC, &t_lap);
+
   // only do for first carrier
   for (unsigned int carrier_idx = 0; carrier_idx < phy->args->nof_carriers && carrier_idx < 1; carrier_idx++) {
     tx_signal_ready = cc_workers[0]->work_sl_tx();
@@ -341,9 +353,15 @@ void sf_worker::work_imp()
     nof_samples[i] = SRSLTE_SF_LEN_PRB(cell.nof_prb) + next_offset[i];
   }
 
+  struct timespec t_tx, t_end;
+  clock_gettime(CLOCK_MONOTONIC, &t_tx);
+
   // Call worker_end to transmit the signal
   phy->worker_end(tx_sem_id, tx_signal_ready, tx_signal_ptr, nof_samples, tx_time);
 
+  clock_gettime(CLOCK_MONOTONIC, &t_end);
+  record_sl_latency(elapsed_ns(&t_lap, &t_tx), elapsed_ns(&t_tx, &t_end), elapsed_ns(&t_start, &t_end));
+
   if (rx_signal_ok) {
     update_measurements();
   }
@@ -365,6 +383,33 @@ void sf_worker::work_imp()
 #endif
 }
 
+void sf_worker::record_sl_latency(uint32_t tx_ns, uint32_t wait_ns, uint32_t tti_ns)
+{
+  if (!sl_latency) {
+    return;
+  }
+
+  // the receive stages are timed by the carrier workers
+  for (uint32_t s = 0; s < SL_RX_NOF_STAGES; s++) {
+    float us = 0;
+    for (uint32_t carrier_idx = 0; carrier_idx < cc_workers.size(); carrier_idx++) {
+      us += cc_workers[carrier_idx]->get_sl_rx_stage_times()[s];
+    }
+    sl_latency->stage[s].add((uint32_t)(us * 1e3f));
+  }
+  sl_latency->stage[SL_STAGE_TX].add(tx_ns);
+  sl_latency->stage[SL_STAGE_WAIT].add(wait_ns);
+  sl_latency->stage[SL_STAGE_TTI].add(tti_ns);
+
+  // The subframe received in TTI n is transmitted in TTI n + TX_DELAY and its
+  // samples only become available at the end of TTI n, so the worker has
+  // TX_DELAY - 1 ms until the samples have to be with the radio.
+  if (tti_ns > (TX_DELAY - 1) * 1000000u) {
+    sl_latency->deadline_misses.store(sl_latency->deadline_misses.load(std::memory_order_relaxed) + 1,
+                                      std::memory_order_relaxed);
+  }
+}
+
 /********************* Uplink common control functions ****************************/
 
 void sf_worker::reset_uci(srslte_uci_data_t* uci_data)
@@ -44,11 +44,10 @@
  */
 
 /*
- * Note that these functions may be called from multiple cc_worker threads
- *      so we may need to add mutexes to make this multi-thread safe.
- *
- *
- *
+ * Note that these functions are called from multiple cc_worker threads,
+ *      each of them working on a different TTI, and from the REST interface.
+ *      The sensing data of a TTI is only written by the worker of that TTI,
+ *      readers take consistent copies using the slot sequence counters.
  */
 
 #include "srssl/hdr/phy/ue_sl_sensing_sps.h"
@@ -70,9 +69,13 @@ SensingSPS::SensingSPS(SL_CommResourcePoolV2X_r14*     _resourcePool,
   currentPrsvpTx = 0;
 
   sensingWindowFilled = 0;
+  latestTti           = 0;
 
   reservation.active = false;
 
+  randSeeded = false;
+  randState  = 0;
+
 #ifdef USE_SENSING_SPS
   printf("SensingSPS numSubChannels=%d sensingWindowSize=%d\n",
          resourcePool->numSubchannel_r14,
@@ -80,14 +83,25 @@ SensingSPS::SensingSPS(SL_CommResourcePoolV2X_r14*     _resourcePool,
 #endif
   assert(sensingWindowSize <= MAX_SENSING_WINDOW);
 
-  memset(numScis, 0, sizeof(numScis));
-  memset(transmit, 0, sizeof(transmit));
-
   for (int i = 0; i < MAX_SENSING_WINDOW; ++i) {
-    avgSRssi[i] = -INFINITY;
+    slots[i].seq      = 0;
+    slots[i].tti      = UINT32_MAX;
+    slots[i].numScis  = 0;
+    slots[i].avgSRssi = -INFINITY;
     for (int j = 0; j < MAX_SUBCHANNELS; ++j) {
-      sRssi[i][j] = -INFINITY;
+      slots[i].sRssi[j] = -INFINITY;
     }
+    transmit[i] = false;
+  }
+
+  for (int i = 0; i < MAX_SENSING_WINDOW / 64; ++i) {
+    unmonitored[i] = UINT64_MAX;
+  }
+  for (int i = 0; i < PROJECTION_RING_SIZE; ++i) {
+    projections[i].seq            = 0;
+    projections[i].tti            = UINT32_MAX;
+    projections[i].numProjections = 0;
+    projections[i].overflow       = false;
   }
 }
 
@@ -102,18 +116,22 @@ float SensingSPS::getThreshold(uint32_t prioTx, uint32_t prioRx) const
 void SensingSPS::tick(uint32_t tti)
 {
   // should be called before any other TTI processing
-  uint32_t idx = getIdx(tti);
+  SensingSlot* slot = &slots[getIdx(tti)];
 
-  numScis[idx] = 0;
-
-  avgSRssi[idx] = -INFINITY;
+  beginWrite(slot);
+  slot->tti      = tti;
+  slot->numScis  = 0;
+  slot->avgSRssi = -INFINITY;
   for (int i = 0; i < MAX_SUBCHANNELS; ++i) {
-    sRssi[idx][i] = -INFINITY;
+    slot->sRssi[i] = -INFINITY;
   }
+  endWrite(slot);
+
+  setMonitored(tti, false);
 
-  latestTti = tti;
+  latestTti.store(tti, std::memory_order_relaxed);
 
-  if (sensingWindowFilled<1000) {
+  if (sensingWindowFilled.load(std::memory_order_relaxed) < 1000) {
     ++sensingWindowFilled;
   }
 }
@@ -121,28 +139,163 @@ void SensingSPS::tick(uint32_t tti)
 void SensingSPS::addSCI(
     uint32_t tti, uint32_t subChannelStart, uint32_t numSubChannels, uint32_t rsvp, uint32_t priority, float rsrp)
 {
+  SensingSlot* slot = &slots[getIdx(tti)];
+  uint32_t     n    = slot->numScis;
+
+  assert(n < MAX_SCIS_IN_TTI);
+
+  beginWrite(slot);
+  slot->scis[n].subChannelStart = subChannelStart;
+  slot->scis[n].numSubChannels  = numSubChannels;
+  slot->scis[n].rsvp            = rsvp;
+  slot->scis[n].priority        = priority;
+  slot->scis[n].rsrp            = rsrp;
+  slot->numScis                 = n + 1;
+  endWrite(slot);
+
+  // Project the reservation into the TTIs it will occupy, so that the resource
+  // selection only needs to look at the TTIs of its selection window.
+  // j=0 is the TTI of the SCI itself, which never lies in a selection window.
+  if (rsvp > 0) {
+    for (uint32_t j = 1; j * PStep * rsvp <= MAX_PROJECTION_DISTANCE; ++j) {
+      addProjection(tti_add(tti, j * PStep * rsvp), tti, n, j);
+    }
+  }
+}
+
+void SensingSPS::addProjection(uint32_t tti, uint32_t srcTti, uint32_t sci, uint32_t j)
+{
+  SensingProjectionBucket* bucket = &projections[tti % PROJECTION_RING_SIZE];
+
+  beginWrite(bucket);
+
+  // buckets are reused lazily, everything still in there belongs to a TTI
+  // which has already passed
+  if (bucket->tti != tti) {
+    bucket->tti            = tti;
+    bucket->numProjections = 0;
+    bucket->overflow       = false;
+  }
+
+  if (bucket->numProjections == MAX_PROJECTIONS_IN_TTI) {
+    // resourceSelection() falls back to scanning the sensing window
+    bucket->overflow = true;
+  } else {
+    SensingProjection* projection = &bucket->projections[bucket->numProjections++];
+    projection->srcTti            = srcTti;
+    projection->sci               = sci;
+    projection->j                 = j;
+  }
+
+  endWrite(bucket);
+}
+
+void SensingSPS::setMonitored(uint32_t tti, bool monitored)
+{
+  // neighbouring TTIs share a word but are handled by different workers
   uint32_t idx = getIdx(tti);
+  if (monitored) {
+    unmonitored[idx / 64].fetch_and(~(1ULL << (idx % 64)), std::memory_order_relaxed);
+  } else {
+    unmonitored[idx / 64].fetch_or(1ULL << (idx % 64), std::memory_order_relaxed);
+  }
+}
+
+// Copies the SCIs of sensing data index idx, returns their number
+uint32_t SensingSPS::readScis(uint32_t idx, SensingSCI* scis)
+{
+  const SensingSlot* slot    = &slots[idx];
+  uint32_t           numScis = 0;
+
+  readConsistent(slot, [&]() {
+    numScis = std::min(slot->numScis, (uint32_t)MAX_SCIS_IN_TTI);
+    memcpy(scis, slot->scis, numScis * sizeof(SensingSCI));
+  });
+  return numScis;
+}
+
+// Copies SCI number sci received in srcTti, fails if the slot has been reused since
+bool SensingSPS::readSci(uint32_t srcTti, uint32_t sci, SensingSCI* out)
+{
+  const SensingSlot* slot  = &slots[getIdx(srcTti)];
+  bool               found = false;
+
+  readConsistent(slot, [&]() {
+    found = slot->tti == srcTti && sci < slot->numScis && sci < MAX_SCIS_IN_TTI;
+    if (found) {
+      *out = slot->scis[sci];
+    }
+  });
+  return found;
+}
+
+float SensingSPS::getAverageSRSSI(uint32_t tti)
+{
+  const SensingSlot* slot = &slots[getIdx(tti)];
+  float              rssi = -INFINITY;
+
+  readConsistent(slot, [&]() { rssi = (slot->tti == tti % 10240) ? slot->avgSRssi : -INFINITY; });
+  return rssi;
+}
+
+float SensingSPS::getAverageSRSRP(uint32_t tti)
+{
+  const SensingSlot* slot = &slots[getIdx(tti)];
+  float              rsrp = -INFINITY;
+
+  readConsistent(slot, [&]() { rsrp = (slot->tti == tti % 10240 && slot->numScis) ? slot->scis[0].rsrp : -INFINITY; });
+  return rsrp;
+}
+
+bool SensingSPS::getSnapshot(uint32_t tti, uint32_t numSubChannels, SensingSnapshot* snapshot)
+{
+  const SensingSlot* slot  = &slots[getIdx(tti)];
+  bool               found = false;
+
+  numSubChannels = std::min(numSubChannels, (uint32_t)MAX_SUBCHANNELS);
+
+  readConsistent(slot, [&]() {
+    found = slot->tti == tti % 10240;
+    if (found) {
+      snapshot->tti      = slot->tti;
+      snapshot->avgSRssi = slot->avgSRssi;
+      snapshot->numScis  = std::min(slot->numScis, (uint32_t)MAX_SCIS_IN_TTI);
+      memcpy(snapshot->sRssi, slot->sRssi, numSubChannels * sizeof(float));
+      memcpy(snapshot->scis, slot->scis, snapshot->numScis * sizeof(SensingSCI));
+    }
+  });
+  return found;
+}
 
-  assert(numScis[idx] < MAX_SCIS_IN_TTI);
+float SensingSPS::getSRSSI(uint32_t tti, uint32_t channel)
+{
+  const SensingSlot* slot = &slots[getIdx(tti)];
+  float              rssi = -INFINITY;
 
-  scis[idx][numScis[idx]].subChannelStart = subChannelStart;
-  scis[idx][numScis[idx]].numSubChannels  = numSubChannels;
-  scis[idx][numScis[idx]].rsvp            = rsvp;
-  scis[idx][numScis[idx]].priority        = priority;
-  scis[idx][numScis[idx]].rsrp            = rsrp;
+  readConsistent(slot, [&]() { rssi = slot->sRssi[channel]; });
+  return rssi;
+}
 
-  ++numScis[idx];
+void SensingSPS::setRandomSeed(uint32_t seed)
+{
+  randState  = seed;
+  randSeeded = true;
 }
 
-uint32_t SensingSPS::calc_reselection_counter(uint32_t rsvp) const
+uint32_t SensingSPS::nextRandom()
+{
+  return randSeeded ? (uint32_t)rand_r(&randState) : (uint32_t)rand();
+}
+
+uint32_t SensingSPS::calc_reselection_counter(uint32_t rsvp)
 {
   uint32_t cresel = 0;
   if (rsvp>=100) {
-    cresel = (rand() % 10) + 5;
+    cresel = (nextRandom() % 10) + 5;
   } else if (rsvp==50) {
-    cresel = (rand() % 20) + 10;
+    cresel = (nextRandom() % 20) + 10;
   } else if (rsvp==20) {
-    cresel = (rand() % 50) + 25;
+    cresel = (nextRandom() % 50) + 25;
   }
   return cresel;
 }
@@ -162,7 +315,7 @@ ReservationResource* SensingSPS::schedule(uint32_t tti, uint32_t bufferOccupancy
           // select same reservation again
           int32_t probResourceKeep = sensingConfig->probResourceKeep_r14 * 100; // convert to a percentage
 
-          if (rand() % 100 <= probResourceKeep) {
+          if ((int32_t)(nextRandom() % 100) <= probResourceKeep) {
             reservation.active = true;
             reservation.Cresel = calc_reselection_counter(reservation.rsvp);
             reservation.startRsvpTti = tti;
@@ -207,9 +360,9 @@ ReservationResource* SensingSPS::schedule(uint32_t tti, uint32_t bufferOccupancy
     if (retransmit) {
       // randomly select a candidate, and try and find a retransmission opportunity
       // returns sl_gap=0 if no retransmission is available
-      candidates.random_with_retx(selectionWindowOffset,subchannelStart,numSubchannels,sl_gap);
+      candidates.random_with_retx(nextRandom(),selectionWindowOffset,subchannelStart,numSubchannels,sl_gap);
     } else {
-      candidates.random(selectionWindowOffset,subchannelStart,numSubchannels);
+      candidates.random(nextRandom(),selectionWindowOffset,subchannelStart,numSubchannels);
     }
 
     candidates.print(false);
@@ -272,7 +425,58 @@ ReservationResource* SensingSPS::schedule(uint32_t tti, uint32_t bufferOccupancy
 CandidateResources SensingSPS::resourceSelection(uint32_t tti, uint32_t t1, uint32_t t2, uint32_t LSubCh, uint32_t prioTx, uint32_t Cresel, uint32_t PrsvpTx)
 {
   // If we do not have enough sensing data, return an empty set of candidate resources
-  if (sensingWindowFilled<sensingWindowSize) {
+  if (sensingWindowFilled.load(std::memory_order_relaxed) < sensingWindowSize) {
+    return CandidateResources();
+  }
+
+  printf("resourceSelection tti=%d t1=%d t2=%d LSubCh=%d\n", tti, t1, t2, LSubCh);
+  assert(t1 <= 4 && t2 >= 20 && t2 <= 100); // @todo 20 can be overridden by higher layer prioTx parameter
+  uint32_t selectionWindowLength = t2 - t1;
+
+  assert(LSubCh > 0 && LSubCh <= resourcePool->numSubchannel_r14);
+
+  CandidateResources setA(selectionWindowLength, LSubCh, resourcePool->numSubchannel_r14);
+  uint32_t           MTotal = setA.size();
+
+  uint32_t PrsvpPrime = PrsvpTx * PStep / 100;
+
+  // remove any subframes which we did not monitor
+  // 36.213 v15.2.0 14.1.1.6 (6)
+  // Only the unmonitored subframes of the sensing window are visited,
+  // see resourceSelectionFullScan() for the meaning of tti and z.
+  for (uint32_t w = 0; w < MAX_SENSING_WINDOW / 64; ++w) {
+    uint64_t bits = unmonitored[w].load(std::memory_order_relaxed);
+    while (bits) {
+      uint32_t idx = w * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+
+      uint32_t age = (getIdx(tti) + MAX_SENSING_WINDOW - idx) % MAX_SENSING_WINDOW;
+      if (age == 0 || age > sensingWindowSize + 1) {
+        // not part of the sensing window
+        continue;
+      }
+      removeUnmonitored(setA, add_tti_wrap(tti), -(int32_t)age, t1, t2, Cresel, PrsvpPrime);
+    }
+  }
+
+  // SCIs
+  CandidateResources copyOfSetA = removeScisProjected(setA, tti, t1, t2, LSubCh, prioTx, Cresel, MTotal);
+
+  // Linear Average of S-RSSI
+  tti = add_tti_wrap(tti);
+  copyOfSetA.handleSrssi(this, tti - sensingWindowSize - 1, tti - 1, t1, t2, MTotal);
+
+  if (copyOfSetA.size() != MTotal) {
+    copyOfSetA.print(true);
+  }
+
+  return copyOfSetA;
+}
+
+CandidateResources SensingSPS::resourceSelectionFullScan(uint32_t tti, uint32_t t1, uint32_t t2, uint32_t LSubCh, uint32_t prioTx, uint32_t Cresel, uint32_t PrsvpTx)
+{
+  // If we do not have enough sensing data, return an empty set of candidate resources
+  if (sensingWindowFilled.load(std::memory_order_relaxed) < sensingWindowSize) {
     return CandidateResources();
   }
 
@@ -309,81 +513,106 @@ CandidateResources SensingSPS::resourceSelection(uint32_t tti, uint32_t t1, uint
   //   idx is the index into the sensing data, starting from the previous TTI
   //   z is the subframe of idx relative to the current TTI
 
-  uint32_t count;
   uint32_t  PrsvpPrime = PrsvpTx * PStep / 100;
 
   for (uint32_t sensingWindowTti = sensingWindowStartTti; sensingWindowTti <= sensingWindowEndTti; ++sensingWindowTti) {
     uint32_t idx = getIdx(sensingWindowTti);
     int32_t z = sensingWindowTti - sensingWindowEndTti - 1;
 
-    //printf("tti %d sensingWindowTti %d z %d idx %d avgRssi %f\n",remove_tti_wrap(tti),remove_tti_wrap(sensingWindowTti),z,idx,avgSRssi[idx]);
+    //printf("tti %d sensingWindowTti %d z %d idx %d avgRssi %f\n",remove_tti_wrap(tti),remove_tti_wrap(sensingWindowTti),z,idx,slots[idx].avgSRssi);
 
-    if (avgSRssi[idx] == -INFINITY) {
+    float avgSRssi = -INFINITY;
+    readConsistent(&slots[idx], [&]() { avgSRssi = slots[idx].avgSRssi; });
+
+    if (avgSRssi == -INFINITY) {
       // Found a subframe we didn't monitor.
       //printf("tti %d did not monitor tti=%d (idx=%d,z=%d)\n", remove_tti_wrap(tti),remove_tti_wrap(sensingWindowTti), idx, z);
+      removeUnmonitored(setA, tti, z, t1, t2, Cresel, PrsvpPrime);
+    }
+  }
 
-      // For each restrictResourceReservationPeriod
-      for (uint32_t nrri = 0;
-           nrri < maxReservationPeriod_r14 && sensingConfig->restrictResourceReservationPeriod_r14[nrri] != 0.0;
-           ++nrri) {
-        float   k = sensingConfig->restrictResourceReservationPeriod_r14[nrri];
-        int32_t Q;
-        if (k < 1) {
-          // @todo should also check nprime - z <= Pstep * k
-          printf("nPrime (?) <= Pstep * k + z (%f)\n", PStep * k + z);
-          Q = 1 / k;
-        } else {
-          Q = 1;
-        }
-        // printf("z %d PStep %d k %f Q %d Cresel %d tti %d\n", z, PStep, k, Q, Cresel,z+tti);
-        for (int32_t q = 1; q <= Q; ++q) {
-          for (int32_t j = 0; j < (int32_t)Cresel; ++j) {
-            int32_t y = z + (int32_t)PStep * k * q - j * PrsvpPrime;
-            // Removing any values which lie in the selection window
-            // @todo what about potential retransmissions?
-            if (y >= (int32_t)t1 && y <= (int32_t)t2) {
-              uint32_t removed = setA.remove(y - t1,CANDIDATE_UNMONITORED);
-              if (removed)
-                printf("tti %d removed %d unmonitored resources for tti %d\n", remove_tti_wrap(tti), removed, remove_tti_wrap(y + tti));
-            }
-          }
+  // SCIs
+  CandidateResources copyOfSetA = removeScisFullScan(setA, tti, t1, t2, prioTx, Cresel, MTotal);
+
+  // Linear Average of S-RSSI
+  copyOfSetA.handleSrssi(this,sensingWindowStartTti,sensingWindowEndTti,t1,t2,MTotal);
+
+  if (copyOfSetA.size() != MTotal) {
+    copyOfSetA.print(true);
+  }
+
+  return copyOfSetA;
+}
+
+void SensingSPS::removeUnmonitored(
+    CandidateResources& setA, uint32_t tti, int32_t z, uint32_t t1, uint32_t t2, uint32_t Cresel, uint32_t PrsvpPrime)
+{
+  // For each restrictResourceReservationPeriod
+  for (uint32_t nrri = 0;
+       nrri < maxReservationPeriod_r14 && sensingConfig->restrictResourceReservationPeriod_r14[nrri] != 0.0;
+       ++nrri) {
+    float   k = sensingConfig->restrictResourceReservationPeriod_r14[nrri];
+    int32_t Q;
+    if (k < 1) {
+      // @todo should also check nprime - z <= Pstep * k
+      printf("nPrime (?) <= Pstep * k + z (%f)\n", PStep * k + z);
+      Q = 1 / k;
+    } else {
+      Q = 1;
+    }
+    // printf("z %d PStep %d k %f Q %d Cresel %d tti %d\n", z, PStep, k, Q, Cresel,z+tti);
+    for (int32_t q = 1; q <= Q; ++q) {
+      for (int32_t j = 0; j < (int32_t)Cresel; ++j) {
+        int32_t y = z + (int32_t)PStep * k * q - j * PrsvpPrime;
+        // Removing any values which lie in the selection window
+        // @todo what about potential retransmissions?
+        if (y >= (int32_t)t1 && y <= (int32_t)t2) {
+          uint32_t removed = setA.remove(y - t1,CANDIDATE_UNMONITORED);
+          if (removed)
+            printf("tti %d removed %d unmonitored resources for tti %d\n", remove_tti_wrap(tti), removed, remove_tti_wrap(y + tti));
         }
       }
     }
   }
+}
+
+CandidateResources SensingSPS::removeScisFullScan(
+    CandidateResources& setA, uint32_t tti, uint32_t t1, uint32_t t2, uint32_t prioTx, uint32_t Cresel, uint32_t MTotal)
+{
+  uint32_t sensingWindowStartTti = tti - sensingWindowSize - 1;
+  uint32_t sensingWindowEndTti = tti - 1;
 
-  // SCIs
   CandidateResources copyOfSetA;
   float              threshDelta = 0.0;
-  int32_t            m;
+  SensingSCI         scis[MAX_SCIS_IN_TTI];
 
   do {
     copyOfSetA = setA;
 
     for (uint32_t sensingWindowTti = sensingWindowStartTti; sensingWindowTti <= sensingWindowEndTti; ++sensingWindowTti) {
-      uint32_t idx = getIdx(sensingWindowTti);
+      uint32_t numScis = readScis(getIdx(sensingWindowTti), scis);
       int32_t m = sensingWindowTti - sensingWindowEndTti - 1;
 
-      for (uint32_t sci = 0; sci < numScis[idx]; ++sci) {
-        uint32_t PrioRx  = scis[idx][sci].priority;
-        uint32_t PrsvpRx = scis[idx][sci].rsvp; // @todo should rsvp be a float?
+      for (uint32_t sci = 0; sci < numScis; ++sci) {
+        uint32_t PrioRx  = scis[sci].priority;
+        uint32_t PrsvpRx = scis[sci].rsvp; // @todo should rsvp be a float?
         float    thresh  = getThreshold(prioTx, PrioRx) + threshDelta;
 
-        printf("tti %d Handling SCI %d PrioRx %d PrsvpRx %d RSRP %f Threshold %f\n",remove_tti_wrap(tti),remove_tti_wrap(sensingWindowTti),PrioRx,PrsvpRx,scis[idx][sci].rsrp, thresh);
+        printf("tti %d Handling SCI %d PrioRx %d PrsvpRx %d RSRP %f Threshold %f\n",remove_tti_wrap(tti),remove_tti_wrap(sensingWindowTti),PrioRx,PrsvpRx,scis[sci].rsrp, thresh);
 
         // Only check SCIs which are above the RSRP threshold, and
         // have a resource_reservation field.
-        if (scis[idx][sci].rsrp > thresh && PrsvpRx > 0) {
+        if (scis[sci].rsrp > thresh && PrsvpRx > 0) {
           for (int32_t j = 0; j < (int32_t)Cresel; ++j) {
             int32_t y = m + j * PStep * PrsvpRx;
             if (y >= (int32_t)t1 && y <= (int32_t)t2) {
-              uint32_t removed = copyOfSetA.remove(y - t1, scis[idx][sci].subChannelStart, scis[idx][sci].numSubChannels,CANDIDATE_SCI_RSRP_THRESH);
+              uint32_t removed = copyOfSetA.remove(y - t1, scis[sci].subChannelStart, scis[sci].numSubChannels,CANDIDATE_SCI_RSRP_THRESH);
               if (removed)
                 printf("tti %d removed %d candidates sci %d:%d tti %d\n",
                        remove_tti_wrap(tti),
                        removed,
-                       scis[idx][sci].subChannelStart,
-                       scis[idx][sci].numSubChannels,
+                       scis[sci].subChannelStart,
+                       scis[sci].numSubChannels,
                        remove_tti_wrap(y + tti));
             }
           }
@@ -392,12 +621,119 @@ CandidateResources SensingSPS::resourceSelection(uint32_t tti, uint32_t t1, uint
     }
     threshDelta += 3.0; // increase by 3dBm
   } while ((float)copyOfSetA.size() < 0.2 * MTotal);
-  
-  // Linear Average of S-RSSI
-  copyOfSetA.handleSrssi(this,sensingWindowStartTti,sensingWindowEndTti,t1,t2,MTotal);
 
-  if (copyOfSetA.size() != MTotal) {
-    copyOfSetA.print(true);
+  return copyOfSetA;
+}
+
+// Number of 3dB increments of the threshold for which an SCI with this RSRP
+// still excludes its resources, as done by the loop in removeScisFullScan()
+static uint32_t threshold_steps(float rsrp, float thresh)
+{
+  uint32_t steps       = 0;
+  float    threshDelta = 0.0;
+
+  while (rsrp > thresh + threshDelta && steps < MAX_THRESHOLD_STEPS) {
+    threshDelta += 3.0;
+    ++steps;
+  }
+  return steps;
+}
+
+CandidateResources SensingSPS::removeScisProjected(CandidateResources& setA,
+                                                   uint32_t            tti,
+                                                   uint32_t            t1,
+                                                   uint32_t            t2,
+                                                   uint32_t            LSubCh,
+                                                   uint32_t            prioTx,
+                                                   uint32_t            Cresel,
+                                                   uint32_t            MTotal)
+{
+  uint32_t selectionWindowLength = t2 - t1;
+  uint32_t NSubCh                = resourcePool->numSubchannel_r14;
+
+  // For each subframe of the selection window and subchannel, the number of
+  // threshold increments until no received reservation occupies it anymore
+  uint8_t occupancy[MAX_SELECTION_WINDOW][MAX_SUBCHANNELS];
+  memset(occupancy, 0, sizeof(occupancy));
+
+  // y = t2 is not part of setA
+  for (uint32_t y = t1; y < t2; ++y) {
+    uint32_t                 projectedTti = tti_add(tti, y);
+    SensingProjectionBucket* bucket       = &projections[projectedTti % PROJECTION_RING_SIZE];
+
+    uint32_t          numProjections = 0;
+    bool              overflow       = false;
+    SensingProjection bucketProjections[MAX_PROJECTIONS_IN_TTI];
+
+    readConsistent(bucket, [&]() {
+      numProjections = 0;
+      overflow       = false;
+      if (bucket->tti == projectedTti) {
+        numProjections = std::min(bucket->numProjections, (uint32_t)MAX_PROJECTIONS_IN_TTI);
+        overflow       = bucket->overflow;
+        memcpy(bucketProjections, bucket->projections, numProjections * sizeof(SensingProjection));
+      }
+    });
+
+    if (overflow) {
+      // we lost projections for this subframe
+      return removeScisFullScan(setA, add_tti_wrap(tti), t1, t2, prioTx, Cresel, MTotal);
+    }
+
+    for (uint32_t i = 0; i < numProjections; ++i) {
+      SensingProjection* projection = &bucketProjections[i];
+
+      // only SCIs received within the sensing window are considered
+      uint32_t age = tti_add(tti, -(int32_t)projection->srcTti);
+      if (age == 0 || age > sensingWindowSize + 1 || projection->j >= Cresel) {
+        continue;
+      }
+
+      SensingSCI sci;
+      if (!readSci(projection->srcTti, projection->sci, &sci)) {
+        continue;
+      }
+      uint32_t steps = threshold_steps(sci.rsrp, getThreshold(prioTx, sci.priority));
+
+      for (uint32_t l = sci.subChannelStart; l < sci.subChannelStart + sci.numSubChannels && l < MAX_SUBCHANNELS; ++l) {
+        occupancy[y - t1][l] = std::max(occupancy[y - t1][l], (uint8_t)steps);
+      }
+    }
+  }
+
+  // A candidate can be used once all of its subchannels are unoccupied
+  uint8_t  candidateSteps[MAX_SELECTION_WINDOW][MAX_CANDIDATE_RESOURCES];
+  uint32_t candidatesAtStep[MAX_THRESHOLD_STEPS + 1] = {};
+
+  for (uint32_t idx = 0; idx < selectionWindowLength; ++idx) {
+    for (uint32_t chan = 0; chan + LSubCh <= NSubCh; ++chan) {
+      if (!setA.valid(idx, chan)) {
+        continue;
+      }
+      uint8_t steps = 0;
+      for (uint32_t l = chan; l < chan + LSubCh; ++l) {
+        steps = std::max(steps, occupancy[idx][l]);
+      }
+      candidateSteps[idx][chan] = steps;
+      ++candidatesAtStep[steps];
+    }
+  }
+
+  // increase the threshold by 3dBm until at least 20% of the candidates are left
+  uint32_t step      = 0;
+  uint32_t available = candidatesAtStep[0];
+  while ((float)available < 0.2 * MTotal && step < MAX_THRESHOLD_STEPS) {
+    available += candidatesAtStep[++step];
+  }
+
+  CandidateResources copyOfSetA(setA);
+
+  for (uint32_t idx = 0; idx < selectionWindowLength; ++idx) {
+    for (uint32_t chan = 0; chan + LSubCh <= NSubCh; ++chan) {
+      if (setA.valid(idx, chan) && candidateSteps[idx][chan] > step) {
+        copyOfSetA.remove(idx, chan, CANDIDATE_SCI_RSRP_THRESH);
+      }
+    }
   }
 
   return copyOfSetA;
@@ -405,13 +741,23 @@ CandidateResources SensingSPS::resourceSelection(uint32_t tti, uint32_t t1, uint
 
 void SensingSPS::addAverageSRSSI(uint32_t tti, float _sRssi)
 {
-  avgSRssi[getIdx(tti)] = _sRssi;
+  SensingSlot* slot = &slots[getIdx(tti)];
+
+  beginWrite(slot);
+  slot->avgSRssi = _sRssi;
+  endWrite(slot);
+
+  setMonitored(tti, _sRssi != -INFINITY);
 }
 
 void SensingSPS::addChannelSRSSI(uint32_t tti, uint32_t channel, float _sRssi)
 {
   assert(channel < MAX_SUBCHANNELS);
-  sRssi[getIdx(tti)][channel] = _sRssi;
+  SensingSlot* slot = &slots[getIdx(tti)];
+
+  beginWrite(slot);
+  slot->sRssi[channel] = _sRssi;
+  endWrite(slot);
 }
 
 class DummyUe {
@@ -490,61 +836,113 @@ void SensingSPS::dummyRx(uint32_t tti)
   }
 }
 
+bool CandidateResources::debug = false;
+
+// Bits first..last (inclusive) of word w of a candidate mask
+static inline uint64_t range_mask(int32_t first, int32_t last, uint32_t w)
+{
+  int32_t lo = std::max(first, (int32_t)(w * 64));
+  int32_t hi = std::min(last, (int32_t)(w * 64 + 63));
+
+  if (lo > hi) {
+    return 0;
+  }
+  uint64_t upper = (hi % 64 == 63) ? ~0ULL : (1ULL << (hi % 64 + 1)) - 1;
+  return upper & ~((1ULL << (lo % 64)) - 1);
+}
+
 CandidateResources::CandidateResources(uint32_t _windowSize, uint32_t _LSubCh, uint32_t _NSubCh)
 {
   windowSize = _windowSize;
   LSubCh     = _LSubCh;
   NSubCh     = _NSubCh;
 
-  memset(numResources, 0, sizeof(numResources));
-  memset(resources, 0, sizeof(resources));
-
-  setSize = 0;
+  memset(mask, 0, sizeof(mask));
 
   for (uint32_t i = 0; i < windowSize; ++i) {
-    numResources[i] = 0;
-    for (uint32_t chan = 0; chan + LSubCh <= NSubCh; ++chan) {
-      resources[i][numResources[i]].valid           = CANDIDATE_VALID;
-      resources[i][numResources[i]].subChannelStart = chan;
-      ++numResources[i];
-      ++setSize;
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      mask[i][w] = range_mask(0, (int32_t)NSubCh - (int32_t)LSubCh, w);
+    }
+  }
+
+  if (debug) {
+    memset(reasons, CANDIDATE_INVALID, sizeof(reasons));
+    for (uint32_t i = 0; i < windowSize; ++i) {
+      for (uint32_t chan = 0; chan + LSubCh <= NSubCh; ++chan) {
+        reasons[i][chan] = CANDIDATE_VALID;
+      }
     }
   }
 }
 
 CandidateResources::CandidateResources(const CandidateResources& other)
+{
+  *this = other;
+}
+
+CandidateResources& CandidateResources::operator=(const CandidateResources& other)
 {
   windowSize = other.windowSize;
   LSubCh     = other.LSubCh;
   NSubCh     = other.NSubCh;
-  setSize    = other.setSize;
 
-  memcpy(numResources, other.numResources, sizeof(numResources));
-  memcpy(resources, other.resources, sizeof(resources));
+  memcpy(mask, other.mask, sizeof(mask));
+
+  if (debug) {
+    memcpy(reasons, other.reasons, sizeof(reasons));
+    memcpy(avgRssi, other.avgRssi, sizeof(avgRssi));
+  }
+  return *this;
+}
+
+uint32_t CandidateResources::size() const
+{
+  uint32_t setSize = 0;
+  for (uint32_t i = 0; i < windowSize; ++i) {
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      setSize += __builtin_popcountll(mask[i][w]);
+    }
+  }
+  return setSize;
+}
+
+void CandidateResources::clear(uint32_t idx, const uint64_t remove[CANDIDATE_WORDS], CandidateResourceStatus reason)
+{
+  for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+    uint64_t removed = mask[idx][w] & remove[w];
+    mask[idx][w] &= ~removed;
+
+    if (debug) {
+      while (removed) {
+        reasons[idx][w * 64 + __builtin_ctzll(removed)] = reason;
+        removed &= removed - 1;
+      }
+    }
+  }
 }
 
 uint32_t CandidateResources::remove(uint32_t idx, CandidateResourceStatus reason)
 {
+  uint64_t all[CANDIDATE_WORDS];
   uint32_t removed = 0;
 
-  if (numResources[idx] == 0)
-    return removed;
-
-  for (uint32_t i = 0; i < MAX_CANDIDATE_RESOURCES; ++i) {
-    if (resources[idx][i].valid == CANDIDATE_VALID) {
-      removed += remove(idx,i,reason);
-    }
+  for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+    all[w] = ~0ULL;
+    removed += __builtin_popcountll(mask[idx][w]);
   }
+  clear(idx, all, reason);
 
   return removed;
 }
 
 uint32_t CandidateResources::remove(uint32_t idx, uint32_t channel, CandidateResourceStatus reason)
 {
-  if (numResources[idx] != 0 && resources[idx][channel].valid == CANDIDATE_VALID) {
-    resources[idx][channel].valid = reason;
-    --setSize;
-    --numResources[idx];
+  if (valid(idx, channel)) {
+    uint64_t single[CANDIDATE_WORDS];
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      single[w] = range_mask(channel, channel, w);
+    }
+    clear(idx, single, reason);
     return 1;
   }
   return 0;
@@ -552,21 +950,19 @@ uint32_t CandidateResources::remove(uint32_t idx, uint32_t channel, CandidateRes
 
 uint32_t CandidateResources::remove(uint32_t idx, uint32_t channel, uint32_t len, CandidateResourceStatus reason)
 {
+  // Candidates starting in (channel - LSubCh, channel + len) overlap
+  // with subchannels channel .. channel + len - 1
+  int32_t  first = std::max((int32_t)channel - (int32_t)LSubCh + 1, 0);
+  int32_t  last  = (int32_t)channel + (int32_t)len - 1;
+  uint64_t overlap[CANDIDATE_WORDS];
   uint32_t removed = 0;
 
-  if (numResources[idx] == 0)
-    return removed;
-
-  for (uint32_t i = 0; i < MAX_CANDIDATE_RESOURCES; ++i) {
-    if (resources[idx][i].valid == CANDIDATE_VALID) {
-      if (resources[idx][i].subChannelStart >= channel + len || resources[idx][i].subChannelStart + LSubCh <= channel) {
-        // okay
-      } else {
-        // overlap
-        removed += remove(idx,i,reason);
-      }
-    }
+  for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+    overlap[w] = range_mask(first, last, w);
+    removed += __builtin_popcountll(mask[idx][w] & overlap[w]);
   }
+  clear(idx, overlap, reason);
+
   return removed;
 }
 
@@ -575,10 +971,15 @@ void CandidateResources::print(bool withRssi)
   for (uint32_t j = 0; j <= NSubCh-LSubCh; ++j) {
     printf("%02d+%d", j,LSubCh);
     for (uint32_t i = 0; i < windowSize; ++i) {
-      switch (resources[i][j].valid) {
-        case CANDIDATE_VALID:
-          printf(" *");
-          break;
+      if (valid(i, j)) {
+        printf(" *");
+        continue;
+      }
+      if (!debug) {
+        printf(" -");
+        continue;
+      }
+      switch (reasons[i][j]) {
         case CANDIDATE_UNMONITORED:
           printf(" U");
           break;
@@ -598,11 +999,11 @@ void CandidateResources::print(bool withRssi)
     }
     printf("\n");
   }
-  if (withRssi) {
+  if (withRssi && debug) {
     for (uint32_t j = 0; j <= NSubCh-LSubCh; ++j) {
       printf("%02d+%d", j,LSubCh);
       for (uint32_t i = 0; i < windowSize; ++i) {
-        if (resources[i][j].valid!=CANDIDATE_UNMONITORED) {
+        if (reasons[i][j]!=CANDIDATE_UNMONITORED) {
           printf(" %.2f",avgRssi[i][j]);
         } else {
           printf(" -");
@@ -617,20 +1018,18 @@ void CandidateResources::handleSrssi(
     SensingSPS* sps, uint32_t sensingWindowStartTti, uint32_t sensingWindowEndTti, uint32_t t1, uint32_t t2, uint32_t MTotal)
 {
   uint32_t numRssiToSort = 0;
-  float rssiToSort[MAX_SELECTION_WINDOW*MAX_CANDIDATE_RESOURCES] = { 0.0 };
+  float    rssiToSort[MAX_SELECTION_WINDOW * MAX_CANDIDATE_RESOURCES];
 
   for (uint32_t selectionIdx = 0; selectionIdx < windowSize; ++selectionIdx) {
-    for (uint32_t chan = 0; chan < MAX_CANDIDATE_RESOURCES; ++chan) {
-      if (resources[selectionIdx][chan].valid == CANDIDATE_VALID) {
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      uint64_t bits = mask[selectionIdx][w];
+      while (bits) {
+        uint32_t chan = w * 64 + __builtin_ctzll(bits);
+        bits &= bits - 1;
 
         float    sumRssi = 0.0;
         uint32_t numRssi = 0;
 
-        for (uint32_t sensingWindowTti = sensingWindowStartTti; sensingWindowTti <= sensingWindowEndTti;
-             ++sensingWindowTti) {
-          int32_t z = sensingWindowTti - sensingWindowEndTti - 1;
-          int32_t y = selectionIdx + t1 - z;
-
 /*
   j is non-negative integer
   if (PrsvpTx >= 100) {
@@ -639,14 +1038,17 @@ void CandidateResources::handleSrssi(
       y - PrsvpTxPrime * j
   }
 */
-
-          if ( y % 100 /* @todo */ == 0) {
-            for (uint32_t l = resources[selectionIdx][chan].subChannelStart; l <= LSubCh; ++l) {
-              float rssi = sps->getSRSSI(sensingWindowTti, l);
-              if (rssi!=-INFINITY) {
-                sumRssi += rssi;
-                ++numRssi;
-              }
+        // Only the sensing subframes z with y = selectionIdx + t1 - z being
+        // a multiple of 100 contribute, visit them in ascending order
+        uint32_t y0               = selectionIdx + t1;
+        uint32_t sensingWindowTti = sensingWindowStartTti + (sensingWindowEndTti + 1 + y0 - sensingWindowStartTti) % 100 /* @todo */;
+
+        for (; sensingWindowTti <= sensingWindowEndTti; sensingWindowTti += 100) {
+          for (uint32_t l = chan; l <= LSubCh; ++l) {
+            float rssi = sps->getSRSSI(sensingWindowTti, l);
+            if (rssi!=-INFINITY) {
+              sumRssi += rssi;
+              ++numRssi;
             }
           }
         }
@@ -662,66 +1064,79 @@ void CandidateResources::handleSrssi(
     }
   }
 
+  if (numRssiToSort == 0) {
+    return;
+  }
+
   //
   // We want to 'sort' the candidate resources and only keep the 0.2*MTotal candidates
   // with the lowest avgRssi.
-  // To do this we will sort the rssiToSort array, and use this to find the threshold,
-  // and then remove the candidates from the set.
+  // To do this we find the threshold in the rssiToSort array, and then remove the
+  // candidates from the set. Note that the last element does not take part in the
+  // ranking.
   //
-  std::sort(&rssiToSort[0], &rssiToSort[numRssiToSort - 1]);
-
   uint32_t threshold_index = (uint32_t)(0.2 * MTotal);
   if (threshold_index > 0)
     threshold_index -= 1;
-  float threshold = rssiToSort[threshold_index];
+
+  float threshold = 0.0;
+  if (threshold_index + 1 < numRssiToSort) {
+    std::nth_element(&rssiToSort[0], &rssiToSort[threshold_index], &rssiToSort[numRssiToSort - 1]);
+    threshold = rssiToSort[threshold_index];
+  } else if (threshold_index < numRssiToSort) {
+    threshold = rssiToSort[threshold_index];
+  }
 
   for (uint32_t selectionIdx = 0; selectionIdx < windowSize; ++selectionIdx) {
-    for (uint32_t chan = 0; chan < MAX_CANDIDATE_RESOURCES; ++chan) {
-      if (resources[selectionIdx][chan].valid == CANDIDATE_VALID) {
-        if (avgRssi[selectionIdx][chan] > threshold) {
-          remove(selectionIdx,chan,CANDIDATE_RSSI);
+    uint64_t above[CANDIDATE_WORDS] = {};
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      uint64_t bits = mask[selectionIdx][w];
+      while (bits) {
+        uint32_t bit = __builtin_ctzll(bits);
+        bits &= bits - 1;
+        if (avgRssi[selectionIdx][w * 64 + bit] > threshold) {
+          above[w] |= 1ULL << bit;
         }
       }
     }
+    clear(selectionIdx, above, CANDIDATE_RSSI);
   }
 }
 
-void CandidateResources::random(uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels)
+void CandidateResources::random(uint32_t rnd, uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels)
 {
 
   // Randomly choose one of the candidate resources
   // Once it has been chosen, it is then removed from the set.
   //
-  uint32_t num = 0;
+  uint32_t chosen = rnd % size();
 
   for (uint32_t selectionIdx = 0; selectionIdx < windowSize; ++selectionIdx) {
-    num += numResources[selectionIdx];
-  }
-
-  uint32_t chosen = rand() % num;
-  uint32_t count = 0;
+    for (uint32_t w = 0; w < CANDIDATE_WORDS; ++w) {
+      uint32_t num = __builtin_popcountll(mask[selectionIdx][w]);
+      if (chosen >= num) {
+        chosen -= num;
+        continue;
+      }
 
-  for (uint32_t selectionIdx = 0; selectionIdx < windowSize; ++selectionIdx) {
-    if (numResources[selectionIdx] != 0) {
-      for (uint32_t chan = 0; chan < MAX_CANDIDATE_RESOURCES; ++chan) {
-        if (resources[selectionIdx][chan].valid == CANDIDATE_VALID) {
-          if (count==chosen) {
-            selectionWindowOffset = selectionIdx;
-            subchannelStart = resources[selectionIdx][chan].subChannelStart;
-            numSubchannels = LSubCh;
-            remove(selectionIdx,chan,CANDIDATE_CHOSEN);
-            return;
-          }
-          ++count;
-        }
+      // skip the preceding candidates of this word
+      uint64_t bits = mask[selectionIdx][w];
+      while (chosen--) {
+        bits &= bits - 1;
       }
+
+      selectionWindowOffset = selectionIdx;
+      subchannelStart = w * 64 + __builtin_ctzll(bits);
+      numSubchannels = LSubCh;
+      remove(selectionIdx,subchannelStart,CANDIDATE_CHOSEN);
+      return;
     }
   }
 }
 
-void CandidateResources::random_with_retx(uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels, uint32_t& sl_gap)
+void CandidateResources::random_with_retx(uint32_t rnd, uint32_t& selectionWindowOffset, uint32_t& subchannelStart, uint32_t& numSubchannels, uint32_t& sl_gap)
 {
-  random(selectionWindowOffset, subchannelStart, numSubchannels);
+  random(rnd, selectionWindowOffset, subchannelStart, numSubchannels);
 
   sl_gap = 0;
 
@@ -736,24 +1151,18 @@ void CandidateResources::random_with_retx(uint32_t& selectionWindowOffset, uint3
   for (uint32_t selectionIdx = (selectionWindowOffset >= 15) ? selectionWindowOffset - 15 : 0;
        selectionIdx < windowSize && selectionIdx <= selectionWindowOffset + 15;
        ++selectionIdx) {
-    if (numResources[selectionIdx] != 0) {
-      for (uint32_t chan = 0; chan < MAX_CANDIDATE_RESOURCES; ++chan) {
-        if (resources[selectionIdx][chan].valid == CANDIDATE_VALID) {
-          if (resources[selectionIdx][chan].subChannelStart == subchannelStart) {
-            printf("Found retx candidate %d orig %d\n", selectionIdx, selectionWindowOffset);
-
-            if (selectionIdx>selectionWindowOffset) {
-              sl_gap = selectionIdx - selectionWindowOffset;
-              remove(selectionIdx,chan,CANDIDATE_CHOSEN);
-            } else {
-              sl_gap = selectionWindowOffset - selectionIdx;
-              selectionWindowOffset = selectionIdx;
-              remove(selectionIdx,chan,CANDIDATE_CHOSEN);
-            }
-            return;
-          }
-        }
+    if (valid(selectionIdx, subchannelStart)) {
+      printf("Found retx candidate %d orig %d\n", selectionIdx, selectionWindowOffset);
+
+      if (selectionIdx>selectionWindowOffset) {
+        sl_gap = selectionIdx - selectionWindowOffset;
+        remove(selectionIdx,subchannelStart,CANDIDATE_CHOSEN);
+      } else {
+        sl_gap = selectionWindowOffset - selectionIdx;
+        selectionWindowOffset = selectionIdx;
+        remove(selectionIdx,subchannelStart,CANDIDATE_CHOSEN);
       }
+      return;
     }
   }
 }
@@ -158,9 +158,8 @@ void demux::push_pdu(uint8_t* buff, uint32_t nof_bytes)
  * This function enqueues the packet and returns quickly because ACK
  * deadline is important here.
  */
-void demux::push_pdu_sl(uint8_t *buff, uint32_t nof_bytes, uint32_t tstamp) {
-  //return pdus.push(buff, nof_bytes, srslte::pdu_queue::SLSCH, tstamp);
-  return pdus.push(buff, nof_bytes, srslte::pdu_queue::SLSCH);
+void demux::push_pdu_sl(uint8_t *buff, uint32_t nof_bytes, const srslte::sl_rx_meta_t& meta) {
+  return pdus.push_sl(buff, nof_bytes, meta);
 }
 
 /* Demultiplexing of MAC PDU associated with SI-RNTI. The PDU passes through
@@ -184,19 +183,16 @@ bool demux::process_pdus()
   return pdus.process_pdus();
 }
 
-void demux::process_pdu(uint8_t* mac_pdu, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel)
+void demux::process_pdu(uint8_t* mac_pdu, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel, const srslte::sl_rx_meta_t* sl_meta)
 {
   Debug("Processing MAC PDU channel %d\n", channel);
   switch(channel) {
     case srslte::pdu_queue::SLSCH:
-
-      sl_mac_msg.snr = *((float*)(mac_pdu + nof_bytes));
-
       // Unpack SLSCH MAC PDU
       sl_mac_msg.init_rx(nof_bytes);
       sl_mac_msg.parse_packet(mac_pdu);
       // sl_mac_msg.fprint(stdout);
-      process_sl_sch_pdu(&sl_mac_msg);
+      process_sl_sch_pdu(&sl_mac_msg, sl_meta);
       pdus.deallocate(mac_pdu);
       break;
     case srslte::pdu_queue::DCH:
@@ -219,8 +215,16 @@ void demux::process_pdu(uint8_t* mac_pdu, uint32_t nof_bytes, srslte::pdu_queue:
   }
 }
 
-void demux::process_sl_sch_pdu(srslte::slsch_pdu *pdu_msg)
+void demux::process_sl_sch_pdu(srslte::slsch_pdu *pdu_msg, const srslte::sl_rx_meta_t* meta)
 {  
+  srslte::sl_rx_meta_t sdu_meta;
+  if (meta) {
+    sdu_meta = *meta;
+  } else {
+    bzero(&sdu_meta, sizeof(sdu_meta));
+  }
+  sdu_meta.src_l2_id = (pdu_msg->SRC[0] << 16) | (pdu_msg->SRC[1] << 8) | pdu_msg->SRC[2];
+
   while(pdu_msg->next()) {
     if (pdu_msg->get()->is_sdu()) {
       bool route_pdu = true; 
@@ -239,24 +243,13 @@ void demux::process_sl_sch_pdu(srslte::slsch_pdu *pdu_msg)
       if (route_pdu) {
         Info("Delivering PDU for lcid=%d, %d bytes\n", pdu_msg->get()->get_sdu_lcid(), pdu_msg->get()->get_payload_size());
         if (pdu_msg->get()->get_payload_size() < MAX_PDU_LEN) {
-          // dirty way to add more data to the buffer without additional buffer
-          // we overwrite data which is places before this MAC SDU, i.e. either the mac header or other mac sdus
-          // in worst case we have only 7 bytes we can overwrite (sl-sch mac subheader and one R/R/E/LCID)
-          uint8_t *sdu_ptr = pdu_msg->get()->get_sdu_ptr();
-          uint32_t sdu_len = pdu_msg->get()->get_payload_size();
-
-          // prepend SNR and src id as hidden values infront of mac payload
-          *((float *)(sdu_ptr-4)) = sl_mac_msg.snr;
-          // this is a human-readable snr output
-          // snprintf((char *)(sdu_ptr-4), 4+1, "%f", sl_mac_msg.snr);
-          sdu_ptr[-7] = pdu_msg->SRC[0];
-          sdu_ptr[-6] = pdu_msg->SRC[1];
-          sdu_ptr[-5] = pdu_msg->SRC[2];
-
-          rlc->write_pdu_sl(pdu_msg->get()->get_sdu_lcid(), sdu_ptr, sdu_len);
-
-          // printf("Delivering PDU for lcid=%d, %d bytes hex=", pdu_msg->get()->get_sdu_lcid(), pdu_msg->get()->get_payload_size());
-          // srslte_vec_fprint_byte(stdout, sdu_ptr, sdu_len);
+          // the SDU is handed over in place, together with the rx information of its TB
+          srslte::sl_sdu_t sdu;
+          sdu.msg     = pdu_msg->get()->get_sdu_ptr();
+          sdu.N_bytes = pdu_msg->get()->get_payload_size();
+          sdu.meta    = &sdu_meta;
+
+          rlc->write_pdu_sl(pdu_msg->get()->get_sdu_lcid(), sdu);
 
         } else {
           char tmp[1024];
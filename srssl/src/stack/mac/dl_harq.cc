@@ -426,8 +426,14 @@ void dl_harq_entity::dl_harq_process::dl_tb_process::tb_decoded(mac_interface_ph
         } else if (cur_grant.rnti == SRSLTE_RNTI_SL_PLACEHOLDER) {
           Debug("SL: Delivering PDU=%d bytes to Dissassemble and Demux unit\n", cur_grant.tb[tid].tbs);
 
-          // @todo: fix this last parameter, is last version it was cur_grant.tti
-          harq_entity->demux_unit->push_pdu_sl(payload_buffer_ptr, cur_grant.tb[tid].tbs, 0);
+          // rx information travels with the PDU, the source ID is added by demux
+          srslte::sl_rx_meta_t meta = {};
+          meta.snr          = grant.sl_snr;
+          meta.rsrp         = grant.sl_rsrp;
+          meta.rx_full_secs = grant.sl_rx_full_secs;
+          meta.rx_frac_secs = grant.sl_rx_frac_secs;
+          meta.tti          = grant.sl_lte_tti;
+          harq_entity->demux_unit->push_pdu_sl(payload_buffer_ptr, cur_grant.tb[tid].tbs, meta);
 
           // Compute average number of retransmissions per packet
           harq_entity->average_retx = SRSLTE_VEC_CMA((float)n_retx, harq_entity->average_retx, harq_entity->nof_pkts++);
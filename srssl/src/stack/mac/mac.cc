@@ -685,6 +685,9 @@ void mac::get_metrics(mac_metrics_t m[SRSLTE_MAX_CARRIERS])
        ul_harq.at(0)->get_average_retx());
 
   metrics[0].ul_buffer = (int)bsr_procedure.get_buffer_state();
+  if (pcap) {
+    metrics[0].pcap_dropped = (int)pcap->get_nof_dropped();
+  }
   memcpy(m, metrics, sizeof(mac_metrics_t) * SRSLTE_MAX_CARRIERS);
   m = metrics;
   bzero(&metrics, sizeof(mac_metrics_t) * SRSLTE_MAX_CARRIERS);
@@ -210,20 +210,42 @@ uint8_t* mux::sl_pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
   // @todo: implement it
   // buffer_state = rlc->get_buffer_state(lcid); 
 
-  int sdu_space = sl_pdu_msg.get_sdu_space();
-
-  if (sl_pdu_msg.new_subh()) { // there is space for a new subheader
+  // while lcid 3 has data, keep up to half of the PDU free for it. A message
+  // that does not fit next to the reservation may use the whole PDU, but not
+  // in two PDUs in a row, so lcid 3 is never starved.
+  uint32_t lcid3_buffer  = rlc->get_buffer_state(3);
+  int      reserved      = lcid3_buffer > 0 ? SRSLTE_MIN((int)lcid3_buffer, (int)pdu_sz / 2) : 0;
+  bool     may_unreserve = !sl_lcid1_unreserved;
+  sl_lcid1_unreserved    = false;
+
+  int sdu_space = sl_pdu_msg.get_sdu_space() - reserved;
+  int nof_lcid1 = 0;
+
+  // the application bypass hands out one message per SDU, so keep adding
+  // subheaders while messages fit into the remaining space
+  while (sdu_space > 0 && sl_pdu_msg.new_subh()) { // there is space for a new subheader
     //int sdu_len = sl_pdu_msg.get()->set_sdu(lcid, b, buffer);
     int sdu_len = sl_pdu_msg.get()->set_sdu(lcid, sdu_space/*sdu_len*/, rlc);
 
+    if (sdu_len <= 0 && nof_lcid1 == 0 && reserved > 0 && may_unreserve) {
+      // the next message may only fit without the reservation
+      sdu_space           = sl_pdu_msg.get_sdu_space();
+      sdu_len             = sl_pdu_msg.get()->set_sdu(lcid, sdu_space, rlc);
+      sl_lcid1_unreserved = sdu_len > 0;
+      reserved            = 0;
+    }
+
     if (sdu_len > 0) { // new SDU could be added
-      printf("SDU:   allocated lcid=%d, rlc_buffer=%d, allocated=%d/%d, max_sdu_sz=%d, remaining=%d\n",
-              lcid, buffer_state, sdu_len, sdu_space, -1/*max_sdu_sz*/, sl_pdu_msg.rem_size());
+      Debug("SDU:   allocated lcid=%d, rlc_buffer=%d, allocated=%d/%d, max_sdu_sz=%d, remaining=%d\n",
+            lcid, buffer_state, sdu_len, sdu_space, -1/*max_sdu_sz*/, sl_pdu_msg.rem_size());
+      nof_lcid1++;
     } else {
       // printf("SDU:   rlc_buffer=%d, allocated=%d/%d, remaining=%d\n", 
       //       buffer_state, sdu_len, sdu_space, sl_pdu_msg.rem_size());
       sl_pdu_msg.del_subh();
+      break;
     }
+    sdu_space = sl_pdu_msg.get_sdu_space() - reserved;
   }
 
   // check for data in lcid 3
@@ -235,8 +257,8 @@ uint8_t* mux::sl_pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
     int sdu_len = sl_pdu_msg.get()->set_sdu(lcid, sdu_space/*sdu_len*/, rlc);
 
     if (sdu_len > 0) { // new SDU could be added
-      printf("SDU:   allocated lcid=%d, rlc_buffer=%d, allocated=%d/%d, max_sdu_sz=%d, remaining=%d\n",
-              lcid, buffer_state, sdu_len, sdu_space, -1/*max_sdu_sz*/, sl_pdu_msg.rem_size());
+      Debug("SDU:   allocated lcid=%d, rlc_buffer=%d, allocated=%d/%d, max_sdu_sz=%d, remaining=%d\n",
+            lcid, buffer_state, sdu_len, sdu_space, -1/*max_sdu_sz*/, sl_pdu_msg.rem_size());
     } else {
       // printf("SDU:   rlc_buffer=%d, allocated=%d/%d, remaining=%d\n", 
       //       buffer_state, sdu_len, sdu_space, sl_pdu_msg.rem_size());
@@ -123,6 +123,8 @@ int ue_stack_lte::init(const stack_args_t& args_, srslte::logger* logger_)
 
   // Set up pcap
   if (args.pcap.enable) {
+    mac_pcap.set_drop_policy(args.pcap.drop_policy == "block" ? srslte::mac_pcap::BLOCK
+                                                                : srslte::mac_pcap::DROP_NEWEST);
     mac_pcap.open(args.pcap.filename.c_str());
     mac.start_pcap(&mac_pcap);
   }
@@ -219,6 +221,7 @@ bool ue_stack_lte::get_metrics(stack_metrics_t* metrics)
   rlc.get_metrics(metrics->rlc);
   nas.get_metrics(&metrics->nas);
   rrc.get_metrics(metrics->rrc);
+  byte_buffer_pool::get_instance()->get_metrics(&metrics->pool);
   return (metrics->nas.state == EMM_STATE_REGISTERED && metrics->rrc.state == RRC_STATE_CONNECTED);
 }
 
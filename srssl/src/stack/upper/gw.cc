@@ -55,12 +55,16 @@
 #include <sys/socket.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <poll.h>
 
 namespace srsue {
 
-gw::gw() : if_up(false), default_lcid(0), thread("GW")
+gw::gw() : if_up(false), default_lcid(0), thread("GW"), tun_fd(-1), nof_queues(1), dl_pkts(0), dl_bytes(0), dl_drops(0)
 {
   current_ip_addr = 0;
+  for (uint32_t i = 0; i < GW_MAX_TUN_QUEUES; i++) {
+    readers[i].parent = this;
+  }
 }
 
 int gw::init(const gw_args_t& args_, srslte::logger* logger_, stack_interface_gw* stack_)
@@ -75,6 +79,12 @@ int gw::init(const gw_args_t& args_, srslte::logger* logger_, stack_interface_gw
   log.set_level(args.log.gw_level);
   log.set_hex_limit(args.log.gw_hex_limit);
 
+  nof_queues = std::max(1u, std::min(args.tun_nof_queues, GW_MAX_TUN_QUEUES));
+  if (nof_queues != args.tun_nof_queues) {
+    log.warning("Invalid number of TUN queues %d. Using %d\n", args.tun_nof_queues, nof_queues);
+  }
+  sem_init(&pdu_sem, 0, 0);
+
   gettimeofday(&metrics_time[1], NULL);
   dl_tput_bytes = 0;
   ul_tput_bytes = 0;
@@ -105,8 +115,8 @@ void gw::stop()
     run_enable = false;
     if(if_up)
     {
-      close(tun_fd);
-      
+      sem_post(&pdu_sem);
+
       // Wait thread to exit gracefully otherwise might leave a mutex locked
       int cnt=0;
       while(running && cnt<100) {
@@ -118,9 +128,13 @@ void gw::stop()
       }
       wait_thread_finish();
 
+      // Readers notice run_enable within one poll timeout
+      close_if();
+
       current_ip_addr = 0;
     }
     // TODO: tear down TUN device?
+    sem_destroy(&pdu_sem);
   }
   if (mbsfn_sock_fd) {
     close(mbsfn_sock_fd);
@@ -137,6 +151,21 @@ void gw::get_metrics(gw_metrics_t &m)
   m.ul_tput_mbps = (ul_tput_bytes*8/(double)1e6)/secs;
   log.info("RX throughput: %4.6f Mbps. TX throughput: %4.6f Mbps.\n", m.dl_tput_mbps, m.ul_tput_mbps);
 
+  m.dl_pkts    = dl_pkts.load(std::memory_order_relaxed);
+  m.dl_bytes   = dl_bytes.load(std::memory_order_relaxed);
+  m.dl_drops   = dl_drops.load(std::memory_order_relaxed);
+  m.nof_queues = nof_queues;
+  for (uint32_t i = 0; i < nof_queues; i++) {
+    m.queue[i].ul_pkts  = readers[i].ul_pkts.load(std::memory_order_relaxed);
+    m.queue[i].ul_bytes = readers[i].ul_bytes.load(std::memory_order_relaxed);
+    m.queue[i].ul_drops = readers[i].ul_drops.load(std::memory_order_relaxed);
+    log.debug("TUN queue %d: %" PRIu64 " packets, %" PRIu64 " bytes, %" PRIu64 " dropped\n",
+              i,
+              m.queue[i].ul_pkts,
+              m.queue[i].ul_bytes,
+              m.queue[i].ul_drops);
+  }
+
   memcpy(&metrics_time[1], &metrics_time[2], sizeof(struct timeval));
   dl_tput_bytes = 0;
   ul_tput_bytes = 0;
@@ -151,20 +180,19 @@ void gw::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
   dl_tput_bytes += pdu->N_bytes;
   if (!if_up) {
     log.warning("TUN/TAP not up - dropping gw RX message\n");
+    dl_drops.fetch_add(1, std::memory_order_relaxed);
   } else if (pdu->N_bytes < 20) {
     // Packet not large enough to hold IPv4 Header
     log.warning("Packet to small to hold IPv4 header. Dropping packet with %d B\n", pdu->N_bytes);
+    dl_drops.fetch_add(1, std::memory_order_relaxed);
   } else {
     // Only handle IPv4 and IPv6 packets
     struct iphdr*   ip_pkt  = (struct iphdr*)pdu->msg;
-    struct ipv6hdr* ip6_pkt = (struct ipv6hdr*)pdu->msg;
     if (ip_pkt->version == 4 || ip_pkt->version == 6) {
-      int n = write(tun_fd, pdu->msg, pdu->N_bytes);
-      if (n > 0 && (pdu->N_bytes != (uint32_t)n)) {
-        log.warning("DL TUN/TAP write failure. Wanted to write %d B but only wrote %d B.\n", pdu->N_bytes, n);
-      }
+      write_tun(pdu);
     } else {
       log.error("Unsupported IP version. Dropping packet with %d B\n", pdu->N_bytes);
+      dl_drops.fetch_add(1, std::memory_order_relaxed);
     }
   }
 }
@@ -185,15 +213,29 @@ void gw::write_pdu_mch(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 
     if (!if_up) {
       log.warning("TUN/TAP not up - dropping gw RX message\n");
+      dl_drops.fetch_add(1, std::memory_order_relaxed);
     } else {
-      int n = write(tun_fd, pdu->msg, pdu->N_bytes); 
-      if(n > 0 && (pdu->N_bytes != (uint32_t) n) ) {
-        log.warning("DL TUN/TAP write failure\n");
-      }
+      write_tun(pdu);
     }
   }
 }
 
+void gw::write_tun(srslte::unique_byte_buffer_t& pdu)
+{
+  // TUN takes exactly one packet per write, so there is nothing to batch here
+  int n = write(tun_fd, pdu->msg, pdu->N_bytes);
+  if (n < 0) {
+    log.warning("DL TUN/TAP write failure: %s\n", strerror(errno));
+    dl_drops.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (pdu->N_bytes != (uint32_t)n) {
+    log.warning("DL TUN/TAP write failure. Wanted to write %d B but only wrote %d B.\n", pdu->N_bytes, n);
+  }
+  dl_pkts.fetch_add(1, std::memory_order_relaxed);
+  dl_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
 /*******************************************************************************
   NAS interface
 *******************************************************************************/
@@ -225,6 +267,7 @@ int gw::apply_traffic_flow_template(const uint8_t&
                                     const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft)
 {
   std::lock_guard<std::mutex> lock(tft_mutex);
+  int                         ret = SRSLTE_SUCCESS;
   switch (tft->tft_op_code) {
     case LIBLTE_MME_TFT_OPERATION_CODE_CREATE_NEW_TFT:
       for (int i = 0; i < tft->packet_filter_list_size; i++) {
@@ -233,15 +276,29 @@ int gw::apply_traffic_flow_template(const uint8_t&
         auto                it = tft_filter_map.insert(std::make_pair(filter.eval_precedence, filter));
         if (it.second == false) {
           log.error("Error inserting TFT Packet Filter\n");
-          return SRSLTE_ERROR_CANT_START;
+          ret = SRSLTE_ERROR_CANT_START;
+          break;
         }
       }
       break;
+    case LIBLTE_MME_TFT_OPERATION_CODE_DELETE_EXISTING_TFT:
+      for (tft_filter_map_t::iterator it = tft_filter_map.begin(); it != tft_filter_map.end();) {
+        if (it->second.eps_bearer_id == erab_id) {
+          tft_filter_map.erase(it++);
+        } else {
+          ++it;
+        }
+      }
+      log.info("Deleted TFT of EPS bearer %d\n", erab_id);
+      break;
     default:
       log.error("Unhandled TFT OP code\n");
       return SRSLTE_ERROR_CANT_START;
   }
-  return SRSLTE_SUCCESS;
+
+  // Filters inserted before an error stay active, as they did before
+  tft_classifier_ptr.publish(new tft_classifier(tft_filter_map));
+  return ret;
 }
 
 /*******************************************************************************
@@ -259,15 +316,6 @@ void gw::add_mch_port(uint32_t lcid, uint32_t port)
 /********************/
 void gw::run_thread()
 {
-  uint32 idx = 0;
-  int32  N_bytes = 0;
-
-  srslte::unique_byte_buffer_t pdu = srslte::allocate_unique_buffer(*pool, true);
-  if (!pdu) {
-    log.error("Fatal Error: Couldn't allocate PDU in run_thread().\n");
-    return;
-  }
-
   const static uint32_t ATTACH_WAIT_TOUT = 40; // 4 sec
   uint32_t attach_wait = 0;
 
@@ -276,31 +324,28 @@ void gw::run_thread()
   running = true;
   while(run_enable)
   {
-    if (SRSLTE_MAX_BUFFER_SIZE_BYTES-SRSLTE_BUFFER_HEADER_OFFSET > idx) {
-      N_bytes = read(tun_fd, &pdu->msg[idx], SRSLTE_MAX_BUFFER_SIZE_BYTES-SRSLTE_BUFFER_HEADER_OFFSET - idx);
-    } else {
-      log.error("GW pdu buffer full - gw receive thread exiting.\n");
-      log.console("GW pdu buffer full - gw receive thread exiting.\n");
-      break;
+    if (sem_wait(&pdu_sem)) {
+      continue;
     }
-    log.debug("Read %d bytes from TUN fd=%d, idx=%d\n", N_bytes, tun_fd, idx);
-    if (N_bytes > 0) {
-      struct iphdr *ip_pkt = (struct iphdr*)pdu->msg;
-      struct ipv6hdr *ip6_pkt = (struct ipv6hdr*)pdu->msg;
-      uint16_t pkt_len = 0;
-      pdu->N_bytes = idx + N_bytes;
-      if (ip_pkt->version == 4 || ip_pkt->version == 6) {
-        if (ip_pkt->version == 4){
-          pkt_len = ntohs(ip_pkt->tot_len);
-        } else if (ip_pkt->version == 6){
-          pkt_len = ntohs(ip6_pkt->payload_len)+40;
-        } else {
-          log.error_hex(pdu->msg, pdu->N_bytes, "Unsupported IP version. Dropping packet.\n");
-          continue;
-        }
-        log.debug("IPv%d packet total length: %d Bytes\n", ip_pkt->version, pkt_len);
-        // Check if entire packet was received
-        if (pkt_len == pdu->N_bytes) {
+
+    // Serve the queues round-robin, one batch at a time, until all are empty
+    uint32_t nof_pdus;
+    do {
+      nof_pdus = 0;
+      for (uint32_t q = 0; q < nof_queues && run_enable; q++) {
+        tun_reader* r = &readers[q];
+        for (uint32_t i = 0; i < TUN_BATCH_LEN && run_enable; i++) {
+          srslte::unique_byte_buffer_t* slot = r->pdus.front();
+          if (!slot) {
+            break;
+          }
+          srslte::unique_byte_buffer_t pdu = std::move(*slot);
+          r->pdus.pop();
+          nof_pdus++;
+          if (r->full.exchange(false)) {
+            sem_post(&r->space_sem);
+          }
+
           log.info_hex(pdu->msg, pdu->N_bytes, "TX PDU");
 
           while (run_enable && !stack->is_lcid_enabled(default_lcid) && attach_wait < ATTACH_WAIT_TOUT) {
@@ -329,46 +374,121 @@ void gw::run_thread()
           if (stack->is_lcid_enabled(lcid)) {
             pdu->set_timestamp();
             ul_tput_bytes += pdu->N_bytes;
+            r->ul_pkts.fetch_add(1, std::memory_order_relaxed);
+            r->ul_bytes.fetch_add(pdu->N_bytes, std::memory_order_relaxed);
             stack->write_sdu(lcid, std::move(pdu), false);
-            do {
-              pdu = srslte::allocate_unique_buffer(*pool);
-              if (!pdu) {
-                log.error("Fatal Error: Couldn't allocate PDU in run_thread().\n");
-                usleep(100000);
-              }
-            } while(!pdu);
-            idx = 0;
+          } else {
+            r->ul_drops.fetch_add(1, std::memory_order_relaxed);
           }
-        }else{
-          idx += N_bytes;
-          log.debug(
-              "Entire packet not read from socket. Total Length %d, N_Bytes %d.\n", ip_pkt->tot_len, pdu->N_bytes);
         }
-      } else {
-        log.error("IP Version not handled. Version %d\n", ip_pkt->version);
       }
-    }else{
-      log.error("Failed to read from TUN interface - gw receive thread exiting.\n");
-      log.console("Failed to read from TUN interface - gw receive thread exiting.\n");
-      break;
-    }
+    } while (nof_pdus > 0 && run_enable);
   }
   running = false;
   log.info("GW IP receiver thread exiting.\n");
 }
 
-uint8_t gw::check_tft_filter_match(const srslte::unique_byte_buffer_t& pdu)
+void gw::run_reader(tun_reader* r)
 {
-  std::lock_guard<std::mutex> lock(tft_mutex);
-  uint8_t                     lcid = default_lcid;
-  for (std::pair<const uint16_t, tft_packet_filter_t>& filter_pair : tft_filter_map) {
-    bool match = filter_pair.second.match(pdu);
-    if (match) {
-      lcid = filter_pair.second.lcid;
-      log.debug("Found filter match -- EPS bearer Id %d, LCID %d\n", filter_pair.second.eps_bearer_id, lcid);
+  struct pollfd pfd;
+  pfd.fd     = r->fd;
+  pfd.events = POLLIN;
+
+  srslte::unique_byte_buffer_t pdu;
+
+  while (run_enable) {
+    int ret = poll(&pfd, 1, TUN_POLL_TIMEOUT_MS);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0 || (pfd.revents & (POLLERR | POLLNVAL))) {
+      log.error("Failed to poll TUN fd=%d - gw reader thread exiting.\n", r->fd);
       break;
     }
+    if (ret == 0) {
+      continue;
+    }
+
+    // The fd is non-blocking, read until it is drained or the batch is full.
+    // When the GW thread falls behind, packets stay queued in the kernel.
+    uint32_t nof_pushed = 0;
+    for (uint32_t i = 0; i < TUN_BATCH_LEN; i++) {
+      srslte::unique_byte_buffer_t* slot = r->pdus.back();
+      while (!slot && run_enable) {
+        // Flag before re-checking, so the GW thread cannot miss the wake-up
+        r->full.store(true);
+        slot = r->pdus.back();
+        if (!slot) {
+          struct timespec tout;
+          clock_gettime(CLOCK_REALTIME, &tout);
+          tout.tv_nsec += TUN_POLL_TIMEOUT_MS * 1000000;
+          tout.tv_sec += tout.tv_nsec / 1000000000;
+          tout.tv_nsec %= 1000000000;
+          sem_timedwait(&r->space_sem, &tout);
+          slot = r->pdus.back();
+        }
+      }
+      if (!slot) {
+        break;
+      }
+      if (!pdu) {
+        pdu = srslte::allocate_unique_buffer(*pool);
+        if (!pdu) {
+          log.error("Couldn't allocate PDU in run_reader().\n");
+          usleep(1000);
+          break;
+        }
+      }
+
+      int32 N_bytes = read(r->fd, pdu->msg, SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET);
+      if (N_bytes <= 0) {
+        if (N_bytes < 0 && errno != EAGAIN && errno != EINTR) {
+          log.error("Failed to read from TUN fd=%d: %s\n", r->fd, strerror(errno));
+        }
+        break;
+      }
+      log.debug("Read %d bytes from TUN fd=%d\n", N_bytes, r->fd);
+
+      // TUN delivers whole packets, anything else is dropped
+      struct iphdr*   ip_pkt  = (struct iphdr*)pdu->msg;
+      struct ipv6hdr* ip6_pkt = (struct ipv6hdr*)pdu->msg;
+      uint32_t        pkt_len = 0;
+      if (ip_pkt->version == 4 && N_bytes >= 20) {
+        pkt_len = ntohs(ip_pkt->tot_len);
+      } else if (ip_pkt->version == 6 && N_bytes >= 40) {
+        pkt_len = ntohs(ip6_pkt->payload_len) + 40;
+      }
+      if (pkt_len != (uint32_t)N_bytes) {
+        log.error_hex(pdu->msg, N_bytes, "Malformed or unsupported IP packet. Dropping packet.\n");
+        r->ul_drops.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      pdu->N_bytes = N_bytes;
+
+      *slot = std::move(pdu);
+      r->pdus.push();
+      nof_pushed++;
+    }
+
+    if (nof_pushed > 0) {
+      sem_post(&pdu_sem);
+    }
   }
+  log.info("GW TUN reader thread exiting.\n");
+}
+
+uint8_t gw::check_tft_filter_match(const srslte::unique_byte_buffer_t& pdu)
+{
+  uint8_t               lcid       = default_lcid;
+  const tft_classifier* classifier = tft_classifier_ptr.read_lock();
+  if (classifier) {
+    const tft_packet_filter_t* filter = classifier->match(pdu);
+    if (filter) {
+      lcid = filter->lcid;
+      log.debug("Found filter match -- EPS bearer Id %d, LCID %d\n", filter->eps_bearer_id, lcid);
+    }
+  }
+  tft_classifier_ptr.read_unlock();
   return lcid;
 }
 
@@ -381,40 +501,48 @@ int gw::init_if(char* err_str)
     return SRSLTE_ERROR_ALREADY_STARTED;
   }
 
-  // Construct the TUN device
-  tun_fd = open("/dev/net/tun", O_RDWR);
-  log.info("TUN file descriptor = %d\n", tun_fd);
-  if (0 > tun_fd) {
-    err_str = strerror(errno);
-    log.debug("Failed to open TUN device: %s\n", err_str);
-    return SRSLTE_ERROR_CANT_START;
-  }
-
+  // Construct the TUN device, one fd per queue
   memset(&ifr, 0, sizeof(ifr));
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (nof_queues > 1) {
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args.tun_dev_name.c_str(), std::min(args.tun_dev_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ-1] = 0;
-  if (0 > ioctl(tun_fd, TUNSETIFF, &ifr)) {
-    err_str = strerror(errno);
-    log.console("Failed to setup TUN device:%s\n", err_str);
-    close(tun_fd);
-    return SRSLTE_ERROR_CANT_START;
+  for (uint32_t i = 0; i < nof_queues; i++) {
+    readers[i].fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+    log.info("TUN file descriptor = %d (queue %d)\n", readers[i].fd, i);
+    if (0 > readers[i].fd) {
+      err_str = strerror(errno);
+      log.debug("Failed to open TUN device: %s\n", err_str);
+      close_if();
+      return SRSLTE_ERROR_CANT_START;
+    }
+
+    struct ifreq qifr = ifr;
+    if (0 > ioctl(readers[i].fd, TUNSETIFF, &qifr)) {
+      err_str = strerror(errno);
+      log.console("Failed to setup TUN device:%s\n", err_str);
+      close_if();
+      return SRSLTE_ERROR_CANT_START;
+    }
   }
+  tun_fd = readers[0].fd;
 
   // Bring up the interface
   sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (0 > ioctl(sock, SIOCGIFFLAGS, &ifr)) {
     err_str = strerror(errno);
     log.debug("Failed to bring up socket: %s\n", err_str);
-    close(tun_fd);
+    close_if();
     return SRSLTE_ERROR_CANT_START;
   }
   ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
   if (0 > ioctl(sock, SIOCSIFFLAGS, &ifr)) {
     err_str = strerror(errno);
     log.debug("Failed to set socket flags: %s\n", err_str);
-    close(tun_fd);
+    close_if();
     return SRSLTE_ERROR_CANT_START;
   }
 
@@ -429,9 +557,27 @@ int gw::init_if(char* err_str)
   }
   if_up = true;
 
+  for (uint32_t i = 0; i < nof_queues; i++) {
+    readers[i].start(GW_THREAD_PRIO);
+  }
+
   return SRSLTE_SUCCESS;
 }
 
+void gw::close_if()
+{
+  for (uint32_t i = 0; i < nof_queues; i++) {
+    if (if_up) {
+      readers[i].wait_thread_finish();
+    }
+    if (readers[i].fd >= 0) {
+      close(readers[i].fd);
+      readers[i].fd = -1;
+    }
+  }
+  tun_fd = -1;
+}
+
 int gw::setup_if_addr4(uint32_t ip_addr, char* err_str)
 {
   if (ip_addr != current_ip_addr) {
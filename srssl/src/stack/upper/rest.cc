@@ -51,6 +51,8 @@
 #include <srssl/hdr/upper/rest.h>
 
 #include <jansson.h>
+#include <math.h>
+#include <unistd.h>
 
 namespace srsue {
 
@@ -93,6 +95,34 @@ static int rest_get_metrics (const struct _u_request * request, struct _u_respon
   return U_CALLBACK_CONTINUE;
 }
 
+// Processing latency of the sidelink TTIs since the start, per stage
+static int rest_get_latency (const struct _u_request * request, struct _u_response * response, void * user_data) {
+  phy_common * _this = (phy_common *)user_data;
+
+  sl_latency_metrics_t m;
+  _this->get_sl_latency_metrics(&m, true);
+
+  json_t * stages = json_object();
+  for (uint32_t s = 0; s < SL_NOF_STAGES; s++) {
+    json_object_set_new(stages, sl_stage_name((sl_stage_t)s), json_pack("{sfsfsf}",
+                                                                         "p50_us", m.p50_us[s],
+                                                                         "p99_us", m.p99_us[s],
+                                                                         "max_us", m.max_us[s]));
+  }
+
+  json_t * json_body = json_pack("{sisiso}",
+                                  "ttis", (int)m.count,
+                                  "deadline_misses", (int)m.deadline_misses,
+                                  "stages", stages);
+
+  char *resp = json_dumps(json_body, JSON_REAL_PRECISION(3));
+  ulfius_set_string_body_response(response, 200, resp);
+
+  free(resp);
+  json_decref(json_body);
+
+  return U_CALLBACK_CONTINUE;
+}
 
 static int rest_get_repo_cb (const struct _u_request * request, struct _u_response * response, void * user_data) {
   phy_common * _this = (phy_common *)user_data;
@@ -271,7 +301,8 @@ static int rest_get_SPS_rsrp(const struct _u_request* request, struct _u_respons
   int tti;
 
   // Get last s samples relative to the latest TTI
-  // It is possible that the data is overwritten as we fetch them
+  // Each sample is read consistently, samples which have already been
+  // overwritten by newer TTIs are returned as -INFINITY
   if (latestTti>=s) {
     tti = latestTti-s;
   } else {
@@ -301,7 +332,8 @@ static int rest_get_SPS_rssi(const struct _u_request* request, struct _u_respons
   int tti;
 
   // Get last s samples relative to the latest TTI
-  // It is possible that the data is overwritten as we fetch them
+  // Each sample is read consistently, samples which have already been
+  // overwritten by newer TTIs are returned as -INFINITY
   if (latestTti>=s) {
     tti = latestTti-s;
   } else {
@@ -326,15 +358,179 @@ static int rest_get_SPS_rssi(const struct _u_request* request, struct _u_respons
 }
 
 
+#define REST_STREAM_MAX_TTIS 1000   // TTIs kept by the sensing, at most this many are sent at once
+#define REST_STREAM_TTI_DELAY 4     // the most recent TTIs may still be processed by the workers
+#define REST_STREAM_BLOCK_SIZE 16384
+#define REST_STREAM_IDLE_WAIT 100   // ms to wait for new TTIs before handing control back
+
+// State of one /phy/SPS_stream connection, allocated once when the client connects
+typedef struct {
+  phy_common*             phy;
+  bool                    follow;
+  uint32_t                nextTti;   // next tti to send
+  uint32_t                remaining; // TTIs left to send if !follow
+  srslte::SensingSnapshot snapshot;
+} rest_stream_t;
+
+// last tti the workers are done with
+static uint32_t rest_stream_last_tti(phy_common* _this)
+{
+  return srslte::SensingSPS::tti_add(_this->sensing_sps->getLatestTti(), -REST_STREAM_TTI_DELAY);
+}
+
+// number of TTIs which can be sent starting from nextTti
+static uint32_t rest_stream_available(rest_stream_t* s)
+{
+  uint32_t last = rest_stream_last_tti(s->phy);
+  uint32_t n    = srslte::SensingSPS::tti_add(last, 1 - (int32_t)s->nextTti);
+
+  if (n > 10240 / 2) {
+    // client asked for TTIs which have not been processed yet
+    return 0;
+  }
+  if (n > REST_STREAM_MAX_TTIS) {
+    // client fell behind, older TTIs have already been overwritten
+    s->nextTti = srslte::SensingSPS::tti_add(last, 1 - REST_STREAM_MAX_TTIS);
+    n          = REST_STREAM_MAX_TTIS;
+  }
+  return n;
+}
+
+// Writes the frame of nextTti to buf. Returns its size, 0 if there is no data
+// for nextTti and -1 if the frame does not fit into max bytes.
+static ssize_t rest_stream_encode(rest_stream_t* s, char* buf, size_t max)
+{
+  uint32_t numSubChannels = s->phy->ue_repo.rp.numSubchannel_r14;
+
+  if (!s->phy->sensing_sps->getSnapshot(s->nextTti, numSubChannels, &s->snapshot)) {
+    return 0;
+  }
+
+  size_t length = sizeof(rest_stream_frame_hdr_t) + numSubChannels * sizeof(float) +
+                  s->snapshot.numScis * sizeof(rest_stream_sci_t);
+  if (length > max) {
+    return -1;
+  }
+
+  rest_stream_frame_hdr_t hdr;
+  hdr.magic          = REST_STREAM_MAGIC;
+  hdr.tti            = s->snapshot.tti;
+  hdr.numSubChannels = numSubChannels;
+  hdr.numScis        = s->snapshot.numScis;
+  hdr.length         = length;
+  hdr.avgSRssi       = s->snapshot.avgSRssi;
+  hdr.rssi           = s->phy->sl_rssi;
+  hdr.snrPsbch       = s->phy->snr_psbch;
+  hdr.rsrpPsbch      = s->phy->rsrp_psbch;
+  memcpy(buf, &hdr, sizeof(hdr));
+  buf += sizeof(hdr);
+
+  memcpy(buf, s->snapshot.sRssi, numSubChannels * sizeof(float));
+  buf += numSubChannels * sizeof(float);
+
+  for (uint32_t i = 0; i < s->snapshot.numScis; i++) {
+    rest_stream_sci_t sci;
+    sci.subChannelStart = s->snapshot.scis[i].subChannelStart;
+    sci.numSubChannels  = s->snapshot.scis[i].numSubChannels;
+    sci.priority        = s->snapshot.scis[i].priority;
+    sci.rsvp            = s->snapshot.scis[i].rsvp;
+    sci.rsrp            = s->snapshot.scis[i].rsrp;
+    memcpy(buf, &sci, sizeof(sci));
+    buf += sizeof(sci);
+  }
+
+  return length;
+}
+
+// Called by ulfius whenever it can send more data, the frames are encoded
+// directly into its output buffer
+static ssize_t rest_stream_cb(void* stream_user_data, uint64_t offset, char* out_buf, size_t max)
+{
+  rest_stream_t* s   = (rest_stream_t*)stream_user_data;
+  size_t         len = 0;
+
+  for (int wait = 0; len == 0 && wait < REST_STREAM_IDLE_WAIT; wait++) {
+    uint32_t n = rest_stream_available(s);
+    if (!s->follow) {
+      n = std::min(n, s->remaining);
+      if (n == 0) {
+        return U_STREAM_END;
+      }
+    } else if (n == 0) {
+      usleep(1000);
+      continue;
+    }
+
+    for (; n > 0; n--) {
+      ssize_t frame = rest_stream_encode(s, out_buf + len, max - len);
+      if (frame < 0) {
+        break;
+      }
+      len += frame;
+      s->nextTti = srslte::SensingSPS::tti_add(s->nextTti, 1);
+      if (!s->follow) {
+        s->remaining--;
+      }
+    }
+
+    if (len == 0 && n > 0) {
+      // not even a single frame fits
+      return U_STREAM_ERROR;
+    }
+  }
+
+  return len;
+}
+
+static void rest_stream_free(void* stream_user_data)
+{
+  delete (rest_stream_t*)stream_user_data;
+}
+
+static int rest_get_SPS_stream(const struct _u_request* request, struct _u_response* response, void* user_data)
+{
+  phy_common* _this = (phy_common*)user_data;
+
+  if (NULL == _this->sensing_sps) {
+    ulfius_set_string_body_response(response, 503, "Sensing is not running");
+    return U_CALLBACK_CONTINUE;
+  }
+
+  rest_stream_t* s = new rest_stream_t;
+  s->phy           = _this;
+  s->remaining     = REST_STREAM_MAX_TTIS;
+
+  const char* follow = u_map_get(request->map_url, "follow");
+  s->follow          = (NULL != follow && 0 != atoi(follow));
+
+  const char* since_tti = u_map_get(request->map_url, "since_tti");
+  if (NULL != since_tti) {
+    s->nextTti = srslte::SensingSPS::tti_add((uint32_t)strtoul(since_tti, NULL, 10) % 10240, 1);
+  } else {
+    s->nextTti = srslte::SensingSPS::tti_add(rest_stream_last_tti(_this), 1 - REST_STREAM_MAX_TTIS);
+  }
+
+  u_map_put(response->map_header, "Content-Type", "application/octet-stream");
+
+  if (U_OK != ulfius_set_stream_response(response, 200, rest_stream_cb, rest_stream_free, U_STREAM_SIZE_UNKOWN,
+                                         REST_STREAM_BLOCK_SIZE, s)) {
+    delete s;
+    ulfius_set_string_body_response(response, 500, "Failed to start stream");
+  }
+
+  return U_CALLBACK_CONTINUE;
+}
+
 
 static int rest_get_misc (const struct _u_request * request, struct _u_response * response, void * user_data) {
 
   phy_common * _this = (phy_common *)user_data;
 
-  json_t * json_body = json_pack("{sfsisi}",
-                                  "transmit_snr", _this->tx_snr,
-                                  "n_subframes_to_dump", _this->n_subframes_to_dump,
-                                  "n_subframes_to_dump_special", _this->n_subframes_to_dump_special);
+  // JSON has no infinity, null means no transmit noise
+  json_t * json_body = json_pack("{sosisi}",
+                                  "transmit_snr", isinf(_this->tx_snr) ? json_null() : json_real(_this->tx_snr),
+                                  "n_subframes_to_dump", (int)_this->n_subframes_to_dump,
+                                  "n_subframes_to_dump_special", (int)_this->n_subframes_to_dump_special);
                                   
   ulfius_set_json_body_response(response, 200, json_body);
   json_decref(json_body);
@@ -361,17 +557,17 @@ static int rest_put_misc (const struct _u_request * request, struct _u_response
 
   json_t *value;
   if((value = json_object_get(req, "transmit_snr"))) {
-    float new_snr = (float)json_number_value(value);
+    float new_snr = json_is_null(value) ? INFINITY : (float)json_number_value(value);
 
     _this->set_transmit_snr(new_snr);
   }
 
   if((value = json_object_get(req, "n_subframes_to_dump"))) {
-    _this->n_subframes_to_dump = (uint8_t)json_integer_value(value);
+    _this->n_subframes_to_dump = (int32_t)json_integer_value(value);
   }
 
   if((value = json_object_get(req, "n_subframes_to_dump_special"))) {
-    _this->n_subframes_to_dump_special = (uint8_t)json_integer_value(value);
+    _this->n_subframes_to_dump_special = (int32_t)json_integer_value(value);
   }
   json_decref(req);
 
@@ -423,12 +619,14 @@ void rest::init_and_start(phy_common * this_){
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "PUT", "/phy/repo", NULL, 0, &srsue::rest_put_repo_cb, this_);
 
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/metrics", NULL, 0, &srsue::rest_get_metrics, this_);
+  ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/latency", NULL, 0, &srsue::rest_get_latency, this_);
 
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/gain", NULL, 0, &srsue::rest_get_gain, this_);
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "PUT", "/phy/gain", NULL, 0, &srsue::rest_put_gain, this_);
 
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/SPS_rsrp", NULL, 0, &srsue::rest_get_SPS_rsrp, this_);
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/SPS_rssi", NULL, 0, &srsue::rest_get_SPS_rssi, this_);
+  ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/SPS_stream", NULL, 0, &srsue::rest_get_SPS_stream, this_);
   
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "GET", "/phy/misc", NULL, 0, &srsue::rest_get_misc, this_);
   ret += ulfius_add_endpoint_by_val(&g_restapi.instance, "PUT", "/phy/misc", NULL, 0, &srsue::rest_put_misc, this_);
@@ -0,0 +1,195 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srssl/hdr/stack/upper/tft_classifier.h"
+#include "srslte/upper/ipv6.h"
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <thread>
+
+namespace srsue {
+
+// Components compared on IPv4 packets through the hash tables
+static const uint16_t V4_HASHED_COMPONENTS = IPV4_LOCAL_ADDR_FLAG | IPV4_REMOTE_ADDR_FLAG | PROTOCOL_ID_FLAG |
+                                             SINGLE_LOCAL_PORT_FLAG | SINGLE_REMOTE_PORT_FLAG | TYPE_OF_SERVICE_FLAG;
+static const uint16_t PORT_RANGE_COMPONENTS = LOCAL_PORT_RANGE_FLAG | REMOTE_PORT_RANGE_FLAG;
+static const uint16_t PORT_COMPONENTS       = SINGLE_LOCAL_PORT_FLAG | SINGLE_REMOTE_PORT_FLAG | PORT_RANGE_COMPONENTS;
+
+size_t tft_classifier::key_hash::operator()(const key_t& k) const
+{
+  uint64_t h = (((uint64_t)k.local_addr << 32) | k.remote_addr) * 0x9e3779b97f4a7c15ULL;
+  h ^= ((uint64_t)k.local_port << 32) | ((uint64_t)k.remote_port << 16) | ((uint64_t)k.protocol << 8) | k.tos;
+  h *= 0xff51afd7ed558ccdULL;
+  return h ^ (h >> 32);
+}
+
+tft_classifier::key_t tft_classifier::make_key(const key_t& fields, uint16_t components)
+{
+  key_t key = {};
+  if (components & IPV4_LOCAL_ADDR_FLAG) {
+    key.local_addr = fields.local_addr;
+  }
+  if (components & IPV4_REMOTE_ADDR_FLAG) {
+    key.remote_addr = fields.remote_addr;
+  }
+  if (components & SINGLE_LOCAL_PORT_FLAG) {
+    key.local_port = fields.local_port;
+  }
+  if (components & SINGLE_REMOTE_PORT_FLAG) {
+    key.remote_port = fields.remote_port;
+  }
+  if (components & PROTOCOL_ID_FLAG) {
+    key.protocol = fields.protocol;
+  }
+  if (components & TYPE_OF_SERVICE_FLAG) {
+    key.tos = fields.tos;
+  }
+  return key;
+}
+
+tft_classifier::key_t tft_classifier::filter_key(const tft_packet_filter_t& filter)
+{
+  key_t fields       = {};
+  fields.local_addr  = filter.ipv4_local_addr;
+  fields.remote_addr = filter.ipv4_remote_addr;
+  fields.local_port  = filter.single_local_port;
+  fields.remote_port = filter.single_remote_port;
+  fields.protocol    = filter.protocol_id;
+  fields.tos         = filter.type_of_service;
+  return make_key(fields, filter.active_filters);
+}
+
+tft_classifier::tft_classifier(const filter_map_t& filter_map)
+{
+  for (filter_map_t::const_iterator it = filter_map.begin(); it != filter_map.end(); ++it) {
+    // Filters without components never match
+    if (it->second.active_filters != 0) {
+      filters.push_back(it->second);
+    }
+  }
+
+  // Groups are created in order of their first filter, which keeps them sorted by best_rank
+  std::map<uint16_t, uint32_t> group_idx;
+  for (uint32_t rank = 0; rank < filters.size(); rank++) {
+    const tft_packet_filter_t& filter     = filters[rank];
+    uint16_t                   components = filter.active_filters & (V4_HASHED_COMPONENTS | PORT_RANGE_COMPONENTS);
+
+    std::map<uint16_t, uint32_t>::iterator it = group_idx.find(components);
+    if (it == group_idx.end()) {
+      group_t group;
+      group.components = components;
+      group.best_rank  = rank;
+      group.match_v6   = !(components & TYPE_OF_SERVICE_FLAG);
+      groups.push_back(group);
+      it = group_idx.insert(std::make_pair(components, (uint32_t)groups.size() - 1)).first;
+    }
+
+    group_t& group = groups[it->second];
+    key_t    key   = filter_key(filter);
+    group.v4_table[make_key(key, components & V4_HASHED_COMPONENTS)].push_back(rank);
+    if (group.match_v6) {
+      group.v6_table[make_key(key, components & PROTOCOL_ID_FLAG)].push_back(rank);
+    }
+  }
+}
+
+const tft_packet_filter_t* tft_classifier::match(const srslte::unique_byte_buffer_t& pdu) const
+{
+  struct iphdr* ip_pkt = (struct iphdr*)pdu->msg;
+  key_t         fields = {};
+  bool          is_v4  = ip_pkt->version == 4;
+  bool          is_udp = false;
+  uint16_t      local_port = 0, remote_port = 0; // Host byte order, for the ranges
+
+  if (is_v4) {
+    fields.local_addr  = ip_pkt->saddr;
+    fields.remote_addr = ip_pkt->daddr;
+    fields.protocol    = ip_pkt->protocol;
+    fields.tos         = ip_pkt->tos;
+    if (ip_pkt->protocol == UDP_PROTOCOL) {
+      struct udphdr* udp_pkt = (struct udphdr*)&pdu->msg[ip_pkt->ihl * 4];
+      fields.local_port      = udp_pkt->source;
+      fields.remote_port     = udp_pkt->dest;
+      local_port             = ntohs(udp_pkt->source);
+      remote_port            = ntohs(udp_pkt->dest);
+      is_udp                 = true;
+    }
+  } else if (ip_pkt->version == 6) {
+    fields.protocol = ((struct ipv6hdr*)pdu->msg)->nexthdr;
+  } else {
+    return NULL;
+  }
+
+  uint32_t best = UINT32_MAX;
+  for (uint32_t g = 0; g < groups.size() && groups[g].best_rank < best; g++) {
+    const group_t& group = groups[g];
+    if (is_v4) {
+      // Port components only match UDP, for IPv6 they are not checked yet
+      if ((group.components & PORT_COMPONENTS) && !is_udp) {
+        continue;
+      }
+      table_t::const_iterator it = group.v4_table.find(make_key(fields, group.components & V4_HASHED_COMPONENTS));
+      if (it == group.v4_table.end()) {
+        continue;
+      }
+      for (uint32_t i = 0; i < it->second.size() && it->second[i] < best; i++) {
+        const tft_packet_filter_t& filter = filters[it->second[i]];
+        if ((filter.active_filters & LOCAL_PORT_RANGE_FLAG) &&
+            (local_port < filter.local_port_range[0] || local_port > filter.local_port_range[1])) {
+          continue;
+        }
+        if ((filter.active_filters & REMOTE_PORT_RANGE_FLAG) &&
+            (remote_port < filter.remote_port_range[0] || remote_port > filter.remote_port_range[1])) {
+          continue;
+        }
+        best = it->second[i];
+        break;
+      }
+    } else if (group.match_v6) {
+      table_t::const_iterator it = group.v6_table.find(make_key(fields, group.components & PROTOCOL_ID_FLAG));
+      if (it != group.v6_table.end() && it->second[0] < best) {
+        best = it->second[0];
+      }
+    }
+  }
+
+  return best < filters.size() ? &filters[best] : NULL;
+}
+
+void tft_classifier_rcu::publish(tft_classifier* classifier)
+{
+  tft_classifier* old = current.exchange(classifier);
+
+  // A reader entering after the exchange sees the new classifier, so only one
+  // that is inside right now can still use the old one
+  uint64_t e = epoch.load();
+  if (e & 1) {
+    while (epoch.load() == e) {
+      std::this_thread::yield();
+    }
+  }
+  delete old;
+}
+
+} // namespace srsue
@@ -68,12 +68,12 @@ tft_packet_filter_t::tft_packet_filter_t(uint8_t
     switch (filter_type) {
       // IPv4
       case IPV4_LOCAL_ADDR_TYPE:
-        active_filters = IPV4_LOCAL_ADDR_FLAG;
+        active_filters |= IPV4_LOCAL_ADDR_FLAG;
         memcpy(&ipv4_local_addr, &tft.filter[idx], IPV4_ADDR_SIZE);
         idx += IPV4_ADDR_SIZE;
         break;
       case IPV4_REMOTE_ADDR_TYPE:
-        active_filters = IPV4_REMOTE_ADDR_FLAG;
+        active_filters |= IPV4_REMOTE_ADDR_FLAG;
         memcpy(&ipv4_remote_addr, &tft.filter[idx], IPV4_ADDR_SIZE);
         idx += IPV4_ADDR_SIZE;
         break;
@@ -86,25 +86,36 @@ tft_packet_filter_t::tft_packet_filter_t(uint8_t
         break;
       // Ports
       case SINGLE_LOCAL_PORT_TYPE:
-        active_filters = SINGLE_LOCAL_PORT_FLAG;
+        active_filters |= SINGLE_LOCAL_PORT_FLAG;
         memcpy(&single_local_port, &tft.filter[idx], 2);
         idx += 2;
         break;
       case SINGLE_REMOTE_PORT_TYPE:
-        active_filters = SINGLE_REMOTE_PORT_FLAG;
+        active_filters |= SINGLE_REMOTE_PORT_FLAG;
         memcpy(&single_remote_port, &tft.filter[idx], 2);
         idx += 2;
         break;
       case LOCAL_PORT_RANGE_TYPE:
+        active_filters |= LOCAL_PORT_RANGE_FLAG;
+        local_port_range[0] = (tft.filter[idx] << 8) | tft.filter[idx + 1];
+        local_port_range[1] = (tft.filter[idx + 2] << 8) | tft.filter[idx + 3];
+        idx += 4;
         break;
       case REMOTE_PORT_RANGE_TYPE:
+        active_filters |= REMOTE_PORT_RANGE_FLAG;
+        remote_port_range[0] = (tft.filter[idx] << 8) | tft.filter[idx + 1];
+        remote_port_range[1] = (tft.filter[idx + 2] << 8) | tft.filter[idx + 3];
+        idx += 4;
         break;
       // Protocol/Next Header
       case PROTOCOL_ID_TYPE:
+        active_filters |= PROTOCOL_ID_FLAG;
+        protocol_id = tft.filter[idx];
+        idx += 1;
         break;
       // Type of service/Traffic class
       case TYPE_OF_SERVICE_TYPE:
-        active_filters = TYPE_OF_SERVICE_FLAG;
+        active_filters |= TYPE_OF_SERVICE_FLAG;
         memcpy(&type_of_service, &tft.filter[idx], 1);
         idx += 1; 
         memcpy(&type_of_service_mask, &tft.filter[idx], 1);
@@ -262,6 +273,18 @@ bool tft_packet_filter_t::match_port(const srslte::unique_byte_buffer_t& pdu)
             return false;
           }
         }
+        if (active_filters & LOCAL_PORT_RANGE_FLAG) {
+          uint16_t port = ntohs(udp_pkt->source);
+          if (port < local_port_range[0] || port > local_port_range[1]) {
+            return false;
+          }
+        }
+        if (active_filters & REMOTE_PORT_RANGE_FLAG) {
+          uint16_t port = ntohs(udp_pkt->dest);
+          if (port < remote_port_range[0] || port > remote_port_range[1]) {
+            return false;
+          }
+        }
         break;
       case TCP_PROTOCOL:
         return false;
@@ -96,7 +96,7 @@ public:
 
   // sidelink extension
   int read_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) {return 0;}
-  void write_pdu_sl(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) {return;}
+  void write_pdu_sl(uint32_t lcid, const srslte::sl_sdu_t& sdu) {return;}
 
   void     write_sdu(uint32_t lcid, uint32_t nof_bytes) { ul_queues[lcid] += nof_bytes; }
   void     write_pdu_bcch_bch(uint8_t* payload, uint32_t nof_bytes){};
@@ -1094,6 +1094,91 @@ int mac_ul_sch_pdu_three_byte_test()
   return SRSLTE_SUCCESS;
 }
 
+// LCID 1 hands out whole messages of a fixed size, LCID 3 segments its queue
+class rlc_sl_dummy : public rlc_dummy
+{
+public:
+  rlc_sl_dummy(srslte::log_filter* log_, uint32_t msg_len_) : rlc_dummy(log_), msg_len(msg_len_) {}
+  int read_pdu_sl(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
+  {
+    if (lcid == 3) {
+      int n = read_pdu(lcid, payload, nof_bytes);
+      lcid3_bytes += n;
+      return n;
+    }
+    if (lcid != 1 || nof_bytes < msg_len) {
+      return 0;
+    }
+    memset(payload, 1, msg_len);
+    lcid1_msgs++;
+    return msg_len;
+  }
+
+  uint32_t msg_len;
+  uint32_t lcid1_msgs  = 0;
+  uint32_t lcid3_bytes = 0;
+};
+
+// LCID 1 must leave room in the SL-SCH PDU for LCID 3
+int mac_sl_pdu_lcid3_test()
+{
+  const uint32_t pdu_sz = 500;
+
+  srslte::log_filter mac_log("MAC");
+  mac_log.set_level(srslte::LOG_LEVEL_DEBUG);
+  mac_log.set_hex_limit(100000);
+
+  srslte::byte_buffer_t payload;
+
+  // small messages, LCID 1 alone fills the PDU
+  {
+    rlc_sl_dummy rlc(&mac_log, 100);
+    mux          mux_unit(&mac_log);
+    mux_unit.init(&rlc, NULL, NULL);
+    mux_unit.sidelink_id = 0;
+
+    payload.clear();
+    TESTASSERT(mux_unit.sl_pdu_get(&payload, pdu_sz) != NULL);
+    TESTASSERT(rlc.lcid1_msgs == 4);
+    TESTASSERT(rlc.lcid3_bytes == 0);
+  }
+
+  // small messages, LCID 3 gets half of the PDU
+  {
+    rlc_sl_dummy rlc(&mac_log, 100);
+    mux          mux_unit(&mac_log);
+    mux_unit.init(&rlc, NULL, NULL);
+    mux_unit.sidelink_id = 0;
+    rlc.write_sdu(3, 10000);
+
+    payload.clear();
+    TESTASSERT(mux_unit.sl_pdu_get(&payload, pdu_sz) != NULL);
+    TESTASSERT(rlc.lcid1_msgs == 2);
+    TESTASSERT(rlc.lcid3_bytes >= pdu_sz / 2);
+  }
+
+  // messages larger than half of the PDU alternate with LCID 3
+  {
+    rlc_sl_dummy rlc(&mac_log, 400);
+    mux          mux_unit(&mac_log);
+    mux_unit.init(&rlc, NULL, NULL);
+    mux_unit.sidelink_id = 0;
+    rlc.write_sdu(3, 10000);
+
+    for (uint32_t i = 0; i < 4; i++) {
+      uint32_t lcid3_bytes = rlc.lcid3_bytes;
+      payload.clear();
+      TESTASSERT(mux_unit.sl_pdu_get(&payload, pdu_sz) != NULL);
+      TESTASSERT(rlc.lcid1_msgs == i / 2 + 1);
+      if (i % 2) {
+        TESTASSERT(rlc.lcid3_bytes - lcid3_bytes >= pdu_sz / 2);
+      }
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 struct ra_test {
   uint32_t                     nof_prachs;
   uint32_t                     rar_nof_rapid; // set to zero to don't transmit RAR
@@ -1524,6 +1609,11 @@ int main(int argc, char** argv)
     return -1;
   }
 
+  if (mac_sl_pdu_lcid3_test()) {
+    printf("mac_sl_pdu_lcid3_test() test failed.\n");
+    return -1;
+  }
+
   if (mac_random_access_test()) {
     printf("mac_random_access_test() test failed.\n");
     return -1;
@@ -380,6 +380,77 @@ int main(int argc, char **argv)
   }
 
 
+  // stream the sensing data as binary frames
+  {
+    phy_args_t phy_args;
+    phy_args.sidelink_id = 0;
+
+    srsue::phy_common common(1);
+
+    common.args = &phy_args;
+    memcpy(&common.ue_repo.rp, &rp, sizeof(rp));
+
+    for (uint32_t tti = 0; tti < 20; tti++) {
+      common.sensing_sps->tick(tti);
+      common.sensing_sps->addAverageSRSSI(tti, -90.0 - tti);
+      for (uint32_t c = 0; c < rp.numSubchannel_r14; c++) {
+        common.sensing_sps->addChannelSRSSI(tti, c, -100.0 - c);
+      }
+      if (tti % 2 == 0) {
+        common.sensing_sps->addSCI(tti, 1, 2, 0, 3, -80.0);
+      }
+    }
+
+    srsue::g_restapi.init_and_start(&common);
+
+    struct _u_request request;
+    struct _u_response response;
+
+    ulfius_init_request(&request);
+    ulfius_init_response(&response);
+
+    // the 4 most recent TTIs are held back, so we expect TTIs 10..15
+    request.http_url = o_strdup("http://localhost:13000/phy/SPS_stream?since_tti=9");
+
+    ret = ulfius_send_http_request(&request, &response);
+    if (U_OK != ret) {
+      printf("ulfius_send_http_request failed with %d\n", ret);
+    }
+
+    printf("respones body %p size %ld addr is at %s\n", response.binary_body, response.binary_body_length, request.http_url);
+
+    uint32_t expected_tti = 10;
+    size_t   offset       = 0;
+    while (offset + sizeof(rest_stream_frame_hdr_t) <= response.binary_body_length) {
+      rest_stream_frame_hdr_t hdr;
+      memcpy(&hdr, (char*)response.binary_body + offset, sizeof(hdr));
+
+      float sRssi[MAX_SUBCHANNELS];
+      memcpy(sRssi, (char*)response.binary_body + offset + sizeof(hdr), hdr.numSubChannels * sizeof(float));
+
+      printf("frame tti %d avgSRssi %f numScis %d length %d\n", hdr.tti, hdr.avgSRssi, hdr.numScis, hdr.length);
+
+      if (hdr.magic != REST_STREAM_MAGIC || hdr.tti != expected_tti || hdr.avgSRssi != -90.0f - hdr.tti ||
+          hdr.numSubChannels != rp.numSubchannel_r14 || sRssi[1] != -101.0f || hdr.numScis != (hdr.tti % 2 == 0)) {
+        printf("Unexpected frame in sensing stream.\n");
+        return -1;
+      }
+      offset += hdr.length;
+      expected_tti++;
+    }
+
+    ulfius_clean_request(&request);
+    ulfius_clean_response(&response);
+
+    srsue::g_restapi.stop();
+
+    if (expected_tti != 16) {
+      printf("Expected 6 frames in sensing stream, got %d.\n", expected_tti - 10);
+      return -1;
+    }
+  }
+
+
 
   {
     phy_args_t phy_args;
@@ -464,18 +535,9 @@ int main(int argc, char **argv)
       return -1;
     }
 
-    // setup buffer for tranmit noise samples
-    common.noise_buffer = (cf_t*)srslte_vec_malloc(sizeof(cf_t) * SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM));
-    if (!common.noise_buffer) {
-      printf("Error: Allocating memory for noise_buffer\n");
-      return -1;
-    }
-
     // this keeps the server running for manual testing
     usleep(ttl*1e6);
 
-    free(common.noise_buffer);
-
     srsue::g_restapi.stop();
   }
 
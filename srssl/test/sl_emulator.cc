@@ -0,0 +1,727 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+
+#include <condition_variable>
+#include <fcntl.h>
+#include <functional>
+#include <inttypes.h>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "srslte/common/log_filter.h"
+#include "srslte/phy/channel/channel.h"
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+#include "srssl/hdr/phy/cc_worker.h"
+#include "srssl/hdr/stack/mac/mac.h"
+
+/*
+ * Runs several sidelink UEs, each with its own PHY (phy_common + cc_worker) and
+ * MAC, in one process and as fast as possible. The UEs are placed on a straight
+ * road. The subframe a UE transmits is passed through one srslte::channel per
+ * receiver (fading and propagation delay), scaled by the path loss of the link
+ * and summed with the other transmissions and thermal noise into the receive
+ * buffer of that UE.
+ *
+ * Every UE sends one packet per PSSCH transmission which fills the whole TB.
+ * The emulator reports the aggregate PSSCH throughput, the packet reception
+ * ratio (PRR) over the distance between transmitter and receiver and the share
+ * of transmissions which overlapped with another one in time and frequency.
+ *
+ * All random choices derive from the seed, two runs with the same arguments
+ * deliver identical results regardless of the number of threads.
+ */
+
+using namespace srsue;
+
+static srslte_cell_t cell = {
+    50,                // nof_prb
+    1,                 // nof_ports
+    0,                 // cell_id
+    SRSLTE_CP_NORM,    // cyclic prefix
+    SRSLTE_PHICH_NORM, // PHICH length
+    SRSLTE_PHICH_R_1   // PHICH resources
+};
+
+static uint32_t    nof_ues          = 10;
+static uint32_t    nof_tti          = 1000;
+static uint32_t    nof_threads      = 0;
+static uint32_t    seed             = 1;
+static float       road_length_m    = 500;
+static float       pathloss_exp     = 3.0;
+static float       tx_power_dbm     = 23.0;
+static float       noise_figure_db  = 9.0;
+static float       rx_gain_db       = 100.0; // fixed gain in front of the ADC, keeps the samples away from denormals
+static float       bin_size_m       = 50;
+static std::string fading_model     = "none";
+static bool        check_repeat     = false;
+static char*       output_file_name = NULL;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [nptjsdexfbro]\n", prog);
+  printf("\t-n Number of UEs [Default %d]\n", nof_ues);
+  printf("\t-p nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-t Number of TTIs to emulate [Default %d]\n", nof_tti);
+  printf("\t-j Number of threads, 0 for one per core [Default %d]\n", nof_threads);
+  printf("\t-s Seed of positions, noise, fading and resource selection [Default %d]\n", seed);
+  printf("\t-d Length of the road in m [Default %.0f]\n", road_length_m);
+  printf("\t-e Path loss exponent [Default %.1f]\n", pathloss_exp);
+  printf("\t-x Transmit power in dBm [Default %.1f]\n", tx_power_dbm);
+  printf("\t-f Fading model of every link, e.g. epa5, eva70 [Default %s]\n", fading_model.c_str());
+  printf("\t-b Width of the PRR distance bins in m [Default %.0f]\n", bin_size_m);
+  printf("\t-r Run twice and fail if the results differ (0/1) [Default %d]\n", check_repeat);
+  printf("\t-o Write the PRR over distance as CSV to this file\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nptjsdexfbro")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_ues = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'p':
+        cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 't':
+        nof_tti = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'j':
+        nof_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        seed = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        road_length_m = strtof(argv[optind], NULL);
+        break;
+      case 'e':
+        pathloss_exp = strtof(argv[optind], NULL);
+        break;
+      case 'x':
+        tx_power_dbm = strtof(argv[optind], NULL);
+        break;
+      case 'f':
+        fading_model = argv[optind];
+        break;
+      case 'b':
+        bin_size_m = strtof(argv[optind], NULL);
+        break;
+      case 'r':
+        check_repeat = strtol(argv[optind], NULL, 10) != 0;
+        break;
+      case 'o':
+        output_file_name = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (nof_ues < 2 || bin_size_m <= 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+// Log-distance path loss at 5.9 GHz, free space up to 1 m
+static float pathloss_db(float d)
+{
+  return 47.86f + 10 * pathloss_exp * log10f(SRSLTE_MAX(d, 1.0f));
+}
+
+/* Every SDU starts with the index of the sending UE and a sequence number, the
+ * rest of the TB is filled with a pattern of both. */
+#define APP_HDR_LEN 8
+
+class app_rlc : public rlc_interface_mac
+{
+public:
+  void init(uint32_t id_, uint32_t nof_ues)
+  {
+    id = id_;
+    rx_seq.resize(nof_ues);
+    rx_bytes.resize(nof_ues);
+  }
+
+  int read_pdu_sl(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
+  {
+    if (lcid != 1 || nof_bytes < APP_HDR_LEN) {
+      return 0;
+    }
+    uint32_t seq = tx_packets++;
+    memcpy(&payload[0], &id, 4);
+    memcpy(&payload[4], &seq, 4);
+    for (uint32_t i = APP_HDR_LEN; i < nof_bytes; i++) {
+      payload[i] = (uint8_t)(id + seq + i);
+    }
+    tx_bytes += nof_bytes;
+    return nof_bytes;
+  }
+
+  // called by the PDU thread of the MAC
+  void write_pdu_sl(uint32_t lcid, const srslte::sl_sdu_t& sdu)
+  {
+    uint32_t src, seq;
+    if (lcid != 1 || sdu.N_bytes < APP_HDR_LEN) {
+      return;
+    }
+    memcpy(&src, &sdu.msg[0], 4);
+    memcpy(&seq, &sdu.msg[4], 4);
+    for (uint32_t i = APP_HDR_LEN; i < sdu.N_bytes; i++) {
+      if (sdu.msg[i] != (uint8_t)(src + seq + i)) {
+        src = UINT32_MAX;
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (src >= rx_seq.size() || src == id) {
+      rx_corrupt++;
+    } else if (rx_seq[src].insert(seq).second) {
+      rx_bytes[src] += sdu.N_bytes;
+    }
+    rx_sdus++;
+  }
+
+  bool     has_data(const uint32_t lcid) { return false; }
+  uint32_t get_buffer_state(const uint32_t lcid) { return 0; }
+  int      read_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) { return 0; }
+  void     write_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) {}
+  void     write_pdu_bcch_bch(uint8_t* payload, uint32_t nof_bytes) {}
+  void     write_pdu_bcch_dlsch(uint8_t* payload, uint32_t nof_bytes) {}
+  void     write_pdu_pcch(uint8_t* payload, uint32_t nof_bytes) {}
+  void     write_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) {}
+
+  uint32_t get_rx_sdus()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rx_sdus;
+  }
+
+  uint32_t id         = 0;
+  uint32_t tx_packets = 0;
+  uint64_t tx_bytes   = 0;
+  uint32_t rx_sdus    = 0;
+  uint32_t rx_corrupt = 0;
+
+  // unique packets and their bytes received from each UE
+  std::vector<std::set<uint32_t> > rx_seq;
+  std::vector<uint64_t>            rx_bytes;
+
+private:
+  std::mutex mutex;
+};
+
+class mac_phy_dummy : public phy_interface_mac_lte
+{
+public:
+  void         configure_prach_params() {}
+  void         prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm) {}
+  prach_info_t prach_get_info()
+  {
+    prach_info_t info = {};
+    return info;
+  }
+  void     sr_send() {}
+  int      sr_last_tx_tti() { return -1; }
+  void     set_mch_period_stop(uint32_t stop) {}
+  void     set_crnti(uint16_t rnti) {}
+  void     set_timeadv_rar(uint32_t ta_cmd) {}
+  void     set_timeadv(uint32_t ta_cmd) {}
+  void     set_activation_deactivation_scell(uint32_t cmd) {}
+  void     set_rar_grant(uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN], uint16_t rnti) {}
+  uint32_t get_current_tti() { return tti; }
+  float    get_phr() { return 0; }
+  float    get_pathloss_db() { return 0; }
+
+  uint32_t tti = 0;
+};
+
+class rrc_dummy : public rrc_interface_mac
+{
+public:
+  void ra_problem() {}
+  void ho_ra_completed(bool ra_successful) {}
+  void release_pucch_srs() {}
+};
+
+// One UE: PHY and MAC and the dummy layers around them
+class emu_ue : public stack_interface_phy_lte
+{
+public:
+  emu_ue(uint32_t id_, uint32_t nof_ues) : id(id_), log("PHY"), mac_log("MAC"), common(1), mac(&mac_log)
+  {
+    args                 = phy_args_t();
+    args.nof_rx_ant      = 1;
+    args.nof_carriers    = 1;
+    args.nof_radios      = 1;
+    args.nof_rf_channels = 1;
+    args.equalizer_mode  = "mmse";
+    args.snr_estim_alg   = "refs";
+    args.sss_algorithm   = "full";
+    args.pdsch_max_its   = 8;
+    // UE 0 sends the sync signals all others align to
+    args.sidelink_master = id == 0;
+#ifdef USE_SENSING_SPS
+    args.sidelink_id = id;
+#else
+    // without Sensing SPS a UE only transmits in the pool subframes of its sidelink_id modulo 5
+    args.sidelink_id = id % 5;
+#endif
+
+    common.args  = &args;
+    common.stack = this;
+    common.set_cell(cell);
+    common.sensing_sps->setRandomSeed(seed * 65537 + 2 * id);
+
+    worker = std::unique_ptr<cc_worker>(new cc_worker(0, cell.nof_prb, &common, &log));
+    worker->set_cell(cell);
+    worker->set_random_seed(seed * 65537 + 2 * id + 1);
+
+    rlc.init(id, nof_ues);
+    mac.sidelink_id = args.sidelink_id;
+    mac.init(&mac_phy, &rlc, &rrc);
+  }
+
+  uint16_t get_dl_sched_rnti(uint32_t tti) { return mac.get_dl_sched_rnti(tti); }
+  uint16_t get_ul_sched_rnti(uint32_t tti) { return mac.get_ul_sched_rnti(tti); }
+
+  void new_grant_ul(uint32_t cc_idx, mac_grant_ul_t grant, tb_action_ul_t* action)
+  {
+    mac.new_grant_ul(cc_idx, grant, action);
+  }
+  void new_grant_dl(uint32_t cc_idx, mac_grant_dl_t grant, tb_action_dl_t* action)
+  {
+    mac.new_grant_dl(cc_idx, grant, action);
+  }
+  void tb_decoded(uint32_t cc_idx, mac_grant_dl_t grant, bool ack[SRSLTE_MAX_CODEWORDS])
+  {
+    mac.tb_decoded(cc_idx, grant, ack);
+  }
+  void bch_decoded_ok(uint8_t* payload, uint32_t len) { mac.bch_decoded_ok(payload, len); }
+  void mch_decoded(uint32_t len, bool crc) { mac.mch_decoded(len, crc); }
+  void new_mch_dl(srslte_pdsch_grant_t phy_grant, tb_action_dl_t* action) { mac.new_mch_dl(phy_grant, action); }
+  void set_mbsfn_config(uint32_t nof_mbsfn_services) { mac.set_mbsfn_config(nof_mbsfn_services); }
+  void run_tti(const uint32_t tti)
+  {
+    mac_phy.tti = tti;
+    mac.run_tti(tti);
+  }
+
+  void in_sync() {}
+  void out_of_sync() {}
+  void new_phy_meas(float rsrp, float rsrq, uint32_t tti, int earfcn = -1, int pci = -1) {}
+
+  uint32_t                   id;
+  phy_args_t                 args;
+  srslte::log_filter         log;
+  srslte::log_filter         mac_log;
+  phy_common                 common;
+  std::unique_ptr<cc_worker> worker;
+  mac_phy_dummy              mac_phy;
+  app_rlc                    rlc;
+  rrc_dummy                  rrc;
+  srsue::mac                 mac;
+};
+
+// A subframe sent by a UE, kept until it is received TX_DELAY TTIs later
+typedef struct {
+  cf_t*    samples;
+  bool     active;
+  bool     sync;  // SLSS and PSBCH, no PSSCH
+  float    scale; // normalises the samples to the transmit power
+  uint32_t n_subch;
+  uint32_t L_subch;
+} tx_slot_t;
+
+#define NOF_TX_SLOTS (TX_DELAY + 1)
+
+// Runs work(thread_idx) on all threads once per call to run()
+class tti_pool
+{
+public:
+  tti_pool(uint32_t nof_threads, std::function<void(uint32_t)> work_) : work(work_)
+  {
+    for (uint32_t i = 0; i < nof_threads; i++) {
+      threads.push_back(std::thread(&tti_pool::run_thread, this, i));
+    }
+  }
+
+  ~tti_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      running = false;
+      start_cvar.notify_all();
+    }
+    for (uint32_t i = 0; i < threads.size(); i++) {
+      threads[i].join();
+    }
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending = (uint32_t)threads.size();
+    generation++;
+    start_cvar.notify_all();
+    while (pending) {
+      done_cvar.wait(lock);
+    }
+  }
+
+private:
+  void run_thread(uint32_t idx)
+  {
+    uint64_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running && generation == seen) {
+          start_cvar.wait(lock);
+        }
+        if (!running) {
+          return;
+        }
+        seen = generation;
+      }
+
+      work(idx);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--pending == 0) {
+        done_cvar.notify_one();
+      }
+    }
+  }
+
+  std::function<void(uint32_t)> work;
+  std::vector<std::thread>      threads;
+  std::mutex                    mutex;
+  std::condition_variable       start_cvar;
+  std::condition_variable       done_cvar;
+  uint64_t                      generation = 0;
+  uint32_t                      pending    = 0;
+  bool                          running    = true;
+};
+
+struct emu_result_t {
+  uint64_t tx_packets   = 0;
+  uint64_t tx_bytes     = 0;
+  uint64_t rx_packets   = 0; // unique packets summed over all receivers
+  uint64_t rx_bytes     = 0;
+  uint64_t rx_corrupt   = 0;
+  uint64_t nof_pssch    = 0;
+  uint64_t nof_collided = 0;
+
+  std::vector<uint64_t> prr_tx; // per distance bin, packets sent to a receiver in that distance
+  std::vector<uint64_t> prr_rx; // of those, the ones which were received
+
+  double wall_ms = 0;
+};
+
+static bool operator==(const emu_result_t& a, const emu_result_t& b)
+{
+  return a.tx_packets == b.tx_packets && a.tx_bytes == b.tx_bytes && a.rx_packets == b.rx_packets &&
+         a.rx_bytes == b.rx_bytes && a.rx_corrupt == b.rx_corrupt && a.nof_pssch == b.nof_pssch &&
+         a.nof_collided == b.nof_collided && a.prr_tx == b.prr_tx && a.prr_rx == b.prr_rx;
+}
+
+static void emulate(emu_result_t* result)
+{
+  uint32_t sf_len   = SRSLTE_SF_LEN_PRB(cell.nof_prb);
+  uint32_t nof_bins = (uint32_t)ceilf(road_length_m / bin_size_m) + 1;
+
+  // Sample power is in W plus the receive gain, noise is thermal noise over the sampling bandwidth
+  float noise_dbw = -204.0f + 10 * log10f(sf_len * 1000.0f) + noise_figure_db + rx_gain_db;
+
+  srslte_random_t random = srslte_random_init(seed);
+
+  std::vector<float> position(nof_ues);
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    position[i] = srslte_random_uniform_real_dist(random, 0, road_length_m);
+  }
+  srslte_random_free(random);
+
+  std::vector<std::unique_ptr<emu_ue> > ues;
+  std::vector<srslte_channel_awgn_t>    rx_awgn(nof_ues);
+  std::vector<cf_t*>                    rx_tmp(nof_ues);
+  std::vector<tx_slot_t>                tx_slots(nof_ues * NOF_TX_SLOTS);
+
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    ues.push_back(std::unique_ptr<emu_ue>(new emu_ue(i, nof_ues)));
+
+    srslte_channel_awgn_init(&rx_awgn[i], seed * 65537 + i);
+    srslte_channel_awgn_set_snr(&rx_awgn[i], -noise_dbw);
+
+    rx_tmp[i] = srslte_vec_cf_malloc(sf_len);
+    for (uint32_t s = 0; s < NOF_TX_SLOTS; s++) {
+      tx_slot_t* slot = &tx_slots[i * NOF_TX_SLOTS + s];
+      bzero(slot, sizeof(tx_slot_t));
+      slot->samples = srslte_vec_cf_malloc(sf_len);
+    }
+  }
+
+  // link j -> i: fading and propagation delay in the channel, path loss as amplitude
+  std::vector<srslte::channel_ptr> links(nof_ues * nof_ues);
+  std::vector<float>               link_gain(nof_ues * nof_ues);
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    for (uint32_t j = 0; j < nof_ues; j++) {
+      if (i == j) {
+        continue;
+      }
+      float d = fabsf(position[i] - position[j]);
+
+      srslte::channel::args_t channel_args;
+      channel_args.enable        = true;
+      channel_args.fading_enable = fading_model != "none";
+      channel_args.fading_model  = fading_model;
+      channel_args.fading_seed   = seed * 65537 + i * nof_ues + j;
+      channel_args.delay_enable  = true;
+      channel_args.delay_min_us  = d / 299.792458f;
+      channel_args.delay_max_us  = channel_args.delay_min_us;
+
+      links[i * nof_ues + j] = srslte::channel_ptr(new srslte::channel(channel_args, 1));
+      links[i * nof_ues + j]->set_srate(sf_len * 1000);
+
+      link_gain[i * nof_ues + j] = sqrtf(powf(10, (tx_power_dbm - 30 - pathloss_db(d) + rx_gain_db) / 10));
+    }
+  }
+
+  uint32_t cur_tti = 0;
+
+  // Receives subframe cur_tti and generates the one sent TX_DELAY later. The
+  // receivers only read the slots of cur_tti, every UE writes its own slot of
+  // cur_tti + TX_DELAY, so all UEs can be processed at the same time.
+  tti_pool pool(nof_threads, [&](uint32_t thread_idx) {
+    srslte_timestamp_t ts;
+    srslte_timestamp_init(&ts, cur_tti / 1000, (cur_tti % 1000) * 1e-3);
+
+    for (uint32_t i = thread_idx; i < nof_ues; i += nof_threads) {
+      emu_ue* ue = ues[i].get();
+      cf_t*   rx = ue->worker->get_rx_buffer(0);
+
+      bzero(rx, sizeof(cf_t) * sf_len);
+      for (uint32_t j = 0; j < nof_ues; j++) {
+        tx_slot_t* slot = &tx_slots[j * NOF_TX_SLOTS + cur_tti % NOF_TX_SLOTS];
+        if (j == i || !slot->active) {
+          continue;
+        }
+        cf_t* in[SRSLTE_MAX_PORTS]  = {slot->samples};
+        cf_t* out[SRSLTE_MAX_PORTS] = {rx_tmp[i]};
+        links[i * nof_ues + j]->run(in, out, sf_len, ts);
+
+        srslte_vec_sc_prod_cfc(rx_tmp[i], link_gain[i * nof_ues + j] * slot->scale, rx_tmp[i], sf_len);
+        srslte_vec_sum_ccc(rx, rx_tmp[i], rx, sf_len);
+      }
+      srslte_channel_awgn_run_c(&rx_awgn[i], rx, rx, sf_len, cur_tti, 0);
+
+      uint32_t tti = cur_tti % 10240;
+      ue->run_tti(tti);
+      ue->worker->set_tti(tti);
+      ue->worker->set_receive_time(ts);
+      ue->worker->work_sl_rx();
+
+      // nothing is sent which would be received after the last TTI
+      tx_slot_t* slot = &tx_slots[i * NOF_TX_SLOTS + (cur_tti + TX_DELAY) % NOF_TX_SLOTS];
+      slot->active    = cur_tti + TX_DELAY < nof_tti && ue->worker->work_sl_tx();
+      if (slot->active) {
+        cf_t* tx = ue->worker->get_tx_buffer(0);
+        memcpy(slot->samples, tx, sizeof(cf_t) * sf_len);
+        ue->worker->get_sl_tx_subchannels(&slot->n_subch, &slot->L_subch);
+        slot->sync  = slot->L_subch == 0;
+        slot->scale = 1.0f / sqrtf(srslte_vec_avg_power_cf(tx, sf_len));
+      }
+    }
+  });
+
+  *result = emu_result_t();
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+
+  for (cur_tti = 0; cur_tti < nof_tti; cur_tti++) {
+    pool.run();
+
+    // transmissions which overlap in at least one subchannel collide
+    for (uint32_t i = 0; i < nof_ues; i++) {
+      tx_slot_t* a = &tx_slots[i * NOF_TX_SLOTS + (cur_tti + TX_DELAY) % NOF_TX_SLOTS];
+      if (!a->active || a->sync) {
+        continue;
+      }
+      result->nof_pssch++;
+      for (uint32_t j = 0; j < nof_ues; j++) {
+        tx_slot_t* b = &tx_slots[j * NOF_TX_SLOTS + (cur_tti + TX_DELAY) % NOF_TX_SLOTS];
+        if (j != i && b->active && !b->sync && a->n_subch < b->n_subch + b->L_subch &&
+            b->n_subch < a->n_subch + a->L_subch) {
+          result->nof_collided++;
+          break;
+        }
+      }
+    }
+  }
+
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  result->wall_ms = t[0].tv_sec * 1e3 + t[0].tv_usec / 1e3;
+
+  // the MAC PDU threads may still be busy with the last TBs
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    uint32_t last   = UINT32_MAX;
+    uint32_t stable = 0;
+    while (stable < 20) {
+      uint32_t n = ues[i]->rlc.get_rx_sdus();
+      stable     = (n == last) ? stable + 1 : 0;
+      last       = n;
+      usleep(1000);
+    }
+  }
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    ues[i]->mac.stop();
+  }
+
+  result->prr_tx.resize(nof_bins);
+  result->prr_rx.resize(nof_bins);
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    app_rlc* rlc = &ues[i]->rlc;
+    result->tx_packets += rlc->tx_packets;
+    result->tx_bytes += rlc->tx_bytes;
+    result->rx_corrupt += rlc->rx_corrupt;
+    for (uint32_t j = 0; j < nof_ues; j++) {
+      if (j == i) {
+        continue;
+      }
+      uint32_t bin = (uint32_t)(fabsf(position[i] - position[j]) / bin_size_m);
+      result->prr_tx[bin] += ues[j]->rlc.tx_packets;
+      result->prr_rx[bin] += rlc->rx_seq[j].size();
+      result->rx_packets += rlc->rx_seq[j].size();
+      result->rx_bytes += rlc->rx_bytes[j];
+    }
+  }
+
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    free(rx_tmp[i]);
+    for (uint32_t s = 0; s < NOF_TX_SLOTS; s++) {
+      free(tx_slots[i * NOF_TX_SLOTS + s].samples);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  if (nof_threads == 0) {
+    nof_threads = SRSLTE_MAX(std::thread::hardware_concurrency(), 1);
+  }
+  nof_threads = SRSLTE_MIN(nof_threads, nof_ues);
+
+  // the PHY and MAC report every TB on stdout, keep it out of the measurement
+  fflush(stdout);
+  int stdout_fd = dup(STDOUT_FILENO);
+  int null_fd   = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+
+  emu_result_t result[2];
+  uint32_t     nof_runs = check_repeat ? 2 : 1;
+  for (uint32_t r = 0; r < nof_runs; r++) {
+    emulate(&result[r]);
+  }
+
+  fflush(stdout);
+  dup2(stdout_fd, STDOUT_FILENO);
+  close(null_fd);
+  close(stdout_fd);
+
+  emu_result_t* res     = &result[0];
+  float         sim_sec = nof_tti / 1000.0f;
+
+  printf("Emulated %d UEs on %.0f m for %d TTIs in %.1f ms (%.2fx real time) with %d threads\n",
+         nof_ues,
+         road_length_m,
+         nof_tti,
+         res->wall_ms,
+         nof_tti / res->wall_ms,
+         nof_threads);
+  printf("PSSCH: %" PRIu64 " transmissions, %" PRIu64 " collided (%.1f%%)\n",
+         res->nof_pssch,
+         res->nof_collided,
+         res->nof_pssch ? 100.0 * res->nof_collided / res->nof_pssch : 0.0);
+  printf("Offered: %" PRIu64 " packets, %.3f Mbps per sender\n",
+         res->tx_packets,
+         res->tx_bytes * 8 / sim_sec / 1e6 / nof_ues);
+  printf("Received: %" PRIu64 " packets, aggregate %.3f Mbps, %" PRIu64 " corrupt\n",
+         res->rx_packets,
+         res->rx_bytes * 8 / sim_sec / 1e6,
+         res->rx_corrupt);
+
+  FILE* csv = output_file_name ? fopen(output_file_name, "w") : NULL;
+  if (csv) {
+    fprintf(csv, "distance_m,sent,received,prr\n");
+  }
+
+  printf("%-12s %10s %10s %8s\n", "distance_m", "sent", "received", "prr");
+  for (uint32_t b = 0; b < res->prr_tx.size(); b++) {
+    if (!res->prr_tx[b]) {
+      continue;
+    }
+    float prr = (float)res->prr_rx[b] / res->prr_tx[b];
+    printf("%5.0f-%-6.0f %10" PRIu64 " %10" PRIu64 " %8.3f\n",
+           b * bin_size_m,
+           (b + 1) * bin_size_m,
+           res->prr_tx[b],
+           res->prr_rx[b],
+           prr);
+    if (csv) {
+      fprintf(csv, "%.0f,%" PRIu64 ",%" PRIu64 ",%.4f\n", b * bin_size_m, res->prr_tx[b], res->prr_rx[b], prr);
+    }
+  }
+
+  if (csv) {
+    fclose(csv);
+  }
+
+  if (check_repeat) {
+    if (!(result[0] == result[1])) {
+      printf("Results of the second run differ\n");
+      return -1;
+    }
+    printf("Second run delivered identical results\n");
+  }
+
+  return 0;
+}
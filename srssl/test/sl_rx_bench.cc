@@ -0,0 +1,297 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "srslte/common/log_filter.h"
+#include "srssl/hdr/phy/cc_worker.h"
+
+/*
+ * Replays IQ captures through cc_worker::work_sl_rx() as fast as possible and
+ * reports the processing time of each receive stage per subframe.
+ *
+ * Captures are files of consecutive subframes of complex float samples, as
+ * written by the IQ capture (raw .bin or .sigmf-data) or lib/examples/sl_snr_file_gen.
+ */
+
+using namespace srsue;
+
+static srslte_cell_t cell = {
+    50,                // nof_prb
+    1,                 // nof_ports
+    0,                 // cell_id
+    SRSLTE_CP_NORM,    // cyclic prefix
+    SRSLTE_PHICH_NORM, // PHICH length
+    SRSLTE_PHICH_R_1   // PHICH resources
+};
+
+static char*    input_file_name  = NULL;
+static char*    output_file_name = NULL;
+static uint32_t nof_loops        = 10;
+static uint32_t start_tti        = 1;
+static bool     sidelink_master  = false;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s -f file [pnsmo]\n", prog);
+  printf("\t-f IQ capture to replay\n");
+  printf("\t-p nof_prb of the capture [Default %d]\n", cell.nof_prb);
+  printf("\t-n Number of times the capture is replayed [Default %d]\n", nof_loops);
+  printf("\t-s TTI of the first subframe [Default %d]\n", start_tti);
+  printf("\t-m Decode the PSBCH in sync subframes (0/1) [Default %d]\n", !sidelink_master);
+  printf("\t-o Write the results as CSV to this file\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "fpnsmo")) != -1) {
+    switch (opt) {
+      case 'f':
+        input_file_name = argv[optind];
+        break;
+      case 'p':
+        cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_loops = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        start_tti = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'm':
+        sidelink_master = strtol(argv[optind], NULL, 10) == 0;
+        break;
+      case 'o':
+        output_file_name = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (!input_file_name) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+// Hands out a TB buffer for every grant, like the MAC does for a new transmission
+class stack_dummy : public stack_interface_phy_lte
+{
+public:
+  stack_dummy() : nof_grants(0), nof_decoded(0)
+  {
+    srslte_softbuffer_rx_init(&softbuffer, SRSLTE_MAX_PRB);
+  }
+  ~stack_dummy() { srslte_softbuffer_rx_free(&softbuffer); }
+
+  uint16_t get_dl_sched_rnti(uint32_t tti) { return SRSLTE_RNTI_SL_PLACEHOLDER; }
+  uint16_t get_ul_sched_rnti(uint32_t tti) { return SRSLTE_RNTI_SL_PLACEHOLDER; }
+
+  void new_grant_ul(uint32_t cc_idx, mac_grant_ul_t grant, tb_action_ul_t* action) { bzero(action, sizeof(*action)); }
+
+  void new_grant_dl(uint32_t cc_idx, mac_grant_dl_t grant, tb_action_dl_t* action)
+  {
+    bzero(action, sizeof(*action));
+    srslte_softbuffer_rx_reset(&softbuffer);
+    action->tb[0].enabled       = true;
+    action->tb[0].rv            = grant.tb[0].rv;
+    action->tb[0].payload       = payload;
+    action->tb[0].softbuffer.rx = &softbuffer;
+    nof_grants++;
+  }
+
+  void tb_decoded(uint32_t cc_idx, mac_grant_dl_t grant, bool ack[SRSLTE_MAX_CODEWORDS])
+  {
+    if (ack[0]) {
+      nof_decoded++;
+    }
+  }
+
+  void bch_decoded_ok(uint8_t* payload, uint32_t len) {}
+  void mch_decoded(uint32_t len, bool crc) {}
+  void new_mch_dl(srslte_pdsch_grant_t phy_grant, tb_action_dl_t* action) {}
+  void set_mbsfn_config(uint32_t nof_mbsfn_services) {}
+  void run_tti(const uint32_t tti) {}
+
+  void in_sync() {}
+  void out_of_sync() {}
+  void new_phy_meas(float rsrp, float rsrq, uint32_t tti, int earfcn = -1, int pci = -1) {}
+
+  uint32_t nof_grants;
+  uint32_t nof_decoded;
+
+private:
+  srslte_softbuffer_rx_t softbuffer;
+  // the rx metadata is handed over in sl_rx_meta_t, the buffer only holds the TB
+  uint8_t payload[SRSLTE_MAX_BUFFER_SIZE_BYTES];
+};
+
+static float percentile(std::vector<float>& v, float p)
+{
+  if (v.empty()) {
+    return 0.0;
+  }
+  std::sort(v.begin(), v.end());
+  return v[std::min((size_t)(p * v.size()), v.size() - 1)];
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  uint32_t sf_len = SRSLTE_SF_LEN_PRB(cell.nof_prb);
+
+  // load all subframes of the capture
+  FILE* f = fopen(input_file_name, "r");
+  if (!f) {
+    perror("fopen");
+    exit(-1);
+  }
+  std::vector<cf_t> capture;
+  std::vector<cf_t> sf(sf_len);
+  while (fread(&sf[0], sizeof(cf_t), sf_len, f) == sf_len) {
+    capture.insert(capture.end(), sf.begin(), sf.end());
+  }
+  fclose(f);
+
+  uint32_t nof_sf = capture.size() / sf_len;
+  if (nof_sf == 0) {
+    printf("%s does not contain a complete subframe of %d PRB\n", input_file_name, cell.nof_prb);
+    exit(-1);
+  }
+
+  phy_args_t args      = phy_args_t();
+  args.nof_rx_ant      = 1;
+  args.nof_carriers    = 1;
+  args.nof_radios      = 1;
+  args.nof_rf_channels = 1;
+  args.equalizer_mode  = "mmse";
+  args.snr_estim_alg   = "refs";
+  args.sss_algorithm   = "full";
+  args.pdsch_max_its   = 8;
+  args.sidelink_master = sidelink_master;
+
+  srslte::log_filter log("PHY");
+  stack_dummy        stack;
+
+  phy_common common(1);
+  common.args  = &args;
+  common.stack = &stack;
+  common.set_cell(cell);
+
+  cc_worker worker(0, cell.nof_prb, &common, &log);
+  if (!worker.set_cell(cell)) {
+    printf("Error setting cell\n");
+    exit(-1);
+  }
+
+  std::vector<float> stage_us[SL_RX_NOF_STAGES];
+  std::vector<float> total_us;
+
+  // the PHY reports every decoded TB on stdout, keep it out of the measurement
+  fflush(stdout);
+  int stdout_fd = dup(STDOUT_FILENO);
+  int null_fd   = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+
+  uint32_t tti = start_tti;
+  for (uint32_t l = 0; l < nof_loops; l++) {
+    for (uint32_t i = 0; i < nof_sf; i++) {
+      memcpy(worker.get_rx_buffer(0), &capture[i * sf_len], sizeof(cf_t) * sf_len);
+      worker.set_tti(tti);
+
+      worker.work_sl_rx();
+
+      const float* times = worker.get_sl_rx_stage_times();
+      float        total = 0;
+      for (uint32_t s = 0; s < SL_RX_NOF_STAGES; s++) {
+        stage_us[s].push_back(times[s]);
+        total += times[s];
+      }
+      total_us.push_back(total);
+
+      tti = (tti + 1) % 10240;
+    }
+  }
+
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  fflush(stdout);
+  dup2(stdout_fd, STDOUT_FILENO);
+  close(null_fd);
+  close(stdout_fd);
+
+  printf("Replayed %d subframes (%d loops of %d) in %.1f ms, %d grants, %d TBs decoded\n",
+         nof_loops * nof_sf,
+         nof_loops,
+         nof_sf,
+         t[0].tv_sec * 1e3 + t[0].tv_usec / 1e3,
+         stack.nof_grants,
+         stack.nof_decoded);
+
+  FILE* csv = output_file_name ? fopen(output_file_name, "w") : NULL;
+  if (csv) {
+    fprintf(csv, "stage,nof_sf,mean_us,p50_us,p99_us,max_us\n");
+  }
+
+  printf("%-8s %10s %10s %10s %10s\n", "stage", "mean_us", "p50_us", "p99_us", "max_us");
+  for (uint32_t s = 0; s <= SL_RX_NOF_STAGES; s++) {
+    std::vector<float>& v    = (s < SL_RX_NOF_STAGES) ? stage_us[s] : total_us;
+    const char*         name = (s < SL_RX_NOF_STAGES) ? sl_stage_name((sl_stage_t)s) : "total";
+
+    float sum = 0;
+    for (uint32_t i = 0; i < v.size(); i++) {
+      sum += v[i];
+    }
+    float mean = sum / v.size();
+    float p50  = percentile(v, 0.50);
+    float p99  = percentile(v, 0.99);
+    float max  = v.back();
+
+    printf("%-8s %10.1f %10.1f %10.1f %10.1f\n", name, mean, p50, p99, max);
+    if (csv) {
+      fprintf(csv, "%s,%d,%.2f,%.2f,%.2f,%.2f\n", name, (uint32_t)v.size(), mean, p50, p99, max);
+    }
+  }
+
+  if (csv) {
+    fclose(csv);
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/**
+* Copyright 2013-2019 
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/common/common.h"
+#include "srssl/hdr/phy/ue_sl_sensing_sps.h"
+
+/*
+ * Compares the projected sensing index used by SensingSPS::resourceSelection()
+ * against the full scan of the sensing window under a dense V2X load.
+ */
+
+static SL_CommResourcePoolV2X_r14 rp = {
+    0,                                                             // sl_OffsetIndicator_r14
+    {0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, // sl_Subframe_r14
+    20,                                                            // sl_Subframe_r14_len
+    true,                                                          // adjacencyPSCCH_PSSCH_r14
+    5,                                                             // sizeSubchannel_r14
+    10,                                                            // numSubchannel_r14
+    0,                                                             // startRB_Subchannel_r14
+    0,                                                             // startRB_PSCCH_Pool_r14
+};
+
+static SL_CommTxPoolSensingConfig_r14 sensing_config;
+
+static uint32_t nof_selections = 100;
+static uint32_t nof_scis       = 10;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [ns]\n", prog);
+  printf("\t-n Number of resource selections [Default %d]\n", nof_selections);
+  printf("\t-s Number of SCIs per TTI [Default %d]\n", nof_scis);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "ns")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_selections = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        nof_scis = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static bool equal(srslte::CandidateResources& a, srslte::CandidateResources& b, uint32_t window, uint32_t L)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < window; ++i) {
+    for (uint32_t c = 0; c + L <= rp.numSubchannel_r14; ++c) {
+      if (a.valid(i, c) != b.valid(i, c)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  for (uint32_t i = 0; i < size_thresPSSCH_RSRP_List_r14; ++i) {
+    sensing_config.thresPSSCH_RSRP_List_r14[i] = -100.0;
+  }
+  sensing_config.restrictResourceReservationPeriod_r14[0] = 1.0;
+  sensing_config.probResourceKeep_r14                     = 0.5;
+  sensing_config.sl_ReselectAfter_r14                     = 1;
+
+  srslte::SensingSPS* sps = new srslte::SensingSPS(&rp, &sensing_config, 1000);
+
+  srand(0);
+
+  const uint32_t t1 = TX_DELAY, t2 = 50, L = 2, prio = 0, Cresel = 10, PrsvpTx = 100;
+
+  struct timeval t[3];
+  double         usec_projected = 0, usec_full = 0;
+  uint32_t       tti            = 0;
+  int            ret            = 0;
+
+  // keep the debug output of the selection out of the measurement
+  fflush(stdout);
+  int stdout_fd = dup(STDOUT_FILENO);
+  if (!freopen("/dev/null", "w", stdout)) {
+    return -1;
+  }
+
+  for (uint32_t n = 0; n < 1000 + nof_selections; ++n, tti = (tti + 1) % 10240) {
+    sps->tick(tti);
+
+    // every 20th subframe is used for our own transmissions
+    if (tti % 20 != 0) {
+      sps->addAverageSRSSI(tti, -90.0 + rand() % 20);
+      for (uint32_t c = 0; c < rp.numSubchannel_r14; ++c) {
+        sps->addChannelSRSSI(tti, c, -90.0 + rand() % 20);
+      }
+      for (uint32_t i = 0; i < nof_scis; ++i) {
+        uint32_t len = 1 + rand() % 3;
+        sps->addSCI(tti, rand() % (rp.numSubchannel_r14 - len + 1), len, 1 + rand() % 2, rand() % 8, -110.0 + rand() % 30);
+      }
+    }
+
+    if (n < 1000) {
+      continue;
+    }
+
+    gettimeofday(&t[1], NULL);
+    srslte::CandidateResources a = sps->resourceSelection(tti, t1, t2, L, prio, Cresel, PrsvpTx);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec_projected += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+    gettimeofday(&t[1], NULL);
+    srslte::CandidateResources b = sps->resourceSelectionFullScan(tti, t1, t2, L, prio, Cresel, PrsvpTx);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec_full += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+    if (!equal(a, b, t2 - t1, L)) {
+      ret = -1;
+    }
+  }
+
+  fflush(stdout);
+  dup2(stdout_fd, STDOUT_FILENO);
+  close(stdout_fd);
+
+  printf("SCIs/TTI=%d selections=%d\n", nof_scis, nof_selections);
+  printf("projected index: %.1f us/selection\n", usec_projected / nof_selections);
+  printf("full scan:       %.1f us/selection\n", usec_full / nof_selections);
+  printf("results %s\n", ret ? "differ" : "match");
+
+  delete sps;
+  exit(ret);
+}
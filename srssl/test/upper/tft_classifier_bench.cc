@@ -0,0 +1,344 @@
+/**
+* Copyright 2013-2019
+* Fraunhofer Institute for Telecommunications, Heinrich-Hertz-Institut (HHI)
+*
+* This file is part of the HHI Sidelink.
+*
+* HHI Sidelink is under the terms of the GNU Affero General Public License
+* as published by the Free Software Foundation version 3.
+*
+* HHI Sidelink is distributed WITHOUT ANY WARRANTY,
+* without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* A copy of the GNU Affero General Public License can be found in
+* the LICENSE file in the top-level directory of this distribution
+* and at http://www.gnu.org/licenses/.
+*
+* The HHI Sidelink is based on srsLTE.
+* All necessary files and sources from srsLTE are part of HHI Sidelink.
+* srsLTE is under Copyright 2013-2017 by Software Radio Systems Limited.
+* srsLTE can be found under:
+* https://github.com/srsLTE/srsLTE
+*/
+
+#include "srslte/common/log_filter.h"
+#include "srssl/hdr/stack/upper/tft_classifier.h"
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/*
+ * Classifies random IPv4/IPv6 packets against a set of random TFT packet
+ * filters, once by walking the filters in precedence order as the GW used to
+ * and once with the compiled classifier, and checks both give the same result.
+ * With -c another thread keeps rebuilding and publishing the classifier while
+ * the packets are classified, like NAS does when the TFTs change.
+ */
+
+using namespace srsue;
+using namespace srslte;
+
+uint32_t nof_filters = 500;
+uint32_t nof_packets = 1000000;
+bool     churn       = false;
+
+#define NOF_PDUS 256
+#define NOF_ADDR 256
+#define NOF_PORTS 4096
+
+typedef struct {
+  const tft_classifier::filter_map_t* filter_map;
+  tft_classifier_rcu*                 rcu;
+  volatile bool                       stop;
+  uint32_t                            nof_publish;
+} churn_args_t;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [npc]\n", prog);
+  printf("\t-n number of packet filters [Default %d]\n", nof_filters);
+  printf("\t-p number of packets to classify [Default %d]\n", nof_packets);
+  printf("\t-c rebuild the classifier continuously [Default %s]\n", churn ? "yes" : "no");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "npc")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_filters = atoi(argv[optind]);
+        break;
+      case 'p':
+        nof_packets = atoi(argv[optind]);
+        break;
+      case 'c':
+        churn = true;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+uint32_t rand_addr()
+{
+  return htonl(0x0a000000 | (rand() % NOF_ADDR));
+}
+
+uint16_t rand_port()
+{
+  return 1024 + rand() % NOF_PORTS;
+}
+
+uint8_t rand_protocol()
+{
+  return rand() % 4 ? UDP_PROTOCOL : TCP_PROTOCOL;
+}
+
+uint8_t* put_port(uint8_t* f, uint16_t port)
+{
+  *f++ = port >> 8;
+  *f++ = port & 0xff;
+  return f;
+}
+
+// Filters follow a few shapes, as operators configure them per service
+tft_packet_filter_t rand_filter(uint32_t i, log_filter* log)
+{
+  LIBLTE_MME_PACKET_FILTER_STRUCT tft = {};
+  tft.dir                             = LIBLTE_MME_TFT_PACKET_FILTER_DIRECTION_BIDIRECTIONAL;
+  tft.id                              = i & 0xff;
+  tft.eval_precedence                 = i & 0xff;
+
+  uint32_t addr = rand_addr();
+  uint16_t port = rand_port();
+  uint8_t* f    = tft.filter;
+  switch (rand() % 5) {
+    case 0: // Server flow
+      *f++ = IPV4_REMOTE_ADDR_TYPE;
+      memcpy(f, &addr, 4);
+      f += 4;
+      *f++ = PROTOCOL_ID_TYPE;
+      *f++ = rand_protocol();
+      *f++ = SINGLE_REMOTE_PORT_TYPE;
+      f    = put_port(f, port);
+      break;
+    case 1: // Server port range
+      *f++ = IPV4_REMOTE_ADDR_TYPE;
+      memcpy(f, &addr, 4);
+      f += 4;
+      *f++ = REMOTE_PORT_RANGE_TYPE;
+      f    = put_port(f, port);
+      f    = put_port(f, port + rand() % 16);
+      break;
+    case 2: // Local application
+      *f++ = PROTOCOL_ID_TYPE;
+      *f++ = rand_protocol();
+      *f++ = SINGLE_LOCAL_PORT_TYPE;
+      f    = put_port(f, port);
+      break;
+    case 3: // Remote host
+      *f++ = IPV4_REMOTE_ADDR_TYPE;
+      memcpy(f, &addr, 4);
+      f += 4;
+      break;
+    case 4: // Marked traffic
+      *f++ = TYPE_OF_SERVICE_TYPE;
+      *f++ = 1 + rand() % 255;
+      *f++ = 0xff;
+      break;
+  }
+  tft.filter_size = f - tft.filter;
+
+  // The bearer and LCID identify the filter in the comparison
+  return tft_packet_filter_t(i & 0xff, i >> 8, tft, log);
+}
+
+// Half of the packets are built to pass a random filter, which may still be
+// shadowed by one with a lower precedence value
+void rand_packet(byte_buffer_t* pdu, tft_classifier::filter_map_t& filter_map)
+{
+  bzero(pdu->msg, 48);
+  if (rand() % 10 == 0) {
+    pdu->msg[0]  = 0x60;
+    pdu->msg[6]  = rand_protocol();
+    pdu->N_bytes = 48;
+    return;
+  }
+  uint32_t saddr = rand_addr();
+  uint32_t daddr = rand_addr();
+  uint16_t sport = rand_port();
+  uint16_t dport = rand_port();
+  uint8_t  proto = rand_protocol();
+  uint8_t  tos   = 0;
+  if (rand() % 2) {
+    tft_classifier::filter_map_t::iterator it = filter_map.find(rand() % filter_map.size());
+    tft_packet_filter_t&                   f  = it->second;
+    if (f.active_filters & IPV4_REMOTE_ADDR_FLAG) {
+      daddr = f.ipv4_remote_addr;
+    }
+    if (f.active_filters & PROTOCOL_ID_FLAG) {
+      proto = f.protocol_id;
+    }
+    if (f.active_filters & (SINGLE_LOCAL_PORT_FLAG | SINGLE_REMOTE_PORT_FLAG | REMOTE_PORT_RANGE_FLAG)) {
+      proto = UDP_PROTOCOL;
+    }
+    if (f.active_filters & SINGLE_LOCAL_PORT_FLAG) {
+      sport = ntohs(f.single_local_port);
+    }
+    if (f.active_filters & SINGLE_REMOTE_PORT_FLAG) {
+      dport = ntohs(f.single_remote_port);
+    }
+    if (f.active_filters & REMOTE_PORT_RANGE_FLAG) {
+      dport = f.remote_port_range[0] + rand() % (f.remote_port_range[1] - f.remote_port_range[0] + 1);
+    }
+    if (f.active_filters & TYPE_OF_SERVICE_FLAG) {
+      tos = f.type_of_service;
+    }
+  }
+  sport       = htons(sport);
+  dport       = htons(dport);
+  pdu->msg[0] = 0x45;
+  pdu->msg[1] = tos;
+  pdu->msg[3] = 28;
+  pdu->msg[9] = proto;
+  memcpy(&pdu->msg[12], &saddr, 4);
+  memcpy(&pdu->msg[16], &daddr, 4);
+  memcpy(&pdu->msg[20], &sport, 2);
+  memcpy(&pdu->msg[22], &dport, 2);
+  pdu->N_bytes = 28;
+}
+
+const tft_packet_filter_t* linear_match(tft_classifier::filter_map_t& filter_map, const unique_byte_buffer_t& pdu)
+{
+  for (tft_classifier::filter_map_t::iterator it = filter_map.begin(); it != filter_map.end(); ++it) {
+    if (it->second.match(pdu)) {
+      return &it->second;
+    }
+  }
+  return NULL;
+}
+
+bool same_filter(const tft_packet_filter_t* a, const tft_packet_filter_t* b)
+{
+  if (a == NULL || b == NULL) {
+    return a == b;
+  }
+  return a->eps_bearer_id == b->eps_bearer_id && a->lcid == b->lcid;
+}
+
+void* churn_thread(void* a)
+{
+  churn_args_t* args = (churn_args_t*)a;
+  while (!args->stop) {
+    args->rcu->publish(new tft_classifier(*args->filter_map));
+    args->nof_publish++;
+  }
+  return NULL;
+}
+
+double elapsed_ns(struct timeval* t, uint32_t n)
+{
+  get_time_interval(t);
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) * 1e3 / n;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  srand(0);
+
+  log_filter log("TFT");
+  log.set_level(LOG_LEVEL_NONE);
+
+  tft_classifier::filter_map_t filter_map;
+  for (uint32_t i = 0; i < nof_filters; i++) {
+    filter_map.insert(std::make_pair((uint16_t)i, rand_filter(i, &log)));
+  }
+
+  byte_buffer_pool*    pool = byte_buffer_pool::get_instance();
+  unique_byte_buffer_t pdus[NOF_PDUS];
+  for (uint32_t i = 0; i < NOF_PDUS; i++) {
+    pdus[i] = allocate_unique_buffer(*pool, true);
+    rand_packet(pdus[i].get(), filter_map);
+  }
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  tft_classifier* classifier = new tft_classifier(filter_map);
+  gettimeofday(&t[2], NULL);
+  printf("Compiled %d filters into %d groups in %.1f us\n",
+         classifier->nof_filters(),
+         classifier->nof_groups(),
+         elapsed_ns(t, 1000));
+
+  tft_classifier_rcu rcu;
+  rcu.publish(classifier);
+
+  // Reference results, also the timing of the linear walk
+  const tft_packet_filter_t* expected[NOF_PDUS];
+  uint32_t                   nof_linear = SRSLTE_MAX(nof_packets / 100, NOF_PDUS);
+  uint32_t                   nof_match  = 0;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_linear; i++) {
+    expected[i % NOF_PDUS] = linear_match(filter_map, pdus[i % NOF_PDUS]);
+  }
+  gettimeofday(&t[2], NULL);
+  double linear_ns = elapsed_ns(t, nof_linear);
+  for (uint32_t i = 0; i < NOF_PDUS; i++) {
+    nof_match += expected[i] != NULL;
+  }
+
+  churn_args_t args = {&filter_map, &rcu, false, 0};
+  pthread_t    churn_id;
+  if (churn) {
+    pthread_create(&churn_id, NULL, churn_thread, &args);
+  }
+
+  uint32_t nof_errors = 0;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_packets; i++) {
+    const tft_classifier*      c      = rcu.read_lock();
+    const tft_packet_filter_t* filter = c->match(pdus[i % NOF_PDUS]);
+    if (!same_filter(filter, expected[i % NOF_PDUS])) {
+      nof_errors++;
+    }
+    rcu.read_unlock();
+  }
+  gettimeofday(&t[2], NULL);
+  double compiled_ns = elapsed_ns(t, nof_packets);
+
+  if (churn) {
+    args.stop = true;
+    pthread_join(churn_id, NULL);
+  }
+
+  printf("%d filters, %d/%d packets match: linear %.1f ns, compiled %.1f ns per packet",
+         nof_filters,
+         nof_match,
+         NOF_PDUS,
+         linear_ns,
+         compiled_ns);
+  if (churn) {
+    printf(", %d rebuilds", args.nof_publish);
+  }
+  printf("\n");
+
+  for (uint32_t i = 0; i < NOF_PDUS; i++) {
+    pdus[i].reset();
+  }
+  byte_buffer_pool::cleanup();
+
+  if (nof_errors) {
+    printf("%d packets classified differently\n", nof_errors);
+    exit(-1);
+  }
+  printf("Ok\n");
+  exit(0);
+}